@@ -19,21 +19,68 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "HeaderList.h"
+#include <algorithm>
+#include "mclass.h"
 
 void HeaderList::add(std::shared_ptr<MElement> aElement) {
     mHeaderList.push_back(aElement);
 }
 
 void HeaderList::done(std::shared_ptr<MElement> aElement) {
-    mDoneList.insert(aElement);
+    if (aElement->IsClassBased()) {
+        size_t ordinal = static_cast<MClass*>(aElement.get())->mOrdinal;
+
+        if (mDoneClasses.size() <= ordinal / 64) {
+            mDoneClasses.resize(MClass::mClassCount / 64 + 1, 0);
+        }
+        mDoneClasses[ordinal / 64] |= (uint64_t(1) << (ordinal % 64));
+    } else {
+        mDoneList.insert(aElement);
+    }
 }
 
 void HeaderList::clear() {
     mHeaderList.clear();
+    mDoneClasses.clear();
     mDoneList.clear();
 }
 
+//
+//  Marks all classes of the bitset as done.
+void HeaderList::done(const std::vector<uint64_t>& aClasses) {
+    if (mDoneClasses.size() < aClasses.size()) {
+        mDoneClasses.resize(aClasses.size(), 0);
+    }
+    for (size_t i = 0; i < aClasses.size(); ++i) {
+        mDoneClasses[i] |= aClasses[i];
+    }
+}
+
+//
+//  True if one of the classes of the bitset is done.
+bool HeaderList::isdone(const std::vector<uint64_t>& aClasses) const {
+    size_t words = std::min(mDoneClasses.size(), aClasses.size());
+
+    for (size_t i = 0; i < words; ++i) {
+        if ((mDoneClasses[i] & aClasses[i]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HeaderClosure::reaches(const MElement* aClass) const {
+    size_t ordinal = static_cast<const MClass*>(aClass)->mOrdinal;
+
+    return (ordinal / 64 < reach.size()) && ((reach[ordinal / 64] & (uint64_t(1) << (ordinal % 64))) != 0);
+}
+
 bool HeaderList::isdone(std::shared_ptr<MElement> aDone) {
+    if (aDone->IsClassBased()) {
+        size_t ordinal = static_cast<MClass*>(aDone.get())->mOrdinal;
+
+        return (ordinal / 64 < mDoneClasses.size()) && ((mDoneClasses[ordinal / 64] & (uint64_t(1) << (ordinal % 64))) != 0);
+    }
     if (mDoneList.find(aDone) != mDoneList.end()) {
         return true;
     }
@@ -21,10 +21,36 @@
 #ifndef XMI2CODE_HEADERLIST_H
 #define XMI2CODE_HEADERLIST_H
 
+#include <deque>
 #include <list>
+#include <map>
 #include <set>
+#include <vector>
+#include <cstdint>
 #include "melement.h"
 
+class CClassBase;
+
+//
+//  One step of the header collection of a class. The steps only depend on the
+//  class, so they are collected once and replayed for every class that needs it.
+struct HeaderStep {
+    enum class Kind {
+        Needed,     //  Collect the element into the header list in work.
+        Optional,   //  Collect the element into the optional header list.
+        Extra,      //  Add the element to the extra headers.
+        Add         //  Add the element to the header list in work.
+    };
+    Kind                      kind;
+    std::shared_ptr<MElement> element;
+};
+
+struct HeaderSteps {
+    size_t                  attributes = 0;    //  Size of allAttr when collected.
+    size_t                  ends       = 0;    //  Size of allEnds when collected.
+    std::vector<HeaderStep> steps;
+};
+
 class HeaderList {
 public:
     void add(std::shared_ptr<MElement> aElement);
@@ -33,9 +59,72 @@ public:
     std::list<std::shared_ptr<MElement>>::iterator begin() {return mHeaderList.begin();}
     std::list<std::shared_ptr<MElement>>::iterator end() { return mHeaderList.end();}
     void clear();
+    void done(const std::vector<uint64_t>& aClasses);
+    bool isdone(const std::vector<uint64_t>& aClasses) const;
 public:
     std::list<std::shared_ptr<MElement>>  mHeaderList;
-    std::set<std::shared_ptr<MElement>>   mDoneList;
+    std::vector<uint64_t>                 mDoneClasses;   //  Bitset over the class ordinals.
+    std::set<std::shared_ptr<MElement>>   mDoneList;      //  Elements that are not class based.
+};
+
+//
+//  The header collection from one class into one list as if it starts with an
+//  empty list. It is kept as the sequence of visits with the adds and extras of
+//  each visit. If none of the classes it reaches is still in collection, every
+//  class it reaches that is done has everything it reaches done as well. So the
+//  collection is the same as the sequence without the visits of classes that are
+//  done and everything collected below them. If none is done, the classes it
+//  reaches are or'ed into the done classes at once.
+//  The optional list does not feed back into the header list in work, so it is
+//  collected when the closure is replayed.
+struct HeaderClosure {
+    struct Event {
+        enum class Kind {
+            Visit,      //  The class is done.
+            Add,        //  The element is added to the list.
+            Extra,      //  The element is added to the extra headers.
+            Optional    //  The element is collected into the optional list.
+        };
+        Kind                      kind;
+        size_t                    end;        //  Of a visit, the first event not collected below it.
+        std::shared_ptr<MElement> element;
+    };
+    size_t                generation = 0;      //  Generation of the steps it was collected from.
+    bool                  building   = false;  //  Set while collecting, to break cycles.
+    std::vector<Event>    events;
+    std::vector<uint64_t> reach;               //  Bitset of the classes done by the closure.
+
+    bool reaches(const MElement* aClass) const;
+};
+
+//
+//  Work state while the strongly connected components of the header steps are
+//  collected. Classes in one component reach each other.
+struct HeaderComponents {
+    size_t                                      next = 0;
+    std::map<size_t, std::pair<size_t, size_t>> index;   //  Index and lowest index reached, by slot.
+    std::vector<size_t>                         stack;
+};
+
+//
+//  The header closures and components of the classes of one namespace. The slot
+//  of a class is twice its ordinal, plus one for the optional list.
+struct HeaderGraph {
+    size_t                    generation = 0;   //  Generation of the steps the components are collected from.
+    std::deque<HeaderClosure> closure;
+    std::vector<size_t>       component;        //  Class ordinal that names the component, SIZE_MAX if not collected.
+};
+
+//
+//  The parts of a header collection that stay the same while the classes are walked.
+struct HeaderWalk {
+    HeaderList*                             optional;
+    std::list<std::shared_ptr<CClassBase>>* extras;
+    const MElement*                         self;     //  The class the headers are for, nullptr for a closure.
+    HeaderClosure*                          record;   //  The closure in collection, if any.
+    bool                                    build;    //  Missing closures are collected.
+    size_t                                  component;          //  Component of the class in work.
+    size_t                                  componentOptional;  //  Component of the class in work on the optional list.
 };
 
 
@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <map>
 #include "melement.h"
 #include "medge.h"
 #include "cedge.h"
@@ -49,6 +50,9 @@
 #include "csignalclass.h"
 #include "cmessageclass.h"
 
+#include "helper.h"
+#include "codewriter.h"
+
 std::string CActivity::FQN() const {
     return name;
 }
@@ -211,6 +215,16 @@ std::list<std::shared_ptr<MElement>> CActivity::CreateBlock(std::shared_ptr<MEle
 }
 
 void CActivity::DumpCxx(std::ostream &src) {
+    if (IsParallel()) {
+        std::ostringstream code;
+
+        if (DumpStructured(code)) {
+            src << code.str();
+            return;
+        }
+        src << "//\n"
+               "//  " << name << " has more than actions, forks and joins. It is listed as blocks.\n";
+    }
     auto il = GetInitialNode();
 
 
@@ -735,8 +749,7 @@ void CActivity::DumpCxx(std::ostream &src, std::shared_ptr<CActionNode> node, in
             //
             //  Remove trailing newlines from the comment.
             while ((node->Body.size()>0) && (node->Body.back()=='\n')) {
-                //comment.pop_back();
-                node->Body = node->Body.substr(0, comment.size()-1);
+                node->Body.pop_back();
             }
             iss.str(node->Body);
             if (node->Body.size() > 0) {
@@ -994,3 +1007,228 @@ std::shared_ptr<MEdge> CActivity::FindEdge(std::shared_ptr<MPin> pin) {
     }
     return retval;
 }
+
+bool CActivity::IsParallel() const {
+    return helper::tolower(helper::trim(GetTaggedValue("Concurrency"))) == "parallel";
+}
+//
+//  The code of the whole activity is generated in one walk along the control
+//  flow. The walk must start on one node and end without a join.
+bool CActivity::DumpStructured(std::ostream &src) {
+    std::vector<std::shared_ptr<MNode>> start = GetInitialNode();
+    std::vector<std::shared_ptr<MNode>> nodes;
+    std::shared_ptr<MNode>              join;
+
+    mForks = 0;
+    mVisited.clear();
+    if (start.size() != 1) {
+        return false;
+    }
+    return DumpSequence(src, start[0], join, nodes) && !join;
+}
+//
+//  Writes the actions from aNode on. The walk ends on a final node, a node
+//  without outgoing edges or on a join, which is passed back in aJoin. All
+//  nodes passed are added to aNodes. Decisions, merges and loops are not
+//  handled here.
+bool CActivity::DumpSequence(std::ostream &src, std::shared_ptr<MNode> aNode, std::shared_ptr<MNode>& aJoin, std::vector<std::shared_ptr<MNode>>& aNodes) {
+    auto node = aNode;
+
+    aJoin = nullptr;
+    while (node) {
+        if (node->type == eElementType::JoinNode) {
+            aJoin = node;
+            return true;
+        }
+        if (!mVisited.insert(node).second) {
+            return false;
+        }
+        aNodes.push_back(node);
+        switch (node->type) {
+        case eElementType::ActionNode:
+            DumpCxx(src, std::dynamic_pointer_cast<CActionNode>(node), 0);
+            break;
+        case eElementType::ForkNode:
+            if (!DumpFork(src, node, node, aNodes)) {
+                return false;
+            }
+            break;
+        case eElementType::InitialNode:
+            break;
+        case eElementType::FinalNode:
+            return true;
+        default:
+            return false;
+        }
+        auto next = Successors(node);
+
+        if (next.size() > 1) {
+            return false;
+        }
+        node = (next.empty()) ? nullptr : next[0]->GetTargetNode();
+    }
+    return true;
+}
+//
+//  All branches of a fork must end on the same join. The branches become tasks
+//  if they share no data, otherwise they are written one after the other.
+bool CActivity::DumpFork(std::ostream &src, std::shared_ptr<MNode> aFork, std::shared_ptr<MNode>& aJoin, std::vector<std::shared_ptr<MNode>>& aNodes) {
+    std::vector<std::vector<std::shared_ptr<MNode>>> branches;
+    std::vector<std::string>                         code;
+    std::shared_ptr<MNode>                           join;
+    std::string                                      forkname = (aFork->name.empty()) ? std::string("Fork") : aFork->name;
+    std::string                                      prefix   = "fork" + std::to_string(mForks++) + "_";
+
+    for (auto & o : aFork->Outgoing) {
+        auto                   edge = std::dynamic_pointer_cast<MEdge>(*o);
+        std::ostringstream     branch;
+        std::shared_ptr<MNode> end;
+
+        branches.emplace_back();
+        if (!DumpSequence(branch, edge->GetTargetNode(), end, branches.back()) || !end || (join && (end != join))) {
+            return false;
+        }
+        join = end;
+        code.push_back(branch.str());
+    }
+    if (!join) {
+        return false;
+    }
+    for (auto & b : branches) {
+        aNodes.insert(aNodes.end(), b.begin(), b.end());
+    }
+    aNodes.push_back(join);
+
+    std::string joinname = (join->name.empty()) ? std::string("Join") : join->name;
+    std::string shared   = SharedName(branches, join);
+
+    if (!shared.empty() || (branches.size() < 2)) {
+        src << "    //\n"
+               "    //  " << forkname;
+        if (!shared.empty()) {
+            src << ": The branches share " << shared << " and run one after the other.\n";
+        } else {
+            src << "\n";
+        }
+        for (auto & c : code) {
+            src << c;
+        }
+        src << "    //\n"
+               "    //  " << joinname << "\n";
+    } else {
+        std::string executor = helper::trim(GetTaggedValue("Executor"));
+
+        src << "    {\n"
+               "        //\n"
+               "        //  " << forkname << ": The branches run concurrently.\n";
+        for (size_t b = 0; b < code.size(); ++b) {
+            if (executor.empty()) {
+                src << "        auto " << prefix << b << " = std::async(std::launch::async, [&]() {\n";
+            } else {
+                src << "        auto " << prefix << b << " = " << executor << ".submit([&]() {\n";
+            }
+            src << CodeWriter::shift(code[b], 8)
+                << "        });\n";
+        }
+        src << "        //\n"
+               "        //  " << joinname << "\n";
+        for (size_t b = 0; b < code.size(); ++b) {
+            src << "        " << prefix << b << ".get();\n";
+        }
+        src << "    }\n";
+    }
+    aJoin = join;
+    return true;
+}
+//
+//  The control flow leaves a node on the edges that start on the node. Nodes
+//  connected by object flows only follow those.
+std::vector<std::shared_ptr<MEdge>> CActivity::Successors(std::shared_ptr<MNode> aNode) {
+    std::vector<std::shared_ptr<MEdge>> control;
+    std::vector<std::shared_ptr<MEdge>> all;
+
+    for (auto & o : aNode->Outgoing) {
+        auto edge = std::dynamic_pointer_cast<MEdge>(*o);
+
+        if (*edge->Source == aNode) {
+            control.push_back(edge);
+        }
+        all.push_back(edge);
+    }
+    return (control.empty()) ? all : control;
+}
+//
+//  Two branches share data if one writes what the other reads or writes, or if
+//  an edge leads from a branch to another branch or out of the fork. The name
+//  of the first shared element is returned.
+std::string CActivity::SharedName(const std::vector<std::vector<std::shared_ptr<MNode>>>& aBranches, std::shared_ptr<MNode> aJoin) {
+    std::vector<std::set<std::string>>       reads(aBranches.size());
+    std::vector<std::set<std::string>>       writes(aBranches.size());
+    std::map<std::shared_ptr<MNode>, size_t> owner;
+
+    for (size_t b = 0; b < aBranches.size(); ++b) {
+        for (auto & n : aBranches[b]) {
+            owner[n] = b;
+            Access(n, reads[b], writes[b]);
+        }
+    }
+    for (auto & e : Edges) {
+        auto                      edge   = std::dynamic_pointer_cast<MEdge>(*e);
+        std::shared_ptr<MElement> source = *edge->Source;
+        std::shared_ptr<MNode>    node;
+
+        if (source && source->IsNodeBased()) {
+            node = std::dynamic_pointer_cast<MNode>(source);
+        } else if (source && (source->type == eElementType::Pin)) {
+            node = std::dynamic_pointer_cast<MNode>(*source->parent);
+        }
+        auto from = owner.find(node);
+
+        if (from != owner.end()) {
+            auto target = edge->GetTargetNode();
+            auto to     = owner.find(target);
+
+            if (((to != owner.end()) && (to->second != from->second)) || ((to == owner.end()) && (target != aJoin))) {
+                return source->name;
+            }
+        }
+    }
+    for (size_t b = 0; b < aBranches.size(); ++b) {
+        for (size_t o = 0; o < aBranches.size(); ++o) {
+            if (o != b) {
+                for (auto & w : writes[b]) {
+                    if ((writes[o].count(w) != 0) || (reads[o].count(w) != 0)) {
+                        return w;
+                    }
+                }
+            }
+        }
+    }
+    return std::string();
+}
+//
+//  The names an action reads and writes as seen by its pins. A write action
+//  assigns to its input pins, all other actions read them. Output pins are
+//  written.
+void CActivity::Access(std::shared_ptr<MNode> aNode, std::set<std::string>& aReads, std::set<std::string>& aWrites) {
+    auto action = std::dynamic_pointer_cast<CActionNode>(aNode);
+
+    if (action) {
+        for (auto & p : action->OutputPins) {
+            aWrites.insert((*p)->name);
+        }
+        for (auto & p : action->InputPins) {
+            auto pin  = std::dynamic_pointer_cast<MPin>(*p);
+            auto edge = FindEdge(pin);
+
+            if (edge && *edge->Source && (*edge->Source != pin)) {
+                aReads.insert(edge->Source->name);
+            }
+            if (action->Kind == eActionKind::Write) {
+                aWrites.insert(pin->name);
+            } else {
+                aReads.insert(pin->name);
+            }
+        }
+    }
+}
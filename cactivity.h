@@ -23,6 +23,7 @@
 #include <string>
 #include <list>
 #include <vector>
+#include <set>
 
 class MElement;
 class MNode;
@@ -78,9 +79,22 @@ public:
     std::list<std::shared_ptr<MElement>> CreateBlock(std::shared_ptr<MElement> aStart);
     std::list<std::shared_ptr<MElement>> GetDumpNodes(std::shared_ptr<MNode> start);
     std::list<std::shared_ptr<MElement>> GetDumpNodes(std::shared_ptr<MEdge> start);
+    //
+    //  The generation mode of the tagged value Concurrency=parallel. It takes
+    //  activities made of actions, forks and joins only.
+    bool IsParallel() const;
+    bool DumpStructured(std::ostream& src);
+    bool DumpSequence(std::ostream& src, std::shared_ptr<MNode> aNode, std::shared_ptr<MNode>& aJoin, std::vector<std::shared_ptr<MNode>>& aNodes);
+    bool DumpFork(std::ostream& src, std::shared_ptr<MNode> aFork, std::shared_ptr<MNode>& aJoin, std::vector<std::shared_ptr<MNode>>& aNodes);
+    std::vector<std::shared_ptr<MEdge>> Successors(std::shared_ptr<MNode> aNode);
+    std::string SharedName(const std::vector<std::vector<std::shared_ptr<MNode>>>& aBranches, std::shared_ptr<MNode> aJoin);
+    void Access(std::shared_ptr<MNode> aNode, std::set<std::string>& aReads, std::set<std::string>& aWrites);
 public:
     std::vector<std::shared_ptr<MNode>> activNodes;
     std::list<std::list<std::shared_ptr<MElement> > > mBlock;
+private:
+    int                              mForks = 0;
+    std::set<std::shared_ptr<MNode>> mVisited;
 };
 
 #endif // CACTIVITY_H
@@ -18,7 +18,12 @@
 // CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
 #include "massociationend.h"
+#include "massociation.h"
 #include "cassociationend.h"
 
 CAssociationEnd::CAssociationEnd()
@@ -66,8 +71,155 @@ void CAssociationEnd::Prepare(void) {
         isMultiple   = true;
         isCollection = false;
     }
+    ResolveContainerPolicy();
+}
+
+//
+//  The container policy is looked up at the end, the association, the class
+//  that owns the end and then up the package hierarchy. The first tagged value
+//  found wins.
+void CAssociationEnd::ResolveContainerPolicy(void) {
+    std::vector<std::shared_ptr<MElement>> chain;
+    auto ma = std::dynamic_pointer_cast<MAssociation>(*parent);
+
+    chain.push_back(sharedthis<MElement>());
+    if (ma) {
+        chain.push_back(ma);
+        if (ma->ends.size() > 1) {
+            auto other = ma->OtherEnd(sharedthis<MAssociationEnd>());
+
+            if ((other) && (other->Classifier)) {
+                for (std::shared_ptr<MElement> e = *other->Classifier; e; e = *e->parent) {
+                    chain.push_back(e);
+                }
+            }
+        }
+    }
+    for (auto & e : chain) {
+        if (e->HasTaggedValue("ContainerPolicy")) {
+            std::string policy = helper::tolower(helper::trim(e->GetTaggedValue("ContainerPolicy")));
+
+            if (policy == "vector") {
+                mContainerPolicy = EContainerPolicy::vector;
+            } else if ((policy == "flatmap") || (policy == "flat_map")) {
+                mContainerPolicy = EContainerPolicy::flatmap;
+            } else if ((policy == "unorderedmap") || (policy == "unordered_map")) {
+                mContainerPolicy = EContainerPolicy::unorderedmap;
+            } else if ((policy == "smallvector") || (policy == "small_vector")) {
+                mContainerPolicy = EContainerPolicy::smallvector;
+            } else if ((policy == "slotmap") || (policy == "slot_map")) {
+                mContainerPolicy = EContainerPolicy::slotmap;
+            } else if ((policy == "shardedmap") || (policy == "sharded_map")) {
+                mContainerPolicy = EContainerPolicy::shardedmap;
+            } else if ((policy == "snapshotmap") || (policy == "snapshot_map")) {
+                mContainerPolicy = EContainerPolicy::snapshotmap;
+            } else if (policy != "map") {
+                std::cerr << "Unknown container policy " << policy << " at " << name << "\n";
+            }
+            //
+            //  The size is the inline capacity of the small vector and the number
+            //  of shards of the sharded map. Both need at least one.
+            if (e->HasTaggedValue("ContainerSize")) {
+                std::string size = helper::trim(e->GetTaggedValue("ContainerSize"));
+
+                if ((!size.empty()) && (size.size() < 10) && std::all_of(size.begin(), size.end(), ::isdigit) &&
+                    (std::stoul(size) > 0)) {
+                    mContainerSize = std::stoul(size);
+                } else {
+                    std::cerr << "Invalid container size " << size << " in " << e->name << ". The default policy is used.\n";
+                    mContainerPolicy = EContainerPolicy::map;
+                }
+            }
+            break;
+        }
+    }
+    //
+    //  A qualified end needs the qualifier as key. The sequence containers have
+    //  no key, so they fall back to the flat map.
+    if ((!QualifierType.empty()) && ((mContainerPolicy == EContainerPolicy::vector) ||
+                                     (mContainerPolicy == EContainerPolicy::smallvector) ||
+                                     (mContainerPolicy == EContainerPolicy::slotmap))) {
+        mContainerPolicy = EContainerPolicy::flatmap;
+    }
+    //
+    //  Struct members are written in place one by one. The snapshot map would
+    //  copy the whole map for each of them, so those ends take the sharded map.
+    if ((mContainerPolicy == EContainerPolicy::snapshotmap) && (Classifier) &&
+        (Classifier->type == eElementType::Struct)) {
+        mContainerPolicy = EContainerPolicy::shardedmap;
+    }
+}
+
+std::string CAssociationEnd::MkContainer(const std::string& aKey, const std::string& aValue) const {
+    std::string retval;
+
+    switch (mContainerPolicy) {
+    case EContainerPolicy::vector:
+        retval = "std::vector< " + aValue + " >";
+        break;
+    case EContainerPolicy::flatmap:
+        retval = "mtt::flat_map< " + aKey + ", " + aValue + " >";
+        break;
+    case EContainerPolicy::unorderedmap:
+        retval = "std::unordered_map< " + aKey + ", " + aValue + " >";
+        break;
+    case EContainerPolicy::smallvector:
+        retval = "mtt::small_vector< " + aValue + ", " + std::to_string(mContainerSize) + " >";
+        break;
+    case EContainerPolicy::slotmap:
+        retval = "mtt::slot_map< " + aValue + " >";
+        break;
+    case EContainerPolicy::shardedmap:
+        retval = "mtt::sharded_map< " + aKey + ", " + aValue + ", " + std::to_string(mContainerSize) + " >";
+        break;
+    case EContainerPolicy::snapshotmap:
+        retval = "mtt::snapshot_map< " + aKey + ", " + aValue + " >";
+        break;
+    default:
+        retval = "std::map< " + aKey + ", " + aValue + " >";
+        break;
+    }
+    return retval;
+}
+
+//
+//  The concurrent maps hand out no references. Their elements are reached
+//  through a locked reference that keeps the lock to the end of the
+//  expression.
+std::string CAssociationEnd::Element(const std::string& aContainer, const std::string& aIndex) const {
+    if (IsConcurrent()) {
+        return "(*" + aContainer + ".locked(" + aIndex + "))";
+    }
+    if (HasContainerPolicy()) {
+        return "mtt::at(" + aContainer + ", " + aIndex + ")";
+    }
+    return aContainer + "[" + aIndex + "]";
+}
+
+std::string CAssociationEnd::Remove(const std::string& aContainer, const std::string& aIndex) const {
+    if (HasContainerPolicy()) {
+        return "mtt::remove(" + aContainer + ", " + aIndex + ")";
+    }
+    return aContainer + ".Remove(" + aIndex + ")";
 }
 
 void CAssociationEnd::Dump(std::shared_ptr<MModel> model) {
     (void)model;
 }
+
+//
+//  Plain reads and writes. The concurrent maps only hand out copies, so they
+//  use their get/set interface.
+std::string CAssociationEnd::Read(const std::string& aContainer, const std::string& aIndex) const {
+    if (IsConcurrent()) {
+        return aContainer + ".get(" + aIndex + ")";
+    }
+    return Element(aContainer, aIndex);
+}
+
+std::string CAssociationEnd::Write(const std::string& aContainer, const std::string& aIndex, const std::string& aValue) const {
+    if (IsConcurrent()) {
+        return aContainer + ".set(" + aIndex + ", " + aValue + ")";
+    }
+    return Element(aContainer, aIndex) + " = " + aValue;
+}
@@ -20,6 +20,20 @@
 #ifndef CASSOCIATIONEND_H
 #define CASSOCIATIONEND_H
 
+//
+//  Container used for the to-many association ends. map is the default that
+//  keeps the generated code unchanged. The sharded and snapshot maps are the
+//  read-optimized replacements of the LockedMap.
+enum class EContainerPolicy {
+    map,
+    vector,
+    flatmap,
+    unorderedmap,
+    smallvector,
+    slotmap,
+    shardedmap,
+    snapshotmap
+};
 
 class CAssociationEnd : public MAssociationEnd
 {
@@ -31,11 +45,25 @@ public:
     virtual std::string FQN(void) const;
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
+    //
+    //  Container policy helpers.
+    bool HasContainerPolicy() const { return (isMultiple && (mContainerPolicy != EContainerPolicy::map)); }
+    bool IsConcurrent() const { return (HasContainerPolicy() && ((mContainerPolicy == EContainerPolicy::shardedmap) ||
+                                                                 (mContainerPolicy == EContainerPolicy::snapshotmap))); }
+    std::string MkContainer(const std::string& aKey, const std::string& aValue) const;
+    std::string Element(const std::string& aContainer, const std::string& aIndex) const;
+    std::string Remove(const std::string& aContainer, const std::string& aIndex) const;
+    std::string Read(const std::string& aContainer, const std::string& aIndex) const;
+    std::string Write(const std::string& aContainer, const std::string& aIndex, const std::string& aValue) const;
+private:
+    void ResolveContainerPolicy(void);
 public:
     std::string QualifierName;
     std::string QualifierType;
     bool        isMultiple;
     bool        isCollection;
+    EContainerPolicy mContainerPolicy = EContainerPolicy::map;
+    size_t           mContainerSize   = 8;
 };
 
 #endif // CASSOCIATIONEND_H
@@ -564,6 +564,11 @@ void CCClass::Dump(std::shared_ptr<MModel> model) {
     bool                                dump;
     auto thisbase = std::dynamic_pointer_cast<CClassBase>(MClass::Instances[id]);
     //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
+    //
     //  Collect all headers needed to dump the files.
     CollectNeededModelHeader(thisbase, neededmodelheader);
 
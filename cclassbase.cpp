@@ -63,6 +63,11 @@
 #include "cdependency.h"
 #include "cmoduleclass.h"
 #include "cinterface.h"
+#include "moperation.h"
+#include "mnode.h"
+#include "mactionnode.h"
+#include "mactivity.h"
+#include "cactivity.h"
 
 #include "msimmessage.h"
 #include "csimmessage.h"
@@ -287,7 +292,7 @@ void CClassBase::PrepareBase() {
 }
 //
 //  This method first creates a backup file before opening the stream
-void CClassBase::OpenStream(std::ofstream& s, const std::string& fname)
+void CClassBase::OpenStream(CodeWriter& s, const std::string& fname)
 {
     int         err=0;
     struct stat dirstat;
@@ -322,7 +327,7 @@ void CClassBase::CloseStreams(void)
     }
 }
 
-void CClassBase::DumpFileHeader(std::ofstream &s, const std::string& fname, const std::string& aExt, const std::string& aName, const std::string& aEmail)
+void CClassBase::DumpFileHeader(CodeWriter &s, const std::string& fname, const std::string& aExt, const std::string& aName, const std::string& aEmail)
 {
     std::string output = gCxxFileHeader;
     size_t      position;
@@ -362,7 +367,7 @@ void CClassBase::DumpFileHeader(std::ofstream &s, const std::string& fname, cons
     s << output;
 }
 
-void CClassBase::DumpGuardHead(std::ofstream &s, const std::string& name, std::string aNameSpace)
+void CClassBase::DumpGuardHead(CodeWriter &s, const std::string& name, std::string aNameSpace)
 {
     std::string guard;
 
@@ -391,7 +396,7 @@ void CClassBase::DumpGuardHead(std::ofstream &s, const std::string& name, std::s
     s << "#define " << guard << "\n";
 }
 
-void CClassBase::DumpGuardTail(std::ofstream &s, const std::string& name, std::string aNameSpace)
+void CClassBase::DumpGuardTail(CodeWriter &s, const std::string& name, std::string aNameSpace)
 {
     std::string guard;
 
@@ -415,7 +420,7 @@ void CClassBase::DumpGuardTail(std::ofstream &s, const std::string& name, std::s
     s << "\n#endif  // " << guard << "\n";
 }
 
-void CClassBase::DumpFunctionHeader(std::ofstream &s, const std::string& name, std::string author, const std::string& creationdate)
+void CClassBase::DumpFunctionHeader(CodeWriter &s, const std::string& name, std::string author, const std::string& creationdate)
 {
     s << "// FH ************************************************************************\n";
     s << "//\n";
@@ -442,23 +447,30 @@ void CClassBase::DumpBase(std::shared_ptr<CModel> model, const std::string& name
     if (!has_src.empty())
     {
         path=cmodel->pathstack.back()+"/."+getFileName()+has_src;
-        cmodel->generatedfiles.push_back( tGenFile {path, id, "//", "src"});
         OpenStream(src, path);
+        cmodel->generatedfiles.push_back( tGenFile {path, id, "//", "src", src.buffer()});
     }
     //
     //  open the header output stream if needed.
     if (!has_hdr.empty())
     {
         path=cmodel->pathstack.back()+"/."+getFileName()+has_hdr;
-        cmodel->generatedfiles.push_back(  tGenFile { path, id, "//", "hdr"} );
         OpenStream(hdr, path);
+        cmodel->generatedfiles.push_back(  tGenFile { path, id, "//", "hdr", hdr.buffer()} );
     }
     //
     //  At this point we have a directory to create the generation
     //  results into.
 }
 
-void CClassBase::DumpPublicMacros(std::ofstream &hdr) {
+//
+//  Checks the content hash of the element against the last run. If it did not
+//  change the files of the last run are taken over and the Dump can be skipped.
+bool CClassBase::IsUnchanged(std::shared_ptr<MModel> aModel) {
+    return std::dynamic_pointer_cast<CModel>(aModel)->IsUnchanged(sharedthis<MElement>());
+}
+
+void CClassBase::DumpPublicMacros(CodeWriter &hdr) {
     size_t                                       msize = 0;
     std::map<std::string, std::string>           macrolist;
 
@@ -487,7 +499,7 @@ void CClassBase::DumpPublicMacros(std::ofstream &hdr) {
     }
 }
 
-void CClassBase::DumpPrivateMacros(std::ofstream &src) {
+void CClassBase::DumpPrivateMacros(CodeWriter &src) {
     size_t                                       msize = 0;
     std::map<std::string, std::string>           macrolist;
 
@@ -688,6 +700,55 @@ std::string CClassBase::MkType(std::shared_ptr<CAttribute> a) {
     return retval;
 }
 
+//
+//  Check whether one of the to-many ends needs the container runtime header.
+bool CClassBase::UsesContainerPolicy() {
+    for (auto & e : allEnds) {
+        if ((e) && (e->HasContainerPolicy())) {
+            return true;
+        }
+    }
+    for (auto & oe : OtherEnd) {
+        auto e = std::dynamic_pointer_cast<CAssociationEnd>(*oe);
+
+        if ((e) && (e->HasContainerPolicy())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+//  Check whether one of the operations runs the branches of its activity as
+//  tasks.
+bool CClassBase::UsesParallelActivity() {
+    for (auto & o : Operation) {
+        auto op = std::dynamic_pointer_cast<MOperation>(*o);
+
+        if (op) {
+            auto activity = std::dynamic_pointer_cast<CActivity>(*op->Activity);
+
+            if ((activity) && (activity->IsParallel())) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//
+//  Messages and signals are passed by value between the objects. The concurrent
+//  maps are of no use there, so those ends take the std::map default.
+void CClassBase::DropConcurrentPolicies() {
+    for (auto & oe : OtherEnd) {
+        auto e = std::dynamic_pointer_cast<CAssociationEnd>(*oe);
+
+        if ((e) && (e->IsConcurrent())) {
+            e->mContainerPolicy = EContainerPolicy::map;
+        }
+    }
+}
+
 std::string CClassBase::MkType(std::shared_ptr<CAssociationEnd> a) {
     std::string retval;
     std::string fqn=a->FQN();
@@ -706,6 +767,8 @@ std::string CClassBase::MkType(std::shared_ptr<CAssociationEnd> a) {
         retval=fqn;
     } else if (a->Multiplicity == "0..1") {
         retval=fqn+"*";
+    } else if (a->HasContainerPolicy()) {
+        retval=a->MkContainer((a->QualifierType.empty()) ? "uint64_t" : a->QualifierType, fqn);
     } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
         if (a->QualifierType.empty()) {
             if (ta == aShared) {
@@ -28,6 +28,7 @@
 #include <memory>
 
 #include "HeaderList.h"
+#include "codewriter.h"
 
 #include "mclass.h"
 
@@ -62,12 +63,12 @@ public:
     std::shared_ptr<CClassBase> shared_this() {return std::dynamic_pointer_cast<CClassBase>(MClass::Instances[id]);}
 
     std::string GetExtraHeader(void) ;
-    void OpenStream(std::ofstream& s, const std::string& fname);
+    void OpenStream(CodeWriter& s, const std::string& fname);
     void CloseStreams(void);
-    void DumpFileHeader(std::ofstream& s, const std::string& fname, const std::string& aExt, const std::string& name = "Hans-Juergen Lange", const std::string& email = "hjl@simulated-universe.de");
-    void DumpGuardHead(std::ofstream& s, const std::string& name, std::string aNameSpace = "");
-    void DumpGuardTail(std::ofstream& s, const std::string& name, std::string aNameSpace = "");
-    void DumpFunctionHeader(std::ofstream& s, const std::string& name, std::string author, const std::string& creationdate);
+    void DumpFileHeader(CodeWriter& s, const std::string& fname, const std::string& aExt, const std::string& name = "Hans-Juergen Lange", const std::string& email = "hjl@simulated-universe.de");
+    void DumpGuardHead(CodeWriter& s, const std::string& name, std::string aNameSpace = "");
+    void DumpGuardTail(CodeWriter& s, const std::string& name, std::string aNameSpace = "");
+    void DumpFunctionHeader(CodeWriter& s, const std::string& name, std::string author, const std::string& creationdate);
 
     void DumpExtraIncludes(std::ostream& src, std::set<std::string>& aDoneIncludes, std::set<std::shared_ptr<MElement>>& aDoneList);
     void DumpExtraIncludes(const std::string& aHeaders, std::ostream& src, std::set<std::string>& aDoneIncludes, bool aCheckModel = true, const std::string& aPath = "");
@@ -84,11 +85,12 @@ public:
 
     void PrepareBase();
     void DumpBase(std::shared_ptr<CModel> model, const std::string& name);
+    bool IsUnchanged(std::shared_ptr<MModel> aModel);
     const std::list<std::shared_ptr<MElement>>& GetNeededHeader(void) {return (neededmodelheader.mHeaderList);}
     void IndentIn() {indentation+=4;indent.clear();indent.assign(indentation, ' ');}
     void IndentOut() {indentation-=4;indent.clear();if (indentation > 0) indent.assign(indentation, ' ');}
-    void DumpPublicMacros(std::ofstream& hdr);
-    void DumpPrivateMacros(std::ofstream& src);
+    void DumpPublicMacros(CodeWriter& hdr);
+    void DumpPrivateMacros(CodeWriter& src);
 
     std::vector<std::shared_ptr<MAttribute> > GetImportAttributes();
     std::vector<std::shared_ptr<MAttribute>> GetDerivedAttributes() ;
@@ -119,6 +121,9 @@ public:
 
     std::string MkType(std::shared_ptr<CAttribute> attr);
     std::string MkType(std::shared_ptr<CAssociationEnd> attr);
+    bool UsesContainerPolicy();
+    bool UsesParallelActivity();
+    void DropConcurrentPolicies();
     bool IsVariantType(const std::string &aClassifierName);
     bool HasSrc() {return (!has_src.empty());}
     bool HasHdr() {return (!has_hdr.empty());}
@@ -177,9 +182,9 @@ public:
     std::string                            mSystemHeader;
     std::string                            has_src;
     std::string                            has_hdr;
-    std::ofstream                          src;
-    std::ofstream                          hdr;
-    std::list<std::ofstream>               more;
+    CodeWriter                             src;
+    CodeWriter                             hdr;
+    std::list<CodeWriter>                  more;
     std::list<std::pair<int, std::string>> mTreatAsReference;
 protected:
     int                                    indentation = 0;
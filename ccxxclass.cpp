@@ -19,6 +19,8 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <tuple>
+#include <algorithm>
+#include <cctype>
 #include "path.h"
 #include "moperation.h"
 #include "coperation.h"
@@ -84,6 +86,8 @@
 
 #include "cpackagebase.h"
 #include "crequirement.h"
+#include "serialheader.h"
+#include "soalayout.h"
 
 #include "main.h"
 
@@ -111,6 +115,24 @@ static const char* cardinaltypes[] = {"int",
                                       "unsigned short",
                                       0
                                      };
+//
+//  Fixed width types that the serializer copies as plain values.
+static const char* serialtypes[] = {"bool",
+                                    "int8_t",
+                                    "uint8_t",
+                                    "int16_t",
+                                    "uint16_t",
+                                    "int32_t",
+                                    "uint32_t",
+                                    "int64_t",
+                                    "uint64_t",
+                                    "size_t",
+                                    "signed char",
+                                    "unsigned int",
+                                    "long int",
+                                    "unsigned long long",
+                                    0
+                                   };
 
 std::vector<std::pair<eVisibility, std::string> > vis = {{vPublic, "public"},
                                                          {vProtected, "protected"},
@@ -119,6 +141,10 @@ std::vector<std::pair<eVisibility, std::string> > vis = {{vPublic, "public"},
 
 const size_t kVisSize = 3U;
 
+std::map<std::pair<size_t, std::string>, HeaderSteps> CCxxClass::mHeaderSteps;
+std::map<std::string, HeaderGraph> CCxxClass::mHeaderGraph;
+size_t CCxxClass::mHeaderGeneration = 1;
+
 std::string CCxxClass::mapVisibility(eVisibility a_vis) {
     for (auto & v : vis) {
         if (v.first == a_vis) {
@@ -140,6 +166,18 @@ bool CCxxClass::IsCardinalType(const std::string& aName) {
     return false;
 }
 
+bool CCxxClass::IsSerialScalar(const std::string& aName) {
+    const char **s = serialtypes;
+
+    if (aName == "void*") {
+        return false;
+    }
+    while ((*s != nullptr) && (aName != *s)) {
+        s++;
+    }
+    return (*s != nullptr) || IsCardinalType(aName);
+}
+
 std::string CCxxClass::FQN() const {
     return mTypeTree.getFQN();
 }
@@ -163,6 +201,32 @@ void CCxxClass::Prepare(void) {
             else {
             }
         }
+        if (HasTaggedValue("Pimpl")) {
+            std::string pimpl = helper::tolower(GetTaggedValue("Pimpl"));
+            if (pimpl == "true") {
+                //
+                //  Only plain classes that are not enclosed in another class can hide their private members.
+                if ((type == eElementType::CxxClass) && (mClassParameter.empty()) && (!mIsInterface) && (!mSerialize) &&
+                    !(parent && parent->IsClassBased())) {
+                    mPimpl = true;
+                } else {
+                    std::cerr << "Pimpl is not supported for " << name << std::endl;
+                }
+            }
+        }
+        if (HasTaggedValue("Layout")) {
+            std::string layout = helper::tolower(GetTaggedValue("Layout"));
+            if (layout == "soa") {
+                //
+                //  The container needs all members in the class itself.
+                if ((type == eElementType::CxxClass) && (mClassParameter.empty()) && (!mIsInterface) && (!mPimpl) &&
+                    !(parent && parent->IsClassBased())) {
+                    mSoA = true;
+                } else {
+                    std::cerr << "SoA layout is not supported for " << name << std::endl;
+                }
+            }
+        }
         //
         //  To have a more complete view on the attributes we create a list of attributes
         //  available in this class.
@@ -276,6 +340,32 @@ void CCxxClass::FillInCollection(const std::string &aTextType) {
     }  //  end of for-loop over typenames.
 }
 //
+//  Only classes in a namespace can be declared forward. So no templates, enums or enclosed classes.
+bool CCxxClass::IsForwardable(std::shared_ptr<CClassBase> aClass) const {
+    return (aClass && (aClass.get() != this) &&
+            ((aClass->type == eElementType::CxxClass) || (aClass->type == eElementType::Struct)) &&
+            (aClass->mClassParameter.empty()) && !(aClass->parent && aClass->parent->IsClassBased()));
+}
+//
+//  Fill in the forwards for the classes of a type. The parts of the type that cannot be
+//  declared forward are included.
+void CCxxClass::FillInForwards(const TypeNode& aNode) {
+    if (aNode.mClassifier) {
+        auto nc = std::dynamic_pointer_cast<CClassBase>(*aNode.mClassifier);
+
+        if (IsForwardable(nc)) {
+            if (std::find(mSelfContainedForwards.begin(), mSelfContainedForwards.end(), nc) == mSelfContainedForwards.end()) {
+                mSelfContainedForwards.push_back(nc);
+            }
+        } else if (nc && (nc.get() != this)) {
+            FillInCollection(nc);
+        }
+    }
+    for (auto & p : aNode.mParameter) {
+        FillInForwards(p);
+    }
+}
+//
 //  Self contained header are not recursive.
 void CCxxClass::CollectSelfContainedHeader() {
     //
@@ -309,10 +399,23 @@ void CCxxClass::CollectSelfContainedHeader() {
             //  We have a look on the aggregation type of the attribute.
             //  Shared attributes are realized through pointers. And pointers only need the class forward.
             if ((a->Aggregation == aNone) || (a->Aggregation == aComposition)) {
-                FillInCollection(*a->Classifier);
+                auto ac = std::dynamic_pointer_cast<CClassBase>(*a->Classifier);
+                //
+                //  Pointers and references only need the forward.
+                if (gPreferForwards && ac && ((ac->mTypeTree.mPointerDereference > 0) || (ac->mTypeTree.NeedsForward()))) {
+                    FillInForwards(ac->mTypeTree);
+                } else {
+                    FillInCollection(*a->Classifier);
+                }
             } else {
             }
-        } else {
+        } else if (gPreferForwards) {
+            TypeNode temp(TypeNode::parse(a->ClassifierName));
+
+            temp.fill(mNameSpace.getString());
+            if ((temp.mPointerDereference > 0) || (temp.NeedsForward())) {
+                FillInForwards(temp);
+            }
         }
     }  //  end of foo-loop over attributes.
     //
@@ -376,12 +479,25 @@ void CCxxClass::CollectSelfContainedHeader() {
     //
     //  Go through the operations.
     for (auto & oi : Operation) {
+        auto op = std::dynamic_pointer_cast<COperation>(*oi);
+        //
+        //  Operations that are only declared in the header do not need the complete parameter types.
+        bool declonly = gPreferForwards && (!op->isInline) && (!isTemplateClass()) && (!op->isTemplateOperation());
         //
         //  Go through the parameters and return values.
-        for (auto & pi : std::dynamic_pointer_cast<COperation>(*oi)->Parameter) {
+        for (auto & pi : op->Parameter) {
             std::shared_ptr<CParameter> param = std::dynamic_pointer_cast<CParameter>(*pi);
 
-            if (param->Classifier) {
+            if (declonly) {
+                if (param->Classifier && (param->Classifier->IsClassBased())) {
+                    FillInForwards(std::dynamic_pointer_cast<CClassBase>(*param->Classifier)->mTypeTree);
+                } else {
+                    TypeNode temp(TypeNode::parse(param->ClassifierName));
+
+                    temp.fill(mNameSpace.getString());
+                    FillInForwards(temp);
+                }
+            } else if (param->Classifier) {
                 //
                 //  If we find any star at the classifier name we have a pointer type
                 if (param->ClassifierName.find('*') == std::string::npos) {
@@ -395,7 +511,7 @@ void CCxxClass::CollectSelfContainedHeader() {
 
 }
 
-void CCxxClass::CollectFromBase(const TypeNode& aNode, HeaderList& aHeaderList) {
+void CCxxClass::CollectFromBase(const TypeNode& aNode, std::vector<HeaderStep>& aSteps) {
     auto nc = aNode.mClassifier;
 
     if (nc) {
@@ -403,16 +519,16 @@ void CCxxClass::CollectFromBase(const TypeNode& aNode, HeaderList& aHeaderList)
         //
         // Check the node classifier.
         if ((ncc->IsExternClass() && (!ncc->IsExternInModel())) || (ncc->type == eElementType::QtClass)) {
-            extramodelheader.push_back(ncc);
+            aSteps.push_back({HeaderStep::Kind::Extra, ncc});
         } else {
-            CollectNeededModelHeader(ncc, aHeaderList);
+            aSteps.push_back({HeaderStep::Kind::Needed, ncc});
         }
         for (auto & p : aNode.mParameter) {
-            CollectFromBase(p, aHeaderList);
+            CollectFromBase(p, aSteps);
         }
     }
 }
-void CCxxClass::CollectFromAttribute(const TypeNode& aNode, HeaderList& aHeaderList, bool aIsTemplateReferences) {
+void CCxxClass::CollectFromAttribute(const TypeNode& aNode, std::vector<HeaderStep>& aSteps, bool aIsTemplateReferences) {
     auto nc = aNode.mClassifier;
 
     if (nc) {
@@ -420,84 +536,83 @@ void CCxxClass::CollectFromAttribute(const TypeNode& aNode, HeaderList& aHeaderL
         //
         // Check the node classifier.
         if ((ncc->IsExternClass() && (!ncc->IsExternInModel())) || (nc->type == eElementType::QtClass)) {
-            extramodelheader.push_back(ncc);
+            aSteps.push_back({HeaderStep::Kind::Extra, ncc});
         } else {
             //
             //  Composition.
             if (aNode.mExtension == TypeExtension::None) {
-                CollectNeededModelHeader(ncc, aHeaderList);
+                aSteps.push_back({HeaderStep::Kind::Needed, ncc});
             } else {
-                CollectNeededModelHeader(ncc, optionalmodelheader);
+                aSteps.push_back({HeaderStep::Kind::Optional, ncc});
             }
         }
     }
     for (auto & p : aNode.mParameter) {
-        CollectFromAttribute(p, aHeaderList);
+        CollectFromAttribute(p, aSteps);
     }
 }
-void CCxxClass::CollectFromParameter(const TypeNode& aNode, HeaderList& aHeaderList) {
+void CCxxClass::CollectFromParameter(const TypeNode& aNode, std::vector<HeaderStep>& aSteps) {
     auto         nc = aNode.mClassifier;
 
     if (nc) {
         auto ncc = std::dynamic_pointer_cast<CClassBase>(*nc);
 
         if ((ncc->IsExternClass() && (!ncc->IsExternInModel())) || (ncc->type == eElementType::QtClass)) {
-            extramodelheader.push_back(ncc);
+            aSteps.push_back({HeaderStep::Kind::Extra, ncc});
         } else {
-            //CollectNeededModelHeader(ncc, neededmodelheader);
             if (aNode.mExtension == TypeExtension::None) {
-                CollectNeededModelHeader(ncc, aHeaderList);
+                aSteps.push_back({HeaderStep::Kind::Needed, ncc});
             } else {
-                CollectNeededModelHeader(ncc, optionalmodelheader);
-            }        
+                aSteps.push_back({HeaderStep::Kind::Optional, ncc});
+            }
         }
     }
     for (auto & p : aNode.mParameter) {
-        CollectFromParameter(p, aHeaderList);
+        CollectFromParameter(p, aSteps);
     }
 }
 
-void CCxxClass::CollectFromSharedAssoc(const TypeNode& aNode, HeaderList& aHeaderList) {
+void CCxxClass::CollectFromSharedAssoc(const TypeNode& aNode, std::vector<HeaderStep>& aSteps) {
     auto         nc = aNode.mClassifier;
 
     if (nc) {
         auto ncc = std::dynamic_pointer_cast<CClassBase>(*nc);
 
         if ((ncc->IsExternClass() && (!ncc->IsExternInModel())) || (ncc->type == eElementType::QtClass)) {
-            extramodelheader.push_back(ncc);
+            aSteps.push_back({HeaderStep::Kind::Extra, ncc});
         } else if (nc->type == eElementType::SimObject) {
             auto st = MClass::mByFQN.find("tSimObj");
 
             if (st != MClass::mByFQN.end()) {
-                CollectNeededModelHeader(st->second, aHeaderList);
+                aSteps.push_back({HeaderStep::Kind::Needed, st->second});
             }
         } else {
-            CollectNeededModelHeader(ncc, optionalmodelheader);
+            aSteps.push_back({HeaderStep::Kind::Optional, ncc});
         }
     }
     for (auto & p : aNode.mParameter) {
-        CollectFromSharedAssoc(p, aHeaderList);
+        CollectFromSharedAssoc(p, aSteps);
     }
 }
 
-void CCxxClass::CollectFromCompositeAssoc(const TypeNode& aNode, HeaderList& aHeaderList) {
+void CCxxClass::CollectFromCompositeAssoc(const TypeNode& aNode, std::vector<HeaderStep>& aSteps) {
     auto         nc = aNode.mClassifier;
 
     if (nc) {
         auto ncc = std::dynamic_pointer_cast<CClassBase>(*nc);
 
         if ((ncc->IsExternClass() && (!ncc->IsExternInModel())) || (ncc->type == eElementType::QtClass)) {
-            extramodelheader.push_back(ncc);
+            aSteps.push_back({HeaderStep::Kind::Extra, ncc});
         } else {
-            CollectNeededModelHeader(ncc, aHeaderList);
+            aSteps.push_back({HeaderStep::Kind::Needed, ncc});
         }
     }
     for (auto & p : aNode.mParameter) {
-        CollectFromCompositeAssoc(p, aHeaderList);
+        CollectFromCompositeAssoc(p, aSteps);
     }
 }
 
-void CCxxClass::CollectFromTemplateBinding(std::shared_ptr<CClassBase> aClass, HeaderList &aHeaderList) {
+void CCxxClass::CollectFromTemplateBinding(std::shared_ptr<CClassBase> aClass, std::vector<HeaderStep>& aSteps) {
     //
     //  Go through the generalizations and find template binding parameter.
     for (auto & g : aClass->Generalization) {
@@ -510,20 +625,20 @@ void CCxxClass::CollectFromTemplateBinding(std::shared_ptr<CClassBase> aClass, H
             if (!parameter->mActual) {
                 if (parameter->Classifier) {
                     auto c = std::dynamic_pointer_cast<CClassBase>(*parameter->Classifier);
-                    CollectFromParameter(c->mTypeTree, aHeaderList);
+                    CollectFromParameter(c->mTypeTree, aSteps);
                 } else {
                     if (!parameter->ClassifierName.empty()) {
                         TypeNode temp(TypeNode::parse(parameter->ClassifierName));
 
                         temp.fill(mNameSpace.getString());
-                        CollectFromParameter(temp, aHeaderList);
+                        CollectFromParameter(temp, aSteps);
                     }
                 }
             } else {
                 if (parameter->mActual->IsClassBased()) {
                     auto cb = std::dynamic_pointer_cast<CClassBase>(*parameter->mActual);
 
-                    CollectFromParameter(cb->mTypeTree, aHeaderList);
+                    CollectFromParameter(cb->mTypeTree, aSteps);
                 } else {
                     // ignoring classbased without classifier set
                 }
@@ -533,192 +648,451 @@ void CCxxClass::CollectFromTemplateBinding(std::shared_ptr<CClassBase> aClass, H
 }
 
 //
-//  The next optimization step ahead.
-void CCxxClass::CollectNeededModelHeader(std::shared_ptr<MElement> e, HeaderList& aHeaderList) {
+//  The steps to collect the headers class c needs. They are collected once
+//  and kept until the attributes or association ends of the class change.
+//  Only unresolved type names depend on the namespace of the collecting class.
+//  If steps are collected again the header closures made from them are outdated.
+const std::vector<HeaderStep>& CCxxClass::GetHeaderSteps(std::shared_ptr<CClassBase> c) {
+    auto& memo = mHeaderSteps[std::make_pair(c->mOrdinal, mNameSpace.getString())];
+
+    if ((!memo.steps.empty()) && (memo.attributes == c->allAttr.size()) && (memo.ends == c->allEnds.size())) {
+        return memo.steps;
+    }
+    if (!memo.steps.empty()) {
+        ++mHeaderGeneration;
+    }
+    memo.steps.clear();
+    memo.attributes = c->allAttr.size();
+    memo.ends       = c->allEnds.size();
+
+    auto& steps = memo.steps;
     //
-    //  We should work only on class based elements.
-    //  And the ones we have not processed so far.
-    if ((e->IsClassBased()) && (!aHeaderList.isdone(e))) {
-        //
-        //  If this and e are the same and we are not in the header list add the element to both headerlists.
-        if (e.get() == this) {
-            if (!optionalmodelheader.isdone(e)) {
-                optionalmodelheader.done(e);
+    // Collect dependencies from the template binding parameter.
+    CollectFromTemplateBinding(c, steps);
+    //
+    //  Go to the base-classes
+    //  Base classes only can be external or similar or are in the needed list.
+    for (auto & bi : c->Base) {
+        CollectFromBase(bi.getElement()->mTypeTree, steps);
+    }
+    //
+    //  Check for alias/use dependency
+    for (auto & i : c->Supplier) {
+        if (i.getConnector()->HasStereotype("use")) {
+            if ((i.getElement()->type == eElementType::ExternClass) || (i.getElement()->type == eElementType::QtClass)) {
+                steps.push_back({HeaderStep::Kind::Extra, i.getElement()});
+            } else {
+                steps.push_back({HeaderStep::Kind::Needed, i.getElement()});
             }
         }
+    }
+    //
+    //  Go to the enclosed classes. They are the same as the class itself.
+    auto enclosed = c->getEnclosedClasses();
+    for (auto& en : enclosed) {
+        steps.push_back({HeaderStep::Kind::Needed, en});
+    }
+    //
+    //  Go through all attributes.
+    for (auto & a : c->allAttr) {
         //
-        //  Whatever we do next we need to lockout the element we process through the donelist.
-        aHeaderList.done(e);
-        //
-        //  As we work on class based elements only we can cast the element to the classbase
-        auto c = std::dynamic_pointer_cast<CClassBase>(e);
-        //
-        // Collect dependencies from the template binding parameter.
-        CollectFromTemplateBinding(c, aHeaderList);
-        //
-        //  Go to the base-classes
-        //  Base classes only can be external or similar or are in the needed list.
-        for (auto & bi : c->Base) {
-            CollectFromBase(bi.getElement()->mTypeTree, aHeaderList);
-        }
-        //
-        //  Check for alias/use dependency
-        for (auto & i : c->Supplier) {
-            if (i.getConnector()->HasStereotype("use")) {
-                if ((i.getElement()->type == eElementType::ExternClass) || (i.getElement()->type == eElementType::QtClass)) {
-                    extramodelheader.push_back(std::dynamic_pointer_cast<CClassBase>(i.getElement()));
+        //  Different ways to handle the attribute type.
+        //  If the attribute type is linked to some classifier we use it.
+        if ((a->Classifier != nullptr) && (a->Classifier->IsClassBased()) && (a->Classifier->type != eElementType::SimObject)) {
+            auto ac = std::dynamic_pointer_cast<CClassBase>(*a->Classifier);
+            //
+            //  Create a list of types from the classifier.
+            CollectFromAttribute(ac->mTypeTree, steps);
+            if (a->isMultiple) {
+                if (a->Qualifier.empty()) {
+                    auto v = MClass::mByFQN.find("std::vector");
+
+                    if (v != MClass::mByFQN.end()) {
+                        steps.push_back({HeaderStep::Kind::Extra, v->second});
+                    }
                 } else {
-                    CollectNeededModelHeader(i.getElement(), aHeaderList);
+                    auto m = MClass::mByFQN.find("std::map");
+
+                    if (m != MClass::mByFQN.end()) {
+                        steps.push_back({HeaderStep::Kind::Extra, m->second});
+                    }
                 }
             }
+        } else {
+            TypeNode temp(TypeNode::parse(a->ClassifierName));
+
+            temp.fill(mNameSpace.getString());
+            CollectFromParameter(temp, steps);
         }
-        //
-        //  Go to the enclosed classes. They are the same as the class itself.
-        auto enclosed = c->getEnclosedClasses();
-        for (auto& en : enclosed) {
-            CollectNeededModelHeader(en, aHeaderList);
-        }
-        //
-        //  Go through all attributes.
-        for (auto & a : c->allAttr) {
+    }
+    //
+    //  Go through all association ends.
+    for (auto & a : c->allEnds) {
+        if (a->Classifier && a->Classifier->IsClassBased() && (a->Classifier->type != eElementType::SimObject)) {
+            auto ac = std::dynamic_pointer_cast<CClassBase> (*a->Classifier);
             //
-            //  Different ways to handle the attribute type.
-            //  If the attribute type is linked to some classifier we use it.
-            if ((a->Classifier != nullptr) && (a->Classifier->IsClassBased()) && (a->Classifier->type != eElementType::SimObject)) {
-                auto ac = std::dynamic_pointer_cast<CClassBase>(*a->Classifier);
+            //  The specific classes of an association.
+            std::shared_ptr<CAssociation>    assoc    = std::dynamic_pointer_cast<CAssociation>(*a->parent);
+            std::shared_ptr<CAssociationEnd> otherend = a;
+            std::shared_ptr<CAssociationEnd> thisend  = std::dynamic_pointer_cast<CAssociationEnd>(assoc->OtherEnd(otherend));
+            //
+            //  Sanity check of otherend and check if navigable.
+            if (otherend && otherend->Classifier && (otherend->isNavigable())) {
                 //
-                //  Create a list of types from the classifier.
-                CollectFromAttribute(ac->mTypeTree, aHeaderList);
-                if (a->isMultiple) {
-                    if (a->Qualifier.empty()) {
+                //  Check if pointer or not.
+                if (thisend && (thisend->Aggregation == aShared)) {
+                    CollectFromSharedAssoc(ac->mTypeTree, steps);
+                } else if (thisend && (thisend->Aggregation == aComposition)) {
+                    CollectFromCompositeAssoc(ac->mTypeTree, steps);
+                }
+                if (!(otherend->Multiplicity.empty()) && (otherend->Multiplicity != "1")) {
+                    if (otherend->mQualifier.empty()) {
                         auto v = MClass::mByFQN.find("std::vector");
 
                         if (v != MClass::mByFQN.end()) {
-                            extramodelheader.push_back(std::dynamic_pointer_cast<CClassBase>(v->second));
+                            steps.push_back({HeaderStep::Kind::Extra, v->second});
                         }
                     } else {
                         auto m = MClass::mByFQN.find("std::map");
 
                         if (m != MClass::mByFQN.end()) {
-                            extramodelheader.push_back(std::dynamic_pointer_cast<CClassBase>(m->second));
+                            steps.push_back({HeaderStep::Kind::Extra, m->second});
                         }
                     }
                 }
+            }
+        }
+    }
+
+    for (auto & oi : c->Operation) {
+        //
+        //  Go through the parameters and return values.
+        for (auto & pi : std::dynamic_pointer_cast<COperation>(*oi)->Parameter) {
+            std::shared_ptr<CParameter> param = std::dynamic_pointer_cast<CParameter>(*pi);
+
+            auto pc = std::dynamic_pointer_cast<CClassBase>(*param->Classifier);
+
+            if (pc && (pc->IsClassBased())) {
+                //
+                //  Create a list of types from the classifier.
+                CollectFromParameter(pc->mTypeTree, steps);
             } else {
-                TypeNode temp(TypeNode::parse(a->ClassifierName));
+                TypeNode temp(TypeNode::parse(param->ClassifierName));
 
                 temp.fill(mNameSpace.getString());
-                CollectFromParameter(temp, aHeaderList);
+                CollectFromParameter(temp, steps);
             }
         }
         //
-        //  Go through all association ends.
-        for (auto & a : c->allEnds) {
-            if (a->Classifier && a->Classifier->IsClassBased() && (a->Classifier->type != eElementType::SimObject)) {
-                auto ac = std::dynamic_pointer_cast<CClassBase> (*a->Classifier);
+        //  Check if there is an exception class attached.
+        auto op = oi->sharedthis<COperation>();
+
+        if (op->mException) {
+            //
+            //  We use the CollectFromParameter() here as I am to lazy to create a new method.
+            auto ec = std::dynamic_pointer_cast<CClassBase>(*(op->mException));
+
+            if (ec && (ec->IsClassBased())) {
                 //
-                //  The specific classes of an association.
-                std::shared_ptr<CAssociation>    assoc    = std::dynamic_pointer_cast<CAssociation>(*a->parent);
-                std::shared_ptr<CAssociationEnd> otherend = a;
-                std::shared_ptr<CAssociationEnd> thisend  = std::dynamic_pointer_cast<CAssociationEnd>(assoc->OtherEnd(otherend));
+                //  Create a list of types from the classifier.
+                CollectFromParameter(ec->mTypeTree, steps);
+            } else {
                 //
-                //  Sanity check of otherend and check if navigable.
-                if (otherend && otherend->Classifier && (otherend->isNavigable())) {
-                    //
-                    //  Check if pointer or not.
-                    if (thisend && (thisend->Aggregation == aShared)) {
-                        CollectFromSharedAssoc(ac->mTypeTree, aHeaderList);
-                    } else if (thisend && (thisend->Aggregation == aComposition)) {
-                        CollectFromCompositeAssoc(ac->mTypeTree, aHeaderList);
-                    }
-                    if (!(otherend->Multiplicity.empty()) && (otherend->Multiplicity != "1")) {
-                        if (otherend->mQualifier.empty()) {
-                            auto v = MClass::mByFQN.find("std::vector");
-
-                            if (v != MClass::mByFQN.end()) {
-                                extramodelheader.push_back(std::dynamic_pointer_cast<CClassBase>(v->second));
-                            }
-                        } else {
-                            auto m = MClass::mByFQN.find("std::map");
-
-                            if (m != MClass::mByFQN.end()) {
-                                extramodelheader.push_back(std::dynamic_pointer_cast<CClassBase>(m->second));
-                            }
-                        }
-                    }
-                }
+                //  The mException can only be a classifier. So no alternate solution
             }
         }
+    }
+    //
+    //  Here starts the exit sequence.
+    //  We add ourselfes into the needed list if the class is not enclosed.
+    //  If the parent is a classbased element, we are enclosed and must not be added.
+    steps.push_back({HeaderStep::Kind::Add, c->getContainerClass()});
+    //
+    // Collect the extraheaders. Ignore the extern classes that have inmodel headers.
+    if (!(!c->IsExternInModel()) && (!c->GetExtraHeader().empty())) {
+        steps.push_back({HeaderStep::Kind::Extra, c});
+    }
+    return memo.steps;
+}
 
-        for (auto & oi : c->Operation) {
-            //
-            //  Go through the parameters and return values.
-            for (auto & pi : std::dynamic_pointer_cast<COperation>(*oi)->Parameter) {
-                std::shared_ptr<CParameter> param = std::dynamic_pointer_cast<CParameter>(*pi);
+//
+//  The next optimization step ahead.
+void CCxxClass::CollectNeededModelHeader(std::shared_ptr<MElement> e, HeaderList& aHeaderList) {
+    CollectNeededModelHeader(e, aHeaderList, {&optionalmodelheader, &extramodelheader, this, nullptr, true, SIZE_MAX, SIZE_MAX});
+}
 
-                auto pc = std::dynamic_pointer_cast<CClassBase>(*param->Classifier);
+void CCxxClass::CollectNeededModelHeader(std::shared_ptr<MElement> e, HeaderList& aHeaderList, HeaderWalk aWalk) {
+    //
+    //  We should work only on class based elements.
+    //  And the ones we have not processed so far.
+    if ((e->IsClassBased()) && (!aHeaderList.isdone(e))) {
+        //
+        //  Take the closure of e if none of the classes it reaches is still in collection.
+        //  Those are the classes the walk came along. A class in the component of the
+        //  class in work reaches them, so its closure is not even collected. A class in
+        //  another component cannot reach them, except for this on the optional list.
+        //  There it is done from the start, but the dependencies lead to other classes.
+        bool    optional  = (&aHeaderList == aWalk.optional);
+        size_t& component = optional ? aWalk.componentOptional : aWalk.component;
 
-                if (pc && (pc->IsClassBased())) {
-                    //
-                    //  Create a list of types from the classifier.
-                    CollectFromParameter(pc->mTypeTree, aHeaderList);
-                } else {
-                    TypeNode temp(TypeNode::parse(param->ClassifierName));
+        if (e.get() != aWalk.self) {
+            size_t next = GetHeaderComponent(e, optional);
 
-                    temp.fill(mNameSpace.getString());
-                    CollectFromParameter(temp, aHeaderList);
+            if (next != component) {
+                const auto* closure = GetHeaderClosure(e, optional, aWalk.build);
+
+                if ((closure != nullptr) && ((!optional) || (aWalk.self == nullptr) || (!closure->reaches(aWalk.self)))) {
+                    ReplayHeaderClosure(*closure, aHeaderList, aWalk);
+                    return;
                 }
+                //
+                //  Below a class that is walked on a cycle only the closures at hand are
+                //  taken. Otherwise closures in collection nest without bounds.
+                aWalk.build = false;
+                component   = next;
             }
-            //
-            //  Check if there is an exception class attached.
-            auto op = oi->sharedthis<COperation>();
+        }
+        CollectFromSteps(e, aHeaderList, aWalk);
+    }
+}
 
-            if (op->mException) {
-                //
-                //  We use the CollectFromParameter() here as I am to lazy to create a new method.
-                auto ec = std::dynamic_pointer_cast<CClassBase>(*(op->mException));
+//
+//  Walks the steps of e. The walk holds the component of e.
+void CCxxClass::CollectFromSteps(std::shared_ptr<MElement> e, HeaderList& aHeaderList, HeaderWalk aWalk) {
+    size_t visit = 0;     //  Index of the visit in the closure in collection.
 
-                if (ec && (ec->IsClassBased())) {
-                    //
-                    //  Create a list of types from the classifier.
-                    CollectFromParameter(ec->mTypeTree, aHeaderList);
-                } else {
-                    //
-                    //  The mException can only be a classifier. So no alternate solution
-                }
+    //
+    //  If this and e are the same and we are not in the header list add the element to both headerlists.
+    if (e.get() == aWalk.self) {
+        if (!aWalk.optional->isdone(e)) {
+            aWalk.optional->done(e);
+        }
+        aWalk.component         = GetHeaderComponent(e, false);
+        aWalk.componentOptional = GetHeaderComponent(e, true);
+    }
+    //
+    //  Whatever we do next we need to lockout the element we process through the donelist.
+    aHeaderList.done(e);
+    if (aWalk.record != nullptr) {
+        visit = aWalk.record->events.size();
+        aWalk.record->events.push_back({HeaderClosure::Event::Kind::Visit, 0, e});
+    }
+    //
+    //  Replay the steps of the class. The steps do not change while we walk the
+    //  classes, so the reference stays valid.
+    for (auto & s : GetHeaderSteps(std::dynamic_pointer_cast<CClassBase>(e))) {
+        switch (s.kind) {
+        case HeaderStep::Kind::Needed:
+            CollectNeededModelHeader(s.element, aHeaderList, aWalk);
+            break;
+        case HeaderStep::Kind::Optional:
+            if ((aWalk.record != nullptr) && (&aHeaderList != aWalk.optional)) {
+                aWalk.record->events.push_back({HeaderClosure::Event::Kind::Optional, 0, s.element});
+            } else {
+                CollectNeededModelHeader(s.element, *aWalk.optional, aWalk);
+            }
+            break;
+        case HeaderStep::Kind::Extra:
+            aWalk.extras->push_back(std::static_pointer_cast<CClassBase>(s.element));
+            if (aWalk.record != nullptr) {
+                aWalk.record->events.push_back({HeaderClosure::Event::Kind::Extra, 0, s.element});
             }
+            break;
+        case HeaderStep::Kind::Add:
+            aHeaderList.add(s.element);
+            if (aWalk.record != nullptr) {
+                aWalk.record->events.push_back({HeaderClosure::Event::Kind::Add, 0, s.element});
+            }
+            break;
         }
-        //
-        //  Here starts the exit sequence.
-        //  We add ourselfes into the needed list if the class is not enclosed.
-        //  If the parent is a classbased element, we are enclosed and must not be added.
-        aHeaderList.add(c->getContainerClass());
+    }
+    //
+    //  If we are on the way out the tree we may add the dependencies.
+    if (e.get() == aWalk.self) {
         //
         // Collect the extraheaders. Ignore the extern classes that have inmodel headers.
-        if (!(!c->IsExternInModel()) && (!c->GetExtraHeader().empty())) {
-            extramodelheader.push_back(c);
+        if ((!IsExternInModel()) && (!GetExtraHeader().empty())) {
+            aWalk.extras->push_back(shared_this());
         }
-        //
-        //  If we are on the way out the tree we may add the dependencies.
-        if (e.get() == this) {
-            //
-            // Collect the extraheaders. Ignore the extern classes that have inmodel headers.
-            if ((!IsExternInModel()) && (!GetExtraHeader().empty())) {
-                extramodelheader.push_back(shared_this());
-            }
-            for (auto & i : Supplier) {
-                if (i.getElement()->IsClassBased() && !(i.getConnector()->HasStereotype("use"))) {
-                    if ((i.getElement()->type == eElementType::ExternClass) || (i.getElement()->type == eElementType::QtClass)) {
-                        extramodelheader.push_back(std::dynamic_pointer_cast<CClassBase>(i.getElement()));
-                    } else {
+        for (auto & i : Supplier) {
+            if (i.getElement()->IsClassBased() && !(i.getConnector()->HasStereotype("use"))) {
+                if ((i.getElement()->type == eElementType::ExternClass) || (i.getElement()->type == eElementType::QtClass)) {
+                    aWalk.extras->push_back(std::dynamic_pointer_cast<CClassBase>(i.getElement()));
+                } else {
 
-                        CollectNeededModelHeader(i.getElement(), optionalmodelheader);
-                    }
+                    CollectNeededModelHeader(i.getElement(), *aWalk.optional, aWalk);
+                }
+            } else {
+            }
+        }
+    }
+    if (aWalk.record != nullptr) {
+        aWalk.record->events[visit].end = aWalk.record->events.size();
+    }
+}
+
+//
+//  The header closure of e on the header list in work or on the optional list.
+//  It is collected with the closures of the classes it reaches, so the closures
+//  make a graph of bitset unions. If a cycle leads back to a closure in collection,
+//  or the closure is missing and aBuild is not set, nullptr is returned and the
+//  steps are walked.
+const HeaderClosure* CCxxClass::GetHeaderClosure(std::shared_ptr<MElement> e, bool aOptional, bool aBuild) {
+    auto& closure = GetHeaderGraph().closure[2 * static_cast<MClass*>(e.get())->mOrdinal + (aOptional ? 1 : 0)];
+
+    if (closure.building) {
+        return nullptr;
+    }
+    if (closure.generation != mHeaderGeneration) {
+        size_t                                 generation = mHeaderGeneration;
+        HeaderList                             list;
+        HeaderList                             optional;
+        std::list<std::shared_ptr<CClassBase>> extras;
+
+        if (!aBuild) {
+            return nullptr;
+        }
+        closure.building = true;
+        closure.events.clear();
+        size_t                                 component  = GetHeaderComponent(e, aOptional);
+
+        CollectFromSteps(e, list, {aOptional ? &list : &optional, &extras, nullptr, &closure, true,
+                                   aOptional ? SIZE_MAX : component, aOptional ? component : SIZE_MAX});
+        closure.reach      = list.mDoneClasses;
+        closure.building   = false;
+        closure.generation = generation;
+    }
+    return &closure;
+}
+
+//
+//  The graph of the namespace of the class. The closures only grow at the end, so
+//  references to them stay valid. The components are collected again if the steps
+//  have changed.
+HeaderGraph& CCxxClass::GetHeaderGraph() {
+    if (mHeaderGraphOfNameSpace == nullptr) {
+        mHeaderGraphOfNameSpace = &mHeaderGraph[mNameSpace.getString()];
+    }
+    auto& graph = *mHeaderGraphOfNameSpace;
+
+    if (graph.closure.size() < 2 * MClass::mClassCount) {
+        graph.closure.resize(2 * MClass::mClassCount);
+        graph.component.resize(2 * MClass::mClassCount, SIZE_MAX);
+    }
+    if (graph.generation != mHeaderGeneration) {
+        std::fill(graph.component.begin(), graph.component.end(), SIZE_MAX);
+        graph.generation = mHeaderGeneration;
+    }
+    return graph;
+}
+
+//
+//  The component of e in the graph of the header steps on the header list in work
+//  or on the optional list.
+size_t CCxxClass::GetHeaderComponent(std::shared_ptr<MElement> e, bool aOptional) {
+    auto&  graph = GetHeaderGraph();
+    size_t slot  = 2 * static_cast<MClass*>(e.get())->mOrdinal + (aOptional ? 1 : 0);
+
+    if (graph.component[slot] == SIZE_MAX) {
+        HeaderComponents work;
+
+        CollectHeaderComponents(e, aOptional, work);
+    }
+    return graph.component[slot];
+}
+
+//
+//  Tarjan's algorithm on the header steps. The component is named by the ordinal
+//  of the class it was entered at.
+void CCxxClass::CollectHeaderComponents(std::shared_ptr<MElement> e, bool aOptional, HeaderComponents& aWork) {
+    auto&  component = GetHeaderGraph().component;
+    size_t slot      = 2 * static_cast<MClass*>(e.get())->mOrdinal + (aOptional ? 1 : 0);
+    size_t index     = aWork.next++;
+    auto&  mark      = aWork.index[slot];
+
+    mark = std::make_pair(index, index);
+    aWork.stack.push_back(slot);
+    for (auto & s : GetHeaderSteps(std::dynamic_pointer_cast<CClassBase>(e))) {
+        if (((s.kind == HeaderStep::Kind::Needed) || ((s.kind == HeaderStep::Kind::Optional) && aOptional)) && (s.element->IsClassBased())) {
+            size_t next = 2 * static_cast<MClass*>(s.element.get())->mOrdinal + (aOptional ? 1 : 0);
+
+            if (component[next] == SIZE_MAX) {
+                auto m = aWork.index.find(next);
+
+                if (m == aWork.index.end()) {
+                    CollectHeaderComponents(s.element, aOptional, aWork);
+                    mark.second = std::min(mark.second, aWork.index[next].second);
                 } else {
+                    mark.second = std::min(mark.second, m->second.first);
                 }
             }
         }
     }
+    if (mark.first == mark.second) {
+        size_t member = 0;
+
+        do {
+            member = aWork.stack.back();
+            aWork.stack.pop_back();
+            component[member] = static_cast<MClass*>(e.get())->mOrdinal;
+        } while (member != slot);
+    }
+}
+
+//
+//  Replays the closure into the lists. Visits of classes that are done are left
+//  out with everything collected below them. If none of the classes is done the
+//  bitset of the closure is or'ed into the done classes.
+void CCxxClass::ReplayHeaderClosure(const HeaderClosure& aClosure, HeaderList& aHeaderList, HeaderWalk aWalk) {
+    std::vector<std::pair<size_t, size_t>> open;     //  End in the closure and index in the closure in collection.
+    size_t                                 i     = 0;
+    bool                                   unite = !aHeaderList.isdone(aClosure.reach);
+
+    if (unite) {
+        aHeaderList.done(aClosure.reach);
+    }
+
+    while (i < aClosure.events.size()) {
+        auto& ev = aClosure.events[i];
+
+        while ((!open.empty()) && (open.back().first <= i)) {
+            aWalk.record->events[open.back().second].end = aWalk.record->events.size();
+            open.pop_back();
+        }
+        switch (ev.kind) {
+        case HeaderClosure::Event::Kind::Visit:
+            if (!unite) {
+                if (aHeaderList.isdone(ev.element)) {
+                    i = ev.end;
+                    continue;
+                }
+                aHeaderList.done(ev.element);
+            }
+            if (aWalk.record != nullptr) {
+                open.emplace_back(ev.end, aWalk.record->events.size());
+            }
+            break;
+        case HeaderClosure::Event::Kind::Add:
+            aHeaderList.add(ev.element);
+            break;
+        case HeaderClosure::Event::Kind::Extra:
+            aWalk.extras->push_back(std::static_pointer_cast<CClassBase>(ev.element));
+            break;
+        case HeaderClosure::Event::Kind::Optional:
+            if (aWalk.record == nullptr) {
+                CollectNeededModelHeader(ev.element, *aWalk.optional, aWalk);
+            }
+            break;
+        }
+        if (aWalk.record != nullptr) {
+            aWalk.record->events.push_back({ev.kind, 0, ev.element});
+        }
+        ++i;
+    }
+    while (!open.empty()) {
+        aWalk.record->events[open.back().second].end = aWalk.record->events.size();
+        open.pop_back();
+    }
 }
 
 void CCxxClass::CollectForwards() {
@@ -827,8 +1201,7 @@ void CCxxClass::DumpPackageOperationDecl(std::ostream& hdr) {
 
 void CCxxClass::DumpOperationDecl(std::ostream& hdr, int indent) {
     bool dump=true;
-    std::string classfiller;
-    classfiller.assign(indent, ' ');
+    const std::string& classfiller = CodeWriter::spaces(indent);
     //
     //  First we dump all "normal" operations.
     for (auto & vi : vis) {
@@ -928,8 +1301,7 @@ void CCxxClass::DumpOperationDecl(std::ostream& hdr, int indent) {
                 auto op = std::dynamic_pointer_cast<COperation>(*mo);
                 std::string header = op->getHeader(indent);
                 std::string pdecl  = op->GetParameterDecl(mNameSpace);
-                std::string filler;
-                filler.assign(indent + IndentSize, ' ');
+                const std::string& filler = CodeWriter::spaces(indent + IndentSize);
                 hdr << header << filler << "///" <<  std::endl;
 
                 if (op->isTemplateOperation()) {
@@ -1052,25 +1424,17 @@ void CCxxClass::DumpOperationDecl(std::ostream& hdr, int indent) {
     }
 }
 
-void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
+//
+//  The members sorted by visibility, in the form they are declared. Package
+//  visibility is not considered here.
+void CCxxClass::CollectAttributeDecl(std::list<tAttributeDecl> aList[], bool aImpl) {
     size_t i = 0U;
-    bool dump = true;
-    std::string classfiller;
-    classfiller.assign(indent, ' ');
-    //
-    //  These are the attributes sorted by visibility.
-    //  Package visibility is not considered here.
-    //  We are collecting them first for proper indentation.
-    //
-    //  tuple<type, name, comment>
-    std::list<std::tuple<std::string, std::string, std::shared_ptr<MElement> > >  attrlist[kVisSize];
+    bool initdefault = aImpl || (!gInitMemberDefaultInInitializerList);  //  The implementation struct has no constructor.
 
     for (auto & vi: vis) {
         for (auto &a: allAttr) {
-            if (a->visibility == vi.first) {
+            if ((a->visibility == vi.first) && (IsPimplMember(a) == aImpl)) {
                 std::string cname;
-                std::ostringstream aname;
-                std::ostringstream tname;
 
                 if ((a->Classifier != nullptr) && (a->Classifier->IsClassBased())) {
                     auto cb = std::dynamic_pointer_cast<CClassBase>(*a->Classifier);
@@ -1086,53 +1450,50 @@ void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
                     cname = tmptree.getFQN();
                 }
                 if (!cname.empty()) {
+                    tAttributeDecl decl;
+
+                    decl.element = a;
+                    decl.value   = a->defaultValue;
                     if (a->isStatic) {
-                        tname << "static ";
+                        decl.qualifier += "static ";
                     }
                     if (a->isReadOnly) {
-                        tname << "const ";
+                        decl.qualifier += "const ";
                     }
                     if (a->Aggregation == eAggregation::aShared) {
-                        tname << "volatile ";
+                        decl.qualifier += "volatile ";
                     }
                     if ((a->Multiplicity == "1") || (a->Multiplicity.empty())) {
-                        tname << cname;
-                        aname << a->name;
-                        if (!a->defaultValue.empty() && (!a->isStatic) && (!gInitMemberDefaultInInitializerList)) {
-                            aname << " = " << a->defaultValue;
-                        }
-
-
+                        decl.type = cname;
+                        decl.name = a->name;
+                        decl.initialize = (!a->defaultValue.empty() && (!a->isStatic) && initdefault);
                     } else {
                         if ((a->Multiplicity == "1..*") || (a->Multiplicity == "*") || (a->Multiplicity == "0..*")) {
                             if (!a->QualifierType.empty()) {
-                                tname << "std::map<" << a->QualifierType << ", " << cname << ">";
-                                //extraheader += " map";
+                                decl.type = "std::map<" + a->QualifierType + ", " + cname + ">";
                             } else {
-                                //extraheader += " vector";
-                                tname << "std::vector<" << cname << ">";
+                                decl.type = "std::vector<" + cname + ">";
                             }
-                            aname << a->name;
+                            decl.name = a->name;
                         } else {
-                            tname << cname;
-                            aname << a->name << "[" << a->Multiplicity << "]";
-                            if (!a->defaultValue.empty() && (!gInitMemberDefaultInInitializerList)) {
-                                aname << " = " << a->defaultValue;
-                            }
+                            decl.type   = cname;
+                            decl.name   = a->name;
+                            decl.extent = "[" + a->Multiplicity + "]";
+                            decl.initialize = (!a->defaultValue.empty() && initdefault);
                         }
                     }
-                    attrlist[i].emplace_back(std::make_tuple(tname.str(), aname.str(), a));
+                    aList[i].push_back(decl);
                 }
             }
         }
 
         for (auto &a: allEnds) {
             auto aa = allAttr.begin();
-            
+
             for (; (aa != allAttr.end()) && ((*aa)->name != a->name); ++aa) ;
 
             if ((aa == allAttr.end()) && (a->Classifier)) {
-                if ((a->visibility == vi.first) && (a->isNavigable()) && (!a->name.empty()) && (!a->mOwner)) {
+                if ((a->visibility == vi.first) && (a->isNavigable()) && (!a->name.empty()) && (!a->mOwner) && (IsPimplMember(a) == aImpl)) {
                     std::shared_ptr<MAssociation> pa = std::dynamic_pointer_cast<MAssociation>(*a->parent);
                     std::shared_ptr<MAssociationEnd> oe = pa->OtherEnd(a);               // own end
 
@@ -1151,20 +1512,18 @@ void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
                             cname.push_back('*');
                         }
                     }
-                    std::ostringstream tname;
-                    std::ostringstream aname;
+                    tAttributeDecl decl;
 
+                    decl.element = a;
+                    decl.value   = a->defaultValue;
                     if ((a->Multiplicity == "1") || (a->Multiplicity.empty())) {
-                        tname << cname;
-                        aname << a->name;
-                        if (!a->defaultValue.empty() && (!gInitMemberDefaultInInitializerList)) {
-                            aname << " = " << a->defaultValue;
-                        }
+                        decl.type = cname;
+                        decl.name = a->name;
+                        decl.initialize = (!a->defaultValue.empty() && initdefault);
                     } else {
                         if ((a->Multiplicity == "1..*") || (a->Multiplicity == "*") || (a->Multiplicity == "0..*")) {
                             if (!a->QualifierType.empty()) {
-                                tname << "std::map<" << a->QualifierType << ", " << cname << ">";
-                                //extraheader += " map";
+                                decl.type = "std::map<" + a->QualifierType + ", " + cname + ">";
                             } else {
                                 std::string container;
 
@@ -1180,28 +1539,46 @@ void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
                                 auto element = MClass::mByFQN.find(container);
 
                                 if (element != MClass::mByFQN.end()) {
-                                    tname << element->first << "<" << cname << ">";
-                                    //extraheader += " vector";
+                                    decl.type = element->first + "<" + cname + ">";
                                 } else {
-                                    tname << "std::vector<" << cname << ">";
-                                    //extraheader += " vector";
+                                    decl.type = "std::vector<" + cname + ">";
                                 }
                             }
-                            aname << a->name;
+                            decl.name = a->name;
                         } else {
-                            tname << cname;
-                            aname << a->name << "[" << a->Multiplicity << "]";
-                            if (!a->defaultValue.empty() && (!gInitMemberDefaultInInitializerList)) {
-                                aname << " = " << a->defaultValue;
-                            }
+                            decl.type   = cname;
+                            decl.name   = a->name;
+                            decl.extent = "[" + a->Multiplicity + "]";
+                            decl.initialize = (!a->defaultValue.empty() && initdefault);
                         }
                     }
-                    attrlist[i].emplace_back(std::make_tuple(tname.str(), aname.str(), a));
+                    aList[i].push_back(decl);
                 }
             }
         }
         i++;
     }
+}
+
+void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent, bool aImpl) {
+    size_t i = 0U;
+    bool dump = true;
+    const std::string& classfiller = CodeWriter::spaces(indent);
+    //
+    //  These are the attributes sorted by visibility.
+    //  Package visibility is not considered here.
+    //  We are collecting them first for proper indentation.
+    //
+    //  tuple<type, name, comment>
+    std::list<std::tuple<std::string, std::string, std::shared_ptr<MElement> > >  attrlist[kVisSize];
+    std::list<tAttributeDecl>                                                    decllist[kVisSize];
+
+    CollectAttributeDecl(decllist, aImpl);
+    for (i = 0; i < vis.size(); ++i) {
+        for (auto & d : decllist[i]) {
+            attrlist[i].emplace_back(std::make_tuple(d.qualifier + d.type, d.name + d.extent + ((d.initialize) ? " = " + d.value : std::string()), d.element));
+        }
+    }
     size_t maxtype = 0;
     size_t maxname = 0;
 
@@ -1221,7 +1598,7 @@ void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
 
         dump = true;
         for (auto &li: attrlist[i]) {
-            if ((dump) && (type != eElementType::Struct)) {
+            if ((dump) && (type != eElementType::Struct) && (!aImpl)) {
                 dump = false;
                 hdr << classfiller << vis[i].second << ":\n";
             }
@@ -1250,6 +1627,17 @@ void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
             }
         }
     }
+    //
+    //  The private members are replaced by the pointer to the implementation.
+    if (mPimpl && (!aImpl)) {
+        hdr << classfiller << "private:\n";
+        hdr << classfiller << "    struct Impl;\n";
+        hdr << classfiller << "    struct ImplDeleter {\n";
+        hdr << classfiller << "        void operator()(Impl* aImpl) const;\n";
+        hdr << classfiller << "    };\n";
+        hdr << classfiller << "    static Impl* CreateImpl();\n";
+        hdr << classfiller << "    std::unique_ptr<Impl, ImplDeleter> mImpl {CreateImpl()};\n";
+    }
 }
 
 void CCxxClass::DumpPackageAttributeDecl(std::ostream& hdr) {
@@ -1362,6 +1750,24 @@ void CCxxClass::DumpPackageAttributeDecl(std::ostream& hdr) {
     }
 }
 
+//
+//  The implementation struct holds the private members of the class. It is only
+//  known in the source file, so changes to it do not touch the users of the header.
+void CCxxClass::DumpPimplDefinition(std::ostream& src) {
+    if (mPimpl) {
+        src << "//\n//  Private members of " << name << "\n";
+        src << "struct " << name << "::Impl {\n";
+        DumpAttributeDecl(src, 0, true);
+        src << "};\n\n";
+        src << name << "::Impl* " << name << "::CreateImpl() {\n";
+        src << "    return new Impl();\n";
+        src << "}\n\n";
+        src << "void " << name << "::ImplDeleter::operator()(Impl* aImpl) const {\n";
+        src << "    delete aImpl;\n";
+        src << "}\n\n";
+    }
+}
+
 void CCxxClass::DumpStaticAttributeDefinition(std::ostream& hdr) {
     for (auto & vi : vis) {
         for (auto & ma : Attribute) {
@@ -1822,111 +2228,400 @@ void CCxxClass::DumpAliases(std::ostream& file, int a_indent, eVisibility a_vis)
     }
 }
 
-void CCxxClass::DumpSerializerDecl(std::ostream& aHdr, int indent) const {
+void CCxxClass::DumpSerializerDecl(std::ostream& aHdr, int indent) {
     if (mSerialize) {
-        aHdr << "public:\n"
-            "    virtual size_t getSize(void) ;\n"
-            "    virtual void* pack(void* aToPtr) ;\n"
-            "    virtual void* unpack(void* aFromPtr) ;\n";
+        //
+        //  A plain class has no vtable, so the serializer can copy it as a whole.
+        const char* virt = IsSerialPod() ? "    " : "    virtual ";
+
+        aHdr << "public:\n";
+        if (IsSerialFixed()) {
+            std::string size;
+
+            for (auto & gi : Generalization) {
+                size.append(" + ").append(std::dynamic_pointer_cast<CGeneralization>(*gi)->base->name).append("::serialSize()");
+            }
+            for (auto & m : SerialMembers()) {
+                if (m.kind == eSerialKind::Record) {
+                    size.append(" + ");
+                    if (!m.count.empty()) {
+                        size.append(m.count).append(" * ");
+                    }
+                    size.append(m.record->mTypeTree.getFQN()).append("::serialSize()");
+                } else {
+                    size.append(" + sizeof(").append(m.name).append(")");
+                }
+            }
+            aHdr <<
+                "    static constexpr size_t serialSize(void) {\n"
+                "        return " << ((size.empty()) ? std::string("0") : size.substr(3)) << ";\n"
+                "    }\n";
+        }
+        aHdr << virt << "size_t getSize(void) const;\n" <<
+            virt << "void* pack(void* aToPtr) const;\n" <<
+            virt << "void* unpack(void* aFromPtr);\n"
+            "    static void* pack_n(const " << name << "* aFrom, size_t aCount, void* aToPtr);\n"
+            "    static void* unpack_n(" << name << "* aTo, size_t aCount, void* aFromPtr);\n";
     }
 }
 
-void CCxxClass::DumpSerializerDefinition(std::ostream& aSrc) {
-    if (mSerialize) {
+std::vector<CCxxClass::tSerialMember> CCxxClass::SerialMembers(void) {
+    std::vector<tSerialMember> retval;
+
+    for (auto& ma : Attribute) {
+        auto          a = std::dynamic_pointer_cast<CAttribute>(*ma);
+        tSerialMember member {a->name, eSerialKind::Scalar, std::string(), nullptr};
+        std::string   tname = (a->Classifier) ? a->Classifier->name : a->ClassifierName;
+
+        if (a->isStatic) {
+            continue;
+        }
+        if ((a->Multiplicity.empty()) || (a->Multiplicity == "1")) {
+        } else if (((a->Multiplicity == "1..*") || (a->Multiplicity == "*") || (a->Multiplicity == "0..*")) && (a->QualifierType.empty())) {
+            member.count = "*";
+        } else if (std::all_of(a->Multiplicity.begin(), a->Multiplicity.end(), ::isdigit)) {
+            member.count = a->Multiplicity;
+        } else {
+            std::cerr << "Serializer of " << name << " skips attribute " << a->name << "\n";
+            continue;
+        }
+        if ((a->Classifier) && (a->Classifier->type == eElementType::CxxClass) &&
+            (std::dynamic_pointer_cast<CCxxClass>(*a->Classifier)->mSerialize)) {
+            member.kind   = eSerialKind::Record;
+            member.record = std::dynamic_pointer_cast<CCxxClass>(*a->Classifier);
+        } else if ((tname == "std::string") || (tname == "string")) {
+            member.kind = eSerialKind::String;
+        } else if (((a->Classifier) && (a->Classifier->type == eElementType::Enumeration)) ||
+                   ((a->Classifier) && (a->Classifier->type == eElementType::PrimitiveType)) || IsSerialScalar(tname)) {
+            member.kind = eSerialKind::Scalar;
+        } else {
+            std::cerr << "Serializer of " << name << " skips attribute " << a->name << "\n";
+            continue;
+        }
+        //
+        //  Strings are only supported as single values and a vector of bool has no data() to copy from.
+        if (((member.kind == eSerialKind::String) && (!member.count.empty())) || ((tname == "bool") && (member.count == "*"))) {
+            std::cerr << "Serializer of " << name << " skips attribute " << a->name << "\n";
+            continue;
+        }
+        retval.push_back(member);
+    }
+    return retval;
+}
+
+//
+//  The size of a fixed class is known at compile time. This is the case if
+//  the bases and all members are single values or arrays of scalars or of
+//  other fixed serializable classes.
+bool CCxxClass::IsSerialFixed(void) {
+    if (!mSerialize) {
+        return false;
+    }
+    for (auto & gi : Generalization) {
+        auto base = std::dynamic_pointer_cast<CCxxClass>(*std::dynamic_pointer_cast<CGeneralization>(*gi)->base);
+
+        if ((!base) || (!base->IsSerialFixed())) {
+            return false;
+        }
+    }
+    for (auto & m : SerialMembers()) {
+        if ((m.count == "*") || (m.kind == eSerialKind::String) ||
+            ((m.kind == eSerialKind::Record) && (!m.record->IsSerialFixed()))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+//  A fixed class in host byte order that is not part of a hierarchy and has
+//  no virtual operations is copied with a single memcpy. The generated code
+//  checks at compile time that the class is trivially copyable and has no
+//  padding. Otherwise it falls back to the copy of each member.
+bool CCxxClass::IsSerialPod(void) {
+    std::set<eVisibility> visibility;
+
+    if ((mByteOrder != eByteOrder::Host) || (!Generalization.empty()) || (!Derived.empty()) ||
+        (mIsInterface) || (!mClassParameter.empty()) || HasAnyVirtuals() || (!IsSerialFixed())) {
+        return false;
+    }
+    //
+    //  Members of different visibility may be reordered by the declaration.
+    for (auto& ma : Attribute) {
+        auto a = std::dynamic_pointer_cast<CAttribute>(*ma);
+
+        if (!a->isStatic) {
+            visibility.insert(a->visibility);
+        }
+    }
+    if (visibility.size() > 1) {
+        return false;
+    }
+    for (auto & m : SerialMembers()) {
+        if ((m.kind == eSerialKind::Record) && (!m.record->IsSerialPod())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CCxxClass::DumpSerialPack(std::ostream& aSrc, const tSerialMember& aMember) {
+    const std::string& m = aMember.name;
+
+    if (aMember.count == "*") {
         aSrc <<
-            "size_t " << name << "::getSize(void) {\n"
-            "    size_t retval = 0;\n\n";
-        
-        for (auto & gi : Generalization) {
-            aSrc << "    retval += " << std::dynamic_pointer_cast<CGeneralization>(*gi)->base->name << "::getSize();\n";
+            "    {\n"
+            "        uint32_t count = static_cast<uint32_t>(" << m << ".size());\n\n";
+        if (mByteOrder == eByteOrder::Network) {
+            aSrc << "        retval = mtt::serial_put(retval, count);\n";
+        } else {
+            aSrc <<
+                "        std::memcpy(retval, &count, sizeof(count));\n"
+                "        retval += sizeof(count);\n";
         }
-        for (auto& ma : Attribute) {
-            auto a = std::dynamic_pointer_cast<CAttribute>(*ma);
+        if (aMember.kind == eSerialKind::Record) {
+            aSrc << "        retval = static_cast<uint8_t*>(" << aMember.record->mTypeTree.getFQN() << "::pack_n(" << m << ".data(), count, retval));\n";
+        } else if (mByteOrder == eByteOrder::Network) {
+            aSrc << "        retval = mtt::serial_put_n(retval, " << m << ".data(), count);\n";
+        } else {
+            aSrc <<
+                "        if (count != 0) {\n"
+                "            std::memcpy(retval, " << m << ".data(), count * sizeof(" << m << "[0]));\n"
+                "            retval += count * sizeof(" << m << "[0]);\n"
+                "        }\n";
+        }
+        aSrc << "    }\n";
+    } else if (aMember.kind == eSerialKind::String) {
+        aSrc <<
+            "    {\n"
+            "        uint32_t count = static_cast<uint32_t>(" << m << ".size());\n\n";
+        if (mByteOrder == eByteOrder::Network) {
+            aSrc << "        retval = mtt::serial_put(retval, count);\n";
+        } else {
+            aSrc <<
+                "        std::memcpy(retval, &count, sizeof(count));\n"
+                "        retval += sizeof(count);\n";
+        }
+        aSrc <<
+            "        std::memcpy(retval, " << m << ".data(), count);\n"
+            "        retval += count;\n"
+            "    }\n";
+    } else if (aMember.kind == eSerialKind::Record) {
+        if (aMember.count.empty()) {
+            aSrc << "    retval = static_cast<uint8_t*>(" << m << ".pack(retval));\n";
+        } else {
+            aSrc << "    retval = static_cast<uint8_t*>(" << aMember.record->mTypeTree.getFQN() << "::pack_n(" << m << ", " << aMember.count << ", retval));\n";
+        }
+    } else if (mByteOrder == eByteOrder::Network) {
+        if (aMember.count.empty()) {
+            aSrc << "    retval = mtt::serial_put(retval, " << m << ");\n";
+        } else {
+            aSrc << "    retval = mtt::serial_put_n(retval, " << m << ", " << aMember.count << ");\n";
+        }
+    } else {
+        aSrc <<
+            "    std::memcpy(retval, " << ((aMember.count.empty()) ? "&" : "") << m << ", sizeof(" << m << "));\n"
+            "    retval += sizeof(" << m << ");\n";
+    }
+}
 
-            if (a->Classifier) {
-                if ((a->Classifier->type == eElementType::PrimitiveType) || (IsCardinalType(a->Classifier->name))) {
-                    aSrc <<
-                        "    retval += sizeof(" << a->Classifier->name << ");\n";
+void CCxxClass::DumpSerialUnpack(std::ostream& aSrc, const tSerialMember& aMember) {
+    const std::string& m = aMember.name;
+
+    if ((aMember.count == "*") || (aMember.kind == eSerialKind::String)) {
+        aSrc <<
+            "    {\n"
+            "        uint32_t count;\n\n";
+        if (mByteOrder == eByteOrder::Network) {
+            aSrc << "        retval = mtt::serial_get(retval, count);\n";
+        } else {
+            aSrc <<
+                "        std::memcpy(&count, retval, sizeof(count));\n"
+                "        retval += sizeof(count);\n";
+        }
+        if (aMember.kind == eSerialKind::String) {
+            aSrc <<
+                "        " << m << ".assign(reinterpret_cast<const char*>(retval), count);\n"
+                "        retval += count;\n";
+        } else {
+            aSrc << "        " << m << ".resize(count);\n";
+            if (aMember.kind == eSerialKind::Record) {
+                aSrc << "        retval = static_cast<uint8_t*>(" << aMember.record->mTypeTree.getFQN() << "::unpack_n(" << m << ".data(), count, retval));\n";
+            } else if (mByteOrder == eByteOrder::Network) {
+                aSrc << "        retval = mtt::serial_get_n(retval, " << m << ".data(), count);\n";
+            } else {
+                aSrc <<
+                    "        if (count != 0) {\n"
+                    "            std::memcpy(" << m << ".data(), retval, count * sizeof(" << m << "[0]));\n"
+                    "            retval += count * sizeof(" << m << "[0]);\n"
+                    "        }\n";
+            }
+        }
+        aSrc << "    }\n";
+    } else if (aMember.kind == eSerialKind::Record) {
+        if (aMember.count.empty()) {
+            aSrc << "    retval = static_cast<uint8_t*>(" << m << ".unpack(retval));\n";
+        } else {
+            aSrc << "    retval = static_cast<uint8_t*>(" << aMember.record->mTypeTree.getFQN() << "::unpack_n(" << m << ", " << aMember.count << ", retval));\n";
+        }
+    } else if (mByteOrder == eByteOrder::Network) {
+        if (aMember.count.empty()) {
+            aSrc << "    retval = mtt::serial_get(retval, " << m << ");\n";
+        } else {
+            aSrc << "    retval = mtt::serial_get_n(retval, " << m << ", " << aMember.count << ");\n";
+        }
+    } else {
+        aSrc <<
+            "    std::memcpy(" << ((aMember.count.empty()) ? "&" : "") << m << ", retval, sizeof(" << m << "));\n"
+            "    retval += sizeof(" << m << ");\n";
+    }
+}
+
+//
+//  The wire format is the sequence of the bases and members in declaration
+//  order without padding. Vectors and strings are prefixed with their count
+//  as uint32_t. With ByteOrder=Network all scalars are written big endian.
+void CCxxClass::DumpSerializerDefinition(std::ostream& aSrc) {
+    if (mSerialize) {
+        std::vector<tSerialMember> members = SerialMembers();
+        bool                       pod     = IsSerialPod();
+        std::string                podcheck = std::string("std::is_trivially_copyable<") + name + ">::value && (sizeof(" + name + ") == serialSize())";
+        //
+        //  Bases and members write themselves in their own byte order. A class
+        //  in network byte order is only consistent if they do the same.
+        if (mByteOrder == eByteOrder::Network) {
+            for (auto & gi : Generalization) {
+                auto base = std::dynamic_pointer_cast<CCxxClass>(*std::dynamic_pointer_cast<CGeneralization>(*gi)->base);
+
+                if ((base) && (base->mByteOrder != eByteOrder::Network)) {
+                    std::cerr << "Serializer of " << name << " writes base " << base->name << " in host byte order\n";
                 }
-                else if (a->Classifier->IsClassBased()) {
-                    aSrc <<
-                        "    retval += " << ma->name << "::getSize()\n";
+            }
+            for (auto & m : members) {
+                if ((m.kind == eSerialKind::Record) && (m.record->mByteOrder != eByteOrder::Network)) {
+                    std::cerr << "Serializer of " << name << " writes " << m.name << " of " << m.record->name << " in host byte order\n";
                 }
             }
         }
 
         aSrc <<
-            "    return retval;\n"
-            "}\n"
-            "void* " << name << "::pack(void* aToPtr) {\n"
-            "    uint8_t* retval = static_cast<uint8_t*>(aToPtr);\n\n";
-        
-        for (auto & gi : Generalization) {
+            "size_t " << name << "::getSize(void) const {\n";
+        if (IsSerialFixed()) {
             aSrc <<
-                "    retval = static_cast<uint8_t*>(" << std::dynamic_pointer_cast<CGeneralization>(*gi)->base->name << "::pack(retval));\n";
-        }
-        for (auto& ma : Attribute) {
-            auto a = std::dynamic_pointer_cast<CAttribute>(*ma);
-
-            if (a->Classifier) {
-                if ((a->Classifier->type == eElementType::PrimitiveType) || (IsCardinalType(a->Classifier->name)) || (a->Classifier->type == eElementType::Enumeration)) {
-                    if (a->Classifier->type == eElementType::Enumeration) {
-                    }
-                    aSrc <<
-                        "    std::memcpy(retval, &" << ma->name << ", sizeof(" << a->Classifier->name << "));\n";
-                    if (mByteOrder == eByteOrder::Network) {
-                        
+                "    return serialSize();\n";
+        } else {
+            aSrc <<
+                "    size_t retval = 0;\n\n";
+            for (auto & gi : Generalization) {
+                aSrc << "    retval += " << std::dynamic_pointer_cast<CGeneralization>(*gi)->base->name << "::getSize();\n";
+            }
+            for (auto & m : members) {
+                if (m.kind == eSerialKind::String) {
+                    aSrc << "    retval += sizeof(uint32_t) + " << m.name << ".size();\n";
+                } else if (m.kind == eSerialKind::Scalar) {
+                    if (m.count == "*") {
+                        aSrc << "    retval += sizeof(uint32_t) + " << m.name << ".size() * sizeof(" << m.name << "[0]);\n";
                     } else {
+                        aSrc << "    retval += sizeof(" << m.name << ");\n";
+                    }
+                } else if (m.record->IsSerialFixed()) {
+                    aSrc << "    retval += ";
+                    if (m.count == "*") {
+                        aSrc << "sizeof(uint32_t) + " << m.name << ".size() * ";
+                    } else if (!m.count.empty()) {
+                        aSrc << m.count << " * ";
+                    }
+                    aSrc << m.record->mTypeTree.getFQN() << "::serialSize();\n";
+                } else if (m.count.empty()) {
+                    aSrc << "    retval += " << m.name << ".getSize();\n";
+                } else {
+                    if (m.count == "*") {
+                        aSrc << "    retval += sizeof(uint32_t);\n";
                     }
                     aSrc <<
-                        "    retval += sizeof(" << a->Classifier->name << ");\n";
-                }
-                else if (a->Classifier->IsClassBased()) {
-                    aSrc <<
-                        "    retval += static_cast<uint8_t*>(" << ma->name << "::pack(retval));\n";
+                        "    for (const auto& e : " << m.name << ") {\n"
+                        "        retval += e.getSize();\n"
+                        "    }\n";
                 }
             }
+            aSrc <<
+                "    return retval;\n";
+        }
+        aSrc <<
+            "}\n"
+            "void* " << name << "::pack(void* aToPtr) const {\n"
+            "    uint8_t* retval = static_cast<uint8_t*>(aToPtr);\n\n";
+        if (pod) {
+            aSrc <<
+                "    if constexpr (" << podcheck << ") {\n"
+                "        std::memcpy(retval, this, sizeof(" << name << "));\n"
+                "        return retval + sizeof(" << name << ");\n"
+                "    }\n";
+        }
+        for (auto & gi : Generalization) {
+            aSrc <<
+                "    retval = static_cast<uint8_t*>(" << std::dynamic_pointer_cast<CGeneralization>(*gi)->base->name << "::pack(retval));\n";
+        }
+        for (auto & m : members) {
+            DumpSerialPack(aSrc, m);
         }
-        //for (auto& me : OtherEnd) {
-        //}
-        
         aSrc <<
             "    return retval;\n"
             "}\n"
             "void* " << name << "::unpack(void* aFromPtr) {\n"
             "    uint8_t* retval = static_cast<uint8_t*>(aFromPtr);\n\n";
-        
+        if (pod) {
+            aSrc <<
+                "    if constexpr (" << podcheck << ") {\n"
+                "        std::memcpy(this, retval, sizeof(" << name << "));\n"
+                "        return retval + sizeof(" << name << ");\n"
+                "    }\n";
+        }
         for (auto & gi : Generalization) {
-            aSrc << 
+            aSrc <<
                 "    retval = static_cast<uint8_t*>(" << std::dynamic_pointer_cast<CGeneralization>(*gi)->base->name << "::unpack(retval));\n";
         }
-        for (auto& ma : Attribute) {
-            auto a = std::dynamic_pointer_cast<CAttribute>(*ma);
-
-            if (a->Classifier != nullptr) {
-                if ((a->Classifier->type == eElementType::PrimitiveType) || (IsCardinalType(a->Classifier->name)) || (a->Classifier->type == eElementType::Enumeration)) {
-                    if (a->Classifier->type == eElementType::Enumeration) {
-                    }
-                    aSrc <<
-                        "    std::memcpy(&" << ma->name << ", retval, sizeof(" << a->Classifier->name << "));\n";
-                    if (mByteOrder == eByteOrder::Network) {
-                        
-                    }
-                    else {
-                    }
-                    aSrc <<
-                        "    retval += sizeof(" << a->Classifier->name << ");\n";
-                }
-                else if (a->Classifier->IsClassBased()) {
-                    aSrc <<
-                        "    retval += static_cast<uint8_t*>(" << ma->name << "::pack(retval));\n";
-                }
-            }
+        for (auto & m : members) {
+            DumpSerialUnpack(aSrc, m);
         }
-        //for (auto& me : OtherEnd) {
-        //}
-        
+        //
+        //  The batched versions call the operations of this class directly as
+        //  the array holds exactly this type.
         aSrc <<
+            "    return retval;\n"
+            "}\n"
+            "void* " << name << "::pack_n(const " << name << "* aFrom, size_t aCount, void* aToPtr) {\n"
+            "    uint8_t* retval = static_cast<uint8_t*>(aToPtr);\n\n";
+        if (pod) {
+            aSrc <<
+                "    if constexpr (" << podcheck << ") {\n"
+                "        if (aCount != 0) {\n"
+                "            std::memcpy(retval, aFrom, aCount * sizeof(" << name << "));\n"
+                "        }\n"
+                "        return retval + aCount * sizeof(" << name << ");\n"
+                "    }\n";
+        }
+        aSrc <<
+            "    for (size_t i = 0; i < aCount; ++i) {\n"
+            "        retval = static_cast<uint8_t*>(aFrom[i]." << name << "::pack(retval));\n"
+            "    }\n"
+            "    return retval;\n"
+            "}\n"
+            "void* " << name << "::unpack_n(" << name << "* aTo, size_t aCount, void* aFromPtr) {\n"
+            "    uint8_t* retval = static_cast<uint8_t*>(aFromPtr);\n\n";
+        if (pod) {
+            aSrc <<
+                "    if constexpr (" << podcheck << ") {\n"
+                "        if (aCount != 0) {\n"
+                "            std::memcpy(aTo, retval, aCount * sizeof(" << name << "));\n"
+                "        }\n"
+                "        return retval + aCount * sizeof(" << name << ");\n"
+                "    }\n";
+        }
+        aSrc <<
+            "    for (size_t i = 0; i < aCount; ++i) {\n"
+            "        retval = static_cast<uint8_t*>(aTo[i]." << name << "::unpack(retval));\n"
+            "    }\n"
             "    return retval;\n"
             "}\n";
     }
@@ -1938,6 +2633,11 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
     std::set<std::string> includesdone;
     std::string           wxappclass    = GetTaggedValue("WxAppClass");
     //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
+    //
     //  Collect the needed modell header.
     CollectNeededModelHeader(shared_this(), neededmodelheader);
     CollectForwards();
@@ -1986,7 +2686,25 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
     donelist.clear();
     if (mSerialize) {
         includesdone.insert("string");
-        hdr << "#include <string>\n";
+        includesdone.insert("cstdint");
+        includesdone.insert("cstring");
+        includesdone.insert("type_traits");
+        hdr << "#include <string>\n"
+            "#include <cstdint>\n"
+            "#include <cstring>\n"
+            "#include <type_traits>\n";
+    }
+    if (mPimpl) {
+        includesdone.insert("memory");
+        hdr << "#include <memory>\n";
+    }
+    if (UsesParallelActivity()) {
+        includesdone.insert("future");
+        hdr << "#include <future>\n";
+    }
+    if (mSoA) {
+        SoALayout::Dump(std::dynamic_pointer_cast<CModel>(model), id);
+        hdr << "#include \"" << SoALayout::Name() << "\"\n";
     }
     //  Dump system headers.
     DumpSystemHeader(hdr);
@@ -2014,6 +2732,7 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
     //
     //  Dump the class declaration with zero indentation.
     DumpClassDecl(hdr, 0);
+    DumpSoADefinition(hdr);
 
     DumpInlineOperations(hdr);
     DumpPackageAttributeDecl(hdr);
@@ -2037,8 +2756,8 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
         headerdir.Create();
         std::string sysheaderpath = (std::string)headerdir;
 
-        cmodel->generatedfiles.push_back(  tGenFile { sysheaderpath, id, "//", "mSysHeader"} );
         OpenStream(mSysHeader, sysheaderpath);
+        cmodel->generatedfiles.push_back(  tGenFile { sysheaderpath, id, "//", "mSysHeader", mSysHeader.buffer()} );
         if (!mSysHeader.is_open()) {
             std::cerr << "Cannot open file " << sysheaderpath << std::endl;
         } else {
@@ -2088,7 +2807,19 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
             dump = true;
             if (mSerialize) {
                 includesdone.insert("string");
-                mSysHeader << "#include <string>\n";
+                includesdone.insert("cstdint");
+                includesdone.insert("cstring");
+                includesdone.insert("type_traits");
+                mSysHeader << "#include <string>\n"
+                    "#include <cstdint>\n"
+                    "#include <cstring>\n"
+                    "#include <type_traits>\n";
+            }
+            if (mPimpl) {
+                mSysHeader << "#include <memory>\n";
+            }
+            if (UsesParallelActivity()) {
+                mSysHeader << "#include <future>\n";
             }
 
             for (auto & h : mSelfContainedHeaders) {
@@ -2158,6 +2889,17 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
                     }
                 }
             }
+            //
+            //  Forwards that replace the includes of model headers.
+            if (!mSelfContainedForwards.empty()) {
+                NameSpaceNode nstree;
+
+                mSysHeader << "//\n//  Forwards instead of includes.\n";
+                for (auto & f : mSelfContainedForwards) {
+                    nstree.add(f->mNameSpace.get(), f);
+                }
+                nstree.dump(mSysHeader);
+            }
             DumpMessageForwards(mSysHeader);
             //
             //  Dump namespace-intro.
@@ -2173,6 +2915,9 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
             DumpOperationDecl(mSysHeader, 0);
     //        DumpQtConnectorDecl(mSysHeader);
             DumpAttributeDecl(mSysHeader, 0);
+            if (mSoA) {
+                mSysHeader << "    friend class " << name << "SoA;\n";
+            }
             mSysHeader << "};\n";
             DumpInlineOperations(mSysHeader);
             DumpPackageAttributeDecl(mSysHeader);
@@ -2206,6 +2951,10 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
         //
         //  Dump include statements for all incoming messages and signals.
         DumpMessageIncludes(src, donelist, includesdone);
+        if (mSerialize && (mByteOrder == eByteOrder::Network)) {
+            SerialHeader::Dump(std::dynamic_pointer_cast<CModel>(model), id);
+            src << "#include \"" << SerialHeader::Name() << "\"\n";
+        }
 
 //        DumpQtConnectorIncludes(src, donelist, includesdone);
         DumpPrivateMacros(src);
@@ -2214,6 +2963,7 @@ void CCxxClass::Dump(std::shared_ptr<MModel> model) {
             DumpNameSpaceIntro(src);
         }
 
+        DumpPimplDefinition(src);
         DumpStaticAttributeDefinition(src);
         DumpPackageAttributeDefinition(src);
         DumpPackageOperationDefinition(src, true);
@@ -2341,6 +3091,21 @@ bool CCxxClass::HasDTOR(void) {
     return retval;
 }
 
+//
+//  Private attributes and association ends of a pimpl class live in the implementation struct.
+bool CCxxClass::IsPimplMember(std::shared_ptr<MElement> aMember) const {
+    bool retval = false;
+
+    if (mPimpl && (aMember->visibility == vPrivate)) {
+        if (aMember->type == eElementType::Attribute) {
+            retval = !(std::dynamic_pointer_cast<MAttribute>(aMember)->isStatic);
+        } else {
+            retval = (aMember->type == eElementType::AssociationEnd);
+        }
+    }
+    return retval;
+}
+
 std::shared_ptr<COperation> CCxxClass::findBySignature(const std::string& aSignature) {
     std::shared_ptr<COperation> retval;
 
@@ -2600,8 +3365,7 @@ uint8_t CCxxClass::getOneOfFive() {
 
 
 void CCxxClass::DumpClassDecl(std::ostream& file, int indent) {
-    std::string filler;
-    filler.assign(indent, ' ');
+    const std::string& filler = CodeWriter::spaces(indent);
 
     //
     //  Dump the usings.
@@ -2671,6 +3435,30 @@ void CCxxClass::DumpClassDecl(std::ostream& file, int indent) {
     DumpSerializerDecl(file, indent);
     //    DumpQtConnectorDecl(file);
     DumpAttributeDecl(file, indent);
+    if (mSoA) {
+        file << filler << "    friend class " << name << "SoA;\n";
+    }
     file << filler << "};\n";
 
 }
+//
+//  The struct of arrays gets a column for each member the class declares.
+//  Static members are not part of an element.
+void CCxxClass::DumpSoADefinition(std::ostream& file) {
+    if (mSoA) {
+        std::list<tAttributeDecl> decllist[kVisSize];
+        SoALayout                 layout(name);
+
+        CollectAttributeDecl(decllist, false);
+        for (size_t i = 0; i < vis.size(); ++i) {
+            for (auto & d : decllist[i]) {
+                if (d.qualifier.find("static ") == std::string::npos) {
+                    std::string extent = (d.extent.empty()) ? std::string() : d.extent.substr(1, d.extent.size() - 2);
+
+                    layout.Member(d.type, d.name, extent, d.value, (d.qualifier.find("const ") != std::string::npos));
+                }
+            }
+        }
+        file << "\n" << layout.Definition();
+    }
+}
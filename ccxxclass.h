@@ -22,6 +22,8 @@
 
 #include <iostream>
 #include <list>
+#include <vector>
+#include <string>
 
 class CClassBase;
 class CAttribute;
@@ -52,13 +54,21 @@ public:
     std::string GetBaseClasses(void);
 
     void CollectNeededModelHeader(std::shared_ptr<MElement> e, HeaderList& aHeaderList) ;
-
-    void CollectFromBase(const TypeNode& aNode, HeaderList& aHeaderList);
-    void CollectFromAttribute(const TypeNode& aNode, HeaderList& aHeaderList, bool aIsTemplateReference = false);
-    void CollectFromParameter(const TypeNode& aNode, HeaderList& aHeaderList);
-    void CollectFromSharedAssoc(const TypeNode& aNode, HeaderList& aHeaderList);
-    void CollectFromCompositeAssoc(const TypeNode& aNode, HeaderList& aHeaderList);
-    void CollectFromTemplateBinding(std::shared_ptr<CClassBase> aClass, HeaderList& aHeaderList);
+    void CollectNeededModelHeader(std::shared_ptr<MElement> e, HeaderList& aHeaderList, HeaderWalk aWalk);
+    void CollectFromSteps(std::shared_ptr<MElement> e, HeaderList& aHeaderList, HeaderWalk aWalk);
+    void ReplayHeaderClosure(const HeaderClosure& aClosure, HeaderList& aHeaderList, HeaderWalk aWalk);
+    const HeaderClosure* GetHeaderClosure(std::shared_ptr<MElement> e, bool aOptional, bool aBuild);
+    HeaderGraph& GetHeaderGraph();
+    size_t GetHeaderComponent(std::shared_ptr<MElement> e, bool aOptional);
+    void CollectHeaderComponents(std::shared_ptr<MElement> e, bool aOptional, HeaderComponents& aWork);
+
+    void CollectFromBase(const TypeNode& aNode, std::vector<HeaderStep>& aSteps);
+    void CollectFromAttribute(const TypeNode& aNode, std::vector<HeaderStep>& aSteps, bool aIsTemplateReference = false);
+    void CollectFromParameter(const TypeNode& aNode, std::vector<HeaderStep>& aSteps);
+    void CollectFromSharedAssoc(const TypeNode& aNode, std::vector<HeaderStep>& aSteps);
+    void CollectFromCompositeAssoc(const TypeNode& aNode, std::vector<HeaderStep>& aSteps);
+    void CollectFromTemplateBinding(std::shared_ptr<CClassBase> aClass, std::vector<HeaderStep>& aSteps);
+    const std::vector<HeaderStep>& GetHeaderSteps(std::shared_ptr<CClassBase> c);
 
 //    void CollectExtraHeader(std::shared_ptr<MElement> e);
     void CollectSelfContainedHeader();
@@ -69,24 +79,27 @@ public:
     void DumpOperationDecl(std::ostream& hdr, int indent);
     void DumpInlineOperations(std::ostream& hdr);
     //void DumpQtConnectorDecl(std::ostream& hdr);
-    void DumpAttributeDecl(std::ostream& hdr, int indent);
+    void DumpAttributeDecl(std::ostream& hdr, int indent, bool aImpl = false);
     void DumpPackageAttributeDecl(std::ostream& hdr);
 
     void DumpStaticAttributeDefinition(std::ostream& src);
     void DumpPackageAttributeDefinition(std::ostream&src);
     void DumpPackageOperationDefinition(std::ostream &src, bool aStatic) ;
     void DumpOperationDefinition(std::ostream& src);
+    void DumpPimplDefinition(std::ostream& src);
     void DumpAliases(std::ostream& file, int a_indent, eVisibility a_vis = vPackage);
     //void DumpQtConnectorDefinition(std::ostream& src);
 
     void DumpCollaboration(std::ostream& src, std::shared_ptr<CClassBase> aCollab);
     static bool IsCardinalType(const std::string&);
+    static bool IsSerialScalar(const std::string&);
 
     bool NeedSimIfc(void);
     //bool HaveAnyContent(void);
     bool HasAnyVirtuals(void);
     //bool HasCTOR(void);
     bool HasDTOR(void);
+    bool IsPimplMember(std::shared_ptr<MElement> aMember) const;
     bool hasOneOfFive(void);
     uint8_t getOneOfFive(void) ;
 
@@ -99,27 +112,71 @@ public:
     void DumpMessageProcessingFunctions(std::shared_ptr<CCxxClass> where, std::set<std::string>& aDoneList);
     //
     //  Serializer specific
-    void DumpSerializerDecl(std::ostream& hdr, int indent) const;
+    void DumpSerializerDecl(std::ostream& hdr, int indent);
     void DumpSerializerDefinition(std::ostream& src);
+    bool IsSerialFixed(void);
+    bool IsSerialPod(void);
 
     void DumpForwards(std::ostream& file);
 
     void DumpClassDecl(std::ostream& file, int indent);
+    void DumpSoADefinition(std::ostream& file);
 public:
 private:
     void CollectForwards(std::shared_ptr<CClassBase> aClass);
     void CollectForwardRefs(std::shared_ptr<CClassBase> aClass);
     void FillInCollection(std::shared_ptr<MElement> e);
     void FillInCollection(const std::string& aTextType);
+    void FillInForwards(const TypeNode& aNode);
+    bool IsForwardable(std::shared_ptr<CClassBase> aClass) const;
     std::string mapVisibility(eVisibility a_vis);
+    //
+    //  The members the serializer writes, in declaration order.
+    enum class eSerialKind {
+        Scalar,
+        String,
+        Record
+    };
+    struct tSerialMember {
+        std::string                name;
+        eSerialKind                kind;
+        std::string                count;   //  Empty for single values, the array size or "*" for vectors.
+        std::shared_ptr<CCxxClass> record;
+    };
+    std::vector<tSerialMember> SerialMembers(void);
+    //
+    //  A member in the form DumpAttributeDecl declares it.
+    struct tAttributeDecl {
+        std::string               qualifier;  //  static, const and volatile
+        std::string               type;
+        std::string               name;
+        std::string               extent;     //  The size of a plain array.
+        std::string               value;      //  The default value from the model.
+        bool                      initialize = false;  //  The default value is part of the declaration.
+        std::shared_ptr<MElement> element;
+    };
+    void CollectAttributeDecl(std::list<tAttributeDecl> aList[], bool aImpl);
+    void DumpSerialPack(std::ostream& aSrc, const tSerialMember& aMember);
+    void DumpSerialUnpack(std::ostream& aSrc, const tSerialMember& aMember);
 protected:
     std::string                          mClassifierType = "class";
     bool                                 mSerialize = false;
+    bool                                 mPimpl     = false;  //  Private members are kept in an implementation struct.
+    bool                                 mSoA       = false;  //  A struct of arrays container is generated along the class.
     eByteOrder                           mByteOrder = eByteOrder::Host;
-    std::ofstream                        mSysHeader;
+    CodeWriter                           mSysHeader;
     std::list<std::shared_ptr<MElement>> mSelfContainedHeaders;
     std::list<std::shared_ptr<MElement>> mSelfContainedExtras;
     std::list<std::shared_ptr<MElement>> mSelfContainedQt;
+    std::list<std::shared_ptr<CClassBase>> mSelfContainedForwards;
+    //
+    //  Header collection steps by class ordinal and namespace of the collecting class.
+    static std::map<std::pair<size_t, std::string>, HeaderSteps> mHeaderSteps;
+    //
+    //  Header closures and components by namespace of the collecting class.
+    static std::map<std::string, HeaderGraph> mHeaderGraph;
+    static size_t                             mHeaderGeneration;
+    HeaderGraph*                              mHeaderGraphOfNameSpace = nullptr;
 };
 
 
@@ -17,12 +17,18 @@
 // HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
 // CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <map>
+#include <cstdlib>
+
+#include "helper.h"
 #include "melement.h"
 
 #include "mattribute.h"
 #include "cattribute.h"
 
 #include "cenumeration.h"
+#include "perfecthash.h"
+#include "enumtable.h"
 
 void CEnumeration::SetFromTags(const std::string& name, const std::string&value)
 {
@@ -152,16 +158,154 @@ void CEnumeration::DumpNameSpaceClosing(std::ostream &file) {
 
 
 void CEnumeration::Dump(std::shared_ptr<MModel> model) {
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
 
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
 
     DumpBase(cmodel, name);
     DumpFileHeader(hdr, name, ".h");
     DumpGuardHead(hdr, name);
+    if (HasStringTable()) {
+        PerfectHash::Dump(cmodel, id);
+        hdr << "#include <cstddef>\n"
+               "#include <cstdint>\n"
+               "#include <cstdlib>\n"
+               "#include <string>\n"
+               "#include <string_view>\n"
+               "#include \"" << PerfectHash::Name() << "\"\n";
+    }
     DumpNameSpaceIntro(hdr);
     DumpClassDecl(hdr, 0);
+    if (HasStringTable()) {
+        DumpStringTable(hdr);
+    }
     DumpNameSpaceClosing(hdr);
 
     DumpGuardTail(hdr, name);
     CloseStreams();
 }
+
+bool CEnumeration::HasStringTable() const {
+    return (!Attribute.empty()) && ((!parent) || (!parent->IsClassBased()));
+}
+
+//
+//  The longest literal name with its quotes as written to JSON.
+size_t CEnumeration::NameBound() const {
+    size_t bound = 0;
+
+    for (auto & i : Attribute) {
+        bound = std::max(bound, (*i)->name.size());
+    }
+    return bound + 2;
+}
+
+//
+//  The string functions of the enumeration as they are called from outside
+//  its namespace.
+std::string CEnumeration::StringFunction(const std::string& aSuffix) const {
+    if (mNameSpace.empty()) {
+        return name + aSuffix;
+    }
+    return mNameSpace.getString() + "::" + name + aSuffix;
+}
+
+//
+//  The literals count up from zero or from the value before. The value of a
+//  literal is known to the generator if it is a number or the name of a
+//  literal declared before.
+void CEnumeration::DumpStringTable(std::ostream &file) {
+    EnumTable                       table(name, name);
+    std::map<std::string, uint64_t> known;
+    uint64_t                        next  = 0;
+    bool                            valid = true;
+
+    for (auto & i : Attribute) {
+        auto        a     = std::dynamic_pointer_cast<CAttribute>(*i);
+        std::string value = helper::trim(a->defaultValue);
+
+        if (!value.empty()) {
+            char* end = nullptr;
+
+            if (value[0] == '-') {
+                next = static_cast<uint64_t>(strtoll(value.c_str(), &end, 0));
+            } else {
+                next = strtoull(value.c_str(), &end, 0);
+            }
+            if ((end != nullptr) && (*end == '\0')) {
+                valid = true;
+            } else if (known.find(value) != known.end()) {
+                next  = known[value];
+                valid = true;
+            } else {
+                valid = false;
+            }
+        }
+        if (valid) {
+            known[a->name] = next;
+            table.Add(a->name, name + "::" + a->name, next++);
+        } else {
+            table.Add(a->name, name + "::" + a->name);
+        }
+    }
+    file << "\n" << table.Definition();
+    file << "\n"
+            "//\n"
+            "//  Reads a " << name << " from the name in a JSON value. Numbers are taken as they are.\n"
+            "//  The tJSON of the runtime is found when the call is compiled.\n"
+            "template <typename J>\n"
+            << name << " to_" << name << "(J* aJson) {\n"
+            "    " << name << " value {};\n"
+            "    std::string text = to_string(aJson);\n"
+            "\n"
+            "    if (!" << name << "FromString(text, value)) {\n"
+            "        char* end = nullptr;\n"
+            "        long long number = std::strtoll(text.c_str(), &end, 0);\n"
+            "\n"
+            "        if ((end != text.c_str()) && (*end == '\\0')) {\n"
+            "            value = static_cast<" << name << ">(number);\n"
+            "        }\n"
+            "    }\n"
+            "    return value;\n"
+            "}\n"
+            "//\n"
+            "//  The name of the literal in quotes as written to JSON. A value without a\n"
+            "//  name is written as number.\n"
+            "inline std::string " << name << "ToJSON(" << name << " aValue) {\n"
+            "    std::string_view literal = " << name << "ToString(aValue);\n"
+            "\n"
+            "    if (literal.empty()) {\n"
+            "        return std::to_string(static_cast<long long>(aValue));\n"
+            "    }\n"
+            "    return \"\\\"\" + std::string(literal) + \"\\\"\";\n"
+            "}\n";
+}
+
+//
+//  The function that reads a value from a tJSON node. Enumerations with string
+//  tables bring their own, the others are read by the runtime.
+std::string CEnumeration::JSONReader(std::shared_ptr<MElement> aClassifier) {
+    auto e = std::dynamic_pointer_cast<CEnumeration>(aClassifier);
+
+    if ((e) && (e->HasStringTable())) {
+        return (e->mNameSpace.empty()) ? "to_" + e->name : e->mNameSpace.getString() + "::to_" + e->name;
+    }
+    return "to_" + aClassifier->name;
+}
+
+//
+//  The stream expression that writes the name of the literal in quotes, or the
+//  number if the value has no name. It is empty if aClassifier is no
+//  enumeration with string tables.
+std::string CEnumeration::JSONWriter(std::shared_ptr<MElement> aClassifier, const std::string& aExpr) {
+    auto e = std::dynamic_pointer_cast<CEnumeration>(aClassifier);
+
+    if ((e) && (e->HasStringTable())) {
+        return e->StringFunction("ToJSON") + "(" + aExpr + ")";
+    }
+    return std::string();
+}
@@ -35,6 +35,17 @@ public:
     virtual void Dump(std::shared_ptr<MModel> aModel);
 
     void DumpClassDecl(std::ostream& file, int indent);
+    void DumpStringTable(std::ostream& file);
+    //
+    //  Only enumerations in a package get the string tables, those within a
+    //  class do not.
+    bool HasStringTable() const;
+    size_t NameBound() const;
+    std::string StringFunction(const std::string& aSuffix) const;
+    //
+    //  The JSON streams of the messages and signals.
+    static std::string JSONReader(std::shared_ptr<MElement> aClassifier);
+    static std::string JSONWriter(std::shared_ptr<MElement> aClassifier, const std::string& aExpr);
     //
     //  Namespaces
     void DumpNameSpaceIntro(std::ostream& file);
@@ -69,20 +69,14 @@ void CExecutablePackage::Prepare(void) {
 }
 
 void CExecutablePackage::Dump(std::shared_ptr<MModel> model) {
-    std::string                               path;
     std::list<std::string>                    modules;
     std::vector<MClass*>::iterator            i;
-    std::list<tConnector<MElement, MElement>> liblist;
     std::list<eElementType>                   contenttypes;
     std::list<std::shared_ptr<MClass>>        content;
 
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
 
     DumpBase(cmodel);
-    path=cmodel->pathstack.back()+"/"+".Makefile";
-    cmodel->generatedfiles.push_back( tGenFile {path, id, "##", "mk"} );
-    OpenStream(makefile, path);
-    DumpMakefileHeader(makefile, OutputName);
     //
     //  Get all content that is part of this package
     contenttypes.push_back(eElementType::Enumeration);
@@ -116,6 +110,32 @@ void CExecutablePackage::Dump(std::shared_ptr<MModel> model) {
             c->Dump(model);
         }
     }
+    if (mBuildSystem == EBuildSystem::cmake) {
+        tBuildInfo info;
+
+        info.name       = OutputName;
+        info.executable = true;
+        info.modules    = modules;
+        FillBuildInfo(info);
+        DumpCMakeLists(cmodel, info);
+    } else {
+        DumpMakefile(cmodel, modules);
+    }
+    //
+    //  Remove last element from path-stack
+    cmodel->pathstack.pop_back();
+}
+
+//
+//  Writes the Makefile of the executable.
+void CExecutablePackage::DumpMakefile(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules) {
+    std::string                               path;
+    std::list<tConnector<MElement, MElement>> liblist;
+
+    path=cmodel->pathstack.back()+"/"+".Makefile";
+    OpenStream(makefile, path);
+    cmodel->generatedfiles.push_back( tGenFile {path, id, "##", "mk", makefile.buffer()} );
+    DumpMakefileHeader(makefile, OutputName);
     makefile << "PROJ=" << OutputName+"\n\n";
     DumpMakefileSource(makefile, modules);
     DumpMakefileObjects(makefile, modules);
@@ -125,8 +145,8 @@ void CExecutablePackage::Dump(std::shared_ptr<MModel> model) {
     if (HasTaggedValue("CxxFlags")) {
         cxxFlags = GetTaggedValue("CxxFlags");
     }
-
-    makefile << "CXXFLAGS+=-std=" << m_cxxstandard << " -fPIC -g $(INCLUDEPATH) " << cxxFlags.c_str() << "\n\n";
+    DumpMakefileProfile(makefile, "./$(PROJ)");
+    makefile << "CXXFLAGS+=-std=" << m_cxxstandard << " -fPIC $(OPTFLAGS) $(INCLUDEPATH) " << cxxFlags.c_str() << "\n\n";
 
     //
     //  Find some CXX-Flags to generate into the Makefile.
@@ -220,6 +240,7 @@ void CExecutablePackage::Dump(std::shared_ptr<MModel> model) {
     makefile << "\trm -f $(PROJ)\n";
     makefile << "\trm -f depend\n";
     makefile << "\trm -f $(OBJ)\n\n";
+    DumpMakefileProfileTarget(makefile);
     makefile << "install:\n"
                 "\trm -f $(BININSTALLDIR)/$(PROJ)\n"
                 "\tcp $(PROJ) $(BININSTALLDIR)\n\n";
@@ -227,7 +248,4 @@ void CExecutablePackage::Dump(std::shared_ptr<MModel> model) {
     makefile << "-include depend\n\n";
 
     makefile.close();
-    //
-    //  Remove last element from path-stack
-    cmodel->pathstack.pop_back();
 }
@@ -22,6 +22,8 @@
 
 #include "melement.h"
 
+class CModel;
+
 
 class CExecutablePackage : public CPackageBase
 {
@@ -33,8 +35,9 @@ public:
     virtual std::string FQN(void) const;
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
+    void DumpMakefile(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules);
 public:
-    std::ofstream makefile;
+    CodeWriter makefile;
 };
 
 #endif // CEXECUTABLEPACKAGE_H
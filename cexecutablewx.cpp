@@ -41,8 +41,8 @@ void CExecutableWx::Dump(std::shared_ptr<MModel> model) {
 
     DumpBase(cmodel);
     path=cmodel->pathstack.back()+"/"+".Makefile";
-    cmodel->generatedfiles.push_back( tGenFile {path, id, "##", "mk"} );
     OpenStream(makefile, path);
+    cmodel->generatedfiles.push_back( tGenFile {path, id, "##", "mk", makefile.buffer()} );
     DumpMakefileHeader(makefile, OutputName);
     //
     //  Get all content that is part of this package
@@ -33,7 +33,7 @@ public:
     //  Virtuals from MElement
     virtual void Dump(std::shared_ptr<MModel> aModel);
 public:
-    std::ofstream makefile;
+    CodeWriter makefile;
 };
 
 #endif // CEXECUTABLEWX_H
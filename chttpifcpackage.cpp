@@ -17,6 +17,10 @@
 // HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
 // CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
 #include "helper.h"
 #include "mdependency.h"
 #include "cdependency.h"
@@ -30,6 +34,7 @@
 
 #include "mmodel.h"
 #include "cmodel.h"
+#include "perfecthash.h"
 
 std::string CHttpIfcPackage::FQN() const {
     std::string val;
@@ -87,8 +92,8 @@ void CHttpIfcPackage::Dump(std::shared_ptr<MModel> model) {
 
     DumpBase(cmodel);
     path=cmodel->pathstack.back()+"/"+".Makefile";
-    cmodel->generatedfiles.push_back(tGenFile {path, id, "##", "mk"});
     OpenStream(makefile, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, id, "##", "mk", makefile.buffer()});
     DumpMakefileHeader(makefile, OutputName+".so");
     //
     //  Get all content that is part of this package
@@ -131,9 +136,7 @@ void CHttpIfcPackage::Dump(std::shared_ptr<MModel> model) {
     //  Before dumping the modeled classes dump the interface source.
     std::string httpifc = cmodel->pathstack.back()+"/";
 
-    DumpHttpIfc(httpifc, modules);
-    cmodel->generatedfiles.push_back(tGenFile {httpifc+".__httpifc.cpp", id, "//", "src"});
-    cmodel->generatedfiles.push_back(tGenFile {httpifc+".__httpifc.h", id, "//", "hdr"});
+    DumpHttpIfc(cmodel, httpifc, modules);
     //
     //  Dump the makefile
     makefile << "PROJ=" << OutputName+"\n\n";
@@ -320,8 +323,8 @@ std::list<std::shared_ptr<MElement>> CHttpIfcPackage::CollectPages(std::shared_p
     return retval;
 }
 
-void CHttpIfcPackage::DumpHttpIfc(const std::string& aPath, std::list<std::string>& aModulelist) {
-    std::ofstream ifc(aPath+".__httpifc.cpp");
+void CHttpIfcPackage::DumpHttpIfc(std::shared_ptr<CModel> aModel, const std::string& aPath, std::list<std::string>& aModulelist) {
+    CodeWriter ifc(aPath+".__httpifc.cpp");
     std::list<std::shared_ptr<MElement>> htmlpages = CollectPages(sharedthis<MPackage>());
 
     ifc <<  "// *************************************************************************************************************\n"
@@ -334,6 +337,9 @@ void CHttpIfcPackage::DumpHttpIfc(const std::string& aPath, std::list<std::strin
             "#include <httpcontentifc.h>\n"
             "#include <map>\n"
             "#include <string>\n"
+            "#include <string_view>\n"
+            "#include <atomic>\n"
+            "#include <utility>\n"
             "#include <libxml/tree.h>\n"
             "#include <httprequest.h>\n"
             "#include <httpresponse.h>\n"
@@ -342,7 +348,9 @@ void CHttpIfcPackage::DumpHttpIfc(const std::string& aPath, std::list<std::strin
             "#include <stdint.h>\n"
             "#include <httpsimulationifc.h>\n"
             "#include <CHtmlPage.h>\n"
+            "#include \"" << PerfectHash::Name() << "\"\n"
             "#include \"__httpifc.h\"\n\n";
+    PerfectHash::Dump(aModel, id);
     std::set<std::string> doneincludes;
     std::set<std::shared_ptr<MElement>>   donelist;
 
@@ -359,59 +367,187 @@ void CHttpIfcPackage::DumpHttpIfc(const std::string& aPath, std::list<std::strin
             std::dynamic_pointer_cast<CClassBase>(h)->DumpNeededIncludes(ifc, std::dynamic_pointer_cast<CClassBase>(h), doneincludes, donelist);
         }
     }
-    ifc <<
-            "std::map<std::string, CHtmlPage*> CIfc::pagemap;\n\n"
-            "CIfc::CIfc(xmlNode* param)  {\n"
-            "    (void)param;\n";
-        for (auto & h : htmlpages) {
-            ifc << "    pagemap.insert(std::pair<std::string, CHtmlPage*>(\"" << h->GetTaggedValue("URI") << "\", new " << h->name << "));\n";
+    //
+    //  The routes are the URI tagged values. A route with a * matches all
+    //  paths that start with the part before it. A {name} matches one path
+    //  segment, which the page gets from CIfc::Params(). All other routes are
+    //  exact and found by a perfect hash. The others are tried after it, the
+    //  parameter routes first and then the longest prefix.
+    std::vector<std::string>                    exact;
+    std::vector<size_t>                         exactpage;
+    std::vector<std::pair<std::string, size_t>> patterns;
+    std::set<std::string>                       uris;
+    size_t                                      page = 0;
+
+    for (auto & h : htmlpages) {
+        std::string uri = helper::trim(h->GetTaggedValue("URI"));
+
+        ++page;
+        if (!uris.insert(uri).second) {
+            std::cerr << "The URI " << uri << " of " << h->name << " is used by another page. The route is left out.\n";
+        } else if ((uri.find('*') == std::string::npos) && (uri.find('{') == std::string::npos)) {
+            exact.push_back(uri);
+            exactpage.push_back(page);
+        } else {
+            if ((uri.find('*') != std::string::npos) && (uri.find('*') != uri.size() - 1)) {
+                std::cerr << "The * in the URI " << uri << " of " << h->name << " must be the last character.\n";
+            }
+            patterns.emplace_back(uri, page);
         }
-    ifc <<  "}\n\n";
+    }
+    std::stable_sort(patterns.begin(), patterns.end(), [](const std::pair<std::string, size_t>& a, const std::pair<std::string, size_t>& b) {
+        bool aprefix = (a.first.back() == '*');
+        bool bprefix = (b.first.back() == '*');
+
+        return (aprefix != bprefix) ? bprefix : (aprefix && (a.first.size() > b.first.size()));
+    });
+
+    PerfectHash           hash;
+    std::vector<uint64_t> keys;
+
+    for (auto & e : exact) {
+        keys.push_back(PerfectHash::Hash(e));
+    }
+    if (!hash.Build(keys)) {
+        //
+        //  Only a collision of two 64 bit hashes ends here. The exact routes
+        //  are then tried in order as the patterns.
+        for (size_t e = 0; e < exact.size(); ++e) {
+            patterns.emplace(patterns.begin() + e, exact[e], exactpage[e]);
+        }
+        exact.clear();
+    }
+    ifc << "\n"
+           "namespace {\n"
+           "struct tRoute {\n"
+           "    std::string_view uri;\n"
+           "    size_t           page;    // The index in CIfc::pages plus one.\n"
+           "};\n"
+           "\n";
+    if (!exact.empty()) {
+        ifc << "constexpr uint16_t cSeed[" << hash.Seeds().size() << "] = {";
+        for (size_t b = 0; b < hash.Seeds().size(); ++b) {
+            ifc << ((b == 0) ? "" : ", ") << hash.Seeds()[b];
+        }
+        ifc << "};\n"
+               "constexpr tRoute   cExact[" << hash.Slots().size() << "] = {\n";
+        for (auto k : hash.Slots()) {
+            if (k == PerfectHash::npos) {
+                ifc << "    {\"\", 0},\n";
+            } else {
+                ifc << "    {\"" << exact[k] << "\", " << exactpage[k] << "},\n";
+            }
+        }
+        ifc << "};\n\n";
+    }
+    if (!patterns.empty()) {
+        ifc << "constexpr tRoute   cPattern[" << patterns.size() << "] = {\n";
+        for (auto & p : patterns) {
+            ifc << "    {\"" << p.first << "\", " << p.second << "},\n";
+        }
+        ifc << "};\n"
+               "//\n"
+               "//  A parameter takes the path up to the next /. The * takes the rest.\n"
+               "bool Match(std::string_view aPattern, std::string_view aUri, std::vector<CIfc::tParam>& aParams) {\n"
+               "    aParams.clear();\n"
+               "    while (!aPattern.empty()) {\n"
+               "        if (aPattern.front() == '*') {\n"
+               "            return true;\n"
+               "        } else if (aPattern.front() == '{') {\n"
+               "            size_t           close = aPattern.find('}');\n"
+               "            std::string_view value = aUri.substr(0, aUri.find('/'));\n"
+               "\n"
+               "            if ((close == std::string_view::npos) || value.empty()) {\n"
+               "                return false;\n"
+               "            }\n"
+               "            aParams.emplace_back(aPattern.substr(1, close - 1), value);\n"
+               "            aPattern.remove_prefix(close + 1);\n"
+               "            aUri.remove_prefix(value.size());\n"
+               "        } else if (aUri.empty() || (aUri.front() != aPattern.front())) {\n"
+               "            return false;\n"
+               "        } else {\n"
+               "            aPattern.remove_prefix(1);\n"
+               "            aUri.remove_prefix(1);\n"
+               "        }\n"
+               "    }\n"
+               "    return aUri.empty();\n"
+               "}\n";
+    }
+    ifc << "} // namespace\n\n";
+
+    ifc << "std::vector<CHtmlPage*>                CIfc::pages;\n"
+           "std::atomic<uint64_t>                  CIfc::requests {0};\n"
+           "std::atomic<uint64_t>                  CIfc::responses {0};\n"
+           "thread_local std::vector<CIfc::tParam> CIfc::params;\n\n"
+           "CIfc::CIfc(xmlNode* param)  {\n"
+           "    (void)param;\n"
+           "    if (pages.empty()) {\n";
+    for (auto & h : htmlpages) {
+        ifc << "        pages.push_back(new " << h->name << ");   // " << h->GetTaggedValue("URI") << "\n";
+    }
+    ifc << "    }\n"
+           "}\n\n";
     ifc <<
             "CIfc::~CIfc()  {\n"
             "}\n\n"
-            "bool CIfc::DoYouHandleURI(const char* uri) {\n"
-            "    bool retval = false;\n"
-            "    std::map<std::string, CHtmlPage*>::iterator pi=CIfc::pagemap.find(uri);\n\n"
-
-            "    if (pi != CIfc::pagemap.end()) {\n"
-            "        retval = true;\n"
-            "    }\n"
-            "    return  (retval);\n"
-            "}\n\n"
-            "tHttpResponse* CIfc::HandleURI(tHttpRequest* req) {\n"
-            "    tHttpResponse* retval = 0;\n"
-            "    std::map<std::string, CHtmlPage*>::iterator pi=CIfc::pagemap.find(req->uri);\n\n"
-
-            "    if (pi != CIfc::pagemap.end()) {\n"
-            "        tHttpResponse* response;\n"
-            "\n"
-            "        RequestCount++;\n"
-            "        response = pi->second->HandleRequest(req);\n"
-            "        if (response != 0) {\n"
-            "            ResponseCount++;\n"
-            "        }\n"
-            "        retval = response;\n"
-            "    }\n"
-            "    return  (retval);\n"
-            "}\n"
-            "\n"
-            "tHttpResponse* CIfc::Process(tHttpRequest* req, std::shared_ptr<tMsg> msg) {\n"
-            "    tHttpResponse* retval = 0;\n"
-            "    std::map<std::string, CHtmlPage*>::iterator pi=CIfc::pagemap.find(req->uri);\n"
-            "\n"
-            "    if (pi != CIfc::pagemap.end()) {\n"
-            "        tHttpResponse* response;\n"
-            "\n"
-            "        response = pi->second->Process(req, msg);\n"
-            "        if (response != 0) {\n"
-            "            ResponseCount++;\n"
-            "        }\n"
-            "        retval = response;\n"
-            "    }\n"
-            "    return  (retval);\n"
-            "}\n\n"
-
+            "//\n"
+            "//  The query is not part of the route.\n"
+            "CHtmlPage* CIfc::Route(std::string_view aUri) {\n"
+            "    aUri = aUri.substr(0, aUri.find('?'));\n"
+            "    params.clear();\n";
+    if (!exact.empty()) {
+        ifc << "\n"
+               "    const tRoute& exact = cExact[mtt::phash_slot(mtt::phash_string(aUri), cSeed, " << hash.BucketMask() << ", " << hash.Shift() << ")];\n"
+               "\n"
+               "    if ((exact.page != 0) && (exact.uri == aUri)) {\n"
+               "        return pages[exact.page - 1];\n"
+               "    }\n";
+    }
+    if (!patterns.empty()) {
+        ifc << "    for (const auto& r : cPattern) {\n"
+               "        if (Match(r.uri, aUri, params)) {\n"
+               "            return pages[r.page - 1];\n"
+               "        }\n"
+               "    }\n"
+               "    params.clear();\n";
+    }
+    ifc << "    return nullptr;\n"
+           "}\n\n"
+           "const std::vector<CIfc::tParam>& CIfc::Params() {\n"
+           "    return params;\n"
+           "}\n\n"
+           "bool CIfc::DoYouHandleURI(const char* uri) {\n"
+           "    return Route(uri) != nullptr;\n"
+           "}\n\n"
+           "//\n"
+           "//  The counters of the base class are set from the atomic counts.\n"
+           "tHttpResponse* CIfc::HandleURI(tHttpRequest* req) {\n"
+           "    tHttpResponse* retval = 0;\n"
+           "    CHtmlPage*     page   = Route(req->uri);\n"
+           "\n"
+           "    if (page != nullptr) {\n"
+           "        RequestCount = requests.fetch_add(1, std::memory_order_relaxed) + 1;\n"
+           "        retval       = page->HandleRequest(req);\n"
+           "        if (retval != 0) {\n"
+           "            ResponseCount = responses.fetch_add(1, std::memory_order_relaxed) + 1;\n"
+           "        }\n"
+           "    }\n"
+           "    return  (retval);\n"
+           "}\n"
+           "\n"
+           "tHttpResponse* CIfc::Process(tHttpRequest* req, std::shared_ptr<tMsg> msg) {\n"
+           "    tHttpResponse* retval = 0;\n"
+           "    CHtmlPage*     page   = Route(req->uri);\n"
+           "\n"
+           "    if (page != nullptr) {\n"
+           "        retval = page->Process(req, msg);\n"
+           "        if (retval != 0) {\n"
+           "            ResponseCount = responses.fetch_add(1, std::memory_order_relaxed) + 1;\n"
+           "        }\n"
+           "    }\n"
+           "    return  (retval);\n"
+           "}\n\n";
+    ifc <<
             "CHttpSimulationIfc* ifc;\n\n"
             "extern \"C\" CHttpContentIfc* getcontentifc(xmlNode* param, CHttpSimulationIfc* simifc) {\n"
             "    CHttpContentIfc* retval = 0;\n\n"
@@ -422,7 +558,9 @@ void CHttpIfcPackage::DumpHttpIfc(const std::string& aPath, std::list<std::strin
 
     aModulelist.emplace_back("__httpifc");
 
-    std::ofstream hdr(aPath + ".__httpifc.h");
+    aModel->generatedfiles.push_back(tGenFile {ifc.filename(), id, "//", "src", ifc.buffer()});
+
+    CodeWriter hdr(aPath + ".__httpifc.h");
 
     hdr <<
            "// *************************************************************************************************************\n"
@@ -449,10 +587,20 @@ void CHttpIfcPackage::DumpHttpIfc(const std::string& aPath, std::list<std::strin
            "    virtual bool DoYouHandleURI(const char* uri) ;\n"
            "    virtual tHttpResponse* HandleURI(tHttpRequest* req) ;\n"
            "    virtual tHttpResponse* Process(tHttpRequest* req, std::shared_ptr<tMsg> msg) ;\n"
+           "    //\n"
+           "    //  The page of the path or nullptr. Params() are the values of the\n"
+           "    //  {name} parts of the route that matched last in this thread.\n"
+           "    using tParam = std::pair<std::string_view, std::string_view>;\n"
+           "    static CHtmlPage* Route(std::string_view aUri);\n"
+           "    static const std::vector<tParam>& Params();\n"
            "public:\n"
-           "    static std::map<std::string, CHtmlPage*> pagemap;\n"
+           "    static std::vector<CHtmlPage*>          pages;\n"
+           "    static std::atomic<uint64_t>            requests;\n"
+           "    static std::atomic<uint64_t>            responses;\n"
+           "    static thread_local std::vector<tParam> params;\n"
            "};\n"
            "\n"
            "#endif  // __HTTPIFC_INC\n";
+    aModel->generatedfiles.push_back(tGenFile {hdr.filename(), id, "//", "hdr", hdr.buffer()});
 
 }
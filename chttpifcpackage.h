@@ -25,6 +25,7 @@
 
 class MElement;
 class MDependency;
+class CModel;
 
 class CHttpIfcPackage : public CPackageBase
 {
@@ -38,9 +39,9 @@ public:
     virtual void Dump(std::shared_ptr<MModel> aModel);
 private:
     std::list<std::shared_ptr<MElement>> CollectPages(std::shared_ptr<MPackage> aPack) ;
-    void DumpHttpIfc(const std::string& aPath, std::list<std::string>& aModulelist);
+    void DumpHttpIfc(std::shared_ptr<CModel> aModel, const std::string& aPath, std::list<std::string>& aModulelist);
 private:
-    std::ofstream makefile;
+    CodeWriter makefile;
 };
 
 #endif // CHTTPIFCPACKAGE_H
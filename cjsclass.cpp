@@ -47,7 +47,7 @@
 #include "coperation.h"
 
 //  This method first creates a backup file before opening the stream
-void CJSClass::OpenStream(std::ofstream& s, const std::string& fname)
+void CJSClass::OpenStream(CodeWriter& s, const std::string& fname)
 {
     int         err=0;
     struct stat dirstat;
@@ -96,8 +96,8 @@ void CJSClass::Dump(std::shared_ptr<MModel> model) {
 
 
     path=cmodel->pathstack.back()+"/"+"."+basename+".js";
-    cmodel->generatedfiles.push_back( tGenFile {path, id, "//", "jscript"});
     OpenStream(out, path);
+    cmodel->generatedfiles.push_back( tGenFile {path, id, "//", "jscript", out.buffer()});
 
     out << "/*\n"
            " */\n";
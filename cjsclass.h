@@ -37,12 +37,12 @@ public:
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
 
-    void OpenStream(std::ofstream& s, const std::string& fname);
+    void OpenStream(CodeWriter& s, const std::string& fname);
 private:
     std::string   lower_name;
     std::string   upper_name;
     std::string   basename;
-    std::ofstream out;
+    CodeWriter out;
 };
 
 #endif // CCLASS_H
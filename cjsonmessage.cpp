@@ -30,6 +30,7 @@
 #include "cclassbase.h"
 #include "ccxxclass.h"
 #include "cstruct.h"
+#include "cenumeration.h"
 #include "massociationend.h"
 #include "cassociationend.h"
 #include "massociation.h"
@@ -73,7 +74,7 @@ void CJSONMessage::Dump(std::shared_ptr<MModel> model) {
     (void)model;
 }
 
-void CJSONMessage::DumpIncoming(std::ofstream& ifc) {
+void CJSONMessage::DumpIncoming(CodeWriter& ifc) {
     std::string tname;
     FillClass();
     if (Class) {
@@ -118,7 +119,7 @@ void CJSONMessage::DumpIncoming(std::ofstream& ifc) {
                 ifc << "    if (j!=0) {\n";
                 if (!a->isMultiple) {
                     if (a->Classifier) {
-                        ifc << "        newsig->" << a->name << " = to_" << a->Classifier->name << "(j);\n";
+                        ifc << "        newsig->" << a->name << " = " << CEnumeration::JSONReader(a->Classifier) << "(j);\n";
                     } else {
                         ifc << "        newsig->" << a->name << " = to_" << a->ClassifierName << "(j);\n";
                     }
@@ -137,9 +138,8 @@ void CJSONMessage::DumpIncoming(std::ofstream& ifc) {
     ifc << "}\n";
 }
 
-void CJSONMessage::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAttribute> a, int space) {
-    std::string filler;
-    filler.assign(space, ' ');
+void CJSONMessage::DumpJSONIncomingArray(CodeWriter &ifc, std::shared_ptr<CAttribute> a, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
     ifc << filler << "tJSONArray *array = (tJSONArray*)j;\n";
     ifc << filler << "std::vector<tJSON*>::iterator ai;\n";
@@ -147,13 +147,12 @@ void CJSONMessage::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAt
                      "}\n";
 }
 
-void CJSONMessage::DumpArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CJSONMessage::DumpArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
     std::string runner;
 
     runner=(char)('a'+space/4);
 
-    filler.assign(space, ' ');
     if (!first) {
         ifc << filler << "    output <<  \", \\\"" << a->name << "\\\": [ \";\n";
     } else {
@@ -194,19 +193,30 @@ void CJSONMessage::DumpArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a,
     ifc << filler << "    output <<  \"]\\n\";\n";
 }
 
-void CJSONMessage::DumpArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CJSONMessage::DumpArray(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
     std::string runner;
+    std::string value;
+    std::string member;
 
     runner=(char)('a'+space/4);
+    value  = "(*" + runner + ")";
+    member = runner + "->";
 
-    filler.assign(space, ' ');
     if (!first) {
         ifc << filler << "    output <<  \", \\\"" << a->name << "\\\": [ \";\n";
     } else {
         ifc << filler << "    output <<  \"\\\"" << a->name << "\\\": [ \";\n";
     }
-    ifc << filler << "    for (std::vector<" << a->FQN() << ">::iterator " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    //
+    //  With a container policy the element type is hidden behind mtt::value.
+    if (a->HasContainerPolicy()) {
+        value  = "mtt::value(*" + runner + ")";
+        member = value + ".";
+        ifc << filler << "    for (auto " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    } else {
+        ifc << filler << "    for (std::vector<" << a->FQN() << ">::iterator " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    }
     if (a->Classifier->type == eElementType::Struct) {
         ifc << filler << "        if (" << runner << " == " << prefix << a->name << ".begin()) {\n";
         ifc << filler << "            output <<  \"{\\n\";\n";
@@ -214,18 +224,18 @@ void CJSONMessage::DumpArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd
         ifc << filler << "            output <<  \", {\\n\";\n";
         ifc << filler << "        }\n";
         ifc << filler << "// struct\n";
-        DumpStruct(ifc, a->Classifier, "", runner+"->", false, space);
+        DumpStruct(ifc, a->Classifier, "", member, false, space);
     } else {
         ifc << filler << "        if (" << runner << " != " << prefix << a->name << ".begin()) {\n";
         ifc << filler << "            output <<  \", \";\n";
         ifc << filler << "        }\n";
         if (a->Classifier->name == "string") {
-                ifc << filler << "        output <<  \"\\\"\" << " << "(*" << runner << ")" << " << \"\\\"\";\n";
+                ifc << filler << "        output <<  \"\\\"\" << " << value << " << \"\\\"\";\n";
         } else {
             if ((a->Classifier->name == "uint64_t") || (a->Classifier->name == "objectid_t")) {
-                    ifc << filler << "        output << (int64_t)" << "(*" << runner << ")" << ";\n";
+                    ifc << filler << "        output << (int64_t)" << value << ";\n";
             } else {
-                    ifc << filler << "        output << (*" << runner << ")" << ";\n";
+                    ifc << filler << "        output << " << value << ";\n";
             }
         }
     }
@@ -235,10 +245,9 @@ void CJSONMessage::DumpArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd
 }
 
 
-void CJSONMessage::DumpStruct(std::ofstream& ifc, std::shared_ptr<MElement> a, std::string sname, std::string prefix, bool first, int space) {
-    std::string filler;
+void CJSONMessage::DumpStruct(CodeWriter& ifc, std::shared_ptr<MElement> a, std::string sname, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
-    filler.assign(space, ' ');
     if (a->type == eElementType::Struct) {
         auto s = std::dynamic_pointer_cast<CStruct>(a);
 
@@ -293,10 +302,9 @@ void CJSONMessage::DumpStruct(std::ofstream& ifc, std::shared_ptr<MElement> a, s
     }
 }
 
-void CJSONMessage::DumpValue(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CJSONMessage::DumpValue(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
-    filler.assign(space, ' ');
     if (a->ClassifierName == "string") {
         if (!first) {
             ifc << filler << "    output <<  \", \\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
@@ -332,10 +340,9 @@ void CJSONMessage::DumpValue(std::ofstream& ifc, std::shared_ptr<CAttribute> a,
     }
 }
 
-void CJSONMessage::DumpValue(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CJSONMessage::DumpValue(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
-    filler.assign(space, ' ');
     if (a->Classifier->name == "string") {
         if (!first) {
             ifc << filler << "    output <<  \", \\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
@@ -372,7 +379,7 @@ void CJSONMessage::DumpValue(std::ofstream& ifc, std::shared_ptr<CAssociationEnd
 }
 
 
-void CJSONMessage::DumpOutgoing(std::ofstream& ifc) {
+void CJSONMessage::DumpOutgoing(CodeWriter& ifc) {
     std::string prefix;
     std::string tname;
 
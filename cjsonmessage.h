@@ -21,6 +21,7 @@
 #define CJSONMESSAGE_H
 
 #include "mclass.h"
+#include "codewriter.h"
 
 class CAttribute;
 class CAssociationEnd;
@@ -40,14 +41,14 @@ public:
     //  Others
     void FillClass(void);
     std::shared_ptr<MClass> GetClass();
-    void DumpIncoming(std::ofstream& ifc);
-    void DumpJSONIncomingArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, int space);
-    void DumpOutgoing(std::ofstream& ifc);
-    void DumpStruct(std::ofstream& ifc, std::shared_ptr<MElement> e, std::string sname, std::string prefix, bool first=false, int space=0);
-    void DumpArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
-    void DumpValue(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
-    void DumpArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
-    void DumpValue(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
+    void DumpIncoming(CodeWriter& ifc);
+    void DumpJSONIncomingArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, int space);
+    void DumpOutgoing(CodeWriter& ifc);
+    void DumpStruct(CodeWriter& ifc, std::shared_ptr<MElement> e, std::string sname, std::string prefix, bool first=false, int space=0);
+    void DumpArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
+    void DumpValue(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
+    void DumpArray(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
+    void DumpValue(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
 public:
     std::shared_ptr<MClass> Class;
 };
@@ -105,7 +105,6 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
     std::list<std::string>                    modules;
     std::list<eElementType>                   contenttypes;
     std::list<std::shared_ptr<MClass>>        content;
-    std::list<tConnector<MElement, MElement>> liblist;
 
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
     //
@@ -123,18 +122,12 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
     if (mCreateSubsystem) {
         if (mSubsystemFormat == SubsystemFormat::EAXMI) {
             path = cmodel->pathstack.back() + "/." + OutputName +".xmi";
-            cmodel->generatedfiles.push_back(tGenFile{path, id, "", "xmi"});
             OpenStream(mExportFile, path);
+            cmodel->generatedfiles.push_back(tGenFile{path, id, "", "xmi", mExportFile.buffer()});
             DumpEAIntro();
         }
     }
     //
-    //  Create the makefile infos.
-    path = cmodel->pathstack.back()+"/"+".Makefile";
-    cmodel->generatedfiles.push_back(tGenFile {path, id, "##", "mk"});
-    OpenStream(makefile, path);
-    DumpMakefileHeader(makefile, OutputName+".so");
-    //
     //  Get all content that is part of this package
     contenttypes.push_back(eElementType::SimObject);
     contenttypes.push_back(eElementType::SimEnumeration);
@@ -196,6 +189,40 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
            DumpEAExtension(cmodel, mExportFile);
         }
     }
+    if (mBuildSystem == EBuildSystem::cmake) {
+        tBuildInfo info;
+
+        info.name    = OutputName;
+        info.archive = true;
+        info.modules = modules;
+        FillBuildInfo(info);
+        DumpCMakeLists(cmodel, info);
+    } else {
+        DumpMakefile(cmodel, modules);
+    }
+    DumpEAOutro();
+    mExportFile.close();
+    //
+    //  Remove last element from path-stack
+    cmodel->pathstack.pop_back();
+    //
+    // Stop dumping 
+    if (gDumpList.find(id) != gDumpList.end()) {
+        gDumpStarted = false;
+    }
+}
+
+//
+//  Writes the Makefile of the library.
+void CLibraryPackage::DumpMakefile(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules) {
+    std::string                               path;
+    std::list<tConnector<MElement, MElement>> liblist;
+    //
+    //  Create the makefile infos.
+    path = cmodel->pathstack.back()+"/"+".Makefile";
+    OpenStream(makefile, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, id, "##", "mk", makefile.buffer()});
+    DumpMakefileHeader(makefile, OutputName+".so");
     makefile << "PROJ=" << OutputName+"\n\n";
     DumpMakefileSource(makefile, modules);
     DumpMakefileObjects(makefile, modules);
@@ -210,7 +237,8 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
     if (HasTaggedValue("CxxFlags")) {
         cxxFlags = GetTaggedValue("CxxFlags");
     }
-    makefile << "CXXFLAGS+=-std=" << m_cxxstandard << " -fPIC -g $(INCLUDEPATH) " << cxxFlags.c_str() << "\n\n";
+    DumpMakefileProfile(makefile, "");
+    makefile << "CXXFLAGS+=-std=" << m_cxxstandard << " -fPIC $(OPTFLAGS) $(INCLUDEPATH) " << cxxFlags.c_str() << "\n\n";
     makefile << "\n";
 
     //
@@ -315,7 +343,7 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
         }
         makefile << "lib$(PROJ).a : $(OBJ)\n";
         if (!modules.empty()) {
-            makefile << "\tar cr $@ $(OBJ)\n\n";
+            makefile << "\t$(AR) cr $@ $(OBJ)\n\n";
         }
         makefile << "BUILD : lib$(PROJ).so\n";
         makefile << "\tcp lib$(PROJ).so lib$(PROJ).so.$(VERSION).$(REVISIONNR).$(NEWBUILDNR)\n";
@@ -333,6 +361,8 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
         makefile << "\trm -f depend\n";
         makefile << "\trm -f $(OBJ)\n\n";
 
+        DumpMakefileProfileTarget(makefile);
+
         makefile << "install:\n"
                     "\trm -f $(LIBINSTALLDIR)/lib$(PROJ).*\n"
                     "\tcp lib$(PROJ).a $(LIBINSTALLDIR)\n"
@@ -351,19 +381,7 @@ void CLibraryPackage::Dump(std::shared_ptr<MModel> model) {
         makefile << "install :\n";
         makefile << "\t$(info Nothing to install)\n";
     }
-    //
-    //  close files that have been done.
     makefile.close();
-    DumpEAOutro();
-    mExportFile.close();
-    //
-    //  Remove last element from path-stack
-    cmodel->pathstack.pop_back();
-    //
-    // Stop dumping 
-    if (gDumpList.find(id) != gDumpList.end()) {
-        gDumpStarted = false;
-    }
 }
 
 void CLibraryPackage::DumpTestDir(const std::string &aTestDir, const std::list<std::string>& aModules) {
@@ -401,7 +419,7 @@ void CLibraryPackage::DumpTestDir(const std::string &aTestDir, const std::list<s
     }
 
     std::string testmakefilename = aTestDir+"/Makefile";
-    std::ofstream  testmakefile(testmakefilename);
+    CodeWriter     testmakefile(testmakefilename);
 
     testmakefile << "PROJ=" << OutputName << "Test\n\n";
 
@@ -24,6 +24,7 @@
 #include "subsystemformat.h"
 
 class MDependency;
+class CModel;
 
 class CLibraryPackage : public CPackageBase
 {
@@ -38,10 +39,11 @@ public:
     virtual void Dump(std::shared_ptr<MModel> aModel);
     void DumpEAIntro();
     void DumpEAOutro();
+    void DumpMakefile(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules);
     void DumpTestDir(const std::string& aTestDir, const std::list<std::string>& aModules);
 private:
 
-    std::ofstream   makefile;
+    CodeWriter      makefile;
 };
 
 #endif // CLIBRARYPACKAGE_H
@@ -29,8 +29,14 @@
 #include "ccxxclass.h"
 #include "cmessageclass.h"
 #include "cstruct.h"
+#include "cenumeration.h"
 #include "mmodel.h"
 #include "cmodel.h"
+#include "containerheader.h"
+#include "jsonheader.h"
+#include "jsonencoder.h"
+#include "jsondecoder.h"
+#include "flatlayout.h"
 
 extern long simversion;
 
@@ -51,6 +57,10 @@ void CMessageClass::SetFromTags(const std::string& name, const std::string&value
         basename=value;
     } if (name== "Direction") {
         direction = value;
+    } else if (name == "JSON") {
+        jsonbuffer = (value == "buffer");
+    } else if (name == "Layout") {
+        flatlayout = (value == "flat");
     }
 }
 
@@ -111,6 +121,7 @@ void CMessageClass::CollectNeededModelHeader(std::shared_ptr<MElement> e) {
 
 void CMessageClass::Prepare(void) {
     PrepareBase();
+    DropConcurrentPolicies();
     //
     //  Take the class name if no base name is set.
     if (basename.empty()) {
@@ -131,6 +142,12 @@ void CMessageClass::Dump(std::shared_ptr<MModel> model) {
     std::list< tAttributePack >::iterator ilist;
     size_t                                typemax = 0u;
     size_t                                namemax = 0u;
+    FlatLayout                            flat(name);
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
 
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
     //
@@ -147,6 +164,18 @@ void CMessageClass::Dump(std::shared_ptr<MModel> model) {
            "#include <helper.h>\n"
            "#include <msg.h>\n"
            ;
+    if (UsesContainerPolicy()) {
+        ContainerHeader::Dump(cmodel, id);
+        hdr << "#include \"" << ContainerHeader::Name() << "\"\n";
+    }
+    if (jsonbuffer) {
+        JsonHeader::Dump(cmodel, id);
+        hdr << "#include \"" << JsonHeader::Name() << "\"\n";
+    }
+    if (flatlayout) {
+        FlatLayout::Dump(cmodel, id);
+        hdr << "#include \"" << FlatLayout::Name() << "\"\n";
+    }
 
     donelist.clear();
     //
@@ -235,19 +264,28 @@ void CMessageClass::Dump(std::shared_ptr<MModel> model) {
            "    }\n";
     hdr << "    //\n"
            "    //  This is the serializer code used for sending out messages in JSON format.\n";
-    hdr << "    virtual std::ostream& pack_json(std::ostream& output) {\n";
-    toJSONBuddy(hdr, "output");
-    hdr << "\n        return output;\n"
-           "    }\n";
-
-    hdr << "    virtual std::ostringstream& pack_json() {\n"
-           "        oss.clear();\n"
-           "        oss.str() = \"\";\n"
-           "        oss << '{';\n";
-    toJSONBuddy(hdr, "oss");
-    hdr << "        oss << '}';\n";
-    hdr << "\n        return oss;\n"
-           "    }\n";
+    if (jsonbuffer) {
+        toJSONBuffer(hdr);
+        fromJSONBuffer(hdr);
+    } else {
+        hdr << "    virtual std::ostream& pack_json(std::ostream& output) {\n";
+        toJSONBuddy(hdr, "output");
+        hdr << "\n        return output;\n"
+               "    }\n";
+
+        hdr << "    virtual std::ostringstream& pack_json() {\n"
+               "        oss.clear();\n"
+               "        oss.str() = \"\";\n"
+               "        oss << '{';\n";
+        toJSONBuddy(hdr, "oss");
+        hdr << "        oss << '}';\n";
+        hdr << "\n        return oss;\n"
+               "    }\n";
+    }
+    if (flatlayout) {
+        FlatMembers(flat);
+        hdr << flat.Declaration(4);
+    }
 
 
     for (auto & a : Attribute) {
@@ -309,6 +347,8 @@ void CMessageClass::Dump(std::shared_ptr<MModel> model) {
                     alist.emplace_back( fqn, a->name, a->defaultValue);
                 } else if (a->Multiplicity == "0..1") {
                     alist.emplace_back( fqn+"*", a->name, a->defaultValue);
+                } else if ((a->isCollection) && (a->HasContainerPolicy())) {
+                    alist.emplace_back( a->MkContainer((a->QualifierType.empty()) ? "uint64_t" : a->QualifierType, fqn), a->name);
                 } else if (a->Multiplicity == "0..*") {
                     if (aa->QualifierType.empty()) {
                         alist.emplace_back( std::string("std::vector< ")+fqn+" >", a->name);
@@ -361,6 +401,9 @@ void CMessageClass::Dump(std::shared_ptr<MModel> model) {
         hdr << ";\n";
     }
     hdr << "};\n";
+    if (flatlayout) {
+        hdr << "\n" << flat.Definition();
+    }
     hdr << "\n\n"
            "using " << name << "Ptr = std::shared_ptr<" << name << ">;\n\n";
 
@@ -369,7 +412,7 @@ void CMessageClass::Dump(std::shared_ptr<MModel> model) {
 
 }
 
-void CMessageClass::fromJSONBuddy(std::ofstream& ifc) {
+void CMessageClass::fromJSONBuddy(CodeWriter& ifc) {
     ifc <<  "            tJSON *j;\n"
             "\n"
             "            j = find(json, \"Destination\");\n"
@@ -394,7 +437,7 @@ void CMessageClass::fromJSONBuddy(std::ofstream& ifc) {
                 if (!aa->isMultiple) {
                     if ((aa->Classifier->type == eElementType::Struct) || (aa->Classifier->type == eElementType::CxxClass)) {
                     } else {
-                        ifc << "                " << aa->name << " = to_" << aa->Classifier->name << "(j);\n";
+                        ifc << "                " << aa->name << " = " << CEnumeration::JSONReader(aa->Classifier) << "(j);\n";
                     }
                 } else {
                     //
@@ -422,7 +465,7 @@ void CMessageClass::fromJSONBuddy(std::ofstream& ifc) {
             if (!ai->isMultiple) {
                 if ((ai->Classifier->type == eElementType::Struct) || (ai->Classifier->type == eElementType::CxxClass)) {
                 } else {
-                    ifc << "                " << ai->name << " = to_" << ai->Classifier->name << "(j);\n";
+                    ifc << "                " << ai->name << " = " << CEnumeration::JSONReader(ai->Classifier) << "(j);\n";
                 }
             } else {
                 //
@@ -442,7 +485,7 @@ void CMessageClass::fromJSONBuddy(std::ofstream& ifc) {
 
 #if 0
 
-void CMessageClass::DumpJSONIncoming(std::ofstream& ifc) {
+void CMessageClass::DumpJSONIncoming(CodeWriter& ifc) {
     ifc <<  "// **************************************************************************\n"
             "//\n"
             "//  Method-Name   : msg_from_json_" << helper::tolower(basename) << "()\n"
@@ -473,7 +516,7 @@ void CMessageClass::DumpJSONIncoming(std::ofstream& ifc) {
                         ifc << "        newsig->" << a->name << "= " << a->Classifier->name << " {"
                                                                                                "};\n";
                     } else {
-                        ifc << "        newsig->" << a->name << "=to_" << a->Classifier->name << "(j);\n";
+                        ifc << "        newsig->" << a->name << "=" << CEnumeration::JSONReader(a->Classifier) << "(j);\n";
                     }
                 } else {
                     ifc << " //  this is a multi structure\n";
@@ -496,13 +539,12 @@ void CMessageClass::DumpJSONIncoming(std::ofstream& ifc) {
 }
 #endif
 
-void CMessageClass::DumpJSONArray(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first, int space) {
-    std::string filler;
+void CMessageClass::DumpJSONArray(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
     std::string runner;
 
     runner=(char)('a'+space/4);
 
-    filler.assign(space, ' ');
     if (!first) {
         ifc << filler << "    " << a_stream  << "<< \", \\\"" << a->name << "\\\": [ \";\n";
     } else {
@@ -531,6 +573,8 @@ void CMessageClass::DumpJSONArray(std::ofstream& ifc, const std::string& a_strea
             << filler << "        }\n";
         if (a->ClassifierName == "string") {
                 ifc << filler << "        " << a_stream <<  " << \"\\\"\" << " << "(*" << runner << ")" << " << \"\\\"\";\n";
+        } else if (!CEnumeration::JSONWriter(a->Classifier, "(*" + runner + ")").empty()) {
+                ifc << filler << "        " << a_stream << " << " << CEnumeration::JSONWriter(a->Classifier, "(*" + runner + ")") << ";\n";
         } else {
             if ((a->ClassifierName == "uint64_t") || (a->ClassifierName == "objectid_t")) {
                     ifc << filler << "        " << a_stream << " << (int64_t)" << "(*" << runner << ")" << ";\n";
@@ -544,19 +588,30 @@ void CMessageClass::DumpJSONArray(std::ofstream& ifc, const std::string& a_strea
         << filler << "    " << a_stream  <<  " << \"]\\n\";\n";
 }
 
-void CMessageClass::DumpJSONArray(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first, int space) {
-    std::string filler;
+void CMessageClass::DumpJSONArray(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
     std::string runner;
+    std::string value;
+    std::string member;
 
     runner=(char)('a'+space/4);
+    value  = "(*" + runner + ")";
+    member = runner + "->";
 
-    filler.assign(space, ' ');
     if (!first) {
         ifc << filler << "    " << a_stream  <<  " << \", \\\"" << a->name << "\\\": [ \";\n";
     } else {
         ifc << filler << "    " << a_stream <<  " << \"\\\"" << a->name << "\\\": [ \";\n";
     }
-    ifc << filler << "    for (std::vector<" << a->FQN() << ">::iterator " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    //
+    //  With a container policy the element type is hidden behind mtt::value.
+    if (a->HasContainerPolicy()) {
+        value  = "mtt::value(*" + runner + ")";
+        member = value + ".";
+        ifc << filler << "    for (auto " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    } else {
+        ifc << filler << "    for (std::vector<" << a->FQN() << ">::iterator " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    }
     if (a->Classifier->type == eElementType::Struct) {
         ifc << filler << "        if (" << runner << " == " << prefix << a->name << ".begin()) {\n"
             << filler << "            " << a_stream <<  " << \"{\\n\";\n"
@@ -564,18 +619,20 @@ void CMessageClass::DumpJSONArray(std::ofstream& ifc, const std::string& a_strea
             << filler << "            " << a_stream <<  " << \", {\\n\";\n"
             << filler << "        }\n"
             << filler << "// struct\n";
-        DumpJSONStruct(ifc, a_stream, a->Classifier, "", runner+"->", false, space);
+        DumpJSONStruct(ifc, a_stream, a->Classifier, "", member, false, space);
     } else {
         ifc << filler << "        if (" << runner << " != " << prefix << a->name << ".begin()) {\n"
             << filler << "            " << a_stream <<  " << \", \";\n"
             << filler << "        }\n";
         if (a->Classifier->name == "string") {
-                ifc << filler << "        " << a_stream  <<  " << \"\\\"\" << " << "(*" << runner << ")" << " << \"\\\"\";\n";
+                ifc << filler << "        " << a_stream  <<  " << \"\\\"\" << " << value << " << \"\\\"\";\n";
+        } else if (!CEnumeration::JSONWriter(a->Classifier, value).empty()) {
+                ifc << filler << "        " << a_stream << " << " << CEnumeration::JSONWriter(a->Classifier, value) << ";\n";
         } else {
             if ((a->Classifier->name == "uint64_t") || (a->Classifier->name == "objectid_t")) {
-                    ifc << filler << "        " << a_stream  << " << (int64_t)" << "(*" << runner << ")" << ";\n";
+                    ifc << filler << "        " << a_stream  << " << (int64_t)" << value << ";\n";
             } else {
-                    ifc << filler << "        " << a_stream  << " << (*" << runner << ")" << ";\n";
+                    ifc << filler << "        " << a_stream  << " << " << value << ";\n";
             }
         }
     }
@@ -585,10 +642,9 @@ void CMessageClass::DumpJSONArray(std::ofstream& ifc, const std::string& a_strea
 }
 
 
-void CMessageClass::DumpJSONStruct(std::ofstream& ifc, const std::string& a_stream , std::shared_ptr<MElement> a, const std::string& sname, const std::string& prefix, bool first, int space) {
-    std::string filler;
+void CMessageClass::DumpJSONStruct(CodeWriter& ifc, const std::string& a_stream , std::shared_ptr<MElement> a, const std::string& sname, const std::string& prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
-    filler.assign(space, ' ');
     if (a->type == eElementType::Struct) {
         auto s = std::dynamic_pointer_cast<CStruct>(a);
 
@@ -641,16 +697,22 @@ void CMessageClass::DumpJSONStruct(std::ofstream& ifc, const std::string& a_stre
     }
 }
 
-void CMessageClass::DumpJSONValue(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first, int space) {
-    std::string filler;
+void CMessageClass::DumpJSONValue(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
+    std::string        literal = CEnumeration::JSONWriter(a->Classifier, prefix + a->name);
 
-    filler.assign(space, ' ');
     if (a->ClassifierName == "string") {
         if (!first) {
             ifc << filler << "    " << a_stream  <<  " << \", \\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         } else {
             ifc << filler << "    " << a_stream <<  " << \"\\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         }
+    } else if (!literal.empty()) {
+        if (!first) {
+            ifc << filler << "    " << a_stream << " << \", \\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        } else {
+            ifc << filler << "    " << a_stream << " << \"\\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        }
     } else {
         if ((a->ClassifierName == "uint64_t") || (a->ClassifierName == "objectid_t")) {
             if (!first) {
@@ -680,16 +742,22 @@ void CMessageClass::DumpJSONValue(std::ofstream& ifc, const std::string& a_strea
     }
 }
 
-void CMessageClass::DumpJSONValue(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first, int space) {
-    std::string filler;
+void CMessageClass::DumpJSONValue(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
+    std::string        literal = CEnumeration::JSONWriter(a->Classifier, prefix + a->name);
 
-    filler.assign(space, ' ');
     if (a->Classifier->name == "string") {
         if (!first) {
             ifc << filler << "    " << a_stream <<  " << \", \\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         } else {
             ifc << filler << "    " << a_stream <<  " << \"\\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         }
+    } else if (!literal.empty()) {
+        if (!first) {
+            ifc << filler << "    " << a_stream << " << \", \\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        } else {
+            ifc << filler << "    " << a_stream << " << \"\\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        }
     } else {
         if ((a->Classifier->name == "uint64_t") || (a->Classifier->name == "objectid_t") || (a->Classifier->type == eElementType::Enumeration)) {
             if (!first) {
@@ -719,12 +787,12 @@ void CMessageClass::DumpJSONValue(std::ofstream& ifc, const std::string& a_strea
     }
 }
 
-void CMessageClass::DumpJSONOutgoingDeclaration(std::ofstream& ifc) {
+void CMessageClass::DumpJSONOutgoingDeclaration(CodeWriter& ifc) {
     ifc << "static std::ostream& msg_to_json_" << helper::tolower(basename) << "(tMsg* aMsg, std::ostream& output);\n";
 }
 
 void
-CMessageClass::DumpFromJSONArray(std::ofstream &ifc, const std::string &a_stream, const std::shared_ptr<CAttribute> a,
+CMessageClass::DumpFromJSONArray(CodeWriter &ifc, const std::string &a_stream, const std::shared_ptr<CAttribute> a,
                                  const std::string &prefix, bool first, int space) {
     std::string filler(space + 4, ' ');
 
@@ -750,7 +818,7 @@ CMessageClass::DumpFromJSONArray(std::ofstream &ifc, const std::string &a_stream
 }
 
 void
-CMessageClass::DumpFromJSONArray(std::ofstream &ifc, const std::string &a_stream, const std::shared_ptr<CAssociationEnd> a,
+CMessageClass::DumpFromJSONArray(CodeWriter &ifc, const std::string &a_stream, const std::shared_ptr<CAssociationEnd> a,
                                  const std::string &prefix, bool first, int space) {
 
     std::string filler(space + 4, ' ');
@@ -777,7 +845,7 @@ CMessageClass::DumpFromJSONArray(std::ofstream &ifc, const std::string &a_stream
 
 }
 
-void CMessageClass::toJSONBuddy(std::ofstream & ifc, const std::string& a_stream) {
+void CMessageClass::toJSONBuddy(CodeWriter & ifc, const std::string& a_stream) {
     std::string prefix = "this->";
     auto al = GetAttributes();
 
@@ -832,3 +900,128 @@ void CMessageClass::toJSONBuddy(std::ofstream & ifc, const std::string& a_stream
     }
 }
 
+//
+//  Header and members as in toJSONBuddy. The destination is written as a
+//  number, as the javascript side sends it.
+void CMessageClass::FlatMembers(FlatLayout& aLayout) {
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            aLayout.Member(std::dynamic_pointer_cast<CAttribute>(ai));
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        auto a = std::dynamic_pointer_cast<CAssociationEnd>(*ai);
+
+        if ((a->visibility == vPublic) && a->isNavigable()) {
+            aLayout.Member(a);
+        }
+    }
+}
+
+void CMessageClass::toJSONBuffer(CodeWriter & ifc) {
+    JsonEncoder encoder(8);
+
+    encoder.Code("auto seqnumber = seq;");
+    encoder.Begin("if (std::holds_alternative<tConnection>(dst)) {", false);
+    encoder.Code("seqnumber = std::get<tConnection>(dst).seqnumber;");
+    encoder.End();
+    encoder.Literal("\"MsgId\":\"" + basename + "\",\"SeqNumber\":");
+    encoder.Write("mtt::json_value(aOut, seqnumber)", "mtt::json_number_bound");
+    encoder.Begin("if (std::holds_alternative<tReference>(dst)) {", false);
+    encoder.Code("auto dstid = std::get<tReference>(dst).m_id;");
+    encoder.Begin("if (dstid != 0) {", false);
+    encoder.Literal(",\"Destination\":");
+    encoder.Write("mtt::json_value(aOut, (int64_t)(dstid))", "mtt::json_number_bound");
+    encoder.End();
+    encoder.End();
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            encoder.Member(std::dynamic_pointer_cast<CAttribute>(ai), "this->", false);
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        if (ai->visibility == vPublic) {
+            encoder.Member(std::dynamic_pointer_cast<CAssociationEnd>(*ai), "this->", false);
+        }
+    }
+    ifc << "    virtual std::ostream& pack_json(std::ostream& output) {\n"
+           "        thread_local std::string buffer;\n"
+           "\n"
+           "        buffer.clear();\n"
+           "        pack_json(buffer);\n"
+           "        output.write(buffer.data(), buffer.size());\n"
+           "\n"
+           "        return output;\n"
+           "    }\n";
+    ifc << "    virtual std::ostringstream& pack_json() {\n"
+           "        oss.clear();\n"
+           "        oss.str(\"\");\n"
+           "        oss << '{';\n"
+           "        pack_json(oss);\n"
+           "        oss << '}';\n"
+           "\n"
+           "        return oss;\n"
+           "    }\n";
+    ifc << "    //\n"
+           "    //  Upper bound of the text written by pack_json(char*).\n"
+           "    size_t json_size() const {\n"
+        << encoder.Size()
+        << "    }\n";
+    ifc << "    //\n"
+           "    //  Writes the JSON text to aOut, which must hold json_size() characters.\n"
+           "    //  Returns the end of the text.\n"
+           "    char* pack_json(char* aOut) const {\n"
+        << encoder.Pack()
+        << "\n        return aOut;\n"
+           "    }\n";
+    ifc << "    void pack_json(std::string& aOut) const {\n"
+           "        size_t used = aOut.size();\n"
+           "\n"
+           "        aOut.resize(used + json_size());\n"
+           "        aOut.resize(pack_json(&aOut[used]) - aOut.data());\n"
+           "    }\n";
+}
+
+//
+//  The decoder reads the members and the routing keys that toJSONBuffer
+//  writes. The message id is left to the caller.
+void CMessageClass::fromJSONBuffer(CodeWriter & ifc) {
+    JsonDecoder decoder;
+
+    decoder.Key("Destination", "objectid_t dstid = 0;\n"
+                               "\n"
+                               "aReader.value(dstid);\n"
+                               "dst = tReference(dstid, nullptr);\n");
+    decoder.Key("SeqNumber", "aReader.value(seq);\n");
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            decoder.Member(std::dynamic_pointer_cast<CAttribute>(ai), "this->");
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        if (ai->visibility == vPublic) {
+            decoder.Member(std::dynamic_pointer_cast<CAssociationEnd>(*ai), "this->");
+        }
+    }
+    ifc << "    //\n"
+           "    //  This is the single pass de-serializer. It reads the JSON object text\n"
+           "    //  straight into the members without building a tree.\n"
+           "    bool unpack_json(const char* aText, size_t aSize) {\n"
+           "        mtt::json_reader reader(aText, aSize);\n"
+           "\n"
+           "        return unpack_json(reader);\n"
+           "    }\n"
+           "    bool unpack_json(mtt::json_reader& aReader) {\n"
+           "        dst = tReference(0, nullptr);\n";
+    for (auto & ai : GetAttributes()) {
+        auto a = std::dynamic_pointer_cast<CAttribute>(ai);
+
+        if ((a->visibility == vPublic) && !a->defaultValue.empty() && !a->isMultiple) {
+            ifc << "        " << a->name << " = " << a->defaultValue << ";\n";
+        }
+    }
+    ifc << "\n"
+        << decoder.Object(8)
+        << "\n        return aReader.good();\n"
+           "    }\n";
+}
@@ -23,6 +23,8 @@
 #include "cclassbase.h"
 #include "ccxxclass.h"
 
+class FlatLayout;
+
 class CMessageClass : public CCxxClass
 {
 public:
@@ -36,26 +38,31 @@ public:
     virtual void Dump(std::shared_ptr<MModel> aModel);
     //void CollectNeededModelHeader(std::shared_ptr<MElement> e) ;
 
-    void DumpJSONIncoming(std::ofstream& ifc);
-    void DumpJSONIncomingDeclaration(std::ofstream& ifc);
-    void DumpJSONIncomingArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, int space);
-    void DumpJSONIncomingArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, int space);
-    void DumpJSONOutgoing(std::ofstream& ifc);
-    void DumpJSONOutgoingDeclaration(std::ofstream& ifc);
-    void DumpJSONStruct(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<MElement> e, const std::string& sname, const std::string& prefix, bool first=false, int space=0);
-    void DumpJSONArray(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first=false, int space=0);
-    void DumpJSONValue(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first=false, int space=0);
-    void DumpJSONArray(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first=false, int space=0);
-    void DumpJSONValue(std::ofstream& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first=false, int space=0);
+    void DumpJSONIncoming(CodeWriter& ifc);
+    void DumpJSONIncomingDeclaration(CodeWriter& ifc);
+    void DumpJSONIncomingArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, int space);
+    void DumpJSONIncomingArray(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, int space);
+    void DumpJSONOutgoing(CodeWriter& ifc);
+    void DumpJSONOutgoingDeclaration(CodeWriter& ifc);
+    void DumpJSONStruct(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<MElement> e, const std::string& sname, const std::string& prefix, bool first=false, int space=0);
+    void DumpJSONArray(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first=false, int space=0);
+    void DumpJSONValue(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first=false, int space=0);
+    void DumpJSONArray(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first=false, int space=0);
+    void DumpJSONValue(CodeWriter& ifc, const std::string& a_stream , const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first=false, int space=0);
 
-    void toJSONBuddy(std::ofstream& ifc, const std::string& a_stream);
+    void toJSONBuddy(CodeWriter& ifc, const std::string& a_stream);
+    void toJSONBuffer(CodeWriter& ifc);
+    void fromJSONBuffer(CodeWriter& ifc);
 
-    void DumpFromJSONArray(std::ofstream& ifc, const std::string& a_stream, const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first=false, int space = 0 );
-    void DumpFromJSONArray(std::ofstream& ifc, const std::string& a_stream, const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first=false, int space = 0 );
+    void DumpFromJSONArray(CodeWriter& ifc, const std::string& a_stream, const std::shared_ptr<CAttribute> a, const std::string& prefix, bool first=false, int space = 0 );
+    void DumpFromJSONArray(CodeWriter& ifc, const std::string& a_stream, const std::shared_ptr<CAssociationEnd> a, const std::string& prefix, bool first=false, int space = 0 );
 
-    void fromJSONBuddy(std::ofstream& ifc);
+    void fromJSONBuddy(CodeWriter& ifc);
+    void FlatMembers(FlatLayout& aLayout);
 public:
     std::string direction;
+    bool        jsonbuffer = false;
+    bool        flatlayout = false;
     std::string msgtype;
     std::string basename;
     std::string lower_name;
@@ -30,6 +30,10 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <tuple>
+#include <vector>
 #include "helper.h"
 #include "path.h"
 #include "main.h"
@@ -48,11 +52,52 @@
 #include "cparameter.h"
 #include "mattribute.h"
 #include "cattribute.h"
+#include "massociationend.h"
 #include "cpackage.h"
 #include "cmodel.h"
+#include "contenthash.h"
 
 #include "cclassbase.h"
 
+//
+//  Source of the generated lines for the merge. The content comes in one piece
+//  from the code writer. Only if it is not available the generated file is read.
+class GeneratedLines {
+public:
+    GeneratedLines(const std::string& aFileName, std::shared_ptr<std::string> aContent) : mContent(aContent) {
+        if (!mContent) {
+            mFile.open(aFileName);
+        }
+    }
+    bool good() {
+        return (mContent) ? (mPos < mContent->size()) : mFile.good();
+    }
+    bool getline(std::string& aLine) {
+        if (mContent) {
+            size_t eol = mContent->find('\n', mPos);
+
+            if (eol == std::string::npos) {
+                mPos = mContent->size();
+                return false;
+            }
+            aLine.assign(*mContent, mPos, eol - mPos);
+            mPos = eol + 1;
+            return true;
+        }
+        mFile.getline(mLineBuffer, sizeof(mLineBuffer)-1);
+        if (mFile.good()) {
+            aLine = mLineBuffer;
+            return true;
+        }
+        return false;
+    }
+private:
+    std::shared_ptr<std::string> mContent;
+    size_t                       mPos = 0;
+    std::ifstream                mFile;
+    char                         mLineBuffer[16384];
+};
+
 CModel::CModel()
 {
 
@@ -203,10 +248,21 @@ void CModel::Dump(void) {
         }
     }
 
+    //
+    //  prepare dump of a list of elements and all elements that depend on them.
+    //  An empty closure would dump everything, so an element that is not found
+    //  stops the generation.
+    if ((!gDumpElements.empty()) && (!CollectDumpClosure())) {
+        failed = true;
+        return;
+    }
     //
     //  At this point we have a directory to create the generation
     //  results into.
     pathstack.push_back(path);
+    //
+    //  The manifest of the last run tells which elements are unchanged.
+    LoadLastGeneratedFiles();
     for (auto p : Packages) {
         p->Dump(shared_from_this());
     }
@@ -240,6 +296,9 @@ void CModel::LoadLastGeneratedFiles() {
                     case 3:
                         igenfile.comment = t;
                         break;
+                    case 4:
+                        igenfile.hash = t;
+                        break;
                     default:
                         break;
                     }
@@ -263,23 +322,310 @@ void CModel::DumpGeneratedFiles() {
         if (outfiles.good()) {
             for (auto & f : generatedfiles) {
                 CPath p(f.ofile);
-                outfiles << (std::string)(p) << ";" << f.id << ";" << f.filetype << ";" << f.comment << std::endl;
+                auto        hash = contenthash.find(f.id);
+
+                outfiles << (std::string)(p) << ";" << f.id << ";" << f.filetype << ";" << f.comment;
+                if (hash != contenthash.end()) {
+                    outfiles << ";" << hash->second;
+                }
+                outfiles << std::endl;
+            }
+        }
+    }
+}
+
+//
+//  The headers in the include statements of a generated file, together with the
+//  quotes or angle brackets. The content is taken from memory if the file has been
+//  generated in this run. Otherwise from the final file or the generated file.
+std::vector<std::string> CModel::GetIncludes(const tGenFile& aFile) {
+    std::vector<std::string> retval;
+    std::istringstream       content;
+    std::ifstream            file;
+    std::istream*            input = &content;
+    std::string              line;
+
+    if (aFile.content && (!aFile.content->empty())) {
+        content.str(*aFile.content);
+    } else {
+        size_t basepos = aFile.ofile.find_last_of('/');
+
+        file.open(aFile.ofile.substr(0, basepos+1) + aFile.ofile.substr(basepos+2));
+        if (!file.good()) {
+            file.open(aFile.ofile);
+        }
+        input = &file;
+    }
+    while (std::getline(*input, line)) {
+        size_t pos = line.find_first_not_of(" \t");
+
+        if ((pos != std::string::npos) && (line.compare(pos, 8, "#include") == 0)) {
+            size_t start = line.find_first_of("\"<", pos + 8);
+            size_t stop  = (start != std::string::npos) ? line.find_first_of("\">", start + 1) : std::string::npos;
+
+            if (stop != std::string::npos) {
+                retval.push_back(line.substr(start, stop - start + 1));
             }
         }
     }
+    return retval;
+}
+
+//
+//  Writes for each generated C/C++ file the number of files it includes directly and
+//  transitively and the number of generated files that include it. The headers that are
+//  used by many files and pull in many others are the ones that cost the compile time.
+void CModel::DumpIncludeReport(void) {
+    std::map<std::string, std::vector<std::string>> includes;   //  Final file path -> names in the include statements.
+    std::map<std::string, std::string>              byname;     //  File name without path -> final file path.
+
+    for (auto & f : generatedfiles) {
+        size_t      basepos = f.ofile.find_last_of('/');
+        std::string ofile   = f.ofile.substr(0, basepos+1) + f.ofile.substr(basepos+2);
+        std::string fname   = CPath(ofile);
+        size_t      extpos  = fname.find_last_of('.');
+        std::string ext     = (extpos != std::string::npos) ? fname.substr(extpos) : std::string();
+
+        if ((ext == ".h") || (ext == ".hpp") || (ext == ".c") || (ext == ".cpp")) {
+            auto& inc = includes[fname];
+
+            for (auto & i : GetIncludes(f)) {
+                inc.push_back(i.substr(1, i.size() - 2));
+            }
+            byname.emplace(fname.substr(fname.find_last_of('/') + 1), fname);
+        }
+    }
+    //
+    //  Includes are searched beside the including file first and then by name in all generated files.
+    //  Anything else is a system or external header.
+    auto resolve = [&includes, &byname](const std::string& aFrom, const std::string& aName) {
+        std::string local = aFrom.substr(0, aFrom.find_last_of('/') + 1) + aName;
+
+        if (includes.find(local) != includes.end()) {
+            return local;
+        }
+        auto b = byname.find(aName.substr(aName.find_last_of('/') + 1));
+
+        return (b != byname.end()) ? b->second : aName;
+    };
+    std::map<std::string, size_t>                       users;   //  Number of generated files that include a file.
+    std::vector<std::tuple<size_t, size_t, std::string>> rows;   //  transitive, direct, file
+
+    for (auto & i : includes) {
+        std::set<std::string>    direct;
+        std::set<std::string>    seen;
+        std::vector<std::string> stack;
+
+        for (auto & n : i.second) {
+            std::string r = resolve(i.first, n);
+
+            if (r != i.first) {
+                direct.insert(r);
+            }
+        }
+        stack.assign(direct.begin(), direct.end());
+        while (!stack.empty()) {
+            std::string current = stack.back();
+
+            stack.pop_back();
+            if ((current != i.first) && (seen.insert(current).second)) {
+                auto ci = includes.find(current);
+
+                if (ci != includes.end()) {
+                    for (auto & n : ci->second) {
+                        stack.push_back(resolve(current, n));
+                    }
+                }
+            }
+        }
+        for (auto & s : seen) {
+            users[s]++;
+        }
+        rows.emplace_back(seen.size(), direct.size(), i.first);
+    }
+    std::sort(rows.begin(), rows.end(), [](const std::tuple<size_t, size_t, std::string>& a, const std::tuple<size_t, size_t, std::string>& b) {
+        return (std::get<0>(a) != std::get<0>(b)) ? (std::get<0>(a) > std::get<0>(b)) : (std::get<2>(a) < std::get<2>(b));
+    });
+
+    std::ofstream report(pathstack.front() + "/" + gIncludeReport);
+
+    if (report.good()) {
+        report << "# file;direct includes;transitive includes;included by\n";
+        for (auto & r : rows) {
+            report << std::get<2>(r) << ";" << std::get<1>(r) << ";" << std::get<0>(r) << ";" << users[std::get<2>(r)] << "\n";
+        }
+    } else {
+        std::cerr << "Cannot open file " << gIncludeReport << std::endl;
+    }
+}
+
+//
+//  Find the classes that are given by id or FQN and all classes whose output
+//  depends on them. These are the derived classes and the classes that have an
+//  attribute or association end of such a type. The packages of these classes
+//  are dumped anyway, so their makefiles are up to date.
+//  Returns false if any of the elements is not in the model.
+bool CModel::CollectDumpClosure(void) {
+    std::map<std::string, std::set<std::string>> users;
+    std::list<std::string>                       todo;
+    bool                                         found = true;
+    //
+    //  Build the reverse dependencies of all classes once.
+    for (auto & c : MClass::Instances) {
+        for (auto & a : c.second->Attribute) {
+            auto attr = std::dynamic_pointer_cast<MAttribute>(*a);
+
+            if (attr && attr->Classifier) {
+                users[attr->Classifier->id].insert(c.first);
+            }
+        }
+        for (auto & g : c.second->Generalization) {
+            auto gen = std::dynamic_pointer_cast<MGeneralization>(*g);
+
+            if (gen && gen->base) {
+                users[gen->base->id].insert(c.first);
+            }
+        }
+    }
+    //
+    //  The classes at the ends of an association depend on each other.
+    for (auto & a : MAssociation::Instances) {
+        for (auto & from : a.second->ends) {
+            for (auto & to : a.second->ends) {
+                auto fromend = std::dynamic_pointer_cast<MAssociationEnd>(*from);
+                auto toend   = std::dynamic_pointer_cast<MAssociationEnd>(*to);
+
+                if ((fromend != toend) && fromend->Classifier && toend->Classifier) {
+                    users[toend->Classifier->id].insert(fromend->Classifier->id);
+                }
+            }
+        }
+    }
+    //
+    //  The start of the closure. Attributes, operations and the like are
+    //  generated with the class they belong to.
+    for (auto & name : gDumpElements) {
+        std::shared_ptr<MElement> e;
+        auto                      byid  = MElement::Instances.find(name);
+        auto                      byfqn = MClass::mByFQN.find(name);
+
+        if (byid != MElement::Instances.end()) {
+            e = byid->second;
+        } else if (byfqn != MClass::mByFQN.end()) {
+            e = byfqn->second;
+        } else {
+            std::cerr << "Element " << name << " not found in model\n";
+            found = false;
+        }
+        while (e && !e->IsClassBased() && !e->IsPackageBased()) {
+            e = *e->parent;
+        }
+        if (e && e->IsPackageBased()) {
+            //
+            //  A package stands for all classes inside.
+            for (auto & c : MClass::Instances) {
+                for (auto p = c.second->parent; p; p = p->parent) {
+                    if (p->id == e->id) {
+                        todo.push_back(c.first);
+                        break;
+                    }
+                }
+            }
+        } else if (e) {
+            todo.push_back(e->id);
+        }
+    }
+    while (!todo.empty()) {
+        std::string id = todo.front();
+
+        todo.pop_front();
+        if (dumpclosure.insert(id).second) {
+            auto u = users.find(id);
+
+            if (u != users.end()) {
+                todo.insert(todo.end(), u->second.begin(), u->second.end());
+            }
+        }
+    }
+    return found;
+}
+
+//
+//  Checks the content hash of the element against the last run. If it did not
+//  change the files of the last run are taken over and the Dump can be skipped.
+//  If a list of elements to dump is given, all elements outside of its closure
+//  keep the files and the hash of the last run.
+bool CModel::IsUnchanged(std::shared_ptr<MElement> aElement) {
+    bool                keep = (!dumpclosure.empty()) && (dumpclosure.find(aElement->id) == dumpclosure.end());
+    std::string         hash;
+    std::list<tGenFile> last;
+
+    if (!keep) {
+        hash = ContentHash::of(aElement);
+        contenthash[aElement->id] = hash;
+        if ((!gIncremental) || (!dumpclosure.empty())) {
+            return false;
+        }
+    }
+    //
+    //  The last generated files are sorted by id and filetype. So all files of the
+    //  element follow the lower bound.
+    for (auto li = lastgeneratedfiles.lower_bound(aElement->id);
+         (li != lastgeneratedfiles.end()) && (li->first.compare(0, aElement->id.size(), aElement->id) == 0); ++li) {
+        if (li->second.id == aElement->id) {
+            struct stat        filestat;
+            const std::string& gfile   = li->second.ofile;
+            size_t             basepos = gfile.find_last_of('/');
+            //
+            //  The final file is the generated one without the leading dot.
+            std::string        ofile   = gfile.substr(0, basepos+1) + gfile.substr(basepos+2);
+
+            if ((!keep) && (li->second.hash != hash)) {
+                return false;
+            }
+            //
+            //  An empty generated file does not produce a final file. Otherwise the
+            //  final file must still be there.
+            if ((stat(gfile.c_str(), &filestat) != 0) ||
+                ((filestat.st_size > 0) && (stat(ofile.c_str(), &filestat) != 0))) {
+                return false;
+            }
+            //
+            //  The source file is generated before the header. Keep that order.
+            if (li->second.filetype == "src") {
+                last.push_front(li->second);
+            } else {
+                last.push_back(li->second);
+            }
+        }
+    }
+    if (last.empty()) {
+        return false;
+    }
+    for (auto & l : last) {
+        l.unchanged = true;
+        generatedfiles.push_back(l);
+    }
+    if ((keep) && (!last.front().hash.empty())) {
+        contenthash[aElement->id] = last.front().hash;
+    }
+    return true;
 }
 
 void CModel::Merge(void) {
     std::list< tGenFile >::iterator files;
 
-    LoadLastGeneratedFiles();
-
     for (files=generatedfiles.begin(); files!=generatedfiles.end(); ++files) {
         size_t      basepos;
         std::string gfile=files->ofile;
         std::string ofile;
         std::string lfile;
         //
+        //  Files of unchanged elements are still in place from the last run.
+        if (files->unchanged) {
+            continue;
+        }
+        //
         //  basepos is the position right before the dot in the generated file name.
         basepos=gfile.find_last_of('/');
         //
@@ -306,19 +652,23 @@ void CModel::Merge(void) {
             lfile = ofile;
         }
         if (files->filetype == "mSysHeader") {
-            MergeSysHeader(gfile, ofile, files->comment, files->id);
+            MergeSysHeader(gfile, ofile, files->comment, files->id, files->content);
         } else {
-            Merge(gfile, ofile, lfile, files->comment);
+            Merge(gfile, ofile, lfile, files->comment, files->content);
         }
     }
     DumpGeneratedFiles();
+    if (!gIncludeReport.empty()) {
+        DumpIncludeReport();
+    }
 }
 //
 //  gname   - name of the generated file. prefixed with a dot.
 //  oname   - name of the file to output. removed the dot from gname.
 //  lname   - name of the file in the last generation without the dot.
 //  comment - the comment style
-void CModel::Merge(const std::string& gname, const std::string&oname, const std::string& lname, const std::string& comment) {
+//  aContent - the generated content if it is still in memory
+void CModel::Merge(const std::string& gname, const std::string&oname, const std::string& lname, const std::string& comment, std::shared_ptr<std::string> aContent) {
     int         state=0;          // State variable for a little statemachine.
     size_t      tagpos;           // Where the tag starts.
     char        linebuffer[16384];// Should be large enough to get almost anything read in.
@@ -331,7 +681,7 @@ void CModel::Merge(const std::string& gname, const std::string&oname, const std:
     std::list<std::string> mlist; // List of modified lines from original file.
     std::map<std::string, std::list <std::string> > mods; // Mods by tag
 
-    std::ifstream gfile(gname);   // Generated file input
+    GeneratedLines gfile(gname, aContent); // Generated file input
     std::ifstream ofile(lname);   // Original file input
     std::ofstream nfile;          // New file output.
 
@@ -339,10 +689,7 @@ void CModel::Merge(const std::string& gname, const std::string&oname, const std:
     //
     //  Create all lists from the generated file.
     while (gfile.good()) {
-        gfile.getline(linebuffer, sizeof(linebuffer)-1);
-        if (gfile.good()) {
-            line=linebuffer;
-
+        if (gfile.getline(line)) {
             tagpos=line.find(search);
             switch (state) {
             case 0:
@@ -372,7 +719,6 @@ void CModel::Merge(const std::string& gname, const std::string&oname, const std:
             }
         }
     }
-    gfile.close();
     //
     //  Create all lists from the modified file.
     search = comment + " User-Defined-Code:";
@@ -519,7 +865,8 @@ void CModel::Merge(const std::string& gname, const std::string&oname, const std:
 //  lname   - name of the file in the last generation without the dot.
 //  comment - the comment style
 //  a_id    - the class id to get the hdr file to use as code-input
-void CModel::MergeSysHeader(const std::string& gname, const std::string&oname, const std::string& comment, const std::string& a_id) {
+//  aContent - the generated content if it is still in memory
+void CModel::MergeSysHeader(const std::string& gname, const std::string&oname, const std::string& comment, const std::string& a_id, std::shared_ptr<std::string> aContent) {
     int         state=0;          // State variable for a little statemachine.
     size_t      tagpos;           // Where the tag starts.
     char        linebuffer[16384];// Should be large enough to get almost anything read in.
@@ -532,7 +879,7 @@ void CModel::MergeSysHeader(const std::string& gname, const std::string&oname, c
     std::list<std::string> mlist; // List of modified lines from original file.
     std::map<std::string, std::list <std::string> > mods; // Mods by tag
 
-    std::ifstream gfile(gname);   // Generated file input
+    GeneratedLines gfile(gname, aContent); // Generated file input
     std::ofstream nfile;          // New file output.
     //
     //  get the complete path to the header file from the id.
@@ -552,10 +899,7 @@ void CModel::MergeSysHeader(const std::string& gname, const std::string&oname, c
     //
     //  Create all lists from the generated file.
     while (gfile.good()) {
-        gfile.getline(linebuffer, sizeof(linebuffer)-1);
-        if (gfile.good()) {
-            line=linebuffer;
-
+        if (gfile.getline(line)) {
             tagpos=line.find(search);
             switch (state) {
             case 0:
@@ -585,7 +929,6 @@ void CModel::MergeSysHeader(const std::string& gname, const std::string&oname, c
             }
         }
     }
-    gfile.close();
     //
     //  Create all lists from the modified file.
     search = comment + " User-Defined-Code:";
@@ -21,6 +21,9 @@
 #define CMODEL_H
 
 #include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
 #include "mmodel.h"
 
 typedef struct tagGenFile {
@@ -28,6 +31,9 @@ typedef struct tagGenFile {
     std::string id;
     std::string comment;
     std::string filetype;
+    std::shared_ptr<std::string> content;   //  Generated content kept in memory for the merge.
+    std::string hash {};                    //  Content hash of the element from the manifest.
+    bool        unchanged = false;          //  Taken over from the last run. Neither dumped nor merged.
 } tGenFile;
 
 class CModel :  public std::enable_shared_from_this<MModel>, public MModel
@@ -41,14 +47,21 @@ public:
     virtual void Dump(void);
     //
     void Merge(void);
-    void Merge(const std::string& gfile, const std::string& ofile, const std::string& lname, const std::string& comment);
-    void MergeSysHeader(const std::string& gfile, const std::string& ofile, const std::string& comment, const std::string& a_id);
+    void Merge(const std::string& gfile, const std::string& ofile, const std::string& lname, const std::string& comment, std::shared_ptr<std::string> aContent = nullptr);
+    void MergeSysHeader(const std::string& gfile, const std::string& ofile, const std::string& comment, const std::string& a_id, std::shared_ptr<std::string> aContent = nullptr);
     void LoadLastGeneratedFiles(void);
     void DumpGeneratedFiles(void);
+    void DumpIncludeReport(void);
+    std::vector<std::string> GetIncludes(const tGenFile& aFile);
+    bool IsUnchanged(std::shared_ptr<MElement> aElement);
+    bool CollectDumpClosure(void);
 public:
     std::list<std::string>            pathstack;
     std::list< tGenFile >             generatedfiles;
     std::map<std::string, tGenFile >  lastgeneratedfiles;
+    std::map<std::string, std::string> contenthash;
+    std::set<std::string>             dumpclosure;        //  Ids of the classes to dump. Empty if all get dumped.
+    bool                              failed = false;     //  Set if the generation was stopped.
 public:
     std::string                       Directory;
     std::string                       License;
@@ -34,7 +34,7 @@ public:
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
 private:
-    std::ofstream makefile;
+    CodeWriter makefile;
 };
 
 #endif // CMODELPACKAGE_H
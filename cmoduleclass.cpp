@@ -812,8 +812,7 @@ void CCxxClass::DumpPackageOperationDecl(std::ostream& hdr) {
 
 void CCxxClass::DumpOperationDecl(std::ostream& hdr, int indent) {
     bool dump=true;
-    std::string classfiller;
-    classfiller.assign(indent, ' ');
+    const std::string& classfiller = CodeWriter::spaces(indent);
     //
     //  First we dump all "normal" operations.
     for (auto & vi : vis) {
@@ -913,8 +912,7 @@ void CCxxClass::DumpOperationDecl(std::ostream& hdr, int indent) {
                 auto op = std::dynamic_pointer_cast<COperation>(*mo);
                 std::string header = op->getHeader(indent);
                 std::string pdecl  = op->GetParameterDecl(mNameSpace);
-                std::string filler;
-                filler.assign(indent + IndentSize, ' ');
+                const std::string& filler = CodeWriter::spaces(indent + IndentSize);
                 hdr << header << filler << "///" <<  std::endl;
 
                 if (op->isTemplateOperation()) {
@@ -1036,8 +1034,7 @@ void CCxxClass::DumpOperationDecl(std::ostream& hdr, int indent) {
 void CCxxClass::DumpAttributeDecl(std::ostream& hdr, int indent) {
     size_t i = 0U;
     bool dump = true;
-    std::string classfiller;
-    classfiller.assign(indent, ' ');
+    const std::string& classfiller = CodeWriter::spaces(indent);
     //
     //  These are the attributes sorted by visibility.
     //  Package visibility is not considered here.
@@ -1846,6 +1843,11 @@ void CModuleClass::Dump(std::shared_ptr<MModel> model) {
     std::set<std::shared_ptr<MElement>>   oplist;
     std::set<std::string> includesdone;
     std::string           wxappclass    = GetTaggedValue("WxAppClass");
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
 
     //
     //  Collect the needed modell header.
@@ -1896,6 +1898,10 @@ void CModuleClass::Dump(std::shared_ptr<MModel> model) {
         includesdone.insert("string");
         hdr << "#include <string>\n";
     }
+    if (UsesParallelActivity()) {
+        includesdone.insert("future");
+        hdr << "#include <future>\n";
+    }
     //  Dump system headers.
     DumpSystemHeader(hdr);
     //
@@ -1946,8 +1952,8 @@ void CModuleClass::Dump(std::shared_ptr<MModel> model) {
         headerdir.Create();
         std::string sysheaderpath = (std::string)headerdir;
 
-        cmodel->generatedfiles.push_back(  tGenFile { sysheaderpath, id, "//", "mSysHeader"} );
         OpenStream(mSysHeader, sysheaderpath);
+        cmodel->generatedfiles.push_back(  tGenFile { sysheaderpath, id, "//", "mSysHeader", mSysHeader.buffer()} );
         if (!mSysHeader.is_open()) {
             std::cerr << "Cannot open file " << sysheaderpath << std::endl;
         } else {
@@ -114,7 +114,7 @@ protected:
     std::string                          mClassifierType = "class";
     bool                                 mSerialize = false;
     eByteOrder                           mByteOrder = eByteOrder::Host;
-    std::ofstream                        mSysHeader;
+    CodeWriter                           mSysHeader;
     std::list<std::shared_ptr<MElement>> mSelfContainedHeaders;
     std::list<std::shared_ptr<MElement>> mSelfContainedExtras;
     std::list<std::shared_ptr<MElement>> mSelfContainedQt;
@@ -240,7 +240,7 @@ void CModulePackage::DumpTestDir(const std::string &aTestDir, const std::list<st
     }
 
     std::string testmakefilename = aTestDir+"/Makefile";
-    std::ofstream  testmakefile(testmakefilename);
+    CodeWriter     testmakefile(testmakefilename);
 
     testmakefile << "PROJ=" << OutputName << "Test\n\n";
 
@@ -41,7 +41,7 @@ public:
     void DumpTestDir(const std::string& aTestDir, const std::list<std::string>& aModules);
 private:
 
-    std::ofstream   makefile;
+    CodeWriter      makefile;
 };
 
 #endif // CMODULEPACKAGE_H
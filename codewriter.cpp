@@ -0,0 +1,177 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <iostream>
+#include <fstream>
+#include <charconv>
+#include <locale>
+#include <cctype>
+#include <deque>
+
+#include "main.h"
+#include "codewriter.h"
+
+//
+//  Number formatting through std::to_chars. Only the plain decimal and hex
+//  cases are handled here. Everything with width, showpos or showbase goes
+//  the standard way.
+class CodeNumPut : public std::num_put<char> {
+public:
+    explicit CodeNumPut(size_t aRefs = 0) : std::num_put<char>(aRefs) {}
+protected:
+    iter_type do_put(iter_type out, std::ios_base& str, char_type fill, long v) const override {
+        return put_integer(out, str, fill, v);
+    }
+    iter_type do_put(iter_type out, std::ios_base& str, char_type fill, unsigned long v) const override {
+        return put_integer(out, str, fill, v);
+    }
+    iter_type do_put(iter_type out, std::ios_base& str, char_type fill, long long v) const override {
+        return put_integer(out, str, fill, v);
+    }
+    iter_type do_put(iter_type out, std::ios_base& str, char_type fill, unsigned long long v) const override {
+        return put_integer(out, str, fill, v);
+    }
+private:
+    template<typename T>
+    iter_type put_integer(iter_type out, std::ios_base& str, char_type fill, T v) const {
+        std::ios_base::fmtflags flags = str.flags();
+        std::ios_base::fmtflags base  = flags & std::ios_base::basefield;
+        int                     radix = 10;
+
+        if ((str.width() != 0) || (flags & (std::ios_base::showpos | std::ios_base::showbase))) {
+            return std::num_put<char>::do_put(out, str, fill, v);
+        }
+        if (base == std::ios_base::hex) {
+            radix = 16;
+        } else if (base == std::ios_base::oct) {
+            radix = 8;
+        }
+        char   digits[72];
+        auto   result = std::to_chars(digits, digits + sizeof(digits), v, radix);
+
+        for (char* c = digits; c != result.ptr; ++c) {
+            *out++ = ((flags & std::ios_base::uppercase) ? static_cast<char>(::toupper(*c)) : *c);
+        }
+        return out;
+    }
+};
+
+static const std::locale& codeLocale() {
+    static const std::locale loc(std::locale::classic(), new CodeNumPut);
+
+    return loc;
+}
+
+CodeBuffer::int_type CodeBuffer::overflow(int_type c) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        mBuffer->push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize CodeBuffer::xsputn(const char* s, std::streamsize n) {
+    mBuffer->append(s, static_cast<size_t>(n));
+    return n;
+}
+
+//
+//  Only the position at the end is known.
+CodeBuffer::pos_type CodeBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    if ((off != 0) || (dir != std::ios_base::cur) || (which != std::ios_base::out)) {
+        return pos_type(off_type(-1));
+    }
+    return pos_type(static_cast<off_type>(mBuffer->size()));
+}
+
+CodeWriter::CodeWriter() : std::ostream(nullptr) {
+    rdbuf(&mBuf);
+    imbue(codeLocale());
+}
+
+CodeWriter::CodeWriter(const std::string& aFileName) : CodeWriter() {
+    open(aFileName);
+}
+
+CodeWriter::~CodeWriter() {
+    close();
+}
+
+void CodeWriter::open(const std::string& aFileName) {
+    close();
+    mBuf.reset();
+    mFileName = aFileName;
+    mOpen     = true;
+    clear();
+}
+//
+//  Write the complete buffer with a single write. The buffer itself
+//  stays alive as long as the model holds it for the merge.
+void CodeWriter::close() {
+    if (mOpen) {
+        std::ofstream out(mFileName);
+
+        mOpen = false;
+        if (out.is_open()) {
+            const auto& content = *mBuf.get();
+
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        }
+        if (!out.good()) {
+            std::cerr << "Cannot write file " << mFileName << std::endl;
+            setstate(std::ios_base::failbit);
+        }
+    }
+}
+
+const std::string& CodeWriter::spaces(size_t aCount) {
+    static std::deque<std::string> cache;
+
+    while (cache.size() <= aCount) {
+        cache.emplace_back(cache.size(), ' ');
+    }
+    return cache[aCount];
+}
+
+const std::string& CodeWriter::indent(int aLevel) {
+    return spaces((aLevel > 0) ? static_cast<size_t>(aLevel * IndentSize) : 0);
+}
+
+std::string CodeWriter::shift(const std::string& aCode, size_t aCount) {
+    std::string shifted;
+    size_t      start = 0;
+
+    while (start < aCode.size()) {
+        size_t end = aCode.find('\n', start);
+
+        if (end == std::string::npos) {
+            end = aCode.size() - 1;
+        }
+        if (end > start) {
+            shifted += spaces(aCount);
+        }
+        shifted.append(aCode, start, end - start + 1);
+        start = end + 1;
+    }
+    return shifted;
+}
+
+void CodeWriter::caselabel(std::ostream& aOut, const std::string& aLabel, tCaseLabels& aCases) {
+    aCases.emplace_back(static_cast<size_t>(aOut.tellp()), aLabel);
+    aOut << "    case " << aLabel << ":\n";
+}
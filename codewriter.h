@@ -0,0 +1,93 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef CODEWRITER_H
+#define CODEWRITER_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <streambuf>
+
+//
+//  The case labels of a switch with their position in the buffer.
+typedef std::vector<std::pair<size_t, std::string>> tCaseLabels;
+
+//
+//  The stream buffer collects everything written into one growing string.
+//  Nothing is written to disk before the writer gets closed. sync() is a no-op
+//  so std::endl and std::flush do not cost a system call. tellp() gives the
+//  size of the buffer.
+class CodeBuffer : public std::streambuf {
+public:
+    CodeBuffer() {reset();}
+    ~CodeBuffer() override = default;
+    std::shared_ptr<std::string> get() const {return mBuffer;}
+    void reset() {mBuffer = std::make_shared<std::string>(); mBuffer->reserve(cInitialSize);}
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    int sync() override {return 0;}
+private:
+    static constexpr size_t      cInitialSize = 64*1024;
+    std::shared_ptr<std::string> mBuffer;
+};
+
+//
+//  The code writer is the output target of all Dump functions. It behaves like
+//  an std::ofstream, but keeps the generated content in memory. On close() the
+//  content is written in one piece and is kept for the merge stage in the model.
+//  Integer output is done with std::to_chars instead of the locale based formatting.
+class CodeWriter : public std::ostream {
+public:
+    CodeWriter();
+    explicit CodeWriter(const std::string& aFileName);
+    CodeWriter(const CodeWriter&) = delete;
+    CodeWriter& operator=(const CodeWriter&) = delete;
+    ~CodeWriter() override;
+
+    void open(const std::string& aFileName);
+    bool is_open() const {return mOpen;}
+    void close();
+    const std::string& filename() const {return mFileName;}
+    //
+    //  The buffer is shared with the generated files list of the model.
+    std::shared_ptr<std::string> buffer() const {return mBuf.get();}
+    //
+    //  Indentation helper. The strings are cached, so no filler must be created.
+    static const std::string& spaces(size_t aCount);
+    static const std::string& indent(int aLevel);
+    //
+    //  Indents every line of a block of generated code by aCount spaces.
+    static std::string shift(const std::string& aCode, size_t aCount);
+    //
+    //  Writes the label of a case at function level and keeps its position, so
+    //  the switch can be rebuilt without parsing the code.
+    static void caselabel(std::ostream& aOut, const std::string& aLabel, tCaseLabels& aCases);
+    static constexpr size_t cCaseSize = 11;   //  Length of a case line without its label.
+private:
+    CodeBuffer  mBuf;
+    std::string mFileName;
+    bool        mOpen = false;
+};
+
+#endif // CODEWRITER_H
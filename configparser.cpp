@@ -34,6 +34,9 @@ bool loadModelConfiguration(std::shared_ptr<MttXmlNode> docRoot) {
         if (!gDumpId.empty()) {
             gDumpStarted =false;
         }
+        for (auto & e : helper::tokenize(modelConfig->stringProperty("elements"), " \t,")) {
+            gDumpElements.insert(e);
+        }
     }
     std::shared_ptr<MttXmlNode> outputConfig = docRoot->findChild("output");
 
@@ -44,6 +47,8 @@ bool loadModelConfiguration(std::shared_ptr<MttXmlNode> docRoot) {
             dir.push_back('/');
             directory = dir;
         } 
+        gIncremental = outputConfig->boolProperty("incremental", gIncremental);
+        gIncludeReport = outputConfig->stringProperty("includereport", gIncludeReport);
     }
     success = true;
 
@@ -114,6 +119,7 @@ static bool loadCxxCodeStyle(std::shared_ptr<MttXmlNode> aCxxCodeStyle) {
 
         if (headerfiles) {
             gGenerateSelfContainedHeader = headerfiles->boolProperty("selfcontained", false);
+            gPreferForwards = headerfiles->boolProperty("preferforwards", false);
 
             if (gGenerateSelfContainedHeader) {
                 gUseSelfContainedHeaderInCPP = headerfiles->boolProperty("useincpp", false);
@@ -208,4 +214,20 @@ bool loadCxxGeneratorConfiguration(std::shared_ptr<MttXmlNode> docRoot) {
     return success;
 }
 
+bool loadBuildConfiguration(std::shared_ptr<MttXmlNode> docRoot) {
+    bool success = false;
+    std::shared_ptr<MttXmlNode> cmake = docRoot->findChild("cmake");
+
+    if (cmake) {
+        gUseCMake       = cmake->boolProperty("enabled", gUseCMake);
+        gUnityBatchSize = cmake->longProperty("unitybatch", gUnityBatchSize);
+        gPchHeaders     = cmake->longProperty("pchheaders", gPchHeaders);
+    }
+    std::shared_ptr<MttXmlNode> make = docRoot->findChild("gnu-make");
 
+    if (make) {
+        gBuildProfile = make->stringProperty("profile", gBuildProfile);
+    }
+    success = true;
+    return success;
+}
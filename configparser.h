@@ -26,6 +26,7 @@
 
 bool loadModelConfiguration(std::shared_ptr<MttXmlNode> docRoot);
 bool loadCxxGeneratorConfiguration(std::shared_ptr<MttXmlNode> docRoot);
+bool loadBuildConfiguration(std::shared_ptr<MttXmlNode> docRoot);
 
 
 #endif //XMI2CODE_CONFIGPARSER_H
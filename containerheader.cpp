@@ -0,0 +1,923 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <set>
+
+#include "main.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "containerheader.h"
+
+//
+//  The runtime is header-only so the generated packages do not need another
+//  library to link against.
+static const char* cContainerRuntime = R"RUNTIME(#pragma once
+#ifndef MTTCONTAINERS_INC
+#define MTTCONTAINERS_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+#include <map>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
+namespace mtt {
+//
+//  Sorted vector of key/value pairs. Lookup is a binary search on contiguous
+//  memory, insertion moves the tail.
+template <typename K, typename T>
+class flat_map {
+public:
+    using key_type       = K;
+    using mapped_type    = T;
+    using value_type     = std::pair<K, T>;
+    using iterator       = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    iterator begin() { return mData.begin(); }
+    iterator end() { return mData.end(); }
+    const_iterator begin() const { return mData.begin(); }
+    const_iterator end() const { return mData.end(); }
+    size_t size() const { return mData.size(); }
+    bool empty() const { return mData.empty(); }
+    void clear() { mData.clear(); }
+    void reserve(size_t aSize) { mData.reserve(aSize); }
+
+    iterator find(const K& aKey) {
+        auto i = lower(aKey);
+        return ((i != mData.end()) && !(aKey < i->first)) ? i : mData.end();
+    }
+    const_iterator find(const K& aKey) const {
+        auto i = std::lower_bound(mData.begin(), mData.end(), aKey, less);
+        return ((i != mData.end()) && !(aKey < i->first)) ? i : mData.end();
+    }
+    size_t count(const K& aKey) const { return (find(aKey) != end()) ? 1 : 0; }
+    T& operator[](const K& aKey) {
+        auto i = lower(aKey);
+        if ((i == mData.end()) || (aKey < i->first)) {
+            i = mData.emplace(i, aKey, T());
+        }
+        return i->second;
+    }
+    size_t erase(const K& aKey) {
+        auto i = find(aKey);
+        if (i == mData.end()) {
+            return 0;
+        }
+        mData.erase(i);
+        return 1;
+    }
+private:
+    static bool less(const value_type& aValue, const K& aKey) { return aValue.first < aKey; }
+    iterator lower(const K& aKey) { return std::lower_bound(mData.begin(), mData.end(), aKey, less); }
+private:
+    std::vector<value_type> mData;
+};
+
+//
+//  Vector that keeps up to N elements inline and only allocates beyond that.
+template <typename T, size_t N>
+class small_vector {
+public:
+    using value_type     = T;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    small_vector() = default;
+    small_vector(const small_vector& aOther) {
+        reserve(aOther.mSize);
+        for (auto const & v : aOther) {
+            push_back(v);
+        }
+    }
+    small_vector(small_vector&& aOther) noexcept {
+        take(std::move(aOther));
+    }
+    ~small_vector() {
+        clear();
+        release();
+    }
+    small_vector& operator=(const small_vector& aOther) {
+        if (this != &aOther) {
+            clear();
+            reserve(aOther.mSize);
+            for (auto const & v : aOther) {
+                push_back(v);
+            }
+        }
+        return *this;
+    }
+    small_vector& operator=(small_vector&& aOther) noexcept {
+        if (this != &aOther) {
+            clear();
+            release();
+            take(std::move(aOther));
+        }
+        return *this;
+    }
+    iterator begin() { return mData; }
+    iterator end() { return mData + mSize; }
+    const_iterator begin() const { return mData; }
+    const_iterator end() const { return mData + mSize; }
+    T* data() { return mData; }
+    size_t size() const { return mSize; }
+    size_t capacity() const { return mCapacity; }
+    bool empty() const { return (mSize == 0); }
+    T& operator[](size_t aIndex) { return mData[aIndex]; }
+    const T& operator[](size_t aIndex) const { return mData[aIndex]; }
+    T& back() { return mData[mSize-1]; }
+
+    void reserve(size_t aSize) {
+        if (aSize <= mCapacity) {
+            return;
+        }
+        T* storage = static_cast<T*>(::operator new(aSize * sizeof(T)));
+
+        for (size_t i = 0; i < mSize; ++i) {
+            new (storage + i) T(std::move(mData[i]));
+            mData[i].~T();
+        }
+        release();
+        mData     = storage;
+        mCapacity = aSize;
+    }
+    template <typename... A>
+    T& emplace_back(A&&... aArgs) {
+        if (mSize == mCapacity) {
+            T value(std::forward<A>(aArgs)...);
+
+            reserve(2 * mCapacity);
+            new (mData + mSize) T(std::move(value));
+        } else {
+            new (mData + mSize) T(std::forward<A>(aArgs)...);
+        }
+        return mData[mSize++];
+    }
+    void push_back(const T& aValue) { emplace_back(aValue); }
+    void push_back(T&& aValue) { emplace_back(std::move(aValue)); }
+    void pop_back() { mData[--mSize].~T(); }
+    void resize(size_t aSize) {
+        while (mSize > aSize) {
+            pop_back();
+        }
+        reserve(aSize);
+        while (mSize < aSize) {
+            emplace_back();
+        }
+    }
+    iterator erase(iterator aPos) {
+        std::move(aPos + 1, end(), aPos);
+        pop_back();
+        return aPos;
+    }
+    void clear() {
+        while (mSize > 0) {
+            pop_back();
+        }
+    }
+private:
+    T* local() { return reinterpret_cast<T*>(mLocal); }
+    void release() {
+        if (mData != local()) {
+            ::operator delete(mData);
+            mData     = local();
+            mCapacity = N;
+        }
+    }
+    void take(small_vector&& aOther) {
+        if (aOther.mData != aOther.local()) {
+            mData     = aOther.mData;
+            mSize     = aOther.mSize;
+            mCapacity = aOther.mCapacity;
+            aOther.mData     = aOther.local();
+            aOther.mSize     = 0;
+            aOther.mCapacity = N;
+        } else {
+            for (auto & v : aOther) {
+                new (mData + mSize++) T(std::move(v));
+            }
+            aOther.clear();
+        }
+    }
+private:
+    alignas(T) unsigned char mLocal[N * sizeof(T)];
+    T*                       mData     = reinterpret_cast<T*>(mLocal);
+    size_t                   mSize     = 0;
+    size_t                   mCapacity = N;
+};
+
+//
+//  Dense storage with stable handles. The handle keeps the slot in the lower
+//  and the generation in the upper 32 bits. Erasing moves the last element
+//  into the gap, so iteration stays on contiguous memory.
+template <typename T>
+class slot_map {
+public:
+    using handle_type    = uint64_t;
+    using value_type     = T;
+    using iterator       = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    iterator begin() { return mValues.begin(); }
+    iterator end() { return mValues.end(); }
+    const_iterator begin() const { return mValues.begin(); }
+    const_iterator end() const { return mValues.end(); }
+    size_t size() const { return mValues.size(); }
+    bool empty() const { return mValues.empty(); }
+    //
+    //  The handle of the element at a position of the dense storage.
+    handle_type handle(size_t aPos) const { return make(mBack[aPos]); }
+
+    handle_type insert(T aValue) {
+        uint32_t slot;
+
+        if (mFree.empty()) {
+            slot = static_cast<uint32_t>(mSlots.size());
+            mSlots.push_back(tSlot());
+        } else {
+            slot = mFree.back();
+            mFree.pop_back();
+        }
+        place(slot, std::move(aValue));
+        return make(slot);
+    }
+    T* find(handle_type aHandle) {
+        uint32_t slot = static_cast<uint32_t>(aHandle);
+
+        if ((slot >= mSlots.size()) || (mSlots[slot].index == cNone) ||
+            (mSlots[slot].generation != static_cast<uint32_t>(aHandle >> 32))) {
+            return nullptr;
+        }
+        return &mValues[mSlots[slot].index];
+    }
+    //
+    //  Access by handle. An unused handle is taken over, so values can be
+    //  restored with the handles they had before.
+    T& operator[](handle_type aHandle) {
+        T* value = find(aHandle);
+
+        if (value != nullptr) {
+            return *value;
+        }
+        uint32_t slot = static_cast<uint32_t>(aHandle);
+
+        while (mSlots.size() <= slot) {
+            mFree.push_back(static_cast<uint32_t>(mSlots.size()));
+            mSlots.push_back(tSlot());
+        }
+        if (mSlots[slot].index != cNone) {
+            erase(make(slot));
+        }
+        mFree.erase(std::find(mFree.begin(), mFree.end(), slot));
+        mSlots[slot].generation = static_cast<uint32_t>(aHandle >> 32);
+        place(slot, T());
+        return mValues.back();
+    }
+    size_t erase(handle_type aHandle) {
+        if (find(aHandle) == nullptr) {
+            return 0;
+        }
+        uint32_t slot = static_cast<uint32_t>(aHandle);
+        uint32_t pos  = mSlots[slot].index;
+
+        mValues[pos] = std::move(mValues.back());
+        mBack[pos]   = mBack.back();
+        mSlots[mBack[pos]].index = pos;
+        mValues.pop_back();
+        mBack.pop_back();
+        mSlots[slot].index = cNone;
+        mSlots[slot].generation++;
+        mFree.push_back(slot);
+        return 1;
+    }
+private:
+    static constexpr uint32_t cNone = 0xffffffff;
+    struct tSlot {
+        uint32_t index      = cNone;
+        uint32_t generation = 0;
+    };
+    handle_type make(uint32_t aSlot) const {
+        return (static_cast<handle_type>(mSlots[aSlot].generation) << 32) | aSlot;
+    }
+    void place(uint32_t aSlot, T&& aValue) {
+        mSlots[aSlot].index = static_cast<uint32_t>(mValues.size());
+        mValues.push_back(std::move(aValue));
+        mBack.push_back(aSlot);
+    }
+private:
+    std::vector<T>        mValues;
+    std::vector<uint32_t> mBack;
+    std::vector<tSlot>    mSlots;
+    std::vector<uint32_t> mFree;
+};
+
+//
+//  Map split into S shards, each with its own reader/writer lock. Readers of
+//  different keys do not block each other and readers of the same shard
+//  only wait for writers. No references are handed out, elements are
+//  changed through set(), update() or a locked reference.
+template <typename K, typename T, size_t S = 8>
+class sharded_map {
+    struct tShard;
+public:
+    using key_type    = K;
+    using mapped_type = T;
+    //
+    //  Holds the write lock of the shard for as long as it lives. Used as a
+    //  temporary it locks the element for one full expression.
+    class locked_ref {
+    public:
+        locked_ref(tShard& aShard, const K& aKey) : mLock(aShard.lock), mValue(aShard.data[aKey]) {}
+        locked_ref(const locked_ref&) = delete;
+        locked_ref& operator=(const locked_ref&) = delete;
+        T& operator*() const { return mValue; }
+        T* operator->() const { return &mValue; }
+    private:
+        std::unique_lock<std::shared_mutex> mLock;
+        T&                                  mValue;
+    };
+
+    sharded_map() = default;
+    sharded_map(const sharded_map& aOther) { assign(aOther); }
+    sharded_map& operator=(const sharded_map& aOther) {
+        if (this != &aOther) {
+            assign(aOther);
+        }
+        return *this;
+    }
+    bool get(const K& aKey, T& aValue) const {
+        auto const &                        s = shard(aKey);
+        std::shared_lock<std::shared_mutex> lock(s.lock);
+        auto                                i = s.data.find(aKey);
+
+        if (i == s.data.end()) {
+            return false;
+        }
+        aValue = i->second;
+        return true;
+    }
+    T get(const K& aKey) const {
+        T value{};
+
+        get(aKey, value);
+        return value;
+    }
+    void set(const K& aKey, T aValue) {
+        auto &                              s = shard(aKey);
+        std::unique_lock<std::shared_mutex> lock(s.lock);
+
+        s.data[aKey] = std::move(aValue);
+    }
+    //
+    //  Changes the element in place under the write lock of its shard.
+    template <typename F>
+    void update(const K& aKey, F aFunction) {
+        auto &                              s = shard(aKey);
+        std::unique_lock<std::shared_mutex> lock(s.lock);
+
+        aFunction(s.data[aKey]);
+    }
+    locked_ref locked(const K& aKey) { return locked_ref(shard(aKey), aKey); }
+    size_t erase(const K& aKey) {
+        auto &                              s = shard(aKey);
+        std::unique_lock<std::shared_mutex> lock(s.lock);
+
+        return s.data.erase(aKey);
+    }
+    size_t count(const K& aKey) const {
+        auto const &                        s = shard(aKey);
+        std::shared_lock<std::shared_mutex> lock(s.lock);
+
+        return s.data.count(aKey);
+    }
+    size_t size() const {
+        size_t retval = 0;
+
+        for (auto const & s : mShards) {
+            std::shared_lock<std::shared_mutex> lock(s.lock);
+
+            retval += s.data.size();
+        }
+        return retval;
+    }
+    //
+    //  Each shard is visited under its read lock.
+    template <typename F>
+    void for_each(F aFunction) const {
+        for (auto const & s : mShards) {
+            std::shared_lock<std::shared_mutex> lock(s.lock);
+
+            for (auto const & e : s.data) {
+                aFunction(e.first, e.second);
+            }
+        }
+    }
+    std::vector<std::pair<K, T>> snapshot() const {
+        std::vector<std::pair<K, T>> retval;
+
+        for_each([&retval](const K& aKey, const T& aValue) { retval.emplace_back(aKey, aValue); });
+        return retval;
+    }
+private:
+    struct alignas(64) tShard {
+        mutable std::shared_mutex lock;
+        std::map<K, T>            data;
+    };
+    tShard& shard(const K& aKey) { return mShards[std::hash<K>()(aKey) % S]; }
+    const tShard& shard(const K& aKey) const { return mShards[std::hash<K>()(aKey) % S]; }
+    void assign(const sharded_map& aOther) {
+        for (size_t i = 0; i < S; ++i) {
+            std::shared_lock<std::shared_mutex> src(aOther.mShards[i].lock);
+            std::unique_lock<std::shared_mutex> dst(mShards[i].lock);
+
+            mShards[i].data = aOther.mShards[i].data;
+        }
+    }
+private:
+    std::array<tShard, S> mShards;
+};
+
+//
+//  Copy-on-write map. Readers take the current snapshot without any lock,
+//  writers copy it, apply the change and publish the new one. An old
+//  snapshot is released when its last reader drops it. Best for maps that
+//  are read far more often than written.
+template <typename K, typename T>
+class snapshot_map {
+public:
+    using key_type    = K;
+    using mapped_type = T;
+    using map_type    = std::map<K, T>;
+    //
+    //  Holds the writer lock and a private copy of the map. The copy is
+    //  published when the reference goes away.
+    class locked_ref {
+    public:
+        locked_ref(snapshot_map& aMap, const K& aKey) :
+            mMap(aMap), mLock(aMap.mWrite), mNext(std::make_shared<map_type>(*aMap.load())), mValue((*mNext)[aKey]) {}
+        ~locked_ref() { std::atomic_store(&mMap.mData, std::shared_ptr<const map_type>(std::move(mNext))); }
+        locked_ref(const locked_ref&) = delete;
+        locked_ref& operator=(const locked_ref&) = delete;
+        T& operator*() const { return mValue; }
+        T* operator->() const { return &mValue; }
+    private:
+        snapshot_map&               mMap;
+        std::lock_guard<std::mutex> mLock;
+        std::shared_ptr<map_type>   mNext;
+        T&                          mValue;
+    };
+
+    snapshot_map() : mData(std::make_shared<const map_type>()) {}
+    snapshot_map(const snapshot_map& aOther) : mData(aOther.load()) {}
+    snapshot_map& operator=(const snapshot_map& aOther) {
+        if (this != &aOther) {
+            std::lock_guard<std::mutex> lock(mWrite);
+
+            std::atomic_store(&mData, aOther.load());
+        }
+        return *this;
+    }
+    std::shared_ptr<const map_type> load() const { return std::atomic_load(&mData); }
+
+    bool get(const K& aKey, T& aValue) const {
+        auto data = load();
+        auto i    = data->find(aKey);
+
+        if (i == data->end()) {
+            return false;
+        }
+        aValue = i->second;
+        return true;
+    }
+    T get(const K& aKey) const {
+        T value{};
+
+        get(aKey, value);
+        return value;
+    }
+    void set(const K& aKey, T aValue) {
+        update([&](map_type& aMap) { aMap[aKey] = std::move(aValue); });
+    }
+    size_t erase(const K& aKey) {
+        size_t retval = 0;
+
+        update([&](map_type& aMap) { retval = aMap.erase(aKey); });
+        return retval;
+    }
+    size_t count(const K& aKey) const { return load()->count(aKey); }
+    size_t size() const { return load()->size(); }
+    //
+    //  Applies a change to a private copy and publishes it.
+    template <typename F>
+    void update(F aFunction) {
+        std::lock_guard<std::mutex> lock(mWrite);
+        auto                        next = std::make_shared<map_type>(*load());
+
+        aFunction(*next);
+        std::atomic_store(&mData, std::shared_ptr<const map_type>(std::move(next)));
+    }
+    template <typename F>
+    void update(const K& aKey, F aFunction) {
+        update([&](map_type& aMap) { aFunction(aMap[aKey]); });
+    }
+    locked_ref locked(const K& aKey) { return locked_ref(*this, aKey); }
+    template <typename F>
+    void for_each(F aFunction) const {
+        auto data = load();
+
+        for (auto const & e : *data) {
+            aFunction(e.first, e.second);
+        }
+    }
+    std::vector<std::pair<K, T>> snapshot() const {
+        auto data = load();
+
+        return std::vector<std::pair<K, T>>(data->begin(), data->end());
+    }
+private:
+    std::shared_ptr<const map_type> mData;
+    std::mutex                      mWrite;
+};
+
+//
+//  Open addressing hash map with linear probing. The slots are one flat
+//  array, so a lookup usually touches a single cache line. Erase shifts the
+//  following entries back, no tombstones are needed.
+template <typename K, typename T, typename H = std::hash<K>>
+class flat_hash_map {
+    struct tSlot {
+        bool                      used = false;
+        std::pair<K, T>           value;
+    };
+public:
+    using key_type    = K;
+    using mapped_type = T;
+    using value_type  = std::pair<K, T>;
+
+    class iterator {
+    public:
+        iterator() = default;
+        iterator(tSlot* aSlot, tSlot* aEnd) : mSlot(aSlot), mEnd(aEnd) { skip(); }
+        value_type& operator*() const { return mSlot->value; }
+        value_type* operator->() const { return &mSlot->value; }
+        iterator& operator++() { ++mSlot; skip(); return *this; }
+        bool operator==(const iterator& aOther) const { return (mSlot == aOther.mSlot); }
+        bool operator!=(const iterator& aOther) const { return (mSlot != aOther.mSlot); }
+    private:
+        void skip() {
+            while ((mSlot != mEnd) && (!mSlot->used)) {
+                ++mSlot;
+            }
+        }
+    private:
+        tSlot* mSlot = nullptr;
+        tSlot* mEnd  = nullptr;
+    };
+
+    iterator begin() { return iterator(mSlots.data(), mSlots.data() + mSlots.size()); }
+    iterator end() { return iterator(mSlots.data() + mSlots.size(), mSlots.data() + mSlots.size()); }
+    size_t size() const { return mSize; }
+    bool empty() const { return (mSize == 0); }
+    void clear() { mSlots.clear(); mSize = 0; }
+
+    iterator find(const K& aKey) {
+        if (mSize == 0) {
+            return end();
+        }
+        for (size_t i = index(aKey); mSlots[i].used; i = (i + 1) & mask()) {
+            if (mSlots[i].value.first == aKey) {
+                return at(i);
+            }
+        }
+        return end();
+    }
+    size_t count(const K& aKey) { return (find(aKey) != end()) ? 1 : 0; }
+    std::pair<iterator, bool> insert(const value_type& aValue) {
+        grow();
+        size_t i = index(aValue.first);
+
+        for (; mSlots[i].used; i = (i + 1) & mask()) {
+            if (mSlots[i].value.first == aValue.first) {
+                return {at(i), false};
+            }
+        }
+        mSlots[i].used  = true;
+        mSlots[i].value = aValue;
+        ++mSize;
+        return {at(i), true};
+    }
+    T& operator[](const K& aKey) { return insert(value_type(aKey, T())).first->second; }
+    size_t erase(const K& aKey) {
+        if (mSize == 0) {
+            return 0;
+        }
+        size_t i = index(aKey);
+
+        for (; mSlots[i].used; i = (i + 1) & mask()) {
+            if (mSlots[i].value.first == aKey) {
+                break;
+            }
+        }
+        if (!mSlots[i].used) {
+            return 0;
+        }
+        //
+        //  Move back the entries that would not be found anymore behind the gap.
+        for (size_t j = (i + 1) & mask(); mSlots[j].used; j = (j + 1) & mask()) {
+            size_t home = index(mSlots[j].value.first);
+
+            if (((j - home) & mask()) >= ((j - i) & mask())) {
+                mSlots[i].value = std::move(mSlots[j].value);
+                i = j;
+            }
+        }
+        mSlots[i].used  = false;
+        mSlots[i].value = value_type();
+        --mSize;
+        return 1;
+    }
+private:
+    size_t mask() const { return mSlots.size() - 1; }
+    size_t index(const K& aKey) const {
+        uint64_t h = static_cast<uint64_t>(H()(aKey)) * 0x9e3779b97f4a7c15ull;
+
+        return static_cast<size_t>(h ^ (h >> 32)) & mask();
+    }
+    iterator at(size_t aIndex) { return iterator(mSlots.data() + aIndex, mSlots.data() + mSlots.size()); }
+    //
+    //  Keep the load below 3/4.
+    void grow() {
+        if (4 * (mSize + 1) <= 3 * mSlots.size()) {
+            return;
+        }
+        std::vector<tSlot> old(std::max<size_t>(16, 2 * mSlots.size()));
+
+        old.swap(mSlots);
+        mSize = 0;
+        for (auto & s : old) {
+            if (s.used) {
+                insert(std::move(s.value));
+            }
+        }
+    }
+private:
+    std::vector<tSlot> mSlots;
+    size_t             mSize = 0;
+};
+
+//
+//  Fixed size allocator for the objects of one size and alignment. Memory is
+//  taken from the system in pages of P blocks and kept for reuse. Freed blocks
+//  go to a per thread cache first, so most allocations take no lock. Full
+//  caches give half of their blocks back to the shared free list.
+template <size_t Size, size_t Align, size_t P = 256>
+class object_pool {
+    struct tBlock {
+        tBlock* next;
+    };
+    static constexpr size_t cAlign = (Align > alignof(tBlock)) ? Align : alignof(tBlock);
+    static constexpr size_t cSize  = ((((Size > sizeof(tBlock)) ? Size : sizeof(tBlock)) + cAlign - 1) / cAlign) * cAlign;
+    static constexpr size_t cCache = 64;
+
+    struct tShared {
+        std::mutex         lock;
+        tBlock*            free = nullptr;
+        std::vector<void*> pages;
+        ~tShared() {
+            for (auto p : pages) {
+                ::operator delete(p, std::align_val_t(cAlign));
+            }
+        }
+    };
+    struct tCache {
+        tBlock* free  = nullptr;
+        size_t  count = 0;
+        tCache() { shared(); }
+        ~tCache() {
+            std::lock_guard<std::mutex> lock(shared().lock);
+
+            while (free != nullptr) {
+                tBlock* b = free;
+
+                free = b->next;
+                b->next = shared().free;
+                shared().free = b;
+            }
+        }
+    };
+public:
+    static void* allocate() {
+        tCache& c = cache();
+
+        if (c.free == nullptr) {
+            refill(c);
+        }
+        tBlock* b = c.free;
+
+        c.free = b->next;
+        --c.count;
+        return b;
+    }
+    static void deallocate(void* aPtr) {
+        tCache& c = cache();
+        tBlock* b = static_cast<tBlock*>(aPtr);
+
+        b->next = c.free;
+        c.free  = b;
+        if (++c.count > 2 * cCache) {
+            std::lock_guard<std::mutex> lock(shared().lock);
+
+            while (c.count > cCache) {
+                b       = c.free;
+                c.free  = b->next;
+                b->next = shared().free;
+                shared().free = b;
+                --c.count;
+            }
+        }
+    }
+private:
+    static tShared& shared() {
+        static tShared s;
+        return s;
+    }
+    static tCache& cache() {
+        thread_local tCache c;
+        return c;
+    }
+    static void refill(tCache& aCache) {
+        tShared&                    s = shared();
+        std::lock_guard<std::mutex> lock(s.lock);
+
+        if (s.free == nullptr) {
+            char* page = static_cast<char*>(::operator new(P * cSize, std::align_val_t(cAlign)));
+
+            s.pages.push_back(page);
+            for (size_t i = P; i > 0; --i) {
+                tBlock* b = reinterpret_cast<tBlock*>(page + (i - 1) * cSize);
+
+                b->next = s.free;
+                s.free  = b;
+            }
+        }
+        while ((s.free != nullptr) && (aCache.count < cCache)) {
+            tBlock* b = s.free;
+
+            s.free       = b->next;
+            b->next      = aCache.free;
+            aCache.free  = b;
+            ++aCache.count;
+        }
+    }
+};
+
+//
+//  Access by index. The sequences grow to the index so positions stay the
+//  index used at the interface. The maps insert on first access.
+template <typename C, typename K>
+auto& at(C& aContainer, const K& aIndex) { return aContainer[aIndex]; }
+template <typename T, typename A, typename K>
+T& at(std::vector<T, A>& aContainer, const K& aIndex) {
+    size_t index = static_cast<size_t>(aIndex);
+    if (index >= aContainer.size()) {
+        aContainer.resize(index + 1);
+    }
+    return aContainer[index];
+}
+template <typename T, size_t N, typename K>
+T& at(small_vector<T, N>& aContainer, const K& aIndex) {
+    size_t index = static_cast<size_t>(aIndex);
+    if (index >= aContainer.size()) {
+        aContainer.resize(index + 1);
+    }
+    return aContainer[index];
+}
+//
+//  Removing from a sequence only resets the element, the positions of the
+//  following elements stay valid.
+template <typename C, typename K>
+void remove(C& aContainer, const K& aIndex) { aContainer.erase(aIndex); }
+template <typename T, typename A, typename K>
+void remove(std::vector<T, A>& aContainer, const K& aIndex) {
+    if (static_cast<size_t>(aIndex) < aContainer.size()) {
+        aContainer[static_cast<size_t>(aIndex)] = T();
+    }
+}
+template <typename T, size_t N, typename K>
+void remove(small_vector<T, N>& aContainer, const K& aIndex) {
+    if (static_cast<size_t>(aIndex) < aContainer.size()) {
+        aContainer[static_cast<size_t>(aIndex)] = T();
+    }
+}
+//
+//  Append at the end. Maps use the next free index as key.
+template <typename C>
+void append(C& aContainer, const typename C::mapped_type& aValue) { aContainer[aContainer.size()] = aValue; }
+template <typename T, typename A>
+void append(std::vector<T, A>& aContainer, const T& aValue) { aContainer.push_back(aValue); }
+template <typename T, size_t N>
+void append(small_vector<T, N>& aContainer, const T& aValue) { aContainer.push_back(aValue); }
+template <typename T>
+void append(slot_map<T>& aContainer, const T& aValue) { aContainer.insert(aValue); }
+template <typename K, typename T, size_t S>
+void append(sharded_map<K, T, S>& aContainer, const T& aValue) { aContainer.set(aContainer.size(), aValue); }
+template <typename K, typename T>
+void append(snapshot_map<K, T>& aContainer, const T& aValue) {
+    aContainer.update([&aValue](std::map<K, T>& aMap) { aMap[aMap.size()] = aValue; });
+}
+//
+//  The value of an element seen while iterating.
+template <typename T>
+T& value(T& aValue) { return aValue; }
+template <typename T>
+const T& value(const T& aValue) { return aValue; }
+template <typename K, typename T>
+T& value(std::pair<K, T>& aValue) { return aValue.second; }
+template <typename K, typename T>
+const T& value(const std::pair<K, T>& aValue) { return aValue.second; }
+//
+//  Iteration with index and value like on a map.
+template <typename C>
+uint64_t key_at(const C&, size_t aPos) { return aPos; }
+template <typename T>
+uint64_t key_at(const slot_map<T>& aContainer, size_t aPos) { return aContainer.handle(aPos); }
+
+template <typename C>
+class indexed_range {
+    using base = decltype(std::declval<C&>().begin());
+public:
+    class iterator {
+    public:
+        iterator(C& aContainer, base aIter, size_t aPos) : mContainer(aContainer), mIter(aIter), mPos(aPos) {}
+        std::pair<uint64_t, decltype(*std::declval<base>())> operator*() const { return {key_at(mContainer, mPos), *mIter}; }
+        iterator& operator++() { ++mIter; ++mPos; return *this; }
+        bool operator!=(const iterator& aOther) const { return (mIter != aOther.mIter); }
+    private:
+        C&     mContainer;
+        base   mIter;
+        size_t mPos;
+    };
+    explicit indexed_range(C& aContainer) : mContainer(aContainer) {}
+    iterator begin() { return iterator(mContainer, mContainer.begin(), 0); }
+    iterator end() { return iterator(mContainer, mContainer.end(), mContainer.size()); }
+private:
+    C& mContainer;
+};
+
+template <typename C>
+C& indexed(C& aContainer) { return aContainer; }
+template <typename T, typename A>
+indexed_range<std::vector<T, A>> indexed(std::vector<T, A>& aContainer) { return indexed_range<std::vector<T, A>>(aContainer); }
+template <typename T, size_t N>
+indexed_range<small_vector<T, N>> indexed(small_vector<T, N>& aContainer) { return indexed_range<small_vector<T, N>>(aContainer); }
+template <typename T>
+indexed_range<slot_map<T>> indexed(slot_map<T>& aContainer) { return indexed_range<slot_map<T>>(aContainer); }
+//
+//  The concurrent maps are iterated on a copy.
+template <typename K, typename T, size_t S>
+std::vector<std::pair<K, T>> indexed(sharded_map<K, T, S>& aContainer) { return aContainer.snapshot(); }
+template <typename K, typename T>
+std::vector<std::pair<K, T>> indexed(snapshot_map<K, T>& aContainer) { return aContainer.snapshot(); }
+} // namespace - mtt
+
+#endif  // MTTCONTAINERS_INC
+)RUNTIME";
+
+void ContainerHeader::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "c-inc", header.buffer()});
+        header << cContainerRuntime;
+        header.close();
+    }
+}
@@ -0,0 +1,41 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef CONTAINERHEADER_H
+#define CONTAINERHEADER_H
+
+#include <string>
+#include <memory>
+
+class CModel;
+
+//
+//  The container header holds the runtime part of the container policies of
+//  the association ends and the object pools of the sim objects. It is
+//  generated once per output directory as mttcontainers.h and is included by
+//  the classes that use one of them.
+class ContainerHeader {
+public:
+    static std::string Name(void) { return "mttcontainers.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+private:
+    ContainerHeader() = default;
+};
+
+#endif // CONTAINERHEADER_H
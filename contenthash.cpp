@@ -0,0 +1,405 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <charconv>
+
+#include "main.h"
+#include "crc64.h"
+#include "contenthash.h"
+
+#include "mclass.h"
+#include "mattribute.h"
+#include "moperation.h"
+#include "mparameter.h"
+#include "massociation.h"
+#include "massociationend.h"
+#include "mgeneralization.h"
+#include "mdependency.h"
+#include "mmessage.h"
+#include "mstatemachine.h"
+#include "mstate.h"
+#include "mpseudostate.h"
+#include "mtransition.h"
+#include "mevent.h"
+#include "mnode.h"
+#include "medge.h"
+#include "mactionnode.h"
+#include "mactivity.h"
+#include "minteraction.h"
+
+std::map<std::string, ContentHash::tOwn> ContentHash::mOwn;
+
+//
+//  The classes referenced by the element are walked breadth first. The order
+//  of the references is fixed by the model, so is the order of the walk.
+std::string ContentHash::of(std::shared_ptr<MElement> aElement) {
+    ContentHash                            hash;
+    Crc64                                  crc;
+    char                                   hex[16];
+    std::set<std::string>                  visited = {aElement->id};
+    std::vector<std::shared_ptr<MElement>> todo    = {aElement};
+    //
+    //  The generator itself and its configuration are part of every hash.
+    hash.add(gGenerationSeed);
+    for (size_t i = 0; i < todo.size(); ++i) {
+        const tOwn& o = own(todo[i]);
+
+        hash.add(todo[i]->id);
+        hash.add(static_cast<int64_t>(o.crc));
+        for (auto & r : o.refs) {
+            if (visited.insert(r->id).second) {
+                todo.push_back(r);
+            }
+        }
+    }
+
+    auto result = std::to_chars(hex, hex + sizeof(hex), crc.calc(hash.mData), 16);
+
+    return std::string(hex, result.ptr);
+}
+
+//
+//  The own hash of an element only changes with the model, so it is computed
+//  once per run.
+const ContentHash::tOwn& ContentHash::own(std::shared_ptr<MElement> aElement) {
+    auto found = mOwn.find(aElement->id);
+
+    if (found != mOwn.end()) {
+        return found->second;
+    }
+    ContentHash hash;
+    Crc64       crc;
+    tOwn        result;
+
+    hash.addElement(MElementRef(aElement));
+    //
+    //  Tagged values like the container policy are looked up in the enclosing
+    //  packages. So their tags are part of the hash as well.
+    for (auto p = aElement->parent; p; p = p->parent) {
+        hash.add(p->id);
+        hash.addTags(*p);
+    }
+    result.crc  = crc.calc(hash.mData);
+    result.refs = std::move(hash.mRefs);
+
+    return mOwn.emplace(aElement->id, std::move(result)).first->second;
+}
+
+void ContentHash::add(const std::string& aValue) {
+    //
+    //  The length prefix keeps "ab","c" apart from "a","bc".
+    add(static_cast<int64_t>(aValue.size()));
+    mData += aValue;
+}
+
+void ContentHash::add(int64_t aValue) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), aValue);
+
+    mData.append(buffer, result.ptr);
+    mData.push_back(';');
+}
+
+//
+//  For referenced elements the identity is part of the own hash. The content
+//  of referenced classes is added by of() through their own hashes, unless
+//  aFollow is false.
+void ContentHash::addRef(const MElementRef& aRef, bool aFollow) {
+    if (aRef) {
+        add(static_cast<int64_t>(aRef->type));
+        add(aRef->FQN());
+        if ((aFollow) && (aRef->IsClassBased())) {
+            mRefs.push_back(*aRef);
+        }
+    } else {
+        add(aRef.mId);
+    }
+}
+
+//
+//  Members of structs, unions and enumerations are expanded into the classes
+//  that use them. So for those the content is part of the hash.
+void ContentHash::addValueType(const MElementRef& aRef) {
+    if (aRef) {
+        switch (aRef->type) {
+        case eElementType::Struct:
+        case eElementType::Union:
+        case eElementType::Enumeration:
+        case eElementType::SimStruct:
+        case eElementType::SimEnumeration:
+            addElement(aRef);
+            return;
+        default:
+            break;
+        }
+    }
+    addRef(aRef);
+}
+
+void ContentHash::addConnector(tConnector<MElement, MElement>& aConnector) {
+    if (aConnector.getConnector()) {
+        add(static_cast<int64_t>(aConnector.getConnector()->type));
+    }
+    if (aConnector.getElement()) {
+        addRef(MElementRef(aConnector.getElement()));
+    }
+}
+
+void ContentHash::addTags(std::shared_ptr<MElement> aElement) {
+    for (auto & t : aElement->tags) {
+        add(t.first);
+        add(t.second);
+    }
+    for (auto & s : aElement->stereotypes) {
+        add(s.first);
+    }
+}
+
+void ContentHash::addCommon(std::shared_ptr<MElement> aElement) {
+    add(static_cast<int64_t>(aElement->type));
+    add(aElement->id);
+    add(aElement->name);
+    add(aElement->comment);
+    add(static_cast<int64_t>(aElement->visibility));
+    add(aElement->mAlias);
+    add(aElement->mPosition);
+    //
+    //  Some modelers provide the modification date. Use it if it is there.
+    add(aElement->mModificationDate);
+    addTags(aElement);
+    for (auto s : aElement->Supplier) {
+        addConnector(s);
+    }
+    for (auto c : aElement->Client) {
+        addConnector(c);
+    }
+}
+
+void ContentHash::addClass(std::shared_ptr<MElement> aElement) {
+    auto c = std::dynamic_pointer_cast<MClass>(aElement);
+
+    add(c->mIsInterface);
+    add(c->mIsFinal);
+    add(c->getTypeName());
+    add(c->mNameSpace.getString());
+    for (auto & p : c->mClassParameter) {
+        add(p.first);
+        addElement(MElementRef(p.second));
+    }
+    for (auto & a : c->Attribute) {
+        addElement(a);
+    }
+    for (auto & o : c->Operation) {
+        addElement(o);
+    }
+    for (auto & e : c->OwnEnd) {
+        addElement(e);
+    }
+    for (auto & e : c->OtherEnd) {
+        addElement(e);
+    }
+    for (auto & g : c->Generalization) {
+        addElement(g);
+    }
+    for (auto & b : c->mSuperClass) {
+        addElement(b);
+    }
+    //
+    //  The derived classes do not change the output of their base.
+    for (auto & d : c->mSubClass) {
+        addRef(d, false);
+    }
+    for (auto & d : c->Dependency) {
+        addElement(d);
+    }
+    for (auto & m : c->Incoming) {
+        addElement(m);
+    }
+    for (auto & m : c->Outgoing) {
+        addElement(m);
+    }
+    for (auto & a : c->Activity) {
+        addElement(a);
+    }
+    for (auto & i : c->mInteraction) {
+        addElement(i);
+    }
+    addElement(c->statemachine);
+}
+
+void ContentHash::addElement(const MElementRef& aRef) {
+    if (!aRef) {
+        add(aRef.mId);
+        return;
+    }
+    auto e = *aRef;
+    //
+    //  Elements reached more than once only add their id.
+    if (!mVisited.insert(e->id).second) {
+        add(e->id);
+        return;
+    }
+    addCommon(e);
+
+    if (std::dynamic_pointer_cast<MClass>(e)) {
+        addClass(e);
+    } else if (auto a = std::dynamic_pointer_cast<MAttribute>(e)) {
+        addValueType(a->Classifier);
+        add(a->ClassifierName);
+        add(a->isStatic);
+        add(a->isReadOnly);
+        add(a->isDerived);
+        add(a->Aggregation);
+        add(a->Multiplicity);
+        add(a->defaultValue);
+    } else if (auto o = std::dynamic_pointer_cast<MOperation>(e)) {
+        add(o->isStatic);
+        add(o->isAbstract);
+        add(o->isQuery);
+        add(o->isPure);
+        add(o->hasConstReturn);
+        add(o->Specification);
+        addRef(o->mException);
+        for (auto & p : o->Parameter) {
+            addElement(p);
+        }
+        addElement(o->Activity);
+    } else if (auto p = std::dynamic_pointer_cast<MParameter>(e)) {
+        add(p->defaultValue);
+        add(p->Multiplicity);
+        add(p->Direction);
+        add(p->isReadOnly);
+        add(p->isLeaf);
+        add(p->ClassifierName);
+        addRef(p->Classifier);
+        addRef(p->mActual);
+        addRef(p->mFormal);
+    } else if (auto ae = std::dynamic_pointer_cast<MAssociationEnd>(e)) {
+        addRef(ae->Classifier);
+        add(ae->Aggregation);
+        add(ae->Multiplicity);
+        add(static_cast<int64_t>(ae->Navigable));
+        add(ae->mQualifier);
+        add(ae->defaultValue);
+        addElement(ae->parent);
+    } else if (auto as = std::dynamic_pointer_cast<MAssociation>(e)) {
+        for (auto & end : as->ends) {
+            addElement(end);
+        }
+    } else if (auto g = std::dynamic_pointer_cast<MGeneralization>(e)) {
+        add(g->mIsRealization);
+        for (auto & t : g->mTemplateParameter) {
+            add(t.first);
+            addRef(t.second);
+        }
+        addElement(g->base);
+    } else if (auto d = std::dynamic_pointer_cast<MDependency>(e)) {
+        addRef(d->src);
+        addRef(d->target);
+    } else if (auto m = std::dynamic_pointer_cast<MMessage>(e)) {
+        add(static_cast<int64_t>(m->mtype));
+        add(m->m_guard);
+        add(m->isConcurrent);
+    } else if (auto sm = std::dynamic_pointer_cast<MStatemachine>(e)) {
+        for (auto & s : sm->states) {
+            addElement(s);
+        }
+        for (auto & t : sm->transitions) {
+            addElement(t);
+        }
+    } else if (auto s = std::dynamic_pointer_cast<MState>(e)) {
+        if (auto ps = std::dynamic_pointer_cast<MPseudoState>(e)) {
+            add(ps->kind);
+        }
+        addRef(s->shallowHistory);
+        for (auto & sub : s->States) {
+            addElement(sub);
+        }
+        for (auto & t : s->Transitions) {
+            addElement(t);
+        }
+        for (auto & act : s->DoActions) {
+            addElement(act);
+        }
+        for (auto & act : s->EntryActions) {
+            addElement(act);
+        }
+        for (auto & act : s->ExitActions) {
+            addElement(act);
+        }
+    } else if (auto t = std::dynamic_pointer_cast<MTransition>(e)) {
+        add(t->kind);
+        add(t->guard);
+        addRef(t->from);
+        addRef(t->to);
+        for (auto & ev : t->events) {
+            addElement(ev);
+        }
+        for (auto & act : t->actions) {
+            addElement(act);
+        }
+    } else if (auto ev = std::dynamic_pointer_cast<MEvent>(e)) {
+        add(ev->kind);
+    } else if (auto ed = std::dynamic_pointer_cast<MEdge>(e)) {
+        addRef(ed->Source);
+        addRef(ed->Target);
+        add(ed->Guard);
+        add(ed->Weight);
+    } else if (auto n = std::dynamic_pointer_cast<MNode>(e)) {
+        addRef(n->Target);
+        for (auto & pin : n->InputPins) {
+            addElement(pin);
+        }
+        for (auto & pin : n->OutputPins) {
+            addElement(pin);
+        }
+        if (auto an = std::dynamic_pointer_cast<MActionNode>(e)) {
+            add(static_cast<int64_t>(an->Kind));
+            addRef(an->Sub);
+            add(an->isLocallyReentrant);
+            add(an->isSynchronous);
+            add(an->Language);
+            add(an->Body);
+        }
+        if (auto act = std::dynamic_pointer_cast<MActivity>(e)) {
+            add(act->isReadOnly);
+            add(act->isReentrant);
+            add(act->isSingleExecution);
+            for (auto & node : act->Nodes) {
+                addElement(node);
+            }
+            for (auto & edge : act->Edges) {
+                addElement(edge);
+            }
+        }
+    } else if (auto in = std::dynamic_pointer_cast<MInteraction>(e)) {
+        for (auto & l : in->lifelines) {
+            addElement(l);
+        }
+        for (auto & m : in->messages) {
+            addElement(m);
+        }
+    }
+    for (auto & o : e->owned) {
+        addElement(o);
+    }
+    for (auto & c : e->mCollaboration) {
+        addElement(c);
+    }
+}
@@ -0,0 +1,70 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <string>
+#include <set>
+#include <map>
+#include <vector>
+#include <memory>
+
+#include "melement.h"
+
+//
+//  The content hash is a fingerprint of the model subgraph that influences the
+//  output of a single element. It covers the element itself, its attributes,
+//  operations, association ends, behaviour, stereotypes and tagged values and the
+//  FQNs of all referenced types. Base classes are followed completely. The tags
+//  of the enclosing packages are included as they are inherited.
+//  The output of an element also depends on the content of the classes it
+//  references, e.g. their serialized size or the headers they need. So the
+//  hash of an element combines its own hash with the own hashes of all
+//  classes it references directly or indirectly.
+//  Two runs on an unchanged subgraph give the same hash.
+class ContentHash {
+public:
+    static std::string of(std::shared_ptr<MElement> aElement);
+private:
+    //
+    //  The own hash of an element and the classes it references.
+    struct tOwn {
+        uint64_t                               crc = 0;
+        std::vector<std::shared_ptr<MElement>> refs;
+    };
+    ContentHash() = default;
+    static const tOwn& own(std::shared_ptr<MElement> aElement);
+    void add(const std::string& aValue);
+    void add(int64_t aValue);
+    void addRef(const MElementRef& aRef, bool aFollow = true);
+    void addValueType(const MElementRef& aRef);
+    void addConnector(tConnector<MElement, MElement>& aConnector);
+    void addTags(std::shared_ptr<MElement> aElement);
+    void addCommon(std::shared_ptr<MElement> aElement);
+    void addClass(std::shared_ptr<MElement> aElement);
+    void addElement(const MElementRef& aRef);
+private:
+    std::string                            mData;
+    std::set<std::string>                  mVisited;
+    std::vector<std::shared_ptr<MElement>> mRefs;
+    static std::map<std::string, tOwn>     mOwn;
+};
+
+#endif // CONTENTHASH_H
@@ -418,13 +418,14 @@ std::string COperation::GetCTORInitList() {
         auto cc = std::dynamic_pointer_cast<CClassBase>(*parent);
 
         std::list <std::pair<std::string, std::string> > il;
+        auto cxx = std::dynamic_pointer_cast<CCxxClass>(cc);
         //
         //  Collect possible member initialization from attributes.
         for (auto & i : cc->Attribute) {
             auto a = std::dynamic_pointer_cast<CAttribute>(*i);
             //
-            //  Only if the name is set.
-            if (!a->name.empty()) {
+            //  Only if the name is set. Members of the pimpl are initialized in the implementation struct.
+            if ((!a->name.empty()) && !(cxx && cxx->IsPimplMember(a))) {
                 if (!(a->ClassifierName.empty())) {
                     //
                     //  Where to do the initialization with member default values.
@@ -441,13 +442,12 @@ std::string COperation::GetCTORInitList() {
         //
         // Collect possible member initialization from association ends.
         if (cc->type == eElementType::CxxClass) {
-            auto cxx = std::dynamic_pointer_cast<CCxxClass>(cc);
             //
             //  Processing the aggregations/compositions that are navigable.
             for (auto & i : cxx->OtherEnd) {
                 auto ae = std::dynamic_pointer_cast<CAssociationEnd>(*i);
 
-                if (ae->isNavigable()) {
+                if (ae->isNavigable() && (!cxx->IsPimplMember(ae))) {
                     //
                     // only if the name is set for the end.
                     //
@@ -691,8 +691,7 @@ std::map <std::string, std::pair<std::string, std::string>>  COperation::parseCt
 
 std::string COperation::getHeader(int indent) {
     std::ostringstream oss;
-    std::string filler;
-    filler.assign(indent+IndentSize, ' ');
+    const std::string& filler = CodeWriter::spaces(indent+IndentSize);
 
     oss << filler << gDoxygenCommentStart << std::endl;
     if (comment.empty()) {
@@ -771,8 +770,7 @@ std::string COperation::getHeader(int indent) {
 
 std::string COperation::getSourceHeader(int indent) {
     std::ostringstream oss;
-    std::string filler;
-    filler.assign(indent, ' ');
+    const std::string& filler = CodeWriter::spaces(indent);
 
     oss << filler << "///\n";
     if (comment.empty()) {
@@ -856,8 +854,7 @@ std::string COperation::getSourceHeader(int indent) {
     return oss.str();
 }
 void COperation::DumpTemplateOperationPrefix(std::ostream& file, bool strip_default, int a_indent) {
-    std::string filler;
-    filler.assign(a_indent, ' ');
+    const std::string& filler = CodeWriter::spaces(a_indent);
     std::string para = GetTaggedValue("parameter");
 
     if (strip_default) {
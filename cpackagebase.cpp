@@ -31,8 +31,12 @@
 #include <string>
 #include <map>
 #include <list>
+#include <set>
+#include <algorithm>
+#include <functional>
 
 #include "helper.h"
+#include "main.h"
 
 #include "cpackagebase.h"
 #include "cpackage.h"
@@ -55,6 +59,22 @@
 
 #include "path.h"
 
+//
+//  Unknown profiles fall back to the debug profile.
+static EBuildProfile toBuildProfile(const std::string& aProfile) {
+    std::string   profile = helper::tolower(aProfile);
+    EBuildProfile retval  = EBuildProfile::debug;
+
+    if (profile == "release") {
+        retval = EBuildProfile::release;
+    } else if (profile == "lto") {
+        retval = EBuildProfile::lto;
+    } else if (profile == "pgo") {
+        retval = EBuildProfile::pgo;
+    }
+    return retval;
+}
+
 std::shared_ptr<MPackage> CPackageBase::construct(const std::string&aId, std::shared_ptr<MStereotype> aStereotype, std::shared_ptr<MElement> aParent)
 {
     MPackage* retval;
@@ -109,7 +129,7 @@ std::shared_ptr<MPackage> CPackageBase::construct(const std::string&aId, const s
 
 //
 //  This method first creates a backup file before opening the stream
-void CPackageBase::OpenStream(std::ofstream&s, const std::string& fname)
+void CPackageBase::OpenStream(CodeWriter&s, const std::string& fname)
 {
     int         err=0;
     struct stat dirstat;
@@ -128,7 +148,7 @@ void CPackageBase::OpenStream(std::ofstream&s, const std::string& fname)
     s.open(fname);
 }
 
-void CPackageBase::DumpMakefileHeader(std::ofstream &s, const std::string& fname)
+void CPackageBase::DumpMakefileHeader(CodeWriter &s, const std::string& fname)
 {
     s << "################################################################################################################\n";
     s << "##\n";
@@ -139,7 +159,7 @@ void CPackageBase::DumpMakefileHeader(std::ofstream &s, const std::string& fname
     s << "################################################################################################################\n";
 }
 
-void CPackageBase::DumpMakefileSource(std::ofstream &s, const std::list<std::string> &modules)
+void CPackageBase::DumpMakefileSource(CodeWriter &s, const std::list<std::string> &modules)
 {
     std::list<std::string>::const_iterator i;
 
@@ -152,6 +172,308 @@ void CPackageBase::DumpMakefileSource(std::ofstream &s, const std::list<std::str
 
 }
 
+//
+//  Collects the libraries, library pathes, include pathes and flags from the
+//  library dependencies and the tagged values of the package.
+void CPackageBase::FillBuildInfo(tBuildInfo &aInfo) {
+    auto liblist = GetLibraryDependency();
+
+    if (HasTaggedValue("CxxFlags")) {
+        for (auto & f : helper::tokenize(GetTaggedValue("CxxFlags"), " \t")) {
+            aInfo.options.push_back(f);
+        }
+    }
+    if (HasTaggedValue("LdFlags")) {
+        for (auto & f : helper::tokenize(GetTaggedValue("LdFlags"), " \t")) {
+            aInfo.linkoptions.push_back(f);
+        }
+    }
+    if (HasTaggedValue("LibPath")) {
+        aInfo.libpath.push_back(GetTaggedValue("LibPath"));
+    }
+    for (auto & di : liblist) {
+        auto element = di.getElement();
+
+        if ((element != nullptr) && ((element->type == eElementType::LibraryPackage) || (element->type == eElementType::ExternPackage))) {
+            auto package = std::dynamic_pointer_cast<CPackageBase>(element);
+
+            if ((di.getConnector()->HasStereotype("static")) || (di.getConnector()->HasStereotype("StaticLinkage"))) {
+                aInfo.staticlibs.push_back(package->OutputName);
+            } else {
+                aInfo.dynlibs.push_back(package->OutputName);
+            }
+            if (element->type == eElementType::LibraryPackage) {
+                std::string libpath = GetPathToPackage(element);
+
+                if (!libpath.empty()) {
+                    aInfo.libpath.push_back(libpath);
+                }
+            } else if (package->Directory != "./") {
+                aInfo.includepath.push_back(package->Directory);
+            } else if (!package->OutputPath.empty()) {
+                aInfo.includepath.push_back(package->OutputPath);
+            }
+        }
+    }
+}
+
+//
+//  The CMake counterpart of the package makefile. The sources are compiled once into
+//  an object library that feeds the shared library or executable and the optional archive.
+//  Optimization and debug flags are left to CMAKE_BUILD_TYPE.
+void CPackageBase::DumpCMakeLists(std::shared_ptr<CModel> aModel, const tBuildInfo &aInfo) {
+    std::string path    = aModel->pathstack.back() + "/.CMakeLists.txt";
+    std::string objects = aInfo.name + "_objects";
+    std::string standard;
+
+    OpenStream(cmakelists, path);
+    aModel->generatedfiles.push_back(tGenFile {path, id, "##", "cmake", cmakelists.buffer()});
+    cmakelists << "################################################################################################################\n";
+    cmakelists << "##\n";
+    cmakelists << "##  CMakeLists.txt for " << aInfo.name << "\n";
+    cmakelists << "##\n";
+    cmakelists << "##  Copyrights by Hans-Juergen Lange <hjl@simulated-universe.de>. All rights reserved.\n";
+    cmakelists << "##\n";
+    cmakelists << "################################################################################################################\n";
+    cmakelists << "cmake_minimum_required(VERSION 3.16)\n\n";
+    cmakelists << "project(" << aInfo.name << " CXX)\n\n";
+    //
+    //  Map the -std value to the CMake standard settings.
+    for (auto c : m_cxxstandard) {
+        if (isdigit(c)) {
+            standard.push_back(c);
+        }
+    }
+    if (!standard.empty()) {
+        cmakelists << "set(CMAKE_CXX_STANDARD " << standard << ")\n";
+        cmakelists << "set(CMAKE_CXX_STANDARD_REQUIRED ON)\n";
+        cmakelists << "set(CMAKE_CXX_EXTENSIONS " << ((m_cxxstandard.compare(0, 3, "gnu") == 0) ? "ON" : "OFF") << ")\n\n";
+    }
+    //
+    //  The build profile only gives the default. Profile guided builds are left to the Makefile.
+    cmakelists << "if(NOT CMAKE_BUILD_TYPE)\n";
+    cmakelists << "    set(CMAKE_BUILD_TYPE " << ((mBuildProfile == EBuildProfile::debug) ? "Debug" : "Release") << ")\n";
+    cmakelists << "endif()\n";
+    if (mBuildProfile == EBuildProfile::lto) {
+        cmakelists << "set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)\n";
+    }
+    cmakelists << "\n";
+    if (aInfo.modules.empty()) {
+        cmakelists << "message(STATUS \"No modules to compile\")\n";
+        cmakelists.close();
+        return;
+    }
+    cmakelists << "set(SRC";
+    for (auto & m : aInfo.modules) {
+        cmakelists << "\n    " << m << ".cpp";
+    }
+    cmakelists << "\n)\n\n";
+
+    cmakelists << "add_library(" << objects << " OBJECT ${SRC})\n";
+    cmakelists << "set_target_properties(" << objects << " PROPERTIES POSITION_INDEPENDENT_CODE ON)\n";
+    if (!aInfo.definitions.empty()) {
+        cmakelists << "target_compile_definitions(" << objects << " PRIVATE";
+        for (auto & d : aInfo.definitions) {
+            cmakelists << "\n    " << d;
+        }
+        cmakelists << "\n)\n";
+    }
+    if (!aInfo.options.empty()) {
+        cmakelists << "target_compile_options(" << objects << " PRIVATE";
+        for (auto & o : aInfo.options) {
+            cmakelists << "\n    " << o;
+        }
+        cmakelists << "\n)\n";
+    }
+    if (!aInfo.includepath.empty()) {
+        cmakelists << "target_include_directories(" << objects << " PRIVATE";
+        for (auto & i : aInfo.includepath) {
+            cmakelists << "\n    " << i;
+        }
+        cmakelists << "\n)\n";
+    }
+    //
+    //  Unity builds batch the sources into a few large translation units.
+    if (mUnityBatchSize > 0) {
+        cmakelists << "set_target_properties(" << objects << " PROPERTIES UNITY_BUILD ON UNITY_BUILD_BATCH_SIZE " << mUnityBatchSize << ")\n";
+        if (!aInfo.nounity.empty()) {
+            cmakelists << "set_source_files_properties(";
+            for (auto & m : aInfo.nounity) {
+                cmakelists << "\n    " << m << ".cpp";
+            }
+            cmakelists << "\n    PROPERTIES SKIP_UNITY_BUILD_INCLUSION ON\n)\n";
+        }
+    }
+    std::string pch = DumpPrecompiledHeader(aModel, aInfo);
+
+    if (!pch.empty()) {
+        cmakelists << "target_precompile_headers(" << objects << " PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/" << pch << ")\n";
+    }
+    cmakelists << "\n";
+
+    if (aInfo.executable) {
+        cmakelists << "add_executable(" << aInfo.name << " $<TARGET_OBJECTS:" << objects << ">)\n";
+    } else {
+        cmakelists << "add_library(" << aInfo.name << " SHARED $<TARGET_OBJECTS:" << objects << ">)\n";
+        if (aInfo.prefix != "lib") {
+            cmakelists << "set_target_properties(" << aInfo.name << " PROPERTIES PREFIX \"" << aInfo.prefix << "\")\n";
+        }
+    }
+    if (!aInfo.libpath.empty()) {
+        cmakelists << "target_link_directories(" << aInfo.name << " PRIVATE";
+        for (auto & l : aInfo.libpath) {
+            cmakelists << "\n    " << l;
+        }
+        cmakelists << "\n)\n";
+    }
+    if (!aInfo.linkoptions.empty()) {
+        cmakelists << "target_link_options(" << aInfo.name << " PRIVATE";
+        for (auto & l : aInfo.linkoptions) {
+            cmakelists << "\n    " << l;
+        }
+        cmakelists << "\n)\n";
+    }
+    if ((!aInfo.staticlibs.empty()) || (!aInfo.dynlibs.empty())) {
+        cmakelists << "target_link_libraries(" << aInfo.name << " PRIVATE";
+        if (!aInfo.staticlibs.empty()) {
+            cmakelists << "\n    -Wl,-Bstatic -Wl,--start-group";
+            for (auto & l : aInfo.staticlibs) {
+                cmakelists << "\n    " << l;
+            }
+            cmakelists << "\n    -Wl,--end-group -Wl,-Bdynamic";
+        }
+        for (auto & l : aInfo.dynlibs) {
+            cmakelists << "\n    " << l;
+        }
+        cmakelists << "\n)\n";
+    }
+    cmakelists << "\n";
+    if (aInfo.archive) {
+        cmakelists << "add_library(" << aInfo.name << "_static STATIC $<TARGET_OBJECTS:" << objects << ">)\n";
+        cmakelists << "set_target_properties(" << aInfo.name << "_static PROPERTIES OUTPUT_NAME " << aInfo.name << ")\n\n";
+        cmakelists << "install(TARGETS " << aInfo.name << " " << aInfo.name << "_static)\n";
+    } else {
+        cmakelists << "install(TARGETS " << aInfo.name << ")\n";
+    }
+    cmakelists.close();
+}
+
+//
+//  Writes the header to precompile for the package. It includes the system headers that
+//  are included most by the generated sources, in the order of their first appearance.
+//  The model headers are left out as they are not self-contained and change often.
+//  Returns the name of the header or an empty string if nothing is worth to precompile.
+std::string CPackageBase::DumpPrecompiledHeader(std::shared_ptr<CModel> aModel, const tBuildInfo &aInfo) {
+    std::string                   retval;
+    std::set<std::string>         sources;
+    std::map<std::string, size_t> count;
+    std::list<std::string>        order;
+
+    if (mPchHeaders == 0) {
+        return retval;
+    }
+    for (auto & m : aInfo.modules) {
+        CPath module(aModel->pathstack.back() + "/" + m);
+
+        sources.insert(CPath(module.Directory() + "./." + module.Base() + ".cpp"));
+    }
+    for (auto & f : aModel->generatedfiles) {
+        if (sources.find(CPath(f.ofile)) != sources.end()) {
+            std::set<std::string> done;
+
+            for (auto & i : aModel->GetIncludes(f)) {
+                if ((i[0] == '<') && (done.insert(i).second)) {
+                    if (count[i]++ == 0) {
+                        order.push_back(i);
+                    }
+                }
+            }
+        }
+    }
+    //
+    //  Find the count that a header needs to get into the precompiled header.
+    //  Headers that are used by a single source only do not gain anything.
+    std::vector<size_t> counts;
+
+    for (auto & c : count) {
+        counts.push_back(c.second);
+    }
+    std::sort(counts.begin(), counts.end(), std::greater<size_t>());
+    if (counts.empty()) {
+        return retval;
+    }
+    size_t limit = std::max<size_t>(2, counts[std::min(counts.size(), mPchHeaders) - 1]);
+
+    std::string path = aModel->pathstack.back() + "/." + aInfo.name + "_pch.h";
+    bool        any  = false;
+
+    for (auto & o : order) {
+        if (count[o] >= limit) {
+            if (!any) {
+                OpenStream(pchheader, path);
+                aModel->generatedfiles.push_back(tGenFile {path, id, "//", "pch", pchheader.buffer()});
+                pchheader << "//\n";
+                pchheader << "//  Precompiled header for " << aInfo.name << "\n";
+                pchheader << "//\n";
+                pchheader << "#pragma once\n";
+                any = true;
+            }
+            pchheader << "#include " << o << "\n";
+        }
+    }
+    if (any) {
+        pchheader.close();
+        retval = aInfo.name + "_pch.h";
+    }
+    return retval;
+}
+
+//
+//  The optimization flags depend on BUILDPROFILE that can be overridden on the
+//  make command line. The default is taken from the model.
+//  The pgo profile uses the training data that the profile target creates.
+void CPackageBase::DumpMakefileProfile(CodeWriter &s, const std::string& aTraining) {
+    static const char* profilenames[] = {"debug", "release", "lto", "pgo-use"};
+
+    s << "##\n";
+    s << "##  Build profile: debug, release, lto, pgo-generate or pgo-use.\n";
+    s << "BUILDPROFILE?=" << profilenames[static_cast<int>(mBuildProfile)] << "\n";
+    s << "OPTLEVEL?=-O2\n";
+    s << "PGODIR?=$(CURDIR)/pgo\n";
+    if (!mPgoTraining.empty()) {
+        s << "PGOTRAINING?=" << mPgoTraining << "\n";
+    } else if (!aTraining.empty()) {
+        s << "PGOTRAINING?=" << aTraining << "\n";
+    }
+    s << "\n";
+    s << "ifeq ($(BUILDPROFILE),release)\n";
+    s << "    OPTFLAGS=$(OPTLEVEL) -DNDEBUG\n";
+    s << "else ifeq ($(BUILDPROFILE),lto)\n";
+    s << "    OPTFLAGS=$(OPTLEVEL) -DNDEBUG -flto=auto\n";
+    s << "    AR=gcc-ar\n";
+    s << "else ifeq ($(BUILDPROFILE),pgo-generate)\n";
+    s << "    OPTFLAGS=$(OPTLEVEL) -DNDEBUG -fprofile-generate=$(PGODIR) -fprofile-update=atomic\n";
+    s << "else ifeq ($(BUILDPROFILE),pgo-use)\n";
+    s << "    OPTFLAGS=$(OPTLEVEL) -DNDEBUG -fprofile-use=$(PGODIR) -fprofile-correction -Wno-missing-profile\n";
+    s << "else\n";
+    s << "    OPTFLAGS=-O0 -g\n";
+    s << "endif\n\n";
+}
+
+//
+//  Two stage profile guided optimization. The instrumented build is trained
+//  by PGOTRAINING before the final build uses the collected data.
+void CPackageBase::DumpMakefileProfileTarget(CodeWriter &s) {
+    s << "profile:\n";
+    s << "\t@if [ -z \"$(PGOTRAINING)\" ] ; then echo \"Set PGOTRAINING to the command that trains the build.\"; exit 1; fi\n";
+    s << "\trm -rf $(PGODIR)\n";
+    s << "\t$(MAKE) clean\n";
+    s << "\t$(MAKE) BUILDPROFILE=pgo-generate all\n";
+    s << "\t$(PGOTRAINING)\n";
+    s << "\t$(MAKE) clean\n";
+    s << "\t$(MAKE) BUILDPROFILE=pgo-use all\n\n";
+}
+
 void CPackageBase::Add(std::shared_ptr<MElement> aElement) {
     MElement::Add(aElement);
     if (aElement->IsClassBased()) {
@@ -168,7 +490,7 @@ void CPackageBase::Add(std::shared_ptr<MElement> aElement) {
     }
 }
 
-void CPackageBase::DumpMakefileObjects(std::ofstream &s, const std::list<std::string> &modules)
+void CPackageBase::DumpMakefileObjects(CodeWriter &s, const std::list<std::string> &modules)
 {
     std::list<std::string>::const_iterator i;
 
@@ -182,6 +504,10 @@ void CPackageBase::PrepareBase(const std::map<std::string, std::string>& tags) {
     if (Directory.empty()) {
         Directory="./";
     }
+    mBuildSystem    = gUseCMake ? EBuildSystem::cmake : EBuildSystem::make;
+    mUnityBatchSize = (gUnityBatchSize > 0) ? gUnityBatchSize : 0;
+    mPchHeaders     = (gPchHeaders > 0) ? gPchHeaders : 0;
+    mBuildProfile   = toBuildProfile(gBuildProfile);
     for (i=tags.begin(); i!= tags.end(); ++i) {
         std::string tagname = helper::tolower(i->first);
 
@@ -218,6 +544,24 @@ void CPackageBase::PrepareBase(const std::map<std::string, std::string>& tags) {
         }
         else if ((tagname == "namespace") && (!i->second.empty())) {
             mNameSpace = i->second;
+        } else if (tagname == "buildsystem") {
+            if (helper::tolower(i->second) == "cmake") {
+                mBuildSystem = EBuildSystem::cmake;
+            } else {
+                mBuildSystem = EBuildSystem::make;
+            }
+        } else if (tagname == "unitybuild") {
+            long batch = strtol(i->second.c_str(), nullptr, 0);
+
+            mUnityBatchSize = (batch > 0) ? batch : 0;
+        } else if (tagname == "precompiledheaders") {
+            long count = strtol(i->second.c_str(), nullptr, 0);
+
+            mPchHeaders = (count > 0) ? count : 0;
+        } else if (tagname == "buildprofile") {
+            mBuildProfile = toBuildProfile(i->second);
+        } else if ((tagname == "pgotraining") && (!i->second.empty())) {
+            mPgoTraining = i->second;
         }
     }
 }
@@ -456,7 +800,7 @@ std::string CPackageBase::GetPathToPackage(std::shared_ptr<MElement> e) {
     return (cleaner);
 }
 
-std::ofstream &CPackageBase::getExportStream() {
+CodeWriter &CPackageBase::getExportStream() {
     //
     // We limit the export to the first library package that we can find upwards.
     if (type == eElementType::LibraryPackage) {
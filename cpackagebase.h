@@ -26,6 +26,8 @@
 #include <list>
 #include <map>
 
+#include "codewriter.h"
+
 #include "melement.h"
 #include "mdependency.h"
 #include "mpackage.h"
@@ -39,6 +41,36 @@ enum class ERepositoryType {
     none
 };
 
+enum class EBuildSystem {
+    make,
+    cmake
+};
+
+enum class EBuildProfile {
+    debug,
+    release,
+    lto,
+    pgo
+};
+//
+//  Everything a build file needs to know about a package. It is filled from the
+//  library dependencies and tagged values and written either as Makefile or as CMakeLists.txt.
+struct tBuildInfo {
+    std::string            name;                //  Name of the build result without prefix and extension.
+    std::string            prefix = "lib";      //  Prefix of the shared library.
+    bool                   executable = false;  //  Build an executable instead of a shared library.
+    bool                   archive = false;     //  Build a static library in addition to the shared one.
+    std::list<std::string> modules;             //  The sources without the .cpp extension.
+    std::list<std::string> nounity;             //  Sources with file scope definitions that clash in a unity build.
+    std::list<std::string> definitions;
+    std::list<std::string> options;
+    std::list<std::string> linkoptions;
+    std::list<std::string> includepath;
+    std::list<std::string> libpath;
+    std::list<std::string> staticlibs;
+    std::list<std::string> dynlibs;
+};
+
 class CPackageBase : public MPackage
 {
 public:
@@ -48,10 +80,15 @@ public:
     static std::shared_ptr<MPackage> construct(const std::string&aId, std::shared_ptr<MStereotype> aStereotype = nullptr, std::shared_ptr<MElement> aParent = nullptr);
     static std::shared_ptr<MPackage> construct(const std::string&aId, const std::string& aPackageType, std::shared_ptr<MElement> aParent = nullptr);
 
-    void OpenStream(std::ofstream&s, const std::string& fname);
-    void DumpMakefileHeader(std::ofstream&, const std::string& fname);
-    void DumpMakefileSource(std::ofstream& s, const std::list<std::string>& modules);
-    void DumpMakefileObjects(std::ofstream& s, const std::list<std::string>& modules);
+    void OpenStream(CodeWriter&s, const std::string& fname);
+    void DumpMakefileHeader(CodeWriter&, const std::string& fname);
+    void DumpMakefileSource(CodeWriter& s, const std::list<std::string>& modules);
+    void DumpMakefileObjects(CodeWriter& s, const std::list<std::string>& modules);
+    void DumpMakefileProfile(CodeWriter& s, const std::string& aTraining);
+    void DumpMakefileProfileTarget(CodeWriter& s);
+    void FillBuildInfo(tBuildInfo& aInfo);
+    void DumpCMakeLists(std::shared_ptr<CModel> aModel, const tBuildInfo& aInfo);
+    std::string DumpPrecompiledHeader(std::shared_ptr<CModel> aModel, const tBuildInfo& aInfo);
     void PrepareBase(const std::map<std::string, std::string>& tags);
     void DumpBase(std::shared_ptr<CModel> model);
     virtual std::list<tConnector<MElement, MElement>> GetLibraryDependency();
@@ -69,7 +106,7 @@ public:
     //
     //  Subsystem handling.
     SubsystemFormat getSubsystemFormat();
-    std::ofstream& getExportStream();
+    CodeWriter& getExportStream();
     void DumpEA(std::shared_ptr<CModel> aModel, std::ostream& aExport);
     void DumpEAExtension(std::shared_ptr<CModel> aModel, std::ostream& aExport);
 public:
@@ -79,10 +116,17 @@ public:
     std::string     OutputName;                //  Name of the build result from the 'Directory' content
     std::string     OutputPath;                //  Directory where the build result can be found.
     std::string     ExtraInclude;              //  Special include files that must be included in every module
-    std::ofstream   makefile;
+    CodeWriter      makefile;
+    CodeWriter      cmakelists;
+    CodeWriter      pchheader;
+    EBuildSystem    mBuildSystem = EBuildSystem::make; //  Which build file is generated for the package.
+    size_t          mUnityBatchSize = 0;       //  Sources per unity build batch. 0 disables unity builds.
+    size_t          mPchHeaders = 0;           //  Number of most included headers to precompile. 0 disables it.
+    EBuildProfile   mBuildProfile = EBuildProfile::debug; //  Default optimization profile of the build file.
+    std::string     mPgoTraining;              //  Command that trains the instrumented build.
     bool            mCreateSubsystem = false;
     SubsystemFormat mSubsystemFormat = SubsystemFormat::EAXMI;
-    std::ofstream   mExportFile;
+    CodeWriter      mExportFile;
     bool            m_init_done = false;       //  Prevent double initialization.
     std::string     m_cxxstandard = "c++17";
 };
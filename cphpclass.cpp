@@ -304,6 +304,12 @@ void CPHPClass::DumpUses(std::ostream &outfile) {
 }
 
 void CPHPClass::Dump(std::shared_ptr<MModel> model) {
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
+
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
     std::set<std::string> includesdone;
 
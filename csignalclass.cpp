@@ -33,9 +33,17 @@
 #include "ccxxclass.h"
 
 #include "cstruct.h"
+#include "cenumeration.h"
 
 #include "mmodel.h"
 #include "cmodel.h"
+#include "containerheader.h"
+#include "jsonheader.h"
+#include "jsonencoder.h"
+#include "jsondecoder.h"
+#include "tlvcodec.h"
+#include "protocodec.h"
+#include "flatlayout.h"
 
 #include "main.h"
 
@@ -84,6 +92,10 @@ void CSignalClass::SetFromTags(const std::string& name, const std::string&value)
         basename=value;
     } if (name== "Direction") {
         direction = value;
+    } else if (name == "JSON") {
+        jsonbuffer = (value == "buffer");
+    } else if (name == "Layout") {
+        flatlayout = (value == "flat");
     }
 }
 
@@ -93,10 +105,9 @@ std::string CSignalClass::FQN() const {
 
 void CSignalClass::Prepare(void) {
     PrepareBase();
+    DropConcurrentPolicies();
     if (HasStereotype("protobuf")) {
         m_encoding = SignalEncoding::protobuf;
-        has_src.clear();
-        has_hdr.clear();
     } else if ((HasStereotype("json")) || (HasStereotype("simsignal"))) {
         m_encoding = SignalEncoding::json;
     } else if (HasStereotype("tlv")) {
@@ -118,6 +129,11 @@ void CSignalClass::Prepare(void) {
 }
 
 void CSignalClass::Dump(std::shared_ptr<MModel> model) {
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
 
     CollectNeededModelHeader(sharedthis<MElement>(), neededmodelheader);
 
@@ -137,30 +153,51 @@ void CSignalClass::Dump(std::shared_ptr<MModel> model) {
     }
 }
 
-void CSignalClass::DumpProtobufAttributes(std::ofstream& a_pbfile, int a_indentation) {
-    auto alla = GetAttributes();
-    std::string filler(a_indentation, ' ');
+//
+//  The codec and the .proto schema are made from the same members, so they
+//  agree on the field numbers.
+void CSignalClass::ProtobufMembers(ProtoCodec& aCodec) {
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            aCodec.Member(std::dynamic_pointer_cast<CAttribute>(ai), name);
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        auto a = std::dynamic_pointer_cast<CAssociationEnd>(*ai);
 
-    for (auto & a : alla) {
-        if (a->Classifier) {
-            auto cb = a->Classifier->sharedthis<CClassBase>();
-            a_pbfile << filler << cb->mTypeTree.mName << " " << a->name << " = " << m_attribute_index++ << ";\n";
-        } else {
-            a_pbfile << filler << a->ClassifierName << " " << a->name << " = " << m_attribute_index++ << ";\n";
+        if ((a->visibility == vPublic) && a->isNavigable()) {
+            aCodec.Member(a, name);
         }
     }
 }
 
+void CSignalClass::FlatMembers(FlatLayout& aLayout) {
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            aLayout.Member(std::dynamic_pointer_cast<CAttribute>(ai));
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        auto a = std::dynamic_pointer_cast<CAssociationEnd>(*ai);
+
+        if ((a->visibility == vPublic) && a->isNavigable()) {
+            aLayout.Member(a);
+        }
+    }
+}
+
+//
+//  Protobuf signals are full signal classes as the ifc creates them from JSON.
+//  The .proto schema is kept for peers that use protoc.
 void CSignalClass::DumpProtobuf(std::shared_ptr<MModel> model) {
-    auto cmodel = std::dynamic_pointer_cast<CModel>(model);
-    DumpBase(cmodel, name);
-    std::ofstream pbfile;
+    ProtoCodec codec;
+    CodeWriter pbfile;
+
+    DumpJSON(model);
+    ProtobufMembers(codec);
     OpenStream(pbfile, name + ".proto");
-    pbfile << "syntax = \"proto3\";\n\n";
-    pbfile << "message " << name << " {\n";
-    DumpProtobufAttributes(pbfile, IndentSize);
-    pbfile << "}\n\n";
-    CloseStreams();
+    pbfile << codec.Schema(name) << "\n";
+    pbfile.close();
 }
 
 void CSignalClass::DumpJSON(std::shared_ptr<MModel> model) {
@@ -168,6 +205,7 @@ void CSignalClass::DumpJSON(std::shared_ptr<MModel> model) {
     std::list< tAttributePack >::iterator ilist;
     size_t                                typemax = 0;
     size_t                                namemax = 0;
+    FlatLayout                            flat(name);
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
     DumpBase(cmodel, name);
     DumpFileHeader(hdr, name, ".h");
@@ -175,6 +213,26 @@ void CSignalClass::DumpJSON(std::shared_ptr<MModel> model) {
 
     hdr << "\n#include <simobj.h>\n";
     hdr << "#include <helper.h>\n";
+    if (UsesContainerPolicy()) {
+        ContainerHeader::Dump(cmodel, id);
+        hdr << "#include \"" << ContainerHeader::Name() << "\"\n";
+    }
+    if (jsonbuffer) {
+        JsonHeader::Dump(cmodel, id);
+        hdr << "#include \"" << JsonHeader::Name() << "\"\n";
+    }
+    if (m_encoding == SignalEncoding::tlv) {
+        TlvCodec::Dump(cmodel, id);
+        hdr << "#include \"" << TlvCodec::Name() << "\"\n";
+    }
+    if (m_encoding == SignalEncoding::protobuf) {
+        ProtoCodec::Dump(cmodel, id);
+        hdr << "#include \"" << ProtoCodec::Name() << "\"\n";
+    }
+    if (flatlayout) {
+        FlatLayout::Dump(cmodel, id);
+        hdr << "#include \"" << FlatLayout::Name() << "\"\n";
+    }
 
     donelist.clear();
     for (auto & i : optionalmodelheader) {
@@ -260,10 +318,25 @@ void CSignalClass::DumpJSON(std::shared_ptr<MModel> model) {
     hdr << "    virtual ~" << name << "() {}\n";
     hdr << "    //\n"
            "    //  This is the serializer code used for sending out messages in JSON format.\n";
-    hdr << "    virtual std::ostream& json(std::ostream& output) {\n";
-    toJSONBuddy(hdr);
-    hdr << "\n        return output;\n"
-           "    }\n";
+    if (jsonbuffer) {
+        toJSONBuffer(hdr);
+        fromJSONBuffer(hdr);
+    } else {
+        hdr << "    virtual std::ostream& json(std::ostream& output) {\n";
+        toJSONBuddy(hdr);
+        hdr << "\n        return output;\n"
+               "    }\n";
+    }
+    if (m_encoding == SignalEncoding::tlv) {
+        toTLV(hdr);
+    }
+    if (m_encoding == SignalEncoding::protobuf) {
+        toProtobuf(hdr);
+    }
+    if (flatlayout) {
+        FlatMembers(flat);
+        hdr << flat.Declaration(4);
+    }
 
     for (auto & i : Attribute) {
         auto a = std::dynamic_pointer_cast<CAttribute>(*i);
@@ -323,6 +396,8 @@ void CSignalClass::DumpJSON(std::shared_ptr<MModel> model) {
                     alist.emplace_back( fqn, a->name, a->defaultValue);
                 } else if (a->Multiplicity == "0..1") {
                     alist.emplace_back( fqn+"*", a->name, a->defaultValue);
+                } else if ((a->isCollection) && (a->HasContainerPolicy())) {
+                    alist.emplace_back( a->MkContainer((a->QualifierType.empty()) ? "uint64_t" : a->QualifierType, fqn), a->name);
                 } else if (a->Multiplicity == "0..*") {
                     if (a->QualifierType.empty()) {
                         alist.emplace_back( std::string("std::vector< ")+fqn+" >", a->name);
@@ -373,17 +448,20 @@ void CSignalClass::DumpJSON(std::shared_ptr<MModel> model) {
         hdr << ";\n";
     }
     hdr << "};\n";
+    if (flatlayout) {
+        hdr << "\n" << flat.Definition();
+    }
     hdr << "\n\n"
            "using " << name << "Ptr = std::shared_ptr<" << name << ">;\n\n";
     DumpGuardTail(hdr, name);
 
     CloseStreams();
 }
-void CSignalClass::DumpJSONIncomingDeclaration(std::ofstream& ifc) {
+void CSignalClass::DumpJSONIncomingDeclaration(CodeWriter& ifc) {
     ifc << "static tSig* sig_from_json_" << helper::tolower(basename) << "(tJSON*  json);\n";
 }
 
-void CSignalClass::fromJSONBuddy(std::ofstream& ifc) {
+void CSignalClass::fromJSONBuddy(CodeWriter& ifc) {
     ifc << "            tJSON *j;\n";
     ifc << "\n";
     ifc << "            j=find(json, \"Destination\");\n";
@@ -405,7 +483,7 @@ void CSignalClass::fromJSONBuddy(std::ofstream& ifc) {
                     if (a->Classifier->type == eElementType::Struct) {
                         //ifc << "                " << a->name << " = " << a->Classifier->name << " {};\n";
                     } else {
-                        ifc << "                " << a->name << " = to_" << a->Classifier->name << "(j);\n";
+                        ifc << "                " << a->name << " = " << CEnumeration::JSONReader(a->Classifier) << "(j);\n";
                     }
                 } else {
                     DumpJSONIncomingArray(ifc, a, "", 16);
@@ -448,7 +526,7 @@ void CSignalClass::fromJSONBuddy(std::ofstream& ifc) {
     }
 }
 
-void CSignalClass::DumpJSONIncoming(std::ofstream& ifc) {
+void CSignalClass::DumpJSONIncoming(CodeWriter& ifc) {
     ifc << "// **************************************************************************\n";
     ifc << "//\n";
     ifc << "//  Method-Name   : sig_from_json_" << helper::tolower(basename) << "()\n";
@@ -479,7 +557,7 @@ void CSignalClass::DumpJSONIncoming(std::ofstream& ifc) {
                     if (a->Classifier->type == eElementType::Struct) {
                         ifc << "        newsig->" << a->name << "= " << a->Classifier->name << " {};\n";
                     } else {
-                        ifc << "        newsig->" << a->name << "=to_" << a->Classifier->name << "(j);\n";
+                        ifc << "        newsig->" << a->name << "=" << CEnumeration::JSONReader(a->Classifier) << "(j);\n";
                     }
                 } else {
                     DumpJSONIncomingArray(ifc, a, "newsig->", 8);
@@ -508,9 +586,8 @@ void CSignalClass::DumpJSONIncoming(std::ofstream& ifc) {
     ifc << "}\n";
 }
 
-void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAttribute> a, std::string prefix, int space) {
-    std::string filler;
-    filler.assign(space, ' ');
+void CSignalClass::DumpJSONIncomingArray(CodeWriter &ifc, std::shared_ptr<CAttribute> a, std::string prefix, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
     ifc << filler << "tJSONArray*                   array = (tJSONArray*)j;\n";
     ifc << filler << "std::vector<tJSON*>::iterator ai;\n";
@@ -528,9 +605,9 @@ void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAt
             //  We expect an array of single values.
             ifc << filler << "    if ((*ai)->type == eValue) {\n";
             if (a->isCollection) {
-                ifc << filler << "        " << prefix << a->name << ".push_back(to_" << a->Classifier->name << "(*ai));\n";
+                ifc << filler << "        " << prefix << a->name << ".push_back(" << CEnumeration::JSONReader(a->Classifier) << "(*ai));\n";
             } else {
-                ifc << filler << "        " << prefix << a->name << "[ac++] = to_" << a->Classifier->name << "(*ai);\n";
+                ifc << filler << "        " << prefix << a->name << "[ac++] = " << CEnumeration::JSONReader(a->Classifier) << "(*ai);\n";
             }
             ifc << filler << "    }\n";
         }
@@ -541,9 +618,8 @@ void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAt
 
 }
 
-void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, int space) {
-    std::string filler;
-    filler.assign(space, ' ');
+void CSignalClass::DumpJSONIncomingArray(CodeWriter &ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
     ifc << filler << "tJSONArray*                   array = (tJSONArray*)find(json, \"" << a->name << "\");\n";
     ifc << filler << "if (array != nullptr) {\n";
@@ -556,7 +632,11 @@ void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAs
     if (a->Classifier) {
         if (a->Classifier->type == eElementType::Struct) {
             DumpJSONIncomingStruct(ifc, a->Classifier, prefix+a->name, space+4);
-            ifc << filler << "        " << a->name << ".push_back(v);" << "\n";
+            if (a->HasContainerPolicy()) {
+                ifc << filler << "        mtt::append(" << a->name << ", v);" << "\n";
+            } else {
+                ifc << filler << "        " << a->name << ".push_back(v);" << "\n";
+            }
 
         } else {
             //
@@ -564,10 +644,12 @@ void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAs
             ifc << filler << "    //\n";
             ifc << filler << "    //  Sanity check here\n";
             ifc << filler << "    if ((*ai)->type == eValue) {\n";
-            if (a->isCollection) {
-                ifc << filler << "        " << prefix << a->name << ".push_back(to_" << a->Classifier->name << "(*ai));\n";
+            if ((a->isCollection) && (a->HasContainerPolicy())) {
+                ifc << filler << "        mtt::append(" << prefix << a->name << ", " << CEnumeration::JSONReader(a->Classifier) << "(*ai));\n";
+            } else if (a->isCollection) {
+                ifc << filler << "        " << prefix << a->name << ".push_back(" << CEnumeration::JSONReader(a->Classifier) << "(*ai));\n";
             } else {
-                ifc << filler << "        " << prefix << a->name << "[ac++] = to_" << a->Classifier->name << "(*ai);\n";
+                ifc << filler << "        " << prefix << a->name << "[ac++] = " << CEnumeration::JSONReader(a->Classifier) << "(*ai);\n";
             }
             ifc << filler << "        }\n";
         }
@@ -576,9 +658,8 @@ void CSignalClass::DumpJSONIncomingArray(std::ofstream &ifc, std::shared_ptr<CAs
     ifc << filler << "}\n";
 }
 
-void CSignalClass::DumpJSONIncomingStruct(std::ofstream &ifc, std::shared_ptr<MElement> aStruct, std::string prefix, int space) {
-    std::string filler;
-    filler.assign(space+4, ' ');
+void CSignalClass::DumpJSONIncomingStruct(CodeWriter &ifc, std::shared_ptr<MElement> aStruct, std::string prefix, int space) {
+    const std::string& filler = CodeWriter::spaces(space+4);
 
     ifc << filler << aStruct->name << " v;\n";
     ifc << filler << "tJSON* j;\n";
@@ -586,9 +667,8 @@ void CSignalClass::DumpJSONIncomingStruct(std::ofstream &ifc, std::shared_ptr<ME
     DumpJSONIncomingValues(ifc, std::dynamic_pointer_cast<CClassBase>(aStruct), "v.", "ai",  space);
 }
 
-void CSignalClass::DumpJSONIncomingValues(std::ofstream &ifc, std::shared_ptr<CClassBase> aClass, std::string prefix, std::string jsonvar, int space) {
-    std::string filler;
-    filler.assign(space, ' ');
+void CSignalClass::DumpJSONIncomingValues(CodeWriter &ifc, std::shared_ptr<CClassBase> aClass, std::string prefix, std::string jsonvar, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
     auto al = aClass->GetAttributes();
 
@@ -603,7 +683,7 @@ void CSignalClass::DumpJSONIncomingValues(std::ofstream &ifc, std::shared_ptr<CC
                     if (a->Classifier->type == eElementType::Struct) {
                         //ifc << "                " << a->name << " = " << a->Classifier->name << " {};\n";
                     } else {
-                        ifc << filler << "        " << prefix << a->name << " = to_" << a->Classifier->name << "(j);\n";
+                        ifc << filler << "        " << prefix << a->name << " = " << CEnumeration::JSONReader(a->Classifier) << "(j);\n";
                     }
                 } else {
                     DumpJSONIncomingArray(ifc, a, "", 16);
@@ -646,13 +726,12 @@ void CSignalClass::DumpJSONIncomingValues(std::ofstream &ifc, std::shared_ptr<CC
     }
 }
 
-void CSignalClass::DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CSignalClass::DumpJSONArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
     std::string runner;
 
     runner=(char)('a'+space/4);
 
-    filler.assign(space, ' ');
     if (!first) {
         ifc << filler << "    output <<  \", \\\"" << a->name << "\\\": [ \";\n";
     } else {
@@ -681,6 +760,8 @@ void CSignalClass::DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAttribute>
         ifc << filler << "        }\n";
         if (a->ClassifierName == "string") {
                 ifc << filler << "        output <<  \"\\\"\" << " << "(*" << runner << ")" << " << \"\\\"\";\n";
+        } else if (!CEnumeration::JSONWriter(a->Classifier, "(*" + runner + ")").empty()) {
+                ifc << filler << "        output << " << CEnumeration::JSONWriter(a->Classifier, "(*" + runner + ")") << ";\n";
         } else {
             if ((a->ClassifierName == "uint64_t") || (a->ClassifierName == "objectid_t")) {
                     ifc << filler << "        output << (int64_t)" << "(*" << runner << ")" << ";\n";
@@ -694,19 +775,30 @@ void CSignalClass::DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAttribute>
     ifc << filler << "    output <<  \"]\\n\";\n";
 }
 
-void CSignalClass::DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CSignalClass::DumpJSONArray(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
     std::string runner;
+    std::string value;
+    std::string member;
 
     runner=(char)('a'+space/4);
+    value  = "(*" + runner + ")";
+    member = runner + "->";
 
-    filler.assign(space, ' ');
     if (!first) {
         ifc << filler << "    output <<  \", \\\"" << a->name << "\\\": [ \";\n";
     } else {
         ifc << filler << "    output <<  \"\\\"" << a->name << "\\\": [ \";\n";
     }
-    ifc << filler << "    for (std::vector<" << a->FQN() << ">::iterator " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    //
+    //  With a container policy the element type is hidden behind mtt::value.
+    if (a->HasContainerPolicy()) {
+        value  = "mtt::value(*" + runner + ")";
+        member = value + ".";
+        ifc << filler << "    for (auto " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    } else {
+        ifc << filler << "    for (std::vector<" << a->FQN() << ">::iterator " << runner << " = " << prefix << a->name << ".begin(); "<< runner <<" != "<< prefix << a->name << ".end(); ++"<< runner <<") {\n";
+    }
     if (a->Classifier->type == eElementType::Struct) {
         ifc << filler << "        if (" << runner << " == " << prefix << a->name << ".begin()) {\n";
         ifc << filler << "            output <<  \"{\\n\";\n";
@@ -714,18 +806,20 @@ void CSignalClass::DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAssociatio
         ifc << filler << "            output <<  \", {\\n\";\n";
         ifc << filler << "        }\n";
         ifc << filler << "// struct\n";
-        DumpJSONStruct(ifc, a->Classifier, "", runner+"->", false, space);
+        DumpJSONStruct(ifc, a->Classifier, "", member, false, space);
     } else {
         ifc << filler << "        if (" << runner << " != " << prefix << a->name << ".begin()) {\n";
         ifc << filler << "            output <<  \", \";\n";
         ifc << filler << "        }\n";
         if (a->Classifier->name == "string") {
-                ifc << filler << "        output <<  \"\\\"\" << " << "(*" << runner << ")" << " << \"\\\"\";\n";
+                ifc << filler << "        output <<  \"\\\"\" << " << value << " << \"\\\"\";\n";
+        } else if (!CEnumeration::JSONWriter(a->Classifier, value).empty()) {
+                ifc << filler << "        output << " << CEnumeration::JSONWriter(a->Classifier, value) << ";\n";
         } else {
             if ((a->Classifier->name == "uint64_t") || (a->Classifier->name == "objectid_t")) {
-                    ifc << filler << "        output << (int64_t)" << "(*" << runner << ")" << ";\n";
+                    ifc << filler << "        output << (int64_t)" << value << ";\n";
             } else {
-                    ifc << filler << "        output << (*" << runner << ")" << ";\n";
+                    ifc << filler << "        output << " << value << ";\n";
             }
         }
     }
@@ -735,10 +829,9 @@ void CSignalClass::DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAssociatio
 }
 
 
-void CSignalClass::DumpJSONStruct(std::ofstream& ifc, std::shared_ptr<MElement> a, std::string sname, std::string prefix, bool first, int space) {
-    std::string filler;
+void CSignalClass::DumpJSONStruct(CodeWriter& ifc, std::shared_ptr<MElement> a, std::string sname, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
 
-    filler.assign(space, ' ');
     if (a->type == eElementType::Struct) {
         auto s = std::dynamic_pointer_cast<CStruct>(a);
 
@@ -792,16 +885,22 @@ void CSignalClass::DumpJSONStruct(std::ofstream& ifc, std::shared_ptr<MElement>
     }
 }
 
-void CSignalClass::DumpJSONValue(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CSignalClass::DumpJSONValue(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
+    std::string        literal = CEnumeration::JSONWriter(a->Classifier, prefix + a->name);
 
-    filler.assign(space, ' ');
     if (a->ClassifierName == "string") {
         if (!first) {
             ifc << filler << "    output <<  \", \\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         } else {
             ifc << filler << "    output <<  \"\\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         }
+    } else if (!literal.empty()) {
+        if (!first) {
+            ifc << filler << "    output <<  \", \\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        } else {
+            ifc << filler << "    output <<  \"\\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        }
     } else {
         if ((a->ClassifierName == "uint64_t") || (a->ClassifierName == "objectid_t")) {
             if (!first) {
@@ -831,16 +930,22 @@ void CSignalClass::DumpJSONValue(std::ofstream& ifc, std::shared_ptr<CAttribute>
     }
 }
 
-void CSignalClass::DumpJSONValue(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
-    std::string filler;
+void CSignalClass::DumpJSONValue(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first, int space) {
+    const std::string& filler = CodeWriter::spaces(space);
+    std::string        literal = CEnumeration::JSONWriter(a->Classifier, prefix + a->name);
 
-    filler.assign(space, ' ');
     if (a->Classifier->name == "string") {
         if (!first) {
             ifc << filler << "    output <<  \", \\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         } else {
             ifc << filler << "    output <<  \"\\\"" << a->name << "\\\":\\\"\" << helper::escape(" << prefix << a->name << ") << \"\\\"\";\n";
         }
+    } else if (!literal.empty()) {
+        if (!first) {
+            ifc << filler << "    output <<  \", \\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        } else {
+            ifc << filler << "    output <<  \"\\\"" << a->name << "\\\":\" << " << literal << ";\n";
+        }
     } else {
         if ((a->Classifier->name == "uint64_t") || (a->Classifier->name == "objectid_t") || (a->Classifier->type == eElementType::Enumeration)) {
             if (!first) {
@@ -870,11 +975,11 @@ void CSignalClass::DumpJSONValue(std::ofstream& ifc, std::shared_ptr<CAssociatio
     }
 }
 
-void CSignalClass::DumpJSONOutgoingDeclaration(std::ofstream& ifc) {
+void CSignalClass::DumpJSONOutgoingDeclaration(CodeWriter& ifc) {
     ifc << "static std::ostream& sig_to_json_" << helper::tolower(basename) << "(tSig* aSig, std::ostream& output);\n";
 }
 
-void CSignalClass::toJSONBuddy(std::ofstream & ifc) {
+void CSignalClass::toJSONBuddy(CodeWriter & ifc) {
     std::string prefix;
     prefix="this->";
     ifc << "        output << \"\\\"SignalId\\\": \\\"" << basename << "\\\"\";\n";
@@ -909,8 +1014,92 @@ void CSignalClass::toJSONBuddy(std::ofstream & ifc) {
     }
 }
 
+//
+//  The buffer encoder writes the same members as toJSONBuddy, but into a
+//  buffer that is sized in advance from the generated upper bound. The stream
+//  serializer is kept for the interface code and writes through it.
+void CSignalClass::toJSONBuffer(CodeWriter & ifc) {
+    JsonEncoder encoder(8);
+
+    encoder.Literal("\"SignalId\":\"" + basename + "\"");
+    for (auto & ai : GetAttributes()) {
+        encoder.Member(std::dynamic_pointer_cast<CAttribute>(ai), "this->", false);
+    }
+    for (auto & ai : OtherEnd) {
+        encoder.Member(std::dynamic_pointer_cast<CAssociationEnd>(*ai), "this->", false);
+    }
+    ifc << "    virtual std::ostream& json(std::ostream& output) {\n"
+           "        thread_local std::string buffer;\n"
+           "\n"
+           "        buffer.clear();\n"
+           "        json(buffer);\n"
+           "        output.write(buffer.data(), buffer.size());\n"
+           "\n"
+           "        return output;\n"
+           "    }\n";
+    ifc << "    //\n"
+           "    //  Upper bound of the text written by json(char*).\n"
+           "    size_t json_size() const {\n"
+        << encoder.Size()
+        << "    }\n";
+    ifc << "    //\n"
+           "    //  Writes the JSON text to aOut, which must hold json_size() characters.\n"
+           "    //  Returns the end of the text.\n"
+           "    char* json(char* aOut) const {\n"
+        << encoder.Pack()
+        << "\n        return aOut;\n"
+           "    }\n";
+    ifc << "    void json(std::string& aOut) const {\n"
+           "        size_t used = aOut.size();\n"
+           "\n"
+           "        aOut.resize(used + json_size());\n"
+           "        aOut.resize(json(&aOut[used]) - aOut.data());\n"
+           "    }\n";
+}
 
-void CSignalClass::DumpJSONOutgoing(std::ofstream& ifc) {
+//
+//  Writes the single pass decoder of the members that toJSONBuffer writes.
+void CSignalClass::fromJSONBuffer(CodeWriter & ifc) {
+    JsonDecoder decoder;
+
+    decoder.Key("Destination", "objectid_t dstid = 0;\n"
+                               "\n"
+                               "aReader.value(dstid);\n"
+                               "dst = tReference(dstid, nullptr);\n");
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            decoder.Member(std::dynamic_pointer_cast<CAttribute>(ai), "this->");
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        if (ai->visibility == vPublic) {
+            decoder.Member(std::dynamic_pointer_cast<CAssociationEnd>(*ai), "this->");
+        }
+    }
+    ifc << "    //\n"
+           "    //  This is the single pass de-serializer. It reads the JSON object text\n"
+           "    //  straight into the members without building a tree.\n"
+           "    bool unpack_json(const char* aText, size_t aSize) {\n"
+           "        mtt::json_reader reader(aText, aSize);\n"
+           "\n"
+           "        return unpack_json(reader);\n"
+           "    }\n"
+           "    bool unpack_json(mtt::json_reader& aReader) {\n"
+           "        dst = tReference(0, nullptr);\n";
+    for (auto & ai : GetAttributes()) {
+        auto a = std::dynamic_pointer_cast<CAttribute>(ai);
+
+        if ((a->visibility == vPublic) && !a->defaultValue.empty() && !a->isMultiple) {
+            ifc << "        " << a->name << " = " << a->defaultValue << ";\n";
+        }
+    }
+    ifc << "\n"
+        << decoder.Object(8)
+        << "\n        return aReader.good();\n"
+           "    }\n";
+}
+
+void CSignalClass::DumpJSONOutgoing(CodeWriter& ifc) {
     std::string prefix;
     ifc << "// **************************************************************************\n";
     ifc << "//\n";
@@ -964,5 +1153,93 @@ void CSignalClass::DumpJSONOutgoing(std::ofstream& ifc) {
     ifc << "}\n";
 }
 
+//
+//  The TLV signals are full signal classes, as the interface creates them from
+//  JSON as well. The binary codec is added to them.
 void CSignalClass::DumpTLV(std::shared_ptr<MModel> model) {
+    DumpJSON(model);
+}
+
+void CSignalClass::toTLV(CodeWriter& ifc) {
+    TlvCodec codec;
+
+    for (auto & ai : GetAttributes()) {
+        if (ai->visibility == vPublic) {
+            codec.Member(std::dynamic_pointer_cast<CAttribute>(ai), name);
+        }
+    }
+    for (auto & ai : OtherEnd) {
+        auto a = std::dynamic_pointer_cast<CAssociationEnd>(*ai);
+
+        if ((a->visibility == vPublic) && a->isNavigable()) {
+            codec.Member(a, name);
+        }
+    }
+    ifc << "    //\n"
+           "    //  This is the binary TLV serializer. tlv_size() is the exact size of the\n"
+           "    //  records written by pack_tlv().\n"
+           "    size_t tlv_size() const {\n"
+        << codec.Size(8)
+        << "    }\n"
+           "    uint8_t* pack_tlv(uint8_t* aOut) const {\n"
+        << codec.Pack(8)
+        << "    }\n"
+           "    void pack_tlv(std::vector<uint8_t>& aOut) const {\n"
+           "        size_t used = aOut.size();\n"
+           "\n"
+           "        aOut.resize(used + tlv_size());\n"
+           "        pack_tlv(aOut.data() + used);\n"
+           "    }\n"
+           "    //\n"
+           "    //  The de-serializer skips records with unknown tags.\n"
+           "    bool unpack_tlv(const uint8_t* aData, size_t aSize) {\n"
+           "        mtt::tlv_reader reader(aData, aSize);\n"
+           "\n"
+           "        return unpack_tlv(reader);\n"
+           "    }\n"
+           "    bool unpack_tlv(mtt::tlv_reader& aReader) {\n"
+        << codec.Unpack(8)
+        << "    }\n";
+}
+
+void CSignalClass::toProtobuf(CodeWriter& ifc) {
+    ProtoCodec codec;
+
+    ProtobufMembers(codec);
+    ifc << "    //\n"
+           "    //  This is the protobuf serializer. It writes the proto3 wire format.\n"
+           "    //  proto_size() is the exact size of the fields written by pack_proto().\n"
+           "    size_t proto_size() const {\n"
+        << codec.Size(8)
+        << "    }\n"
+           "    uint8_t* pack_proto(uint8_t* aOut) const {\n"
+        << codec.Pack(8)
+        << "    }\n"
+           "    //\n"
+           "    //  Writes nothing and returns 0 if the buffer is too small.\n"
+           "    size_t pack_proto(uint8_t* aOut, size_t aSize) const {\n"
+           "        size_t size = proto_size();\n"
+           "\n"
+           "        if (size > aSize) {\n"
+           "            return 0;\n"
+           "        }\n"
+           "        pack_proto(aOut);\n"
+           "        return size;\n"
+           "    }\n"
+           "    void pack_proto(std::vector<uint8_t>& aOut) const {\n"
+           "        size_t used = aOut.size();\n"
+           "\n"
+           "        aOut.resize(used + proto_size());\n"
+           "        pack_proto(aOut.data() + used);\n"
+           "    }\n"
+           "    //\n"
+           "    //  The de-serializer skips fields with unknown numbers.\n"
+           "    bool unpack_proto(const uint8_t* aData, size_t aSize) {\n"
+           "        mtt::pb_reader reader(aData, aSize);\n"
+           "\n"
+           "        return unpack_proto(reader);\n"
+           "    }\n"
+           "    bool unpack_proto(mtt::pb_reader& aReader) {\n"
+        << codec.Unpack(8)
+        << "    }\n";
 }
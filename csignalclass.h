@@ -26,6 +26,8 @@
 #include "ccxxclass.h"
 
 class CAssociationEnd;
+class ProtoCodec;
+class FlatLayout;
 
 enum class SignalEncoding {
     none,     //  No code is will be generated.
@@ -49,28 +51,34 @@ public:
     void DumpProtobuf(std::shared_ptr<MModel> aModel);
     void DumpTLV(std::shared_ptr<MModel> aModel);
     //void CollectNeededModelHeader(std::shared_ptr<MElement> e) ;
-    void DumpJSONIncoming(std::ofstream& ifc);
-    void DumpJSONIncomingDeclaration(std::ofstream& ifc);
-    void DumpJSONIncomingValues(std::ofstream& ifc, std::shared_ptr<CClassBase> aClass, std::string prefix, std::string jsonvar, int space);
-    void DumpJSONIncomingArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, int space);
-    void DumpJSONIncomingArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, int space);
-    void DumpJSONIncomingStruct(std::ofstream& ifc, std::shared_ptr<MElement> aStruct, std::string prefix, int space);
+    void DumpJSONIncoming(CodeWriter& ifc);
+    void DumpJSONIncomingDeclaration(CodeWriter& ifc);
+    void DumpJSONIncomingValues(CodeWriter& ifc, std::shared_ptr<CClassBase> aClass, std::string prefix, std::string jsonvar, int space);
+    void DumpJSONIncomingArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, int space);
+    void DumpJSONIncomingArray(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, int space);
+    void DumpJSONIncomingStruct(CodeWriter& ifc, std::shared_ptr<MElement> aStruct, std::string prefix, int space);
 
-    void DumpJSONOutgoing(std::ofstream& ifc);
-    void DumpJSONOutgoingDeclaration(std::ofstream& ifc);
-    void DumpJSONStruct(std::ofstream& ifc, std::shared_ptr<MElement> e, std::string sname, std::string prefix, bool first=false, int space=0);
-    void DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
-    void DumpJSONValue(std::ofstream& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
-    void DumpJSONArray(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
-    void DumpJSONValue(std::ofstream& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
+    void DumpJSONOutgoing(CodeWriter& ifc);
+    void DumpJSONOutgoingDeclaration(CodeWriter& ifc);
+    void DumpJSONStruct(CodeWriter& ifc, std::shared_ptr<MElement> e, std::string sname, std::string prefix, bool first=false, int space=0);
+    void DumpJSONArray(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
+    void DumpJSONValue(CodeWriter& ifc, std::shared_ptr<CAttribute> a, std::string prefix, bool first=false, int space=0);
+    void DumpJSONArray(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
+    void DumpJSONValue(CodeWriter& ifc, std::shared_ptr<CAssociationEnd> a, std::string prefix, bool first=false, int space=0);
 
-    void toJSONBuddy(std::ofstream& ifc);
-    void fromJSONBuddy(std::ofstream& ifc);
+    void toJSONBuddy(CodeWriter& ifc);
+    void toJSONBuffer(CodeWriter& ifc);
+    void fromJSONBuffer(CodeWriter& ifc);
+    void toTLV(CodeWriter& ifc);
+    void toProtobuf(CodeWriter& ifc);
+    void fromJSONBuddy(CodeWriter& ifc);
 
-
-    void DumpProtobufAttributes(std::ofstream& a_pbfile, int a_indentation);
+    void ProtobufMembers(ProtoCodec& aCodec);
+    void FlatMembers(FlatLayout& aLayout);
 public:
     SignalEncoding m_encoding = SignalEncoding::none;
+    bool           jsonbuffer = false;
+    bool           flatlayout = false;
     std::string    direction;
     std::string    msgtype;
     std::string    basename;
@@ -78,7 +86,6 @@ public:
     std::string    upper_name;
     std::string    lower_basename;
     std::string    upper_basename;
-    int            m_attribute_index = 1;
 };
 
 #endif // CSIGNALCLASS_H
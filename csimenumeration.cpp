@@ -30,6 +30,8 @@
 
 #include "mattribute.h"
 #include "cattribute.h"
+#include "perfecthash.h"
+#include "enumtable.h"
 
 extern long simversion;
 
@@ -56,15 +58,11 @@ void CSimEnumeration::Prepare(void) {
     upper_basename=helper::toupper(basename);
 }
 
-void CSimEnumeration::Dump(std::shared_ptr<MModel> model) {
-    std::list<std::pair<std::string, std::string> > alist;
-    size_t                                          alistmax = 0;
-    Crc64                                           crc;
-    DumpBase(std::dynamic_pointer_cast<CModel>(model), name);
-    DumpFileHeader(hdr, name, ".h");
-    DumpGuardHead(hdr, basename);
-    //
-    //  Create the list of attributes and the values.
+//
+//  Fill the id map that is exported to ids.h and the list of names and values.
+void CSimEnumeration::CollectIds(std::list<std::pair<std::string, std::string> >& aList) {
+    Crc64 crc;
+
     for (auto & i : Attribute) {
         auto a = std::dynamic_pointer_cast<CAttribute>(*i);
         std::string defvalue;
@@ -72,12 +70,38 @@ void CSimEnumeration::Dump(std::shared_ptr<MModel> model) {
         defvalue = "IDE_"+helper::toupper(helper::normalize(a->name.substr(1)));
         if (a->defaultValue.empty()) {
             id_map.insert(std::pair<std::string, uint64_t>(defvalue, crc.calc(defvalue)));
-            alist.emplace_back( a->name, defvalue);
+            aList.emplace_back( a->name, defvalue);
         } else {
             id_map.insert(std::pair<std::string, uint64_t>(defvalue, strtoul(a->defaultValue.c_str(), 0, 0)));
-            alist.emplace_back( a->name, a->defaultValue);
+            aList.emplace_back( a->name, a->defaultValue);
         }
     }
+}
+
+void CSimEnumeration::Dump(std::shared_ptr<MModel> model) {
+    std::list<std::pair<std::string, std::string> > alist;
+    size_t                                          alistmax = 0;
+    Crc64                                           crc;
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        CollectIds(alist);
+        return;
+    }
+
+    DumpBase(std::dynamic_pointer_cast<CModel>(model), name);
+    DumpFileHeader(hdr, name, ".h");
+    DumpGuardHead(hdr, basename);
+    if ((simversion == 2) && (!Attribute.empty())) {
+        PerfectHash::Dump(std::dynamic_pointer_cast<CModel>(model), id);
+        hdr << "#include <cstddef>\n"
+               "#include <cstdint>\n"
+               "#include <string_view>\n"
+               "#include \"" << PerfectHash::Name() << "\"\n\n";
+    }
+    //
+    //  Create the list of attributes and the values.
+    CollectIds(alist);
     //
     //  Find the max size of the attribute name.
     for (auto & ilist: alist) {
@@ -94,8 +118,7 @@ void CSimEnumeration::Dump(std::shared_ptr<MModel> model) {
         std::string defvalue;
 
         defvalue = "IDE_"+helper::toupper(helper::normalize(a->name.substr(1)));
-        std::string filler;
-        filler.assign((alistmax+4)-defvalue.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces((alistmax+4)-defvalue.size()+1);
 
         if (a->defaultValue.empty()) {
             hdr << "#ifndef " << defvalue << "\n";
@@ -114,8 +137,7 @@ void CSimEnumeration::Dump(std::shared_ptr<MModel> model) {
         hdr << "typedef enum __" << name << " {";
 
         for (auto & ilist : alist) {
-            std::string filler;
-            filler.assign(alistmax-ilist.first.size()+1, ' ');
+            const std::string& filler = CodeWriter::spaces(alistmax-ilist.first.size()+1);
             if (ilist == *alist.begin()) {
                 hdr << "\n    " << ilist.first << filler << " = " << ilist.second;
             } else {
@@ -134,6 +156,26 @@ void CSimEnumeration::Dump(std::shared_ptr<MModel> model) {
         }
         hdr << "};\n";
         hdr << "\n";
+        //
+        //  The ids are spread by the crc, so the names are found by a switch.
+        if (!Attribute.empty()) {
+            EnumTable table(name, "uint64_t");
+
+            for (auto & i : Attribute) {
+                auto     a      = std::dynamic_pointer_cast<CAttribute>(*i);
+                char*    end    = nullptr;
+                uint64_t number = strtoull(a->defaultValue.c_str(), &end, 0);
+
+                if (a->defaultValue.empty()) {
+                    table.Add(a->name, name + "::" + a->name, crc.calc("IDE_" + helper::toupper(helper::normalize(a->name.substr(1)))));
+                } else if (*end == '\0') {
+                    table.Add(a->name, name + "::" + a->name, number);
+                } else {
+                    table.Add(a->name, name + "::" + a->name);
+                }
+            }
+            hdr << table.Definition() << "\n";
+        }
     }
     DumpGuardTail(hdr, basename);
 
@@ -34,6 +34,7 @@ public:
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
 private :
+    void CollectIds(std::list<std::pair<std::string, std::string> >& aList);
 public:
     std::map<std::string, uint64_t> id_map;             //  This map is used to be exported to the ids.
     std::string                     basename;
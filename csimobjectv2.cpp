@@ -18,6 +18,7 @@
 // CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <iomanip>
+#include <algorithm>
 #include <sstream>
 
 #include "main.h"
@@ -40,6 +41,10 @@
 #include "mclass.h"
 #include "cclass.h"
 #include "cmodel.h"
+#include "containerheader.h"
+#include "cstatetable.h"
+#include "perfecthash.h"
+#include "profileheader.h"
 #include "mmessage.h"
 #include "cmessage.h"
 #include "msimmessage.h"
@@ -137,6 +142,15 @@ std::string CSimObjectV2::MapVariant(const std::string& classifier) {
     }
     return retval;
 }
+//
+//  The template store keeps the template instances by their id.
+std::string CSimObjectV2::TemplateStoreType() const {
+    if (Pooled) {
+        return "mtt::flat_hash_map<objectid_t, " + name + "*>";
+    }
+    return "std::map<objectid_t, " + name + "*>";
+}
+
 std::string CSimObjectV2::MapSimAttr(const std::string& classifier) {
     std::string retval = classifier;
 
@@ -193,6 +207,25 @@ void CSimObjectV2::SetFromTags(const std::string& name, const std::string&value)
     if (helper::tolower(name) == "releasetimeout") {
         ReleaseTimeout = std::atol(value.c_str());
     }
+    if (helper::tolower(name) == "pool") {
+        Pooled = (helper::tolower(value) != "false");
+    }
+    if (helper::tolower(name) == "profile") {
+        Profiled = (helper::tolower(value) != "false");
+    }
+    if (helper::tolower(name) == "messagehandler") {
+        RawMessages = (helper::tolower(value) == "pointer");
+    }
+    if (helper::tolower(name) == "dbupdate") {
+        BatchUpdates = (helper::tolower(value) == "cycle");
+    }
+    if (helper::tolower(name) == "statemachine") {
+        if (helper::tolower(value) == "table") {
+            statetable = std::make_shared<CStateTable>();
+        } else {
+            statetable.reset();
+        }
+    }
 }
 //
 //  This is an easy indication for SimObject Types.
@@ -1017,6 +1050,19 @@ void CSimObjectV2::Prepare(void) {
         CollectAttributes();
         PrepareBase();
         //
+        //  Public ends of simple types and sim objects are kept in the member
+        //  arrays of the appcore. A container policy does not apply to them.
+        for (auto & a : allEnds) {
+            if ((a) && (a->visibility == vPublic) && (a->Classifier)) {
+                std::string fqn = (a->Classifier->type == eElementType::SimEnumeration) ? "uint64_t" : a->FQN();
+
+                fqn = MapSimAttr(fqn);
+                if ((fqn == "tMemberValue") || (fqn == "tMemberRef")) {
+                    a->mContainerPolicy = EContainerPolicy::map;
+                }
+            }
+        }
+        //
         //  Create the Basename and the lowercase version.
         if (basename.empty()) {
             basename=name;
@@ -1122,6 +1168,8 @@ std::string CSimObjectV2::MkType(std::shared_ptr<CAssociationEnd> a) {
         retval=fqn;
     } else if (a->Multiplicity == "0..1") {
         retval=fqn+"*";
+    } else if (a->HasContainerPolicy()) {
+        retval=a->MkContainer((a->QualifierType.empty()) ? "uint64_t" : a->QualifierType, fqn);
     } else if (a->Multiplicity == "0..*") {
         if (a->QualifierType.empty()) {
             retval=std::string("std::map< uint64_t, ")+fqn+" >";
@@ -1223,6 +1271,8 @@ std::string CSimObjectV2::MkSimAttr(std::shared_ptr<CAssociationEnd> a) {
             retval=fqn;
         } else if (a->Multiplicity == "0..1") {
             retval=fqn;
+        } else if ((a->HasContainerPolicy()) && (fqn != "tMemberValue") && (fqn != "tMemberRef")) {
+            retval=a->MkContainer("uint64_t", fqn);
         } else if (a->Multiplicity == "0..*") {
             if (fqn == "tMemberValue") {
                 retval="tMemberValueArray";
@@ -1303,6 +1353,8 @@ std::string CSimObjectV2::MkVariant(std::shared_ptr<CAssociationEnd> a) {
             retval=fqn;
         } else if (a->Multiplicity == "0..1") {
             retval=fqn;
+        } else if (a->HasContainerPolicy()) {
+            retval=a->MkContainer(qualifier, fqn);
         } else if (a->Multiplicity == "0..*") {
             retval=std::string("LockedMap< ") + qualifier + ", " +fqn +" >";
         } else if (a->Multiplicity == "1..*") {
@@ -1432,36 +1484,39 @@ std::shared_ptr<MState> CSimObjectV2::GetInitialTargetState(std::shared_ptr<MSta
 }
 
 
-void CSimObjectV2::DumpSetStateSwitch(std::ostream& output) {
+void CSimObjectV2::DumpSetStateSwitch(std::ostream& output, tCaseLabels& aCases) {
     if (statemachine) {
         auto sm = std::dynamic_pointer_cast<CSimStatemachine>(*statemachine);
 
-        output << "    case IDA_STATE:\n";
+        CodeWriter::caselabel(output, "IDA_STATE", aCases);
         output << "        "<< "state = value;\n";
+        if (statetable) {
+            statetable->DumpSetState(output, basename);
+        }
         output << "        break;\n";
         for (auto & st : sm->states) {
             if (st->type == eElementType::State) {
                 auto substate = std::dynamic_pointer_cast<CState>(*st);
 
-                substate->DumpSetStateSwitch(output, basename);
+                substate->DumpSetStateSwitch(output, basename, aCases);
             }
         }
     }
 }
 
 
-void CSimObjectV2::DumpGetStateSwitch(std::ostream& output) {
+void CSimObjectV2::DumpGetStateSwitch(std::ostream& output, tCaseLabels& aCases) {
     if (statemachine) {
         auto sm = std::dynamic_pointer_cast<CSimStatemachine>(*statemachine);
 
-        output << "    case IDA_STATE:\n";
+        CodeWriter::caselabel(output, "IDA_STATE", aCases);
         output << "        "<< "retval = state;\n";
         output << "        break;\n";
         for (auto & st : sm->states) {
             if (st->type == eElementType::State) {
                 auto substate = std::dynamic_pointer_cast<CState>(*st);
 
-                substate->DumpGetStateSwitch(output, basename);
+                substate->DumpGetStateSwitch(output, basename, aCases);
             }
         }
     }
@@ -1498,7 +1553,7 @@ void CSimObjectV2::DumpSetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
             }
             if (a->visibility==vPublic) {
                 if ((!a->Classifier) && (!a->ClassifierName.empty())) {
-                    where->src << "    case " << uppername << ":\n";
+                    CodeWriter::caselabel(where->src, uppername, where->cases);
                     where->src << "        *((tVariant*)(&" << localobject <<  a->name << ")) = value;\n";
                     where->src << "        break;\n";
                 } else {
@@ -1511,7 +1566,7 @@ void CSimObjectV2::DumpSetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                             where->refs.push_back(a);
                             //
                             //  Create the case label.
-                            where->src << "    case " << uppername << ":\n";
+                            CodeWriter::caselabel(where->src, uppername, where->cases);
                             if ((a->Multiplicity == "1") || (a->Multiplicity == "0..1") || a->Multiplicity.empty()) {
                                 where->src << "        ((tObjectRef&)" << localobject <<  a->name << ") = tObjectRef(value, nullptr);\n";
                             } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
@@ -1530,7 +1585,7 @@ void CSimObjectV2::DumpSetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                         case eElementType::Class:
                             break;
                         default:
-                            where->src << "    case " << uppername << ":\n";
+                            CodeWriter::caselabel(where->src, uppername, where->cases);
                             if ((a->Multiplicity == "1") || (a->Multiplicity == "0..1") || (a->Multiplicity.empty()) ) {
                                 where->src << "        ((tVariant&)" << localobject <<  a->name << ") = value;\n";
                             } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
@@ -1591,32 +1646,36 @@ void CSimObjectV2::DumpSetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                         where->refs.push_back(a);
                         //
                         //  Create the case label.
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if ((a->Multiplicity == "1") || (a->Multiplicity == "0..1") || (a->Multiplicity.size() == 0)) {
                             where->src << "        ((tObjectRef&)" << localobject <<  a->name << ") = tObjectRef(value, nullptr);\n";
                         } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
-                            where->src << "        (tObjectRef&)(" << localobject << a->name << "[valueindex]) = tObjectRef(value, nullptr);\n";
+                            if (a->IsConcurrent()) {
+                                where->src << "        " << a->Write(localobject + a->name, "valueindex", "tObjectRef(value, nullptr)") << ";\n";
+                            } else {
+                                where->src << "        (tObjectRef&)(" << a->Element(localobject + a->name, "valueindex") << ") = tObjectRef(value, nullptr);\n";
+                            }
                         } else {
                         }
                         where->src << "        break;\n";
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            DumpSetValueSwitch(where, a->Classifier, localobject+a->name+"[valueindex].", uppername+"_", aDoneList);
+                            DumpSetValueSwitch(where, a->Classifier, a->Element(localobject+a->name, "valueindex")+".", uppername+"_", aDoneList);
                         } else {
                             DumpSetValueSwitch(where, a->Classifier, localobject+a->name+".", uppername+"_", aDoneList);
                         }
                         break;
                     case eElementType::SimEnumeration:
                     case eElementType::Enumeration:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if ((a->Multiplicity == "1") || (a->Multiplicity == "0..1") || (a->Multiplicity.size() == 0) ) {
                             where->src << "        ((tVariant&)" << localobject <<  a->name << ") = value;\n";
                         } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
                             if (IsVariantType(a->Classifier->name)) {
-                                where->src << "        (tVariant&)(" << localobject << a->name << "[valueindex]) = value;\n";
+                                where->src << "        (tVariant&)(" << a->Element(localobject + a->name, "valueindex") << ") = value;\n";
                             } else {
-                                where->src << "        (tVariant&)(" << localobject << a->name << "[valueindex]) = value;\n";
+                                where->src << "        (tVariant&)(" << a->Element(localobject + a->name, "valueindex") << ") = value;\n";
                             }
                         } else {
                         }
@@ -1627,14 +1686,18 @@ void CSimObjectV2::DumpSetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                         break;
 
                     default:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if ((a->Multiplicity == "1") || (a->Multiplicity == "0..1") || (a->Multiplicity.size() == 0) ) {
                             where->src << "        ((tVariant&)" << localobject <<  a->name << ") = value;\n";
                         } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
                             if (IsVariantType(a->Classifier->name)) {
-                                where->src << "        (tVariant&)(" << localobject << a->name << "[valueindex]) = value;\n";
+                                where->src << "        (tVariant&)(" << a->Element(localobject + a->name, "valueindex") << ") = value;\n";
                             } else {
-                                where->src << "        (tVariant&)(" << localobject << a->name << "[valueindex]) = *((" << a->Classifier->name << "*)(value));\n";
+                                if (a->IsConcurrent()) {
+                                    where->src << "        " << a->Write(localobject + a->name, "valueindex", "*((" + a->Classifier->name + "*)(value))") << ";\n";
+                                } else {
+                                    where->src << "        (tVariant&)(" << a->Element(localobject + a->name, "valueindex") << ") = *((" << a->Classifier->name << "*)(value));\n";
+                                }
                             }
                         } else {
                         }
@@ -1667,7 +1730,7 @@ void CSimObjectV2::DumpGetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
 
             if ((a->visibility==vPublic) || (a->visibility == vProtected)) {
                 if (!(a->Classifier) && (!a->ClassifierName.empty())) {
-                    where->src << "    case " << uppername << ":\n";
+                    CodeWriter::caselabel(where->src, uppername, where->cases);
                     if (a->isMultiple) {
                         where->src << "        retval = " << localobject <<  a->name << "[valueindex];\n";
                     } else {
@@ -1690,7 +1753,7 @@ void CSimObjectV2::DumpGetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                         case eElementType::Class:
                             break;
                         default:
-                            where->src << "    case " << uppername << ":\n";
+                            CodeWriter::caselabel(where->src, uppername, where->cases);
                             if (a->isMultiple) {
                                 where->src << "        retval = " << localobject <<  a->name << "[valueindex];\n";
                             } else {
@@ -1721,7 +1784,7 @@ void CSimObjectV2::DumpGetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            DumpGetValueSwitch(where, a->Classifier, localobject+a->name+"[valueindex].", uppername+"_", aDoneList);
+                            DumpGetValueSwitch(where, a->Classifier, a->Element(localobject+a->name, "valueindex")+".", uppername+"_", aDoneList);
                         } else {
                             DumpGetValueSwitch(where, a->Classifier, localobject+a->name+".", uppername+"_", aDoneList);
                         }
@@ -1729,17 +1792,17 @@ void CSimObjectV2::DumpGetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::
                     case eElementType::Class:
                         break;
                     default:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->Classifier->name != "string") {
                             if ((a->Multiplicity == "1") || (a->Multiplicity.size() == 0)) {
                                 where->src << "        retval = (" << MapType(a) << ")(" << localobject <<  a->name << ");\n";
                             } else if (a->Multiplicity == "0..1") {
                             } else if ((a->Multiplicity == "0..*") || (a->Multiplicity == "1..*") || (a->Multiplicity == "*")) {
                                 if (a->QualifierType.empty()) {
-                                    where->src << "        retval = (" << MapType(a) << ")(" << localobject <<  a->name << "[valueindex]);\n";
+                                    where->src << "        retval = (" << MapType(a) << ")(" << a->Read(localobject + a->name, "valueindex") << ");\n";
                                 } else {
                                     if (a->QualifierType=="uint64_t") {
-                                        where->src << "        retval = (" << MapType(a) << ")(" << localobject <<  a->name << "[valueindex]);\n";
+                                        where->src << "        retval = (" << MapType(a) << ")(" << a->Read(localobject + a->name, "valueindex") << ");\n";
                                     }
                                 }
                             } else {
@@ -1785,11 +1848,11 @@ void CSimObjectV2::DumpSetValueDBSwitch(std::shared_ptr<CSimObjectV2> where, std
             if (!(a->Classifier) && (!a->ClassifierName.empty())){
                 std::string maptype=MapType(a);
 
-                where->src << "    case " << uppername << ":\n";
+                CodeWriter::caselabel(where->src, uppername, where->cases);
                 if (a->isMultiple) {
                     where->src << "        " << localobject << a->name << "[valueindex] = value;\n";
                 } else {
-                    where->src << "        " << localobject << a->name << " = value;\n";
+                    DumpSetDBValue(where, localobject, a->name);
                 }
                 where->src << "        break;\n";
             } else {
@@ -1807,11 +1870,11 @@ void CSimObjectV2::DumpSetValueDBSwitch(std::shared_ptr<CSimObjectV2> where, std
                     case eElementType::Class:
                         break;
                     default:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->isMultiple) {
                             where->src << "        " << localobject << a->name << "[valueindex] = value;\n";
                         } else {
-                            where->src << "        " << localobject << a->name << " = value;\n";
+                            DumpSetDBValue(where, localobject, a->name);
                         }
 
                         where->src << "        break;\n";
@@ -1838,7 +1901,7 @@ void CSimObjectV2::DumpSetValueDBSwitch(std::shared_ptr<CSimObjectV2> where, std
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            DumpSetValueSwitch(where, a->Classifier, localobject+a->name+"[valueindex].", uppername+"_", aDoneList);
+                            DumpSetValueSwitch(where, a->Classifier, a->Element(localobject+a->name, "valueindex")+".", uppername+"_", aDoneList);
                         } else {
                             DumpSetValueSwitch(where, a->Classifier, localobject+a->name+".", uppername+"_", aDoneList);
                         }
@@ -1846,11 +1909,11 @@ void CSimObjectV2::DumpSetValueDBSwitch(std::shared_ptr<CSimObjectV2> where, std
                     case eElementType::Class:
                         break;
                     default:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->isMultiple) {
-                            where->src << "        " << localobject << a->name << "[valueindex] = value;\n";
+                            where->src << "        " << a->Write(localobject + a->name, "valueindex", "value") << ";\n";
                         } else {
-                            where->src << "        " << localobject << a->name << " = value;\n";
+                            DumpSetDBValue(where, localobject, a->name);
                         }
 
                         where->src << "        break;\n";
@@ -1896,7 +1959,7 @@ void CSimObjectV2::DumpGetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, s
                         case eElementType::SimObject:
                             //
                             //  Create the case label.
-                            where->src << "    case " << uppername << ":\n";
+                            CodeWriter::caselabel(where->src, uppername, where->cases);
                             if ((!a->isMultiple) || (a->Multiplicity == "0..1")) {
                                 where->src << "        retval = " << localobject <<  a->name << ";\n";
                             } else {
@@ -1938,17 +2001,17 @@ void CSimObjectV2::DumpGetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, s
                     case eElementType::SimObject:
                         //
                         //  Create the case label.
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if ((!a->isMultiple) || (a->Multiplicity == "0..1")) {
                             where->src << "        retval = " << localobject <<  a->name << ";\n";
                         } else {
-                            where->src << "        retval = " << localobject <<  a->name << "[valueindex];\n";
+                            where->src << "        retval = " << a->Read(localobject + a->name, "valueindex") << ";\n";
                         }
                         where->src << "        break;\n";
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            DumpGetReferenceSwitch(where, a->Classifier, localobject+a->name+"[valueindex].", uppername+"_", aDoneList);
+                            DumpGetReferenceSwitch(where, a->Classifier, a->Element(localobject+a->name, "valueindex")+".", uppername+"_", aDoneList);
                         } else {
                             DumpGetReferenceSwitch(where, a->Classifier, localobject+a->name+".", uppername+"_", aDoneList);
                         }
@@ -1995,7 +2058,7 @@ void CSimObjectV2::DumpSetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, s
                 if (a->Classifier) {
                     switch (a->Classifier->type) {
                     case eElementType::SimObject:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->isMultiple) {
                             where->src << "        " << localobject << a->name << "[valueindex] = value;\n";
                         } else {
@@ -2033,9 +2096,9 @@ void CSimObjectV2::DumpSetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, s
                 if (a->Classifier) {
                     switch (a->Classifier->type) {
                     case eElementType::SimObject:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->isMultiple) {
-                            where->src << "        " << localobject << a->name << "[valueindex] = value;\n";
+                            where->src << "        " << a->Write(localobject + a->name, "valueindex", "value") << ";\n";
                         } else {
                             where->src << "        " << localobject << a->name << " = value;\n";
                         }
@@ -2043,7 +2106,7 @@ void CSimObjectV2::DumpSetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, s
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            DumpSetReferenceSwitch(where, a->Classifier, localobject+a->name+"[valueindex].", uppername+"_", aDoneList);
+                            DumpSetReferenceSwitch(where, a->Classifier, a->Element(localobject+a->name, "valueindex")+".", uppername+"_", aDoneList);
                         } else {
                             DumpSetReferenceSwitch(where, a->Classifier, localobject+a->name+".", uppername+"_", aDoneList);
                         }
@@ -2090,7 +2153,7 @@ void CSimObjectV2::DumpRemoveReferenceSwitch(std::shared_ptr<CSimObjectV2> where
                 if (a->Classifier) {
                     switch (a->Classifier->type) {
                     case eElementType::SimObject:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->isMultiple) {
                             where->src << "        " << localobject << a->name << ".Remove(valueindex);\n";
                         } else {
@@ -2128,9 +2191,9 @@ void CSimObjectV2::DumpRemoveReferenceSwitch(std::shared_ptr<CSimObjectV2> where
                 if (a->Classifier) {
                     switch (a->Classifier->type) {
                     case eElementType::SimObject:
-                        where->src << "    case " << uppername << ":\n";
+                        CodeWriter::caselabel(where->src, uppername, where->cases);
                         if (a->isMultiple) {
-                            where->src << "        " << localobject << a->name << ".Remove(valueindex);\n";
+                            where->src << "        " << a->Remove(localobject + a->name, "valueindex") << ";\n";
                         } else {
                             where->src << "        " << localobject << a->name << " = tObjectRef();\n";
                         }
@@ -2138,7 +2201,7 @@ void CSimObjectV2::DumpRemoveReferenceSwitch(std::shared_ptr<CSimObjectV2> where
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            DumpRemoveReferenceSwitch(where, a->Classifier, localobject+a->name+"[valueindex].", uppername+"_", aDoneList);
+                            DumpRemoveReferenceSwitch(where, a->Classifier, a->Element(localobject+a->name, "valueindex")+".", uppername+"_", aDoneList);
                         } else {
                             DumpRemoveReferenceSwitch(where, a->Classifier, localobject+a->name+".", uppername+"_", aDoneList);
                         }
@@ -2169,6 +2232,227 @@ void CSimObjectV2::DumpRemoveReferenceSwitch(std::shared_ptr<CSimObjectV2> where
     }
 }
 
+//
+//  The cases of the switch at aSwitch in src. They are taken from the cases
+//  written so far, the ones before aSwitch are left over from other functions.
+tCaseLabels CSimObjectV2::SwitchCases(size_t aSwitch) {
+    tCaseLabels retval;
+
+    for (auto & c : cases) {
+        if (c.first >= aSwitch) {
+            retval.push_back(c);
+        }
+    }
+    cases.clear();
+    return retval;
+}
+
+//
+//  The switches over the value and message ids are sparse. With enough cases
+//  they are turned into a perfect hash lookup of the id and a dense switch over
+//  the case number, which the compiler emits as a jump table. aSwitch is the
+//  position of the switch over aSelector in src. The switch must be the last
+//  thing written to src.
+void CSimObjectV2::DumpIdDispatch(size_t aSwitch, const std::string& aSelector) {
+    static constexpr size_t cMinCases = 4;
+    auto                    buffer    = src.buffer();
+    tCaseLabels             labels    = SwitchCases(aSwitch);
+    std::string             head      = "    switch (" + aSelector + ") {\n";
+    std::string             body;
+    std::vector<uint64_t>   keys;
+    size_t                  from      = head.size();
+    PerfectHash             hash;
+    Crc64                   crc;
+
+    if (buffer->compare(aSwitch, head.size(), head) != 0) {
+        return;
+    }
+    for (auto & l : labels) {
+        const std::string& label = l.second;
+        //
+        //  Only the ids generated from their name can be hashed here. The
+        //  cycle signals are defined by the runtime.
+        if (((label.compare(0, 4, "IDA_") != 0) && (label.compare(0, 4, "IDM_") != 0) && (label.compare(0, 4, "IDS_") != 0)) ||
+            (label == "IDS_STARTCYCLE") || (label == "IDS_ENDCYCLE")) {
+            return;
+        }
+        auto id = id_map.find(label);
+
+        if (label == "IDA_OBJ_PARENT") {
+            keys.push_back(cObjParentId);
+        } else if (id != id_map.end()) {
+            keys.push_back(id->second);
+        } else {
+            keys.push_back(crc.calc(label));
+        }
+    }
+    if ((labels.size() < cMinCases) || (!hash.Build(keys))) {
+        return;
+    }
+    body = buffer->substr(aSwitch);
+    buffer->resize(aSwitch);
+    src << std::dec;
+    src << "    static constexpr uint16_t cSeed[" << hash.Seeds().size() << "] = {";
+    for (size_t b = 0; b < hash.Seeds().size(); ++b) {
+        src << ((b == 0) ? "" : ", ") << hash.Seeds()[b];
+    }
+    src << "};\n";
+    src << "    static constexpr uint64_t cKey[" << hash.Slots().size() << "] = {\n";
+    for (auto k : hash.Slots()) {
+        src << "        " << ((k == PerfectHash::npos) ? std::string("0") : labels[k].second) << ",\n";
+    }
+    src << "    };\n";
+    src << "    static constexpr uint16_t cCase[" << hash.Slots().size() << "] = {";
+    for (size_t s = 0; s < hash.Slots().size(); ++s) {
+        src << ((s == 0) ? "" : ", ") << ((hash.Slots()[s] == PerfectHash::npos) ? 0 : hash.Slots()[s] + 1);
+    }
+    src << "};\n";
+    src << "    size_t   slot = mtt::phash_slot(" << aSelector << ", cSeed, " << hash.BucketMask() << ", " << hash.Shift() << ");\n\n";
+    src << "    switch ((cKey[slot] == " << aSelector << ") ? cCase[slot] : 0) {\n";
+    for (size_t c = 0; c < labels.size(); ++c) {
+        size_t at = labels[c].first - aSwitch;
+
+        src.write(body.data() + from, static_cast<std::streamsize>(at - from));
+        src << "    case " << c + 1 << ":   // " << labels[c].second << "\n";
+        from = at + labels[c].second.size() + CodeWriter::cCaseSize;
+    }
+    src.write(body.data() + from, static_cast<std::streamsize>(body.size() - from));
+}
+
+//
+//  The profile scope is started before the switch of Process() and each case
+//  sets the index of its message id. The scope records the time when Process()
+//  returns. Returns the new position of the switch.
+size_t CSimObjectV2::DumpProfileScope(size_t aSwitch, std::vector<std::string>& aLabels) {
+    auto        buffer = src.buffer();
+    tCaseLabels labels = SwitchCases(aSwitch);
+    std::string body;
+    size_t      from   = 0;
+    size_t      retval;
+
+    if (labels.empty()) {
+        return aSwitch;
+    }
+    body = buffer->substr(aSwitch);
+    buffer->resize(aSwitch);
+    src << std::dec << "    mtt::profile_scope<" << name << ", " << labels.size() << "> profile;\n\n";
+    retval = buffer->size();
+    for (size_t c = 0; c < labels.size(); ++c) {
+        size_t at  = labels[c].first - aSwitch;
+        size_t end = at + labels[c].second.size() + CodeWriter::cCaseSize;
+
+        src.write(body.data() + from, static_cast<std::streamsize>(at - from));
+        CodeWriter::caselabel(src, labels[c].second, cases);
+        //
+        //  Cases that share their code get the index of the last one.
+        if ((c + 1 == labels.size()) || (labels[c + 1].first - aSwitch != end)) {
+            src << "        profile.index = " << c << ";\n";
+        }
+        aLabels.push_back(labels[c].second);
+        from = end;
+    }
+    src.write(body.data() + from, static_cast<std::streamsize>(body.size() - from));
+    return retval;
+}
+
+//
+//  With batched updates the changes of the objects are only marked. The
+//  objects are queued when the first bit gets set. At the end of the cycle
+//  the simulation interface calls <basename>_flush_dirty() that writes
+//  each changed value once.
+void CSimObjectV2::DumpFlushDirty(std::ostream& output) {
+    output << "\n"
+              "//\n"
+              "//  The objects with values changed in this cycle.\n"
+              "static std::vector<" << name << "*> d_objects;\n\n"
+              "void " << name << "::mark_dirty(uint64_t aBits) {\n"
+              "    if (mDirty == 0) {\n"
+              "        d_objects.push_back(this);\n"
+              "    }\n"
+              "    mDirty |= aBits;\n"
+              "}\n\n"
+              "void " << name << "::flush_dirty() {\n"
+              "    uint64_t dirty = mDirty;\n\n"
+              "    mDirty = 0;\n"
+              "    if ((dirty & cDirtyParent) != 0) {\n"
+              "        stdb_set((uint8_t)eMemberValueType::Reference, objid, IDA_OBJ_PARENT, 0, (uint64_t)(parent));\n"
+              "    }\n";
+    if (statemachine) {
+        output << "    if ((dirty & cDirtyState) != 0) {\n"
+                  "        stdb_updatedata(objid, IDA_STATE, 0, state);\n"
+                  "    }\n";
+    }
+    //
+    //  The member values write themselves to the database on assignment.
+    for (auto & v : dirtyvalues) {
+        output << "    if ((dirty & cDirty_" << v << ") != 0) {\n"
+                  "        tVariant value = *((tVariant*)(&" << v << "));\n\n"
+                  "        " << v << " = value;\n"
+                  "    }\n";
+    }
+    output << "}\n\n"
+              "void " << lower_basename << "_flush_dirty() {\n"
+              "    for (auto o : d_objects) {\n"
+              "        o->flush_dirty();\n"
+              "    }\n"
+              "    d_objects.clear();\n"
+              "}\n";
+}
+
+//
+//  SetValue assigns the values of the object. With batched updates the value
+//  is stored without writing it through and its dirty bit is set.
+void CSimObjectV2::DumpSetDBValue(std::shared_ptr<CSimObjectV2> where, const std::string& localobject, const std::string& aName) {
+    if (where->BatchUpdates && localobject.empty() &&
+        (std::find(where->dirtyvalues.begin(), where->dirtyvalues.end(), aName) != where->dirtyvalues.end())) {
+        where->src << "        *((tVariant*)(&" << aName << ")) = value;\n"
+                      "        mark_dirty(cDirty_" << aName << ");\n";
+    } else {
+        where->src << "        " << localobject << aName << " = value;\n";
+    }
+}
+//
+//  The single member values SetValue writes through to the database. Each of
+//  them gets a dirty bit after the parent and the state. Values that do not fit
+//  into the mask are still written through.
+void CSimObjectV2::CollectDirtyValues(std::shared_ptr<MElement> e, std::set<std::string>& aDoneList) {
+    static constexpr size_t cMaxDirtyValues = 62;
+    auto                    c = std::dynamic_pointer_cast<MClass>(e);
+
+    for (auto & i : c->Attribute) {
+        auto a = std::dynamic_pointer_cast<CAttribute>(*i);
+
+        if (((a->visibility == vPublic) || (a->visibility == vProtected)) && (!a->isMultiple) &&
+            (aDoneList.insert(helper::toupper(a->name)).second)) {
+            if ((MkSimAttr(a) == "tMemberValue") && (dirtyvalues.size() < cMaxDirtyValues)) {
+                dirtyvalues.push_back(a->name);
+            }
+        }
+    }
+    for (auto & i : c->OtherEnd) {
+        auto a = std::dynamic_pointer_cast<CAssociationEnd>(*i);
+
+        if ((a->Classifier) && (a->Classifier != e) && ((a->visibility == vPublic) || (a->visibility == vProtected)) &&
+            (!a->name.empty()) && (!a->isMultiple) && (aDoneList.insert(helper::toupper(a->name)).second)) {
+            if ((MkSimAttr(a) == "tMemberValue") && (dirtyvalues.size() < cMaxDirtyValues)) {
+                dirtyvalues.push_back(a->name);
+            }
+        }
+    }
+    for (auto & deplist : Dependency) {
+        auto target = std::dynamic_pointer_cast<CDependency>(*deplist)->target;
+
+        if (((*deplist)->HasStereotype("Import")) && (target->type == eElementType::SimObject)) {
+            std::dynamic_pointer_cast<CSimObjectV2>(*target)->CollectDirtyValues(*target, aDoneList);
+        }
+    }
+    for (auto& baselist : Base) {
+        if (baselist.getElement()->type == eElementType::SimObject) {
+            std::dynamic_pointer_cast<CSimObjectV2>(baselist.getElement())->CollectDirtyValues(baselist.getElement(), aDoneList);
+        }
+    }
+}
+
 //
 //  this only initializes the membervalues with its DB infos. No init of var content done here.
 void CSimObjectV2::DumpInitEmptyObject(std::ostream &output, std::shared_ptr<MElement> e, std::string localobject,
@@ -2826,8 +3110,8 @@ void CSimObjectV2::DumpCopyTemplate(std::ostream &output, std::shared_ptr<MEleme
                         break;
                     case eElementType::Struct:
                         if (a->isMultiple) {
-                            output << "            for (auto element : " << localobject << a->name << ") {\n";
-                                DumpCopyTemplate(src, a->Classifier, "    "+localobject+a->name+"[element.first].", uppername+"_", "element.second.", aDoneList);
+                            output << "            for (auto element : " << ((a->HasContainerPolicy()) ? "mtt::indexed(" + localobject + a->name + ")" : localobject + a->name) << ") {\n";
+                                DumpCopyTemplate(src, a->Classifier, "    "+a->Element(localobject+a->name, "element.first")+".", uppername+"_", "element.second.", aDoneList);
                             output << "            }\n";
                         } else {
                             DumpCopyTemplate(src, a->Classifier, localobject+a->name+".", uppername+"_", found+a->name+".", aDoneList);
@@ -3069,7 +3353,7 @@ void CSimObjectV2::DumpInitAttributesInDB(std::ostream &output, std::shared_ptr<
 
 void CSimObjectV2::DumpEventTransition(std::shared_ptr<MState> compositestate, std::ostream &src, const std::string& evname) {
     for (auto & i : compositestate->States) {
-        auto state  = std::dynamic_pointer_cast<CState>(*i);
+        auto state  = std::dynamic_pointer_cast<MState>(*i);
 
         for (auto & tri : state->Outgoing) {
             auto trans = std::dynamic_pointer_cast<MTransition>(*tri);
@@ -3106,7 +3390,14 @@ void CSimObjectV2::DumpEventTransition(std::shared_ptr<MState> compositestate, s
 
 void CSimObjectV2::DumpEventTransition(std::ostream &src, const std::string& evname) {
     int x=0;
-
+    //
+    //  The table driven statemachine finds the transition at runtime.
+    if (statetable) {
+        if (statetable->HasEvent(evname)) {
+            src << "    Dispatch(e" << basename << "Event::" << helper::normalize(evname) << ");\n";
+        }
+        return;
+    }
     if (statemachine) {
         auto sm = std::dynamic_pointer_cast<CSimStatemachine>(*statemachine);
 
@@ -3132,7 +3423,11 @@ void CSimObjectV2::DumpEventTransition(std::ostream &src, const std::string& evn
                             for (auto & i : statelist) {
                                 if (i==helper::tolower(trans->to->name)+"_state") {
                                     src << "    " << filler << "obj->state  = 0x" << std::hex << std::setw(16) << std::setfill('0') << x << ";\n";
-                                    src << "    " << filler << "stdb_updatedata(obj->objid, IDA_STATE, 0, obj->state);\n";
+                                    if (BatchUpdates) {
+                                        src << "    " << filler << "mark_dirty(cDirtyState);\n";
+                                    } else {
+                                        src << "    " << filler << "stdb_updatedata(obj->objid, IDA_STATE, 0, obj->state);\n";
+                                    }
                                     break;
                                 }
                                 x++;
@@ -3285,12 +3580,37 @@ void CSimObjectV2::DumpReturnTypeForwards(std::ostream &output) {
     }
 }
 
+//
+//  The simulation package needs the ids of all simobjects for ids.h and the sql
+//  scripts. If the class itself is not generated we still collect them.
+void CSimObjectV2::CollectIds() {
+    std::list<std::pair<std::string, std::string> > alist;
+    std::set<std::string>                           donelist;
+
+    if (statemachine) {
+        std::dynamic_pointer_cast<CSimStatemachine>(*statemachine)->GetStateVars(alist, id_map, basename);
+    }
+    //
+    //  The switch is written into src. As the stream is not opened for a skipped
+    //  class nothing of it is written.
+    DumpSetValueSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
+}
+
 void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     std::list<std::pair<std::string, std::string> >           alist;
     std::set<std::string>                                     donelist;
     std::set<std::string>                                     includesdone;
     size_t                                                    alistmax=0;
+    size_t                                                    valueswitch = 0;
     std::set<std::shared_ptr<MElement>>                       msgdone;
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        CollectNeededModelHeader(sharedthis<MElement>(), neededmodelheader);
+        CollectNeededFromMessages(sharedthis<MElement>(), neededmodelheader);
+        CollectIds();
+        return;
+    }
 
     CollectNeededModelHeader(sharedthis<MElement>(), neededmodelheader);
     CollectNeededFromMessages(sharedthis<MElement>(), neededmodelheader);
@@ -3300,7 +3620,25 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
 
     DumpFileHeader(src, name, ".cpp");
 
-    hdr << "\n#include <membertypes.h>\n\n";
+    hdr << "\n#include <membertypes.h>\n";
+    if ((Pooled) || (UsesContainerPolicy())) {
+        ContainerHeader::Dump(std::dynamic_pointer_cast<CModel>(model), id);
+        hdr << "#include \"" << ContainerHeader::Name() << "\"\n";
+    }
+    if (statetable) {
+        if (statemachine) {
+            statetable->Build(std::dynamic_pointer_cast<CSimStatemachine>(*statemachine));
+            CStateTable::DumpRuntime(std::dynamic_pointer_cast<CModel>(model), id);
+            hdr << "#include \"" << CStateTable::Name() << "\"\n";
+        } else {
+            statetable.reset();
+        }
+    }
+    if (Profiled) {
+        ProfileHeader::Dump(std::dynamic_pointer_cast<CModel>(model), id);
+        hdr << "#include \"" << ProfileHeader::Name() << "\"\n";
+    }
+    hdr << "\n";
     DumpPublicMacros(hdr);
     hdr << "//\n"
            "//  Forward declarations\n";
@@ -3336,6 +3674,9 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
         auto sm = std::dynamic_pointer_cast<CSimStatemachine>(*statemachine);
 
         sm->DumpStateEnumerators(hdr, basename);
+        if (statetable) {
+            statetable->DumpEventEnumerator(hdr, basename);
+        }
     }
 
     hdr << "//\n";
@@ -3357,6 +3698,31 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     //
     //  Add the virtual destructor. Its always there because we always have virtuals in the model item.
     hdr <<       "    virtual ~" << name << "();\n";
+    if (Pooled) {
+        hdr << "    //\n"
+               "    //  The objects are allocated from a pool.\n"
+               "    static void* operator new(size_t aSize);\n"
+               "    static void operator delete(void* aPtr, size_t aSize);\n";
+    }
+    if (BatchUpdates) {
+        hdr << "    //\n"
+               "    //  The changed values are written to the database by flush_dirty()\n"
+               "    //  at the end of the cycle.\n"
+               "    static constexpr uint64_t cDirtyParent = 0x1;\n";
+        if (statemachine) {
+            hdr << "    static constexpr uint64_t cDirtyState  = 0x2;\n";
+        }
+        std::set<std::string> dirtydone;
+
+        dirtyvalues.clear();
+        CollectDirtyValues(sharedthis<MElement>(), dirtydone);
+        for (size_t v = 0; v < dirtyvalues.size(); ++v) {
+            hdr << "    static constexpr uint64_t cDirty_" << dirtyvalues[v] << " = 0x" << std::hex << (4ull << v) << std::dec << ";\n";
+        }
+        hdr << "    void mark_dirty(uint64_t aBits);\n"
+               "    void flush_dirty();\n"
+               "    uint64_t mDirty = 0;\n";
+    }
     //
     //  Create a list of all operations including the ones from import dependencies.
     auto io = GetImportOperation();
@@ -3382,9 +3748,12 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
             "     */\n";
     hdr << "public:\n"
             "    tMsg* Process(std::shared_ptr<tMsg> aMsg) override;\n";
+    if (Profiled) {
+        hdr << "    static void DumpProfile(std::ostream& aOut);\n";
+    }
     if (MainViewPort) {
-        hdr << "    void process(std::shared_ptr<tSignalStartCycle> aMsg);\n";
-        hdr << "    void process(std::shared_ptr<tSignalEndCycle> aMsg);\n";
+        hdr << "    void process(" << MessageParameter("tSignalStartCycle") << " aMsg);\n";
+        hdr << "    void process(" << MessageParameter("tSignalEndCycle") << " aMsg);\n";
     }
     DumpMessageProcessingProto(hdr, msgdone);
     msgdone.clear();
@@ -3413,6 +3782,9 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
         }
     }
     hdr << "    bool update(uint64_t aCycle) override;\n";
+    if (statetable) {
+        statetable->DumpPrototypes(hdr, name);
+    }
     hdr << "    /*\n"
            "     *  Here are the attributes of the object defined.\n"
            "     */\n"
@@ -3563,8 +3935,7 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     //  Now dump the list of attributes of the simulation object.
     for (auto const& ilist : alist) {
         if (donelist.find(ilist.second) == donelist.end()) {
-            std::string filler;
-            filler.assign(alistmax - ilist.first.size()+1, ' ');
+            const std::string& filler = CodeWriter::spaces(alistmax - ilist.first.size()+1);
             hdr << "    " << ilist.first << filler << ilist.second << ";\n";
             donelist.insert(ilist.second);
         }
@@ -3573,6 +3944,9 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     hdr << "\n";    
 
     hdr << "extern tObjLib " << lower_basename << "_factory;\n";
+    if (BatchUpdates) {
+        hdr << "void " << lower_basename << "_flush_dirty();\n";
+    }
 
     DumpGuardTail(hdr, basename);
 
@@ -3585,18 +3959,29 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     src << "#include <simapi.h>\n";
     src << "#include <vector>\n";
     src << "#include <map>\n";
+    if (BatchUpdates) {
+        src << "#include <algorithm>\n";
+    }
+    if (UsesParallelActivity()) {
+        src << "#include <future>\n";
+    }
     if (MainViewPort) {
         src << "#include <tSignalStartCycle.h>\n";
         src << "#include <tSignalEndCycle.h>\n";
     }
 
     src << "#include \"generated.h\"\n";
+    PerfectHash::Dump(std::dynamic_pointer_cast<CModel>(model), id);
+    src << "#include \"" << PerfectHash::Name() << "\"\n";
     //
     //  Dump the extra includes.
     donelist.clear();
     //
     //  Fill donelist with hard coded headers.
     includesdone.insert("map");
+    if (BatchUpdates) {
+        includesdone.insert("algorithm");
+    }
     includesdone.insert("vector");
     includesdone.insert("simobjfactory.h");
     includesdone.insert("simapi.h");
@@ -3604,6 +3989,7 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     includesdone.insert("stdint.h");
     includesdone.insert("simifc.h");
     includesdone.insert("generated.h");
+    includesdone.insert(PerfectHash::Name());
     includesdone.insert("membertypes.h");
     if (MainViewPort) {
         includesdone.insert("tSignalStartCycle.h");
@@ -3680,12 +4066,37 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
            "/*\n"
            " *  The template storage map\n"
            " */\n"
-           "static std::map<objectid_t, " << name << "*> t_store;\n"
-           "/*\n"
+           "static " << TemplateStoreType() << " t_store;\n";
+    if (Pooled) {
+        src << "\n"
+               "void* " << name << "::operator new(size_t aSize) {\n"
+               "    if (aSize != sizeof(" << name << ")) {\n"
+               "        return ::operator new(aSize);\n"
+               "    }\n"
+               "    return mtt::object_pool<sizeof(" << name << "), alignof(" << name << ")>::allocate();\n"
+               "}\n\n"
+               "void " << name << "::operator delete(void* aPtr, size_t aSize) {\n"
+               "    if (aSize != sizeof(" << name << ")) {\n"
+               "        ::operator delete(aPtr);\n"
+               "        return;\n"
+               "    }\n"
+               "    mtt::object_pool<sizeof(" << name << "), alignof(" << name << ")>::deallocate(aPtr);\n"
+               "}\n";
+    }
+    if (BatchUpdates) {
+        DumpFlushDirty(src);
+    }
+    src << "/*\n"
            " *\n"
            " *       !!!!    Here is a collection of functions that are editable.   !!!!\n"
            " */\n";
     src << name << "::~" << name << "() {\n";
+    if (BatchUpdates) {
+        src << "    if (mDirty != 0) {\n"
+               "        flush_dirty();\n"
+               "        d_objects.erase(std::find(d_objects.begin(), d_objects.end(), this));\n"
+               "    }\n";
+    }
     src << "// User-Defined-Code: virtual destructor " << "-- " << name << std::endl;
     src << "// End-Of-UDC: virtual destructor " << "-- " << name << std::endl;
     src << "}\n";
@@ -3778,6 +4189,9 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
            "bool " << name << "::update(uint64_t aCycle) {\n";
            DumpStatemachine(src, "State");
     src << "}\n\n";
+    if (statetable) {
+        statetable->DumpTable(src, name, basename);
+    }
 
     //
     //
@@ -3799,39 +4213,47 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     DumpFunctionHeader(src, "InitMember", "", "");
 
     src << "void " << name << "::InitMember(uint64_t  valueid, uint64_t  valueindex, const tVariant& value) {\n";
+    valueswitch = src.buffer()->size();
     src << "    switch (valueid) {\n";
-    src << "    case IDA_OBJ_PARENT:\n"
-           "        parent = tObjectRef(value, nullptr);\n"
+    CodeWriter::caselabel(src, "IDA_OBJ_PARENT", cases);
+    src << "        parent = tObjectRef(value, nullptr);\n"
            "        break;\n";
-    DumpSetStateSwitch(src);
+    DumpSetStateSwitch(src, cases);
     donelist.clear();
     DumpSetValueSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
 
     src << "    default:\n";
     src << "        break;\n";
     src << "    }\n";
+    DumpIdDispatch(valueswitch, "valueid");
     src << "}\n";
 
     DumpFunctionHeader(src, "SetParent", "", "");
     src << "void " << name << "::SetParent(const tObjectRef& aParent) {\n"
            "    if (parent != aParent) {\n"
-           "        parent = aParent;\n"
-           "        stdb_set((uint8_t)eMemberValueType::Reference, objid, IDA_OBJ_PARENT, 0, (uint64_t)(parent));\n"
-           "    }\n"
+           "        parent = aParent;\n";
+    if (BatchUpdates) {
+        src << "        mark_dirty(cDirtyParent);\n";
+    } else {
+        src << "        stdb_set((uint8_t)eMemberValueType::Reference, objid, IDA_OBJ_PARENT, 0, (uint64_t)(parent));\n";
+    }
+    src << "    }\n"
            "}\n";
 
     DumpFunctionHeader(src, "GetValue", "", "");
 
     src << "tVariant " << name << "::GetValue(uint64_t  valueid, uint64_t  valueindex) {\n"
-           "    tVariant retval;\n\n"
-           "    switch (valueid) {\n";
-    DumpGetStateSwitch(src);
+           "    tVariant retval;\n\n";
+    valueswitch = src.buffer()->size();
+    src << "    switch (valueid) {\n";
+    DumpGetStateSwitch(src, cases);
     donelist.clear();
     DumpGetValueSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
 
     src << "    default:\n";
     src << "        break;\n";
     src << "    }\n";
+    DumpIdDispatch(valueswitch, "valueid");
     src << "    return (retval);\n";
     src << "}\n";
 
@@ -3845,28 +4267,32 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     DumpFunctionHeader(src, std::string("SetValue"), "", "");
 
     src << "void " << name << "::SetValue(valueid_t  valueid, valueindex_t  valueindex, const tVariant& value) {\n";
+    valueswitch = src.buffer()->size();
     src << "    switch (valueid) {\n";
-    DumpSetStateSwitch(src);
+    DumpSetStateSwitch(src, cases);
     donelist.clear();
     DumpSetValueDBSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
 
     src << "    default:\n";
     src << "        break;\n";
     src << "    }\n";
+    DumpIdDispatch(valueswitch, "valueid");
     src << "}\n";
     donelist.clear();
 
     DumpFunctionHeader(src, "GetReference", "", "");
 
     src << "tObjectRef " << name << "::GetReference(uint64_t  valueid, uint64_t  valueindex) {\n"
-           "    tObjectRef retval;\n\n"
-           "    switch (valueid) {\n";
+           "    tObjectRef retval;\n\n";
+    valueswitch = src.buffer()->size();
+    src << "    switch (valueid) {\n";
     donelist.clear();
     DumpGetReferenceSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
 
     src << "    default:\n";
     src << "        break;\n";
     src << "    }\n";
+    DumpIdDispatch(valueswitch, "valueid");
     src << "    return (retval);\n";
     src << "}\n";
 
@@ -3880,6 +4306,7 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     DumpFunctionHeader(src, std::string("SetReference"), "", "");
 
     src << "void " << name << "::SetReference(valueid_t  valueid, valueindex_t  valueindex, const tObjectRef& value) {\n";
+    valueswitch = src.buffer()->size();
     src << "    switch (valueid) {\n";
     donelist.clear();
     DumpSetReferenceSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
@@ -3887,12 +4314,14 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     src << "    default:\n";
     src << "        break;\n";
     src << "    }\n";
+    DumpIdDispatch(valueswitch, "valueid");
     src << "}\n";
     donelist.clear();
 
     DumpFunctionHeader(src, std::string("RemoveReference"), "", "");
 
     src << "void " << name << "::RemoveReference(valueid_t  valueid, valueindex_t  valueindex) {\n";
+    valueswitch = src.buffer()->size();
     src << "    switch (valueid) {\n";
     donelist.clear();
     DumpRemoveReferenceSwitch(sharedthis<CSimObjectV2>(), sharedthis<MElement>(), "", std::string("IDA_"), donelist);
@@ -3900,6 +4329,7 @@ void CSimObjectV2::Dump(std::shared_ptr<MModel> model) {
     src << "    default:\n";
     src << "        break;\n";
     src << "    }\n";
+    DumpIdDispatch(valueswitch, "valueid");
     src << "}\n";
 
     donelist.clear();
@@ -4093,12 +4523,16 @@ void CSimObjectV2::ChangeState(std::ostream& output, std::shared_ptr<MState> to,
             break;
         }
     }
+    //
+    //  Completion transitions keep the flat state index of the table in step.
+    if (statetable) {
+        output << filler << "mStateIdx = " << statetable->Leaf(to) << ";\n";
+    }
 }
 
 void CSimObjectV2::DumpTransitionAction(std::ostream& output, std::shared_ptr<MTransition> trans, int spacer) {
-    std::string filler;
+    const std::string& filler = CodeWriter::spaces(spacer);
 
-    filler.assign(spacer, ' ');
 
     for (auto & i : trans->actions) {
         auto a = std::dynamic_pointer_cast<MAction>(*i);
@@ -4230,9 +4664,11 @@ void CSimObjectV2::DumpCompositeStatemachine(std::ostream &output, std::shared_p
         output << "    switch(static_cast<uint64_t>(" << instate->statevar << ")) {\n";
 
         for (auto & st : instate->States) {
-            auto state = std::dynamic_pointer_cast<CState>(*st);
+            auto state   = std::dynamic_pointer_cast<MState>(*st);
+            bool initial = (st->type == eElementType::PseudoState) &&
+                           (helper::tolower(std::dynamic_pointer_cast<MPseudoState>(*st)->kind) == "initial");
 
-            if ((st->type != eElementType::PseudoState) || (state->isInitial())) {
+            if ((st->type != eElementType::PseudoState) || (initial)) {
                 output << "    case " << instate->stateclass << "::" << helper::normalize(state->name) << ":\n";
                 //
                 //  First thing to do in a state is to run the do-actions.
@@ -4306,7 +4742,9 @@ void CSimObjectV2::DumpDefaultMsgHandler(std::ostream& src) {
 
 
 void CSimObjectV2::DumpNewProcessMsg(std::ostream& src) {
-    std::set<std::string> done;
+    std::set<std::string>    done;
+    std::vector<std::string> labels;
+    size_t                   msgswitch;
     src << "// **************************************************************************\n";
     src << "//\n";
     src << "//  Method-Name   : process_msg()\n";
@@ -4318,33 +4756,72 @@ void CSimObjectV2::DumpNewProcessMsg(std::ostream& src) {
             "    tMsg *retmsg=0;\n\n";
 
     src <<  "//\n//  A quick out.\n"
-            "    if (msg == nullptr) return nullptr;\n\n"
-            "    switch (msg->id) {\n";
+            "    if (msg == nullptr) return nullptr;\n\n";
+    msgswitch = this->src.buffer()->size();
+    src <<  "    switch (msg->id) {\n";
 
-    DumpProcessMsgSwitch(src, done);
-    DumpProcessSigSwitch(src, done);
+    DumpProcessMsgSwitch(src, cases, done);
+    DumpProcessSigSwitch(src, cases, done);
 
     if (HaveOperation("deletereq")) {
-        src << "    case IDM_DELETEREQ:\n";
+        CodeWriter::caselabel(src, "IDM_DELETEREQ", cases);
         src << "        thisobj->process(std::static_pointer_cast<tMsgDeleteReq>(msg));\n";
         src << "        break;\n";
     }
     if (HaveOperation("deletereply")) {
-        src << "    case IDM_DELETEREPLY:\n";
+        CodeWriter::caselabel(src, "IDM_DELETEREPLY", cases);
         src << "        thisobj->process( std::static_pointer_cast<tMsgDeleteReply>(msg));\n";
         src << "        break;\n";
     }
     src << "    default:\n";
     src << "        if (((msg->type == MSG_TYPE_REPLY) || (msg->type == MSG_TYPE_INDICATION)) && (parent.valid()) && (*parent != this)) {\n";
-    src << "            retmsg = parent->Process(msg);\n";
-    src << "        } else {\n";
-    src << "            retmsg = DefaultMsgHandler(msg);\n";
+    if (RawMessages) {
+        //
+        //  msg is not used afterwards. Moving it saves the reference count.
+        src << "            retmsg = parent->Process(std::move(msg));\n";
+        src << "        } else {\n";
+        src << "            retmsg = DefaultMsgHandler(std::move(msg));\n";
+    } else {
+        src << "            retmsg = parent->Process(msg);\n";
+        src << "        } else {\n";
+        src << "            retmsg = DefaultMsgHandler(msg);\n";
+    }
     src << "        }\n";
     src << "        break;\n";
     src << "    }\n";
+    if (Profiled) {
+        msgswitch = DumpProfileScope(msgswitch, labels);
+    }
+    //
+    //  Without the shared_ptr copies the lookup of the handler is the
+    //  remaining cost of the dispatch.
+    if (RawMessages) {
+        DumpIdDispatch(msgswitch, "msg->id");
+    }
 
     src << "    return retmsg;\n";
     src << "}\n";
+    if (Profiled) {
+        src << "// **************************************************************************\n"
+               "//\n"
+               "//  Method-Name   : DumpProfile()\n"
+               "//\n"
+               "//  Generated source code.\n"
+               "//\n"
+               "// **************************************************************************\n"
+               "void " << name << "::DumpProfile(std::ostream& aOut) {\n";
+        if (labels.empty()) {
+            src << "    aOut << \"" << name << "\\n\";\n";
+        } else {
+            src << "    static const char* const names[" << labels.size() << "] = {\n";
+            for (auto & l : labels) {
+                src << "        \"" << l << "\",\n";
+            }
+            src << "    };\n\n"
+                   "    mtt::profile_dump<" << name << ", " << labels.size() << ">(aOut, \"" << name << "\", names);\n";
+        }
+        src << "}\n";
+    }
 }
 
 
@@ -4396,9 +4873,8 @@ void CSimObjectV2::DumpCreateObject(std::ostream& src) {
 }
 
 void CSimObjectV2::DumpStateInit(std::ostream &output, std::shared_ptr<MState> aState, int spacer) {
-    std::string filler;
+    const std::string& filler = CodeWriter::spaces(spacer);
 
-    filler.assign(spacer, ' ');
 
     if (!aState->States.empty()) {
         auto cs = std::dynamic_pointer_cast<CState>(aState);
@@ -4501,7 +4977,7 @@ void CSimObjectV2::DumpCopyFromTemplate(std::ostream& src) {
     src << "// **************************************************************************\n";
     src << "static void copy_from_template(tSimObj* obj, templateid_t  tid) {\n";
     src << "    " << name << "* var" << lower_basename << " = ("<< name << "*)obj;\n";
-    src << "    std::map<objectid_t, " << name << "*>::iterator found;\n\n";
+    src << "    " << TemplateStoreType() << "::iterator found;\n\n";
 
     src << "    found = t_store.find(tid);\n";
     src << "    if (found != t_store.end()) {\n";
@@ -4522,7 +4998,7 @@ void CSimObjectV2::DumpCreateNewObjectFromTemplate(std::ostream& src) {
     src << "// **************************************************************************\n";
     src << "static tSimObj* create_new_" << lower_basename << "_obj_from_template(templateid_t  tid, objectid_t  oid) {\n";
     src << "    " << name << "* new" << lower_basename << " = 0;\n";
-    src << "    std::map<objectid_t, " << name << "*>::iterator found;\n\n";
+    src << "    " << TemplateStoreType() << "::iterator found;\n\n";
 
     src << "    found = t_store.find(tid);\n";
     src << "    if (found != t_store.end()) {\n";
@@ -4597,12 +5073,12 @@ void CSimObjectV2::DumpMessageProcessingProto(std::ostream & src, std::set<std::
                 auto s = mic->m_implementation->sharedthis<CClassBase>();
 
                 if ((mic->isMessage()) && (mic->mtype != enumMessageType::mReply)) {
-                    if (!HaveProcessOperation("process", "std::shared_ptr<" + s->name + ">")) {
-                        src << "    virtual tMsg* process(std::shared_ptr<" << s->name << "> msg);\n";
+                    if (!HaveProcessOperation("process", MessageParameter(s->name))) {
+                        src << "    virtual tMsg* process(" << MessageParameter(s->name) << " msg);\n";
                     }
                 } else if (mic->isSignal()) {
-                    if (!HaveProcessOperation("process", "std::shared_ptr<" + s->name + ">")) {
-                        src << "    virtual void process(std::shared_ptr<" << s->name << "> sig);\n";
+                    if (!HaveProcessOperation("process", MessageParameter(s->name))) {
+                        src << "    virtual void process(" << MessageParameter(s->name) << " sig);\n";
                     }
                 } else {
                     //
@@ -4788,7 +5264,7 @@ void CSimObjectV2::DumpMessageProcessingFunctions(std::shared_ptr<CSimObjectV2>
         where->src << " *  Partial generated source code.\n";
         where->src << " *\n";
         where->src << " * *************************************************************************/\n";
-        where->src << "void " << name << "::process(std::shared_ptr<tSignalStartCycle> msg) {\n";
+        where->src << "void " << name << "::process(" << MessageParameter("tSignalStartCycle") << " msg) {\n";
         where->src << "// User-Defined-Code: " << helper::tolower(name) << "-startcycle\n";
         where->src << "// End-Of-UDC:" << helper::tolower(name) << "-startcycle\n";
         where->src << "}\n";
@@ -4799,7 +5275,7 @@ void CSimObjectV2::DumpMessageProcessingFunctions(std::shared_ptr<CSimObjectV2>
         where->src << " *  Partial generated source code.\n";
         where->src << " *\n";
         where->src << " * *************************************************************************/\n";
-        where->src << "void " << name << "::process(std::shared_ptr<tSignalEndCycle> msg) {\n";
+        where->src << "void " << name << "::process(" << MessageParameter("tSignalEndCycle") << " msg) {\n";
         where->src << "// User-Defined-Code: " << helper::tolower(name) << "-endcycle\n";
         where->src << "// End-Of-UDC:" << helper::tolower(name) << "-endcycle\n";
         where->src << "}\n";
@@ -4814,15 +5290,15 @@ void CSimObjectV2::DumpMessageProcessingFunctions(std::shared_ptr<CSimObjectV2>
                 auto s = mic->m_implementation->sharedthis<CClassBase>();
 
                 if ((mic->isMessage()) && (mic->mtype != enumMessageType::mReply)) {
-                    if (!HaveProcessOperation("process", "std::shared_ptr<" + s->name + ">")) {
+                    if (!HaveProcessOperation("process", MessageParameter(s->name))) {
                         where->src << "/* **************************************************************************\n";
                         where->src << " *\n";
-                        where->src << " *  Method-Name   : process(std::shared_ptr<" << s->name << ">)\n";
+                        where->src << " *  Method-Name   : process(" << MessageParameter(s->name) << ")\n";
                         where->src << " *\n";
                         where->src << " *  Partial generated source code.\n";
                         where->src << " *\n";
                         where->src << " * *************************************************************************/\n";
-                        where->src << "tMsg* " << where->name << "::process(std::shared_ptr<" << s->name << "> msg) {\n";
+                        where->src << "tMsg* " << where->name << "::process(" << MessageParameter(s->name) << " msg) {\n";
                         where->src << "    tMsg* retval = nullptr;\n";
                         where->src << "// User-Defined-Code: " << where->id << "-process-" << s->name << "\n";
                         where->src << "// End-Of-UDC: " << where->id << "-process-" << s->name << "\n";
@@ -4833,15 +5309,15 @@ void CSimObjectV2::DumpMessageProcessingFunctions(std::shared_ptr<CSimObjectV2>
                         where->src << "}\n";
                     }
                 } else if (mic->isSignal()) {
-                    if (!HaveProcessOperation("process", "std::shared_ptr<" + s->name + ">")) {
+                    if (!HaveProcessOperation("process", MessageParameter(s->name))) {
                         where->src << "/* **************************************************************************\n";
                         where->src << " *\n";
-                        where->src << " *  Method-Name   : process(std::shared_ptr<" << s->name << ">)\n";
+                        where->src << " *  Method-Name   : process(" << MessageParameter(s->name) << ")\n";
                         where->src << " *\n";
                         where->src << " *  Partial generated source code.\n";
                         where->src << " *\n";
                         where->src << " * *************************************************************************/\n";
-                        where->src << "void " << where->name << "::process(std::shared_ptr<" << s->name << "> sig) {\n";
+                        where->src << "void " << where->name << "::process(" << MessageParameter(s->name) << " sig) {\n";
                         where->src << "// User-Defined-Code: " << where->id << "-process-" << s->name << "\n";
                         where->src << "// End-Of-UDC: " << where->id << "-process-" << s->name << "\n";
                         if (this == where.get()) {
@@ -4863,14 +5339,14 @@ void CSimObjectV2::DumpMessageProcessingFunctions(std::shared_ptr<CSimObjectV2>
     }
 }
 
-void CSimObjectV2::DumpProcessSigSwitch(std::ostream &src, std::set<std::string> &aDoneList) {
+void CSimObjectV2::DumpProcessSigSwitch(std::ostream &src, tCaseLabels& aCases, std::set<std::string> &aDoneList) {
     auto     i = GetImportIncoming();
     if (MainViewPort) {
-        src << "    case IDS_STARTCYCLE:\n";
-        src << "        process(std::static_pointer_cast<tSignalStartCycle>(msg));\n";
+        CodeWriter::caselabel(src, "IDS_STARTCYCLE", aCases);
+        src << "        process(" << MessageCast("tSignalStartCycle") << ");\n";
         src << "        break;\n";
-        src << "    case IDS_ENDCYCLE:\n";
-        src << "        process(std::static_pointer_cast<tSignalEndCycle>(msg));\n";
+        CodeWriter::caselabel(src, "IDS_ENDCYCLE", aCases);
+        src << "        process(" << MessageCast("tSignalEndCycle") << ");\n";
         src << "        break;\n";
 
     }
@@ -4881,20 +5357,20 @@ void CSimObjectV2::DumpProcessSigSwitch(std::ostream &src, std::set<std::string>
             auto s = mic->m_implementation->sharedthis<CClassBase>();
 
             if (mic->isSignal()) {
-                src << "    case IDS_" << helper::toupper(s->name) << ":\n";
-                src << "        process(std::static_pointer_cast<" << s->name << ">(msg));\n";
+                CodeWriter::caselabel(src, "IDS_" + helper::toupper(s->name), aCases);
+                src << "        process(" << MessageCast(s->name) << ");\n";
                 src << "        break;\n";
             }
         }
     }
     for (auto& baselist : Base) {
         if (baselist.getElement()->type == eElementType::SimObject) {
-            std::dynamic_pointer_cast<CSimObjectV2>(baselist.getElement())->DumpProcessSigSwitch(src, aDoneList);
+            std::dynamic_pointer_cast<CSimObjectV2>(baselist.getElement())->DumpProcessSigSwitch(src, aCases, aDoneList);
         }
     }
 }
 
-void CSimObjectV2::DumpProcessMsgSwitch(std::ostream &src, std::set<std::string> &aDoneList) {
+void CSimObjectV2::DumpProcessMsgSwitch(std::ostream &src, tCaseLabels& aCases, std::set<std::string> &aDoneList) {
     auto     i = GetImportIncoming();
 
     for (auto & mi : i) {
@@ -4904,15 +5380,15 @@ void CSimObjectV2::DumpProcessMsgSwitch(std::ostream &src, std::set<std::string>
             auto s = mic->m_implementation->sharedthis<CClassBase>();
 
             if ((mic->isMessage()) && (mic->mtype != enumMessageType::mReply)) {
-                src << "    case IDM_" << helper::toupper(s->name) << ":\n";
-                src << "        retmsg = process(std::static_pointer_cast<" << s->name << ">(msg));\n";
+                CodeWriter::caselabel(src, "IDM_" + helper::toupper(s->name), aCases);
+                src << "        retmsg = process(" << MessageCast(s->name) << ");\n";
                 src << "        break;\n";
             }
         }
     }
     for (auto& baselist : Base) {
         if (baselist.getElement()->type == eElementType::SimObject) {
-            std::dynamic_pointer_cast<CSimObjectV2>(baselist.getElement())->DumpProcessMsgSwitch(src, aDoneList);
+            std::dynamic_pointer_cast<CSimObjectV2>(baselist.getElement())->DumpProcessMsgSwitch(src, aCases, aDoneList);
         }
     }
 #if 0
@@ -4993,6 +5469,25 @@ std::list<std::string>  CSimObjectV2::GetStateVars(std::shared_ptr<MElement> che
     return retval;
 }
 
+//
+//  The message handlers take the message as shared_ptr by default. With the
+//  tagged value MessageHandler=pointer they get a plain pointer. The message
+//  is kept alive by the caller of Process() during the call, so no reference
+//  count has to be touched.
+std::string CSimObjectV2::MessageParameter(const std::string& aClass) const {
+    if (RawMessages) {
+        return aClass + "*";
+    }
+    return "std::shared_ptr<" + aClass + ">";
+}
+
+std::string CSimObjectV2::MessageCast(const std::string& aClass) const {
+    if (RawMessages) {
+        return "static_cast<" + aClass + "*>(msg.get())";
+    }
+    return "std::static_pointer_cast<" + aClass + ">(msg)";
+}
+
 bool CSimObjectV2::HaveProcessOperation(std::string opname, std::string msg) {
     bool retval = false;
     auto  op = GetImportOperation();
@@ -33,6 +33,7 @@ class CAssociationEnd;
 class CAttribute;
 class MState;
 class MTransition;
+class CStateTable;
 
 class CSimObjectV2 : public CCxxClass
 {
@@ -46,6 +47,9 @@ public:
     virtual std::string FQN(void) const;
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
+    //
+    //  The id of the parent reference. It is not generated from a name.
+    static constexpr uint64_t cObjParentId = 0x1c300f13baa65aa9ull;
 private:
     //void CollectNeededModelHeader(std::shared_ptr<MElement>);
     //void CollectOptionalModelHeader(std::shared_ptr<MElement> e) ;
@@ -54,11 +58,17 @@ private:
     void DumpSetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& donelist);
     void DumpGetValueSwitch(std::shared_ptr<CSimObjectV2> where, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& donelist);
     void DumpSetValueDBSwitch(std::shared_ptr<CSimObjectV2> where, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& donelist);
-    void DumpSetStateSwitch(std::ostream& output);
-    void DumpGetStateSwitch(std::ostream& output);
+    void DumpSetStateSwitch(std::ostream& output, tCaseLabels& aCases);
+    void DumpGetStateSwitch(std::ostream& output, tCaseLabels& aCases);
     void DumpGetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& donelist);
     void DumpSetReferenceSwitch(std::shared_ptr<CSimObjectV2> where, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& donelist);
     void DumpRemoveReferenceSwitch(std::shared_ptr<CSimObjectV2> where, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& donelist);
+    void DumpIdDispatch(size_t aSwitch, const std::string& aSelector);
+    void DumpFlushDirty(std::ostream& output);
+    void DumpSetDBValue(std::shared_ptr<CSimObjectV2> where, const std::string& localobject, const std::string& aName);
+    void CollectDirtyValues(std::shared_ptr<MElement> e, std::set<std::string>& aDoneList);
+    size_t DumpProfileScope(size_t aSwitch, std::vector<std::string>& aLabels);
+    tCaseLabels SwitchCases(size_t aSwitch);
     void DumpInitEmptyObject(std::ostream& output, std::shared_ptr<MElement> e, std::string localobject, std::string prefix, std::set<std::string>& aDoneList);
     void DumpInitDBObject(std::ostream &output, std::shared_ptr<MElement> e, std::string localobject,
                                         std::string prefix, std::set<std::string>& aDoneList)    ;
@@ -76,8 +86,8 @@ private:
     void DumpHistoryFromTransition(std::ostream& output, std::shared_ptr<MState> from, std::shared_ptr<MState> to, int spacer) ;
     void DumpCompositeStateEnum(std::ostream& output, std::string prefix, std::shared_ptr<MState> st);
     void DumpInitNew(std::ostream&src);
-    void DumpProcessSigSwitch(std::ostream& src, std::set<std::string>& aDoneList) ;
-    void DumpProcessMsgSwitch(std::ostream& src, std::set<std::string>& aDoneList) ;
+    void DumpProcessSigSwitch(std::ostream& src, tCaseLabels& aCases, std::set<std::string>& aDoneList) ;
+    void DumpProcessMsgSwitch(std::ostream& src, tCaseLabels& aCases, std::set<std::string>& aDoneList) ;
     void DumpNewProcessMsg(std::ostream& src);
     void DumpCreateObject(std::ostream& src) ;
     void DumpCopyFromTemplate(std::ostream& src) ;
@@ -106,11 +116,14 @@ private:
     std::string MapType(std::shared_ptr<CAssociationEnd> attr);
     std::string MapVariant(const std::string& classifier);
     std::string MapSimAttr(const std::string& classifier);
+    std::string TemplateStoreType() const;
     std::string MapVariantType(const std::string& classifier);
     std::string MapDBAttrType(const std::string& classifier);
     int GetStateIndex(std::shared_ptr<MState> st);
     bool HaveOperation(const char* opname);
     bool HaveProcessOperation(std::string opname, std::string msg);
+    std::string MessageParameter(const std::string& aClass) const;
+    std::string MessageCast(const std::string& aClass) const;
     std::shared_ptr<MState> GetInitialTargetState(std::shared_ptr<MState> st);
     std::string GetBaseClasses(void);
     bool HaveSimObjectBase(void);
@@ -122,19 +135,27 @@ private:
     //void CollectNeededRecursive(std::shared_ptr<MElement> e);
     //void CollectNeededFromTextTyped(std::string aTextType);
     void CollectNeededFromMessages(std::shared_ptr<MElement> e, HeaderList & a_headerlist);
+    void CollectIds(void);
 public:
     std::map<std::string, uint64_t>    id_map;             //  This map is used to be exported to the ids.
     std::map<std::string, uint64_t>    id_name_map;        //  This map is used to create the name mapping for the code and the DB.
     std::map<std::string, std::string> macrolist;          //  List of public macros.
     std::set<uint64_t>                 iddb;               //  This set of ids is used to detect already processed attributes.
     std::list<std::string>             statelist;          //  Mapping between state function names and index into function array.
+    tCaseLabels                        cases;              //  The case labels of the switches over ids written to src.
     std::list<std::string>             smhistorylist;      //  List of state history attribute names
     std::list<std::shared_ptr<MElement>> refs;               //  List of references to initialize
+    std::vector<std::string>           dirtyvalues;        //  The values with a dirty bit if the updates are batched.
     std::string                        basename;
     std::string                        lower_basename;
     std::string                        upper_basename;
     bool                               MainViewPort = false;
     uint64_t                           ReleaseTimeout = __UINT64_MAX__;
+    bool                               Pooled = true;      //  Objects come from a pool and the template store is a flat hash map.
+    bool                               RawMessages = false;    //  The message handlers get a plain pointer instead of a shared_ptr.
+    bool                               Profiled = false;       //  The message handlers count calls and latencies.
+    bool                               BatchUpdates = false;   //  Database updates are collected and written at the end of the cycle.
+    std::shared_ptr<CStateTable>       statetable;         //  Set if the statemachine is generated as a transition table.
 };
 
 #endif // CSimObjectV2_H
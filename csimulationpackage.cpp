@@ -86,7 +86,7 @@ void CSimulationPackage::Prepare(void) {
     }
 }
 
-void CSimulationPackage::DumpExtraIncludes(std::ofstream &ifc, std::string aHeaders, std::set<std::string> &aDoneIncludes) {
+void CSimulationPackage::DumpExtraIncludes(CodeWriter &ifc, std::string aHeaders, std::set<std::string> &aDoneIncludes) {
     std::string extra;
     size_t      start       = 0;
     size_t      end         = 0;
@@ -134,7 +134,7 @@ void CSimulationPackage::DumpExtraIncludes(std::ofstream &ifc, std::string aHead
     }
 }
 
-void CSimulationPackage::DumpExtraIncludes(std::ofstream &ifc, std::shared_ptr<CClassBase> aClass, std::set<std::string>& aDoneIncludes) {
+void CSimulationPackage::DumpExtraIncludes(CodeWriter &ifc, std::shared_ptr<CClassBase> aClass, std::set<std::string>& aDoneIncludes) {
     DumpExtraIncludes(ifc, aClass->GetExtraHeader(), aDoneIncludes);
 
     for (auto em : aClass->extramodelheader) {
@@ -142,7 +142,7 @@ void CSimulationPackage::DumpExtraIncludes(std::ofstream &ifc, std::shared_ptr<C
     }
 }
 
-void CSimulationPackage::DumpExtraIncludes(std::ofstream &ifc, std::set<std::string>& aDoneIncludes) {
+void CSimulationPackage::DumpExtraIncludes(CodeWriter &ifc, std::set<std::string>& aDoneIncludes) {
     ifc << "#include <simifc.h>\n";
     ifc << "#include <stdint.h>\n";
     ifc << "#include <stdlib.h>\n";
@@ -194,17 +194,12 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     std::string                               path;
     std::list<std::string>                    modules;
     std::list<eElementType>                   contenttypes;
-    std::list<tConnector<MElement, MElement>> liblist;
     Crc64                                     crc;
     auto                                      cmodel = std::dynamic_pointer_cast<CModel>(model);
 
     modules.emplace_back("_simifc");
     modules.emplace_back("generated");
     DumpBase(cmodel);
-    path=cmodel->pathstack.back()+"/"+".Makefile";
-    cmodel->generatedfiles.push_back(tGenFile {path, id, "##", "mk"});
-    OpenStream(makefile, path);
-    DumpMakefileHeader(makefile, OutputName+".so");
     //
     //  Get all content that is part of this package
     contenttypes.emplace_back(eElementType::SimObject);
@@ -221,121 +216,15 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
         }
         ci->Dump(model);
     }
-    makefile << "PROJ=" << OutputName + ".so\n\n";
-    DumpMakefileSource(makefile, modules);
-    DumpMakefileObjects(makefile, modules);
-    //
-    //  Find some CXX-Flags to generate into the Makefile.
-    std::string cxxFlags;
-    if (HasTaggedValue("CxxFlags")) {
-        cxxFlags = GetTaggedValue("CxxFlags");
-    }
-    if (simversion == 2) {
-        makefile << "CXXFLAGS+=-DSIMVERSION=2 -std=" << m_cxxstandard << " -fPIC -Wno-unused-function -O0 $(INCPATH) -g " << cxxFlags << "\n\n";
-    } else {
-        makefile << "CXXFLAGS+=-std=" << m_cxxstandard << " -fPIC -Wno-unused-function -O0 $(INCPATH) -g " << cxxFlags << "\n\n";
-    }
-    //
-    //  First we add the libs.
-    liblist = GetLibraryDependency();
-
-    makefile << "STATICLIBS+=-lsimbase-" << cmodel->AppCoreVersion << " -lsimifc-" << cmodel->AppCoreVersion;
-    for (auto& di : liblist) {
-        if ((di.getConnector()->HasStereotype("static")) || (di.getConnector()->HasStereotype("StaticLinkage"))) {
-            if (di.getElement() != nullptr) {
-                if (di.getElement()->type == eElementType::LibraryPackage) {
-                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
-                }
-                else if (di.getElement()->type == eElementType::ExternPackage) {
-                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
-                }
-            }
-        }
-    }
-    makefile << "\n\n";
-    makefile << "DYNLIBS+=";
-    for (auto& di : liblist) {
-        if (!(di.getConnector()->HasStereotype("static")) && !(di.getConnector()->HasStereotype("StaticLinkage"))) {
-            if (di.getElement() != nullptr) {
-                if (di.getElement()->type == eElementType::LibraryPackage) {
-                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
-                }
-                else if (di.getElement()->type == eElementType::ExternPackage) {
-                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
-                }
-            }
-        }
-    }
-    makefile << "\n\n";
-    //
-    //  Than we add the library pathes.
-    makefile << "LIBPATH=";
-    for (auto& di : liblist) {
-        if (di.getElement() != nullptr) {
-            if (di.getElement()->type == eElementType::LibraryPackage) {
-                std::string libpath = GetPathToPackage(di.getElement());
-
-                if (!libpath.empty()) {
-                    makefile << "\\\n" << "     -L" << libpath;
-                }
-            }
-        }
-        else {
-
-        }
-    }
-    makefile << "\n\n";
-    //
-    //  Than we add the include pathes.
-    makefile << "INCPATH=\\\n";
-    //
-    // prepend the appcore header pathes.
-    if (!cmodel->AppCoreVersion.empty()) {
-        makefile << "     -I/usr/local/include/appcore/" << cmodel->AppCoreVersion << "\\\n     -I/usr/include/appcore/" << cmodel->AppCoreVersion;
-    }
-    for (auto& di : liblist) {
-        if (di.getElement() != nullptr) {
-            auto target = di.getElement();
-
-            if (target->type == eElementType::LibraryPackage) {
-                std::string libpath = GetPathToPackage(target);
-
-                if (!libpath.empty()) {
-                    makefile << "\\\n" << "     -I" << libpath;
-                }
-            } else if (target->type == eElementType::ExternPackage) {
-                std::string libpath;
-
-                if (target->HasTaggedValue("directory")) {
-                    libpath = target->GetTaggedValue("directory");
-                }
-                if (!libpath.empty()) {
-                    makefile << "\\\n" << "     -I" << libpath;
-                }
-
-            }
-        } else {
-
-        }
+    if (mBuildSystem == EBuildSystem::make) {
+        DumpMakefile(cmodel, modules);
     }
-    makefile << "\n\n";
-
-    makefile << "all : $(PROJ)\n\n";
-    makefile << "$(PROJ) : $(OBJ)\n";
-    makefile << "\tg++ -g -shared $(OBJ) $(LDFLAGS) $(LIBPATH) -Wl,-Bstatic -Wl,--start-group $(STATICLIBS) -Wl,--end-group -Wl,-Bdynamic -Wl,--start-group $(DYNLIBS) -Wl,--end-group -o $@\n\n";
-    makefile << "clean :\n";
-    makefile << "\trm -f $(PROJ)\n";
-    makefile << "\trm -f depend\n";
-    makefile << "\trm -f $(OBJ)\n\n";
-    makefile << "depend : $(SRC)\n";
-    makefile << "\tg++ $(CXXFLAGS) -M $(SRC) > depend\n\n";
-    makefile << "-include depend\n\n";
     //
     //
     //  delreq
     path=cmodel->pathstack.back()+"/"+".tMsgDeleteReq.h";
-    cmodel->generatedfiles.push_back( tGenFile {path, "tMsgDeleteReq",  "//", "c-inc"});
     OpenStream(delreq, path);
+    cmodel->generatedfiles.push_back( tGenFile {path, "tMsgDeleteReq",  "//", "c-inc", delreq.buffer()});
     delreq << "#pragma once\n";
     delreq << "#ifndef TMSGDELETEREQ_INC\n";
     delreq << "#define TMSGDELETEREQ_INC\n\n";
@@ -357,8 +246,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     //
     //  delreply
     path=cmodel->pathstack.back()+"/"+".tMsgDeleteReply.h";
-    cmodel->generatedfiles.push_back(tGenFile { path,"tMsgDeleteReply", "//", "c-inc"} );
     OpenStream(delreply, path);
+    cmodel->generatedfiles.push_back(tGenFile { path,"tMsgDeleteReply", "//", "c-inc", delreply.buffer()} );
     delreply << "#pragma once\n";
     delreply << "#ifndef TMSGDELETEREPLY_INC\n";
     delreply << "#define TMSGDELETEREPLY_INC\n\n";
@@ -379,8 +268,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     //
     //  delindication
     path=cmodel->pathstack.back()+"/"+".tSigDeleteIndication.h";
-    cmodel->generatedfiles.push_back(tGenFile { path,"tSigDeleteIndication", "//", "c-inc"} );
     OpenStream(delindication, path);
+    cmodel->generatedfiles.push_back(tGenFile { path,"tSigDeleteIndication", "//", "c-inc", delindication.buffer()} );
     delindication << "#pragma once\n";
     delindication << "#ifndef TSIGDELETEINDICATION_INC\n";
     delindication << "#define TSIGDELETEINDICATION_INC\n\n";
@@ -401,8 +290,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     //
     //  delconfirm
     path=cmodel->pathstack.back()+"/"+".tSigDeleteConfirm.h";
-    cmodel->generatedfiles.push_back(tGenFile { path,"tSigDeleteConfirm", "//", "c-inc"} );
     OpenStream(delconfirm, path);
+    cmodel->generatedfiles.push_back(tGenFile { path,"tSigDeleteConfirm", "//", "c-inc", delconfirm.buffer()} );
     delconfirm << "#pragma once\n";
     delconfirm << "#ifndef TSIGDELETECONFIRM_INC\n";
     delconfirm << "#define TSIGDELETECONFIRM_INC\n\n";
@@ -427,8 +316,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     //
     //
     path=cmodel->pathstack.back()+"/.ids.h";
-    cmodel->generatedfiles.push_back(tGenFile { path,"ids.h", "//", "c-inc"} );
     OpenStream(ids_h, path);
+    cmodel->generatedfiles.push_back(tGenFile { path,"ids.h", "//", "c-inc", ids_h.buffer()} );
     ids_h << "// *************************************************************************************************************\n";
     ids_h << "//\n";
     ids_h << "//  Modul-Name     : ids.h\n";
@@ -495,8 +384,7 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
         }
     }
     for (auto & cmapi : complete_macro_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_h << "#define " << cmapi.first << filler << cmapi.second << "\n";
     }
@@ -504,18 +392,16 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     ids_h << "//\n";
     ids_h << "//  This is the list of object ids used to identify object types in the DB\n";
     for (auto & cmapi : complete_obj_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_h << "#define " << cmapi.first << filler << "(0x" << std::hex << std::setw(16) << std::setfill('0') << cmapi.second << ")\n";
     }
     ids_h << "//\n";
     ids_h << "//\n";
     ids_h << "//  This is the list of attribute ids used to identify object attributes in the DB\n";
-    ids_h << "#define IDA_OBJ_PARENT (0x1c300f13baa65aa9)\n";
+    ids_h << "#define IDA_OBJ_PARENT (0x" << std::hex << std::setw(16) << std::setfill('0') << CSimObjectV2::cObjParentId << ")\n";
     for (auto & cmapi : complete_attr_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_h << "#define " << cmapi.first << filler << "(0x" << std::hex << std::setw(16) << std::setfill('0') << cmapi.second << ")\n";
     }
@@ -523,8 +409,7 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     ids_h << "//\n";
     ids_h << "//  This is the list of enumeration ids used to identify object enumerators in the DB\n";
     for (auto & cmapi : complete_enum_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_h << "#define " << cmapi.first << filler << "(0x" << std::hex << std::setw(16) << std::setfill('0') << cmapi.second << ")\n";
     }
@@ -542,8 +427,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     } else {
         path="."+cmodel->Directory+"/"+cmodel->SQLDirectory+"/.ids.sql";
     }
-    cmodel->generatedfiles.push_back(tGenFile {path, "ids.sql", "//", "pre-sql"});
     OpenStream(ids_sql, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, "ids.sql", "//", "pre-sql", ids_sql.buffer()});
     ids_sql << "-- *************************************************************************************************************\n";
     ids_sql << "--\n";
     ids_sql << "--  Modul-Name     : ids.sql\n";
@@ -558,18 +443,16 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     ids_sql << "--\n";
     ids_sql << "--  This is the list of object ids used to identify object types in the DB\n";
     for (auto & cmapi : complete_obj_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_sql << "#define " << cmapi.first << filler << "cast (x'" << std::hex << std::setw(16) << std::setfill('0') << cmapi.second << "' as bigint)\n";
     }
     ids_sql << "--\n";
     ids_sql << "--\n";
     ids_sql << "--  This is the list of attribute ids used to identify object attributes in the DB\n";
-    ids_sql << "#define IDA_OBJ_PARENT cast(x'1c300f13baa65aa9' as bigint)\n";
+    ids_sql << "#define IDA_OBJ_PARENT cast(x'" << std::hex << std::setw(16) << std::setfill('0') << CSimObjectV2::cObjParentId << "' as bigint)\n";
     for (auto & cmapi : complete_attr_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_sql << "#define " << cmapi.first << filler << "cast (x'" << std::hex << std::setw(16) << std::setfill('0') << cmapi.second << "' as bigint)\n";
     }
@@ -577,8 +460,7 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     ids_sql << "--\n";
     ids_sql << "--  This is the list of enumeration ids used to identify enumerator values in the DB\n";
     for (auto & cmapi : complete_enum_map) {
-        std::string filler;
-        filler.assign(idmaxlen-cmapi.first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(idmaxlen-cmapi.first.size()+1);
 
         ids_sql << "#define " << cmapi.first << filler << "cast (x'" << std::hex << std::setw(16) << std::setfill('0') << cmapi.second << "' as bigint)\n";
     }
@@ -596,8 +478,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     } else {
         path="."+cmodel->Directory+"/"+cmodel->SQLDirectory+"/.createnamemaps.sql";
     }
-    cmodel->generatedfiles.push_back(tGenFile {path, "createnamemaps.sql", "//", "pre-sql"});
     OpenStream(crmaps_sql, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, "createnamemaps.sql", "//", "pre-sql", crmaps_sql.buffer()});
     crmaps_sql << "-- *************************************************************************************************************\n";
     crmaps_sql << "--\n";
     crmaps_sql << "--  Modul-Name     : createnamemaps.sql\n";
@@ -649,8 +531,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
 
 
     path = cmodel->pathstack.back()+"/.generated.h";
-    cmodel->generatedfiles.push_back(tGenFile {path, "-generated-inc", "//", "cxx"});
     OpenStream(generated, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, "-generated-inc", "//", "cxx", generated.buffer()});
 
     generated << "// *************************************************************************************************************\n";
     generated << "//\n";
@@ -687,8 +569,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     generated.close();
 
     path = cmodel->pathstack.back()+"/.generated.cpp";
-    cmodel->generatedfiles.push_back(tGenFile {path, "-generated-src", "//", "cxx"});
     OpenStream(generated, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, "-generated-src", "//", "cxx", generated.buffer()});
 
     generated << "#include \"generated.h\"\n"
                  "#include <simobjfactory.h>\n\n";
@@ -761,8 +643,8 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     //
     //
     path=cmodel->pathstack.back()+"/._simifc.cpp";
-    cmodel->generatedfiles.push_back(tGenFile {path, "-simifc", "//", "cxx"});
     OpenStream(ifc, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, "-simifc", "//", "cxx", ifc.buffer()});
     ifc << "// *************************************************************************************************************\n";
     ifc << "//\n";
     ifc << "//  Modul-Name     : _simifc.cpp\n";
@@ -840,6 +722,26 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
         }
     }
     std::set<std::string> done;
+    //
+    //  The classes with buffer codecs can be created from the JSON text.
+    std::vector<std::shared_ptr<CMessageClass>> buffermsgs;
+    std::vector<std::shared_ptr<CSignalClass>>  buffersigs;
+
+    for (auto & mm : MClass::Instances) {
+        if (mm.second->type == eElementType::SimMessageClass) {
+            auto s = std::dynamic_pointer_cast<CMessageClass>(mm.second);
+
+            if (!s->basename.empty() && s->jsonbuffer) {
+                buffermsgs.push_back(s);
+            }
+        } else if (mm.second->type == eElementType::SimSignalClass) {
+            auto s = std::dynamic_pointer_cast<CSignalClass>(mm.second);
+
+            if (!s->basename.empty() && s->jsonbuffer) {
+                buffersigs.push_back(s);
+            }
+        }
+    }
     ifc << "class CGeneratedSimIfc : public CSimIfc {\n"
            "public:\n"
            "    CGeneratedSimIfc() {\n"
@@ -867,8 +769,11 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
            "    tNetPack*   Process(tNetPack* aPackage) override;\n"
            "    tNetPack*   ProcessRaw(tNetPack* aPackage) override;\n"
            "    std::string GetMessageName(uint64_t aId) override;\n"
-           "    tMsg*       GetMessage(tJSON* aJson) override;\n"
-           "public:\n"
+           "    tMsg*       GetMessage(tJSON* aJson) override;\n";
+    if (!buffermsgs.empty() || !buffersigs.empty()) {
+        ifc << "    tMsg*       GetMessage(const char* aText, size_t aSize);\n";
+    }
+    ifc << "public:\n"
            "    tSimObj*                                mainviewport = nullptr;\n"
            "    static std::map<uint64_t, std::string>  gIdToString;\n"
            "private:\n"
@@ -949,7 +854,15 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
            "    s->Cycle = GetCycle();\n"
            "    if (mainviewport != nullptr) {\n"
            "        mainviewport->Process(std::shared_ptr<tMsg>(s));\n"
-           "    }\n"
+           "    }\n";
+    //
+    //  The objects with batched updates write their changes once per cycle.
+    for (auto & ci : content) {
+        if ((ci->type == eElementType::SimObject) && (std::dynamic_pointer_cast<CSimObjectV2>(ci)->BatchUpdates)) {
+            ifc << "    " << std::dynamic_pointer_cast<CSimObjectV2>(ci)->lower_basename << "_flush_dirty();\n";
+        }
+    }
+    ifc <<
     "}\n"
     "tMsg*     CGeneratedSimIfc::Process(std::shared_ptr<tMsg> aMsg) {\n"
            "    tMsg* retval = nullptr;\n"
@@ -1057,6 +970,63 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
            ;
 
 
+    if (!buffermsgs.empty() || !buffersigs.empty()) {
+        ifc << "//\n"
+               "//  Creates the message from the JSON text without building a tree. Only the\n"
+               "//  classes with buffer codecs are known here. For all others nullptr is\n"
+               "//  returned and the text must go through the tree.\n"
+               "tMsg* CGeneratedSimIfc::GetMessage(const char* aText, size_t aSize) {\n"
+               "    mtt::json_reader reader(aText, aSize);\n"
+               "    std::string_view key;\n"
+               "    std::string      msgid;\n"
+               "    std::string      sigid;\n"
+               "\n"
+               "    if (reader.open('{')) {\n"
+               "        while (reader.key(key)) {\n"
+               "            if (key == \"MsgId\") {\n"
+               "                reader.value(msgid);\n"
+               "                break;\n"
+               "            }\n"
+               "            if (key == \"SignalId\") {\n"
+               "                reader.value(sigid);\n"
+               "                break;\n"
+               "            }\n"
+               "            reader.skip();\n"
+               "        }\n"
+               "    }\n";
+        if (!buffermsgs.empty()) {
+            ifc << "    if (!msgid.empty()) {\n"
+                   "        msgid = helper::tolower(msgid);\n";
+            for (auto & m : buffermsgs) {
+                ifc << "        if (msgid == \"" << helper::tolower(m->basename) << "\") {\n"
+                       "            auto msg = new " << m->name << ";\n"
+                       "\n"
+                       "            if (msg->unpack_json(aText, aSize)) {\n"
+                       "                return msg;\n"
+                       "            }\n"
+                       "            delete msg;\n"
+                       "        }\n";
+            }
+            ifc << "    }\n";
+        }
+        if (!buffersigs.empty()) {
+            ifc << "    if (!sigid.empty()) {\n"
+                   "        sigid = helper::tolower(sigid);\n";
+            for (auto & m : buffersigs) {
+                ifc << "        if (sigid == \"" << helper::tolower(m->basename) << "\") {\n"
+                       "            auto sig = new " << m->name << ";\n"
+                       "\n"
+                       "            if (sig->unpack_json(aText, aSize)) {\n"
+                       "                return sig;\n"
+                       "            }\n"
+                       "            delete sig;\n"
+                       "        }\n";
+            }
+            ifc << "    }\n";
+        }
+        ifc << "    return nullptr;\n"
+               "}\n\n";
+    }
     ifc << "CGeneratedSimIfc simifc;\n";
     done.clear();
     ifc << "// **************************************************************************\n";
@@ -1119,13 +1089,187 @@ void CSimulationPackage::Dump(std::shared_ptr<MModel> model) {
     ifc.close();
     ids_h.close();
     ids_sql.close();
-    makefile.close();
     delreq.close();
     delreply.close();
     delindication.close();
     delconfirm.close();
     crmaps_sql.close();
     //
+    //  The CMakeLists.txt is written at last so that the precompiled header
+    //  can take the generated interface sources into account.
+    if (mBuildSystem == EBuildSystem::cmake) {
+        DumpCMakeLists(cmodel, modules);
+    }
+    //
     //  Remove last element from path-stack
     cmodel->pathstack.pop_back();
 }
+
+//
+//  Writes the Makefile of the simulation.
+void CSimulationPackage::DumpMakefile(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules) {
+    std::string                               path;
+    std::list<tConnector<MElement, MElement>> liblist;
+
+    path=cmodel->pathstack.back()+"/"+".Makefile";
+    OpenStream(makefile, path);
+    cmodel->generatedfiles.push_back(tGenFile {path, id, "##", "mk", makefile.buffer()});
+    DumpMakefileHeader(makefile, OutputName+".so");
+    makefile << "PROJ=" << OutputName + ".so\n\n";
+    DumpMakefileSource(makefile, modules);
+    DumpMakefileObjects(makefile, modules);
+    //
+    //  Find some CXX-Flags to generate into the Makefile.
+    std::string cxxFlags;
+    if (HasTaggedValue("CxxFlags")) {
+        cxxFlags = GetTaggedValue("CxxFlags");
+    }
+    DumpMakefileProfile(makefile, "");
+    if (simversion == 2) {
+        makefile << "CXXFLAGS+=-DSIMVERSION=2 -std=" << m_cxxstandard << " -fPIC -Wno-unused-function $(OPTFLAGS) $(INCPATH) " << cxxFlags << "\n\n";
+    } else {
+        makefile << "CXXFLAGS+=-std=" << m_cxxstandard << " -fPIC -Wno-unused-function $(OPTFLAGS) $(INCPATH) " << cxxFlags << "\n\n";
+    }
+    //
+    //  First we add the libs.
+    liblist = GetLibraryDependency();
+
+    makefile << "STATICLIBS+=-lsimbase-" << cmodel->AppCoreVersion << " -lsimifc-" << cmodel->AppCoreVersion;
+    for (auto& di : liblist) {
+        if ((di.getConnector()->HasStereotype("static")) || (di.getConnector()->HasStereotype("StaticLinkage"))) {
+            if (di.getElement() != nullptr) {
+                if (di.getElement()->type == eElementType::LibraryPackage) {
+                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
+                }
+                else if (di.getElement()->type == eElementType::ExternPackage) {
+                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
+                }
+            }
+        }
+    }
+    makefile << "\n\n";
+    makefile << "DYNLIBS+=";
+    for (auto& di : liblist) {
+        if (!(di.getConnector()->HasStereotype("static")) && !(di.getConnector()->HasStereotype("StaticLinkage"))) {
+            if (di.getElement() != nullptr) {
+                if (di.getElement()->type == eElementType::LibraryPackage) {
+                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
+                }
+                else if (di.getElement()->type == eElementType::ExternPackage) {
+                    makefile << "\\\n" << "     -l" << (std::dynamic_pointer_cast<CPackageBase>(di.getElement()))->OutputName;
+                }
+            }
+        }
+    }
+    makefile << "\n\n";
+    //
+    //  Than we add the library pathes.
+    makefile << "LIBPATH=";
+    for (auto& di : liblist) {
+        if (di.getElement() != nullptr) {
+            if (di.getElement()->type == eElementType::LibraryPackage) {
+                std::string libpath = GetPathToPackage(di.getElement());
+
+                if (!libpath.empty()) {
+                    makefile << "\\\n" << "     -L" << libpath;
+                }
+            }
+        }
+        else {
+
+        }
+    }
+    makefile << "\n\n";
+    //
+    //  Than we add the include pathes.
+    makefile << "INCPATH=\\\n";
+    //
+    // prepend the appcore header pathes.
+    if (!cmodel->AppCoreVersion.empty()) {
+        makefile << "     -I/usr/local/include/appcore/" << cmodel->AppCoreVersion << "\\\n     -I/usr/include/appcore/" << cmodel->AppCoreVersion;
+    }
+    for (auto& di : liblist) {
+        if (di.getElement() != nullptr) {
+            auto target = di.getElement();
+
+            if (target->type == eElementType::LibraryPackage) {
+                std::string libpath = GetPathToPackage(target);
+
+                if (!libpath.empty()) {
+                    makefile << "\\\n" << "     -I" << libpath;
+                }
+            } else if (target->type == eElementType::ExternPackage) {
+                std::string libpath;
+
+                if (target->HasTaggedValue("directory")) {
+                    libpath = target->GetTaggedValue("directory");
+                }
+                if (!libpath.empty()) {
+                    makefile << "\\\n" << "     -I" << libpath;
+                }
+
+            }
+        } else {
+
+        }
+    }
+    makefile << "\n\n";
+
+    makefile << "all : $(PROJ)\n\n";
+    makefile << "$(PROJ) : $(OBJ)\n";
+    makefile << "\tg++ $(OPTFLAGS) -shared $(OBJ) $(LDFLAGS) $(LIBPATH) -Wl,-Bstatic -Wl,--start-group $(STATICLIBS) -Wl,--end-group -Wl,-Bdynamic -Wl,--start-group $(DYNLIBS) -Wl,--end-group -o $@\n\n";
+    makefile << "clean :\n";
+    makefile << "\trm -f $(PROJ)\n";
+    makefile << "\trm -f depend\n";
+    makefile << "\trm -f $(OBJ)\n\n";
+    DumpMakefileProfileTarget(makefile);
+    makefile << "depend : $(SRC)\n";
+    makefile << "\tg++ $(CXXFLAGS) -M $(SRC) > depend\n\n";
+    makefile << "-include depend\n\n";
+    makefile.close();
+}
+
+//
+//  Collects the build information of the simulation and writes the CMakeLists.txt.
+//  On top of the library dependencies a simulation needs the appcore headers and libraries.
+void CSimulationPackage::DumpCMakeLists(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules) {
+    tBuildInfo info;
+
+    info.name    = OutputName;
+    info.prefix  = "";
+    info.modules = modules;
+    //
+    //  The sim object sources define their template store and factory
+    //  functions at file scope with the same names.
+    for (auto & ci : content) {
+        if (ci->type == eElementType::SimObject) {
+            info.nounity.push_back(ci->name);
+        }
+    }
+    if (simversion == 2) {
+        info.definitions.push_back("SIMVERSION=2");
+    }
+    info.options.push_back("-Wno-unused-function");
+    if (!cmodel->AppCoreVersion.empty()) {
+        info.includepath.push_back("/usr/local/include/appcore/" + cmodel->AppCoreVersion);
+        info.includepath.push_back("/usr/include/appcore/" + cmodel->AppCoreVersion);
+        info.staticlibs.push_back("simbase-" + cmodel->AppCoreVersion);
+        info.staticlibs.push_back("simifc-" + cmodel->AppCoreVersion);
+    }
+    FillBuildInfo(info);
+    //
+    //  The makefile of the simulation takes the headers of the libraries from
+    //  the library directory and from the directory tag of extern packages.
+    for (auto& di : GetLibraryDependency()) {
+        auto target = di.getElement();
+
+        if ((target != nullptr) && (target->type == eElementType::LibraryPackage)) {
+            std::string libpath = GetPathToPackage(target);
+
+            if (!libpath.empty()) {
+                info.includepath.push_back(libpath);
+            }
+        }
+    }
+    CPackageBase::DumpCMakeLists(cmodel, info);
+}
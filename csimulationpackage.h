@@ -28,6 +28,7 @@ class MDependency;
 class MClass;
 class CCxxClass;
 class CClassBase;
+class CModel;
 
 class CSimulationPackage : public CPackageBase
 {
@@ -41,21 +42,23 @@ public:
     virtual void Prepare(void);
     virtual void Dump(std::shared_ptr<MModel> aModel);
 
-    void DumpExtraIncludes(std::ofstream& ifc, std::set<std::string>& aDoneIncludes);
-    void DumpExtraIncludes(std::ofstream& ifc, std::shared_ptr<CClassBase> aClass, std::set<std::string>& aDoneIncludes);
-    void DumpExtraIncludes(std::ofstream &ifc, std::string aHeaders, std::set<std::string>& aDoneIncludes);
+    void DumpMakefile(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules);
+    void DumpCMakeLists(std::shared_ptr<CModel> cmodel, const std::list<std::string>& modules);
+    void DumpExtraIncludes(CodeWriter& ifc, std::set<std::string>& aDoneIncludes);
+    void DumpExtraIncludes(CodeWriter& ifc, std::shared_ptr<CClassBase> aClass, std::set<std::string>& aDoneIncludes);
+    void DumpExtraIncludes(CodeWriter &ifc, std::string aHeaders, std::set<std::string>& aDoneIncludes);
 private:
     std::string        SimulationName;
-    std::ofstream      delreq;
-    std::ofstream      delreply;
-    std::ofstream      delindication;
-    std::ofstream      delconfirm;
-    std::ofstream      ids_h;
-    std::ofstream      ids_sql;
-    std::ofstream      crmaps_sql;
-    std::ofstream      ids_php;
-    std::ofstream      ifc;
-    std::ofstream      generated;
+    CodeWriter         delreq;
+    CodeWriter         delreply;
+    CodeWriter         delindication;
+    CodeWriter         delconfirm;
+    CodeWriter         ids_h;
+    CodeWriter         ids_sql;
+    CodeWriter         crmaps_sql;
+    CodeWriter         ids_php;
+    CodeWriter         ifc;
+    CodeWriter         generated;
     std::list<std::shared_ptr<MClass>> content;
     std::shared_ptr<CCxxClass>         mIfcClass;   //  this is the base for all pathes to be build.
 };
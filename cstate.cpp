@@ -71,34 +71,38 @@ std::list<std::string> CState::GetHistoryAttributes(std::string prefix) {
 }
 
 
-void CState::DumpSetStateSwitch(std::ostream &output, std::string prefix) {
+void CState::DumpSetStateSwitch(std::ostream &output, std::string prefix, tCaseLabels& aCases) {
     prefix += name;
     //
     //  The state contains a statemachine.
     if (!States.empty()) {
-        output << "    case IDA_" << helper::toupper(prefix + "State") << ":\n"
-               << "        " << prefix << "State = value;\n"
+        CodeWriter::caselabel(output, "IDA_" + helper::toupper(prefix + "State"), aCases);
+        output << "        " << prefix << "State = value;\n"
                << "        break;\n";
         for (auto & st : States) {
-            auto substates = std::dynamic_pointer_cast<CState>(*st);
+            if (st->type == eElementType::State) {
+                auto substates = std::dynamic_pointer_cast<CState>(*st);
 
-            substates->DumpSetStateSwitch(output, prefix);
+                substates->DumpSetStateSwitch(output, prefix, aCases);
+            }
         }
     }
 }
 
-void CState::DumpGetStateSwitch(std::ostream &output, std::string prefix) {
+void CState::DumpGetStateSwitch(std::ostream &output, std::string prefix, tCaseLabels& aCases) {
     prefix += name;
     //
     //  The state contains a statemachine.
     if (!States.empty()) {
-        output << "    case IDA_" << helper::toupper(prefix + "State") << ":\n"
-               << "        retval = " << prefix << "State;\n"
+        CodeWriter::caselabel(output, "IDA_" + helper::toupper(prefix + "State"), aCases);
+        output << "        retval = " << prefix << "State;\n"
                << "        break;\n";
         for (auto & st : States) {
-            auto substates = std::dynamic_pointer_cast<CState>(*st);
+            if (st->type == eElementType::State) {
+                auto substates = std::dynamic_pointer_cast<CState>(*st);
 
-            substates->DumpGetStateSwitch(output, prefix);
+                substates->DumpGetStateSwitch(output, prefix, aCases);
+            }
         }
     }
 }
@@ -20,6 +20,7 @@
 #ifndef CSTATE_H
 #define CSTATE_H
 
+#include "codewriter.h"
 
 class CState : public MState
 {
@@ -39,8 +40,8 @@ public:
                       std::string prefix);
 
     void DumpStateEnumerators(std::ostream& output, std::string prefix);
-    void DumpSetStateSwitch(std::ostream& output, std::string prefix);
-    void DumpGetStateSwitch(std::ostream& output, std::string prefix);
+    void DumpSetStateSwitch(std::ostream& output, std::string prefix, tCaseLabels& aCases);
+    void DumpGetStateSwitch(std::ostream& output, std::string prefix, tCaseLabels& aCases);
     std::shared_ptr<MState> GetInitialState();
     bool isInitial();
 public:
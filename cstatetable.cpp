@@ -0,0 +1,834 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+
+#include "main.h"
+#include "helper.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "mstate.h"
+#include "cstate.h"
+#include "mpseudostate.h"
+#include "cpseudostate.h"
+#include "mtransition.h"
+#include "maction.h"
+#include "msimstatemachine.h"
+#include "csimstatemachine.h"
+#include "cstatetable.h"
+
+//
+//  The dispatch runtime is a header-only template so the table of any sim
+//  object can use it without another library to link against.
+static const char* cStatemachineRuntime = R"RUNTIME(#pragma once
+#ifndef MTTSTATEMACHINE_INC
+#define MTTSTATEMACHINE_INC
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mtt {
+//
+//  A cell handles one event in one state. It tries the transitions of the
+//  state and of its enclosing states, innermost first, and runs the first one
+//  with a passing guard: the exit chain, the effect and the entry chain. The
+//  cell stores the new state itself and returns whether a transition fired.
+template <class T>
+using state_cell = bool (*)(T&);
+
+//
+//  The cell of a state and an event without any transition.
+template <class T>
+bool no_cell(T&) {
+    return false;
+}
+
+template <class T>
+struct state_machine {
+    const state_cell<T>* table;         //  Per state and event the cell.
+    uint16_t             events;        //  Row length of table.
+};
+
+//
+//  Dispatch one event with a single indirect call and no other branch.
+template <class T>
+bool dispatch(const state_machine<T>& aSm, T& aObj, uint16_t aState, uint16_t aEvent) {
+    return aSm.table[aState * aSm.events + aEvent](aObj);
+}
+} // namespace mtt
+
+#endif  // MTTSTATEMACHINE_INC
+)RUNTIME";
+
+void CStateTable::DumpRuntime(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/.";
+    //
+    //  One header and one benchmark per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+        CodeWriter bench;
+
+        header.open(path + Name());
+        aModel->generatedfiles.push_back(tGenFile {path + Name(), aId, "//", "sm-inc", header.buffer()});
+        header << cStatemachineRuntime;
+        header.close();
+
+        bench.open(path + "mttstatemachine_bench.cpp");
+        aModel->generatedfiles.push_back(tGenFile {path + "mttstatemachine_bench.cpp", aId, "//", "sm-bench", bench.buffer()});
+        DumpBench(bench);
+        bench.close();
+    }
+}
+
+size_t CStateTable::Find(std::shared_ptr<MElement> aState) const {
+    for (size_t v = 1; v < mVertex.size(); ++v) {
+        if (mVertex[v].state == aState) {
+            return v;
+        }
+    }
+    return npos;
+}
+
+//
+//  The vertex entered by default. Initial pseudo states with guarded
+//  transitions are resolved to the target of their first transition.
+static std::shared_ptr<MElement> InitialTarget(std::shared_ptr<MState> aInitial) {
+    if ((aInitial) && (aInitial->type == eElementType::PseudoState)) {
+        if (aInitial->Outgoing.empty()) {
+            return nullptr;
+        }
+        return *std::dynamic_pointer_cast<MTransition>(*aInitial->Outgoing[0])->to;
+    }
+    return aInitial;
+}
+
+size_t CStateTable::AddVertex(std::shared_ptr<MState> aState, size_t aParent, const std::string& aPrefix) {
+    size_t  v = mVertex.size();
+    tVertex vertex;
+
+    vertex.state  = aState;
+    vertex.fnc    = aPrefix + helper::normalize(helper::tolower(aState->name));
+    vertex.entry  = vertex.fnc + "_entry";
+    if (!aState->ExitActions.empty()) {
+        vertex.exit = vertex.fnc + "_exit";
+    }
+    vertex.parent = aParent;
+    vertex.depth  = mVertex[aParent].depth + 1;
+    mVertex.push_back(vertex);
+
+    for (auto & st : aState->States) {
+        if ((st->type == eElementType::State) || (st->type == eElementType::FinalState)) {
+            AddVertex(std::dynamic_pointer_cast<MState>(*st), v, mVertex[v].fnc + "_");
+        }
+    }
+    size_t initial = v;
+
+    if (!aState->States.empty()) {
+        auto cs = std::dynamic_pointer_cast<CState>(aState);
+
+        initial = Find(InitialTarget(cs->GetInitialState()));
+        if (initial == npos) {
+            initial = v;
+        }
+        if (cs->shallowHistory) {
+            mVertex[v].history = mHistorySlots++;
+        }
+    }
+    mVertex[v].initial = initial;
+    return v;
+}
+
+size_t CStateTable::Resolve(size_t aVertex) const {
+    while (mVertex[aVertex].initial != aVertex) {
+        aVertex = mVertex[aVertex].initial;
+    }
+    return aVertex;
+}
+
+size_t CStateTable::Leaf(std::shared_ptr<MElement> aState) const {
+    size_t v = Find(aState);
+
+    return (v == npos) ? 0 : Resolve(v);
+}
+
+std::vector<size_t> CStateTable::Path(size_t aVertex) const {
+    std::vector<size_t> path(mVertex[aVertex].depth + 1);
+
+    for (size_t v = aVertex; ; v = mVertex[v].parent) {
+        path[mVertex[v].depth] = v;
+        if (v == 0) {
+            break;
+        }
+    }
+    return path;
+}
+
+//
+//  The scope is the deepest common ancestor that neither the source nor the
+//  target is. So a transition to an enclosing state leaves it and enters it
+//  again.
+size_t CStateTable::Scope(size_t aSource, size_t aTarget) const {
+    auto   from  = Path(mVertex[aSource].parent);
+    auto   to    = Path(mVertex[aTarget].parent);
+    size_t scope = 0;
+
+    for (size_t d = 0; (d < from.size()) && (d < to.size()) && (from[d] == to[d]); ++d) {
+        scope = from[d];
+    }
+    return scope;
+}
+
+bool CStateTable::HasEvent(const std::string& aEvent) const {
+    return std::find(mEvent.begin(), mEvent.end(), aEvent) != mEvent.end();
+}
+
+void CStateTable::Build(std::shared_ptr<CSimStatemachine> aSm) {
+    mSm           = aSm;
+    mHistorySlots = 0;
+    mVertex.assign(1, tVertex());
+    mTransition.assign(1, tTransition());
+    mEvent.clear();
+    mTopLevel.clear();
+
+    for (auto & st : aSm->states) {
+        if ((st->type == eElementType::State) || (st->type == eElementType::FinalState)) {
+            AddVertex(std::dynamic_pointer_cast<MState>(*st), 0, "");
+        }
+    }
+    size_t initial = Find(InitialTarget(aSm->GetInitialState()));
+
+    mVertex[0].initial = (initial == npos) ? 0 : initial;
+    //
+    //  The toplevel enumerator numbers the initial pseudo state and the states
+    //  in the order of the model. See CSimStatemachine::DumpStateEnumerators.
+    for (auto & st : aSm->states) {
+        if (st->type == eElementType::State) {
+            mTopLevel.push_back(Leaf(*st));
+        } else if ((st->type == eElementType::PseudoState) &&
+                   (helper::tolower(std::dynamic_pointer_cast<CPseudoState>(*st)->kind) == "initial")) {
+            mTopLevel.push_back(0);
+        }
+    }
+    //
+    //  Collect the transitions that are triggered by an event. Completion
+    //  transitions are still run by update().
+    for (size_t v = 1; v < mVertex.size(); ++v) {
+        for (auto & ot : mVertex[v].state->Outgoing) {
+            auto        trans = std::dynamic_pointer_cast<MTransition>(*ot);
+            tTransition t;
+
+            if ((trans->events.empty()) || (!trans->to)) {
+                continue;
+            }
+            t.trans  = trans;
+            t.source = v;
+            t.target = Find(*trans->to);
+            if ((t.target == npos) && (trans->to->type == eElementType::PseudoState) &&
+                (helper::tolower(std::dynamic_pointer_cast<MPseudoState>(*trans->to)->kind) == "shallowhistory")) {
+                t.target = Find(*trans->to->parent);
+                t.resume = true;
+            }
+            if (t.target == npos) {
+                continue;
+            }
+            t.scope = Scope(t.source, t.target);
+            if (!trans->guard.empty()) {
+                t.guard = "sm_guard_" + std::to_string(mTransition.size());
+            }
+            if (!trans->actions.empty()) {
+                t.effect = "sm_effect_" + std::to_string(mTransition.size());
+            }
+            for (auto & ev : trans->events) {
+                auto found = std::find(mEvent.begin(), mEvent.end(), ev->name);
+
+                t.events.push_back(found - mEvent.begin());
+                if (found == mEvent.end()) {
+                    mEvent.push_back(ev->name);
+                }
+            }
+            mTransition.push_back(t);
+        }
+    }
+    Flatten();
+}
+
+void CStateTable::DumpEventEnumerator(std::ostream &output, const std::string& aBasename) {
+    output << "/*\n"
+              " *  Event Enumerator for " << aBasename << "\n"
+              " */\n"
+              "struct e" << aBasename << "Event {\n";
+    for (size_t e = 0; e < mEvent.size(); ++e) {
+        output << "    static const uint16_t " << helper::normalize(mEvent[e]) << " = " << e << ";\n";
+    }
+    output << "    static const uint16_t LastEvent = " << mEvent.size() << ";\n"
+              "};\n\n";
+}
+
+void CStateTable::DumpPrototypes(std::ostream &output, const std::string& aClass) {
+    output << "    /*\n"
+              "     *  The table driven statemachine.\n"
+              "     */\n"
+              "    bool Dispatch(uint16_t aEvent);\n";
+    for (size_t v = 1; v < mVertex.size(); ++v) {
+        output << "    void " << mVertex[v].entry << "();\n";
+        if (!mVertex[v].exit.empty()) {
+            output << "    void " << mVertex[v].exit << "();\n";
+        }
+    }
+    for (size_t t = 1; t < mTransition.size(); ++t) {
+        if (!mTransition[t].guard.empty()) {
+            output << "    bool " << mTransition[t].guard << "();\n";
+        }
+        if (!mTransition[t].effect.empty()) {
+            output << "    void " << mTransition[t].effect << "();\n";
+        }
+    }
+    DumpCellPrototypes(output, aClass);
+    output << "    uint16_t mStateIdx = " << Resolve(0) << ";\n";
+    if (mHistorySlots > 0) {
+        output << "    uint16_t mHistory[" << mHistorySlots << "] = {};\n";
+    }
+}
+
+void CStateTable::DumpTable(std::ostream &output, const std::string& aClass, const std::string& aBasename) {
+    output << "/*\n"
+              " *  The table driven statemachine.\n"
+              " */\n";
+    //
+    //  The entry of a vertex keeps the state attributes of its level up to date.
+    for (size_t v = 1; v < mVertex.size(); ++v) {
+        auto state = mVertex[v].state;
+
+        output << "void " << aClass << "::" << mVertex[v].entry << "() {\n";
+        if (mVertex[v].parent == 0) {
+            output << "    state = " << mSm->stateclass << "::" << helper::normalize(state->name) << ";\n";
+        } else {
+            auto cs = std::dynamic_pointer_cast<CState>(mVertex[mVertex[v].parent].state);
+
+            output << "    " << cs->statevar << " = " << cs->stateclass << "::" << helper::normalize(state->name) << ";\n";
+        }
+        for (auto & a : state->EntryActions) {
+            a->DumpComment(output, 4);
+            output << "    " << a->name << ";\n";
+        }
+        output << "}\n";
+        if (!mVertex[v].exit.empty()) {
+            output << "void " << aClass << "::" << mVertex[v].exit << "() {\n";
+            for (auto & a : state->ExitActions) {
+                a->DumpComment(output, 4);
+                output << "    " << a->name << ";\n";
+            }
+            output << "}\n";
+        }
+    }
+    for (size_t t = 1; t < mTransition.size(); ++t) {
+        auto trans = mTransition[t].trans;
+
+        if (!mTransition[t].guard.empty()) {
+            output << "bool " << aClass << "::" << mTransition[t].guard << "() {\n"
+                      "    return (" << trans->guard << ");\n"
+                      "}\n";
+        }
+        if (!mTransition[t].effect.empty()) {
+            output << "void " << aClass << "::" << mTransition[t].effect << "() {\n";
+            for (auto & a : trans->actions) {
+                a->DumpComment(output, 4);
+                output << "    " << a->name << ";\n";
+            }
+            output << "}\n";
+        }
+    }
+    DumpCells(output, aClass);
+    DumpArrays(output, aClass, "c" + aBasename);
+
+    output << "static constexpr uint16_t c" << aBasename << "StateVertex[] = {";
+    for (auto v : mTopLevel) {
+        output << " " << v << ",";
+    }
+    output << " 0 };\n\n";
+
+    output << "bool " << aClass << "::Dispatch(uint16_t aEvent) {\n"
+              "    return mtt::dispatch(c" << aBasename << "Statemachine, *this, mStateIdx, aEvent);\n"
+              "}\n\n";
+}
+
+//
+//  Resolve every transition for every state it applies to. The cell of a
+//  state and an event lists the routes of the state and of its enclosing
+//  states, innermost first. The list ends at the first route without a
+//  guard, as the ones after it are never tried. Cells with equal routes
+//  share one function.
+void CStateTable::Flatten(void) {
+    const size_t                           events = std::max<size_t>(mEvent.size(), 1);
+    std::map<std::vector<std::string>, size_t> routes;
+    std::map<std::vector<size_t>, size_t>      cells;
+
+    mRoute.assign(1, tRoute());
+    mCell.assign(1, tCell());
+    mTable.clear();
+    for (size_t v = 0; v < mVertex.size(); ++v) {
+        for (size_t e = 0; e < events; ++e) {
+            std::vector<size_t> key;
+            tCell               cell;
+            bool                closed = false;
+
+            for (size_t up = v; (up != 0) && (e < mEvent.size()) && (!closed); up = mVertex[up].parent) {
+                for (size_t t = 1; (t < mTransition.size()) && (!closed); ++t) {
+                    const tTransition& tr = mTransition[t];
+
+                    if ((tr.source != up) || (std::find(tr.events.begin(), tr.events.end(), e) == tr.events.end())) {
+                        continue;
+                    }
+                    tRoute     route;
+                    tCandidate candidate;
+                    auto       path = Path(tr.resume ? tr.target : Resolve(tr.target));
+
+                    route.guard  = tr.guard;
+                    route.effect = tr.effect;
+                    route.resume = tr.resume;
+                    for (size_t x = v; x != tr.scope; x = mVertex[x].parent) {
+                        route.exits.push_back(x);
+                    }
+                    for (size_t d = mVertex[tr.scope].depth + 1; d < path.size(); ++d) {
+                        route.entries.push_back(path[d]);
+                    }
+                    std::vector<std::string> body = {route.guard, route.effect};
+
+                    for (auto x : route.exits) {
+                        if (!mVertex[x].exit.empty()) {
+                            body.push_back("x" + mVertex[x].exit);
+                        }
+                    }
+                    for (auto n : route.entries) {
+                        body.push_back("n" + std::to_string(n));
+                    }
+                    if (route.resume) {
+                        body.push_back("r");
+                    }
+                    auto found = routes.find(body);
+
+                    if (found == routes.end()) {
+                        found = routes.emplace(body, mRoute.size()).first;
+                        mRoute.push_back(route);
+                    }
+                    candidate.transition = t;
+                    candidate.route      = found->second;
+                    cell.push_back(candidate);
+                    key.push_back(candidate.route);
+                    closed = route.guard.empty();
+                }
+            }
+            if (cell.empty()) {
+                mTable.push_back(0);
+                continue;
+            }
+            auto found = cells.find(key);
+
+            if (found == cells.end()) {
+                found = cells.emplace(key, mCell.size()).first;
+                mCell.push_back(cell);
+            }
+            mTable.push_back(found->second);
+        }
+    }
+}
+
+void CStateTable::DumpCellPrototypes(std::ostream &output, const std::string& aClass) {
+    for (size_t c = 1; c < mCell.size(); ++c) {
+        output << "    static bool sm_cell_" << c << "(" << aClass << "& aObj);\n";
+    }
+}
+
+//
+//  Enter the vertices from the first one down to the resolved state.
+void CStateTable::DumpEntries(std::ostream &output, const std::vector<size_t>& aEntries, int spacer) {
+    const std::string& filler = CodeWriter::spaces(spacer);
+
+    for (auto n : aEntries) {
+        size_t slot = mVertex[mVertex[n].parent].history;
+
+        if (slot != npos) {
+            output << filler << "aObj.mHistory[" << slot << "] = " << n << ";\n";
+        }
+        if (!mVertex[n].entry.empty()) {
+            output << filler << "aObj." << mVertex[n].entry << "();\n";
+        }
+    }
+}
+
+//
+//  The run code of a route is straight code, so the exit and entry functions
+//  of the chain can be inlined. Only a target that is resumed through its
+//  shallow history selects the child at runtime.
+void CStateTable::DumpRoute(std::ostream &output, const tRoute& aRoute, int spacer) {
+    const std::string& filler = CodeWriter::spaces(spacer);
+
+    for (auto x : aRoute.exits) {
+        if (!mVertex[x].exit.empty()) {
+            output << filler << "aObj." << mVertex[x].exit << "();\n";
+        }
+    }
+    if (!aRoute.effect.empty()) {
+        output << filler << "aObj." << aRoute.effect << "();\n";
+    }
+    DumpEntries(output, aRoute.entries, spacer);
+    if (aRoute.resume) {
+        size_t target = aRoute.entries.back();
+        size_t slot   = mVertex[target].history;
+
+        output << filler << "switch (aObj.mHistory[" << slot << "]) {\n";
+        for (size_t c = 1; c < mVertex.size(); ++c) {
+            if ((mVertex[c].parent == target) && (c != mVertex[target].initial)) {
+                auto path = Path(Resolve(c));
+
+                output << filler << "case " << c << ":\n";
+                DumpEntries(output, std::vector<size_t>(path.begin() + mVertex[c].depth, path.end()), spacer + 4);
+                output << filler << "    aObj.mStateIdx = " << path.back() << ";\n"
+                       << filler << "    return true;\n";
+            }
+        }
+        auto path = Path(Resolve(target));
+
+        output << filler << "default:\n";
+        DumpEntries(output, std::vector<size_t>(path.begin() + mVertex[target].depth + 1, path.end()), spacer + 4);
+        output << filler << "    aObj.mStateIdx = " << path.back() << ";\n"
+               << filler << "    return true;\n"
+               << filler << "}\n";
+    } else {
+        output << filler << "aObj.mStateIdx = " << aRoute.entries.back() << ";\n"
+               << filler << "return true;\n";
+    }
+}
+
+//
+//  A cell is one function with the guard cascade of its routes inlined, so
+//  an event costs a single indirect call.
+void CStateTable::DumpCells(std::ostream &output, const std::string& aClass) {
+    for (size_t c = 1; c < mCell.size(); ++c) {
+        bool guarded = true;
+
+        output << "bool " << aClass << "::sm_cell_" << c << "(" << aClass << "& aObj) {\n";
+        for (auto & candidate : mCell[c]) {
+            const tRoute& route = mRoute[candidate.route];
+
+            output << "    //  To " << mVertex[route.entries.back()].fnc << "\n";
+            if (route.guard.empty()) {
+                DumpRoute(output, route, 4);
+                guarded = false;
+            } else {
+                output << "    if (aObj." << route.guard << "()) {\n";
+                DumpRoute(output, route, 8);
+                output << "    }\n";
+            }
+        }
+        if (guarded) {
+            output << "    return false;\n";
+        }
+        output << "}\n";
+    }
+    output << "\n";
+}
+
+void CStateTable::DumpArrays(std::ostream &output, const std::string& aClass, const std::string& aPrefix) {
+    const size_t events = std::max<size_t>(mEvent.size(), 1);
+
+    output << "static constexpr mtt::state_cell<" << aClass << "> " << aPrefix << "Cell[] = {\n"
+              "    &mtt::no_cell<" << aClass << ">,\n";
+    for (size_t c = 1; c < mCell.size(); ++c) {
+        const tRoute& route = mRoute[mCell[c].front().route];
+
+        output << "    &" << aClass << "::sm_cell_" << c << ",   // To " << mVertex[route.entries.back()].fnc << "\n";
+    }
+    output << "};\n\n";
+
+    //
+    //  The table holds the cells themselves, so the dispatch does not have to
+    //  go through an index first.
+    output << "static constexpr mtt::state_cell<" << aClass << "> " << aPrefix << "Table[] = {\n";
+    for (size_t v = 0; v < mVertex.size(); ++v) {
+        output << "   ";
+        for (size_t e = 0; e < events; ++e) {
+            output << " " << aPrefix << "Cell[" << mTable[v * events + e] << "],";
+        }
+        output << "\n";
+    }
+    output << "};\n\n";
+
+    output << "static constexpr mtt::state_machine<" << aClass << "> " << aPrefix << "Statemachine = {\n"
+              "    " << aPrefix << "Table, " << events << "\n"
+              "};\n\n";
+}
+
+//
+//  A restored state attribute also moves the flat state index.
+void CStateTable::DumpSetState(std::ostream &output, const std::string& aBasename) {
+    output << "        mStateIdx = (static_cast<uint64_t>(state) < " << mTopLevel.size() << ") ? c" << aBasename
+           << "StateVertex[static_cast<uint64_t>(state)] : 0;\n";
+}
+
+//
+//  The benchmark runs the same deep machine once in the if-chain style of the
+//  state functions and once through the table. The machine is a complete
+//  binary tree of composite states. Vertex v has the children 2v+1 and 2v+2
+//  and every composite state enters its first child by default.
+//
+//  Step   moves from every leaf to the next one.
+//  Flip   is defined on the two toplevel states and resumes the other one
+//         through its shallow history.
+//  Poke   is a guarded self transition of every leaf.
+//
+//  Both modes do the same work per event, the if-chain one inlined into the
+//  nested switches of the state attributes.
+//
+//  The events are a single random stream with one Flip, three Step and four
+//  Poke in eight. The bench prints the mean time per event of each mode over
+//  that stream and nothing per event kind. Both modes pay about one
+//  mispredicted branch per event on it. The table mode then runs one cell
+//  while the if-chain mode still walks one switch per level.
+void CStateTable::DumpBench(std::ostream &output) {
+    const size_t depth = 6;
+    const size_t first = (size_t(1) << depth) - 1;    //  The first leaf. All vertices before have children.
+    const size_t count = 2 * first + 1;
+    auto         level = [](size_t v) { size_t d = 0; for (; v != 0; v = (v - 1) / 2) ++d; return d; };
+    auto         up    = [](size_t v) { return (v - 1) / 2; };
+    auto         next  = [&](size_t v) { return (v + 1 < count) ? v + 1 : first; };
+    auto         scope = [&](size_t a, size_t b) {
+        //
+        //  Same rule as CStateTable::Scope on the heap numbering.
+        a = up(a);
+        b = up(b);
+        while (a != b) {
+            if (a > b) a = up(a); else b = up(b);
+        }
+        return a;
+    };
+
+    output << "//\n"
+              "//  Micro benchmark of the statemachine dispatch modes on a deep hierarchical\n"
+              "//  machine with " << count - 1 << " states in " << depth << " levels.\n"
+              "//\n"
+              "//  g++ -O2 -std=c++17 -I. mttstatemachine_bench.cpp -o mttstatemachine_bench\n"
+              "//\n"
+              "#include <chrono>\n"
+              "#include <cstdint>\n"
+              "#include <cstdio>\n"
+              "#include <cstdlib>\n"
+              "#include <cstring>\n"
+              "#include <vector>\n\n"
+              "#include \"" << Name() << "\"\n\n"
+              "struct eBenchEvent {\n"
+              "    static const uint16_t Step = 0;\n"
+              "    static const uint16_t Flip = 1;\n"
+              "    static const uint16_t Poke = 2;\n"
+              "    static const uint16_t LastEvent = 3;\n"
+              "};\n\n"
+              "struct BenchState {\n"
+              "    uint64_t entries = 0;\n"
+              "    uint64_t exits   = 0;\n"
+              "    uint64_t actions = 0;\n"
+              "    uint64_t count   = 0;\n"
+              "    uint8_t  sv[" << first << "] = {};     //  The state attribute of every composite state.\n"
+              "};\n\n";
+    //
+    //  The if-chain mode.
+    output << "class ChainMachine : public BenchState {\n"
+              "public:\n"
+              "    bool Dispatch(uint16_t aEvent);\n"
+              "    uint16_t Leaf() const {\n"
+              "        uint16_t v = 0;\n\n"
+              "        while (v < " << first << ") {\n"
+              "            v = static_cast<uint16_t>(2 * v + 1 + sv[v]);\n"
+              "        }\n"
+              "        return v;\n"
+              "    }\n"
+              "private:\n"
+              "    bool step();\n"
+              "    bool flip();\n"
+              "    bool poke();\n"
+              "};\n\n";
+
+    std::function<void(size_t, size_t, bool)> chain = [&](size_t v, size_t indent, bool aPoke) {
+        const std::string& filler = CodeWriter::spaces(indent);
+
+        if ((v >= first) && (aPoke)) {
+            output << filler << "if ((++count & 3) != 0) {\n"
+                   << filler << "    ++exits;\n"
+                   << filler << "    ++actions;\n"
+                   << filler << "    ++entries;\n"
+                   << filler << "    sv[" << up(v) << "] = " << v - (2 * up(v) + 1) << ";\n"
+                   << filler << "    return true;\n"
+                   << filler << "}\n"
+                   << filler << "return false;\n";
+        } else if (v >= first) {
+            size_t to = next(v);
+            size_t s  = scope(v, to);
+
+            output << filler << "exits   += " << level(v) - level(s) << ";\n"
+                   << filler << "entries += " << level(to) - level(s) << ";\n";
+            for (size_t a = to; a != 0; a = up(a)) {
+                output << filler << "sv[" << up(a) << "] = " << a - (2 * up(a) + 1) << ";\n";
+            }
+            output << filler << "return true;\n";
+        } else {
+            output << filler << "switch (sv[" << v << "]) {\n"
+                   << filler << "case 0:\n";
+            chain(2 * v + 1, indent + 4, aPoke);
+            output << filler << "default:\n";
+            chain(2 * v + 2, indent + 4, aPoke);
+            output << filler << "}\n";
+        }
+    };
+    output << "bool ChainMachine::step() {\n";
+    chain(0, 4, false);
+    output << "}\n\n"
+              "bool ChainMachine::poke() {\n";
+    chain(0, 4, true);
+    output << "}\n\n";
+    output << "bool ChainMachine::flip() {\n"
+              "    uint16_t v = static_cast<uint16_t>(2 * (2 - sv[0]) + 1);\n\n"
+              "    exits   += " << depth << ";\n"
+              "    entries += " << depth << ";\n"
+              "    sv[0]    = static_cast<uint8_t>(1 - sv[0]);\n"
+              "    v        = static_cast<uint16_t>(v + sv[(v - 1) / 2]);\n"
+              "    while (v < " << first << ") {\n"
+              "        sv[v] = 0;\n"
+              "        v     = static_cast<uint16_t>(2 * v + 1);\n"
+              "    }\n"
+              "    return true;\n"
+              "}\n\n"
+              "bool ChainMachine::Dispatch(uint16_t aEvent) {\n"
+              "    switch (aEvent) {\n"
+              "    case eBenchEvent::Step:\n"
+              "        return step();\n"
+              "    case eBenchEvent::Flip:\n"
+              "        return flip();\n"
+              "    case eBenchEvent::Poke:\n"
+              "        return poke();\n"
+              "    default:\n"
+              "        return false;\n"
+              "    }\n"
+              "}\n\n";
+    //
+    //  The table mode runs on a hand built state table.
+    CStateTable bench;
+
+    bench.mVertex.resize(count);
+    bench.mVertex[0].initial = 1;
+    for (size_t v = 1; v < count; ++v) {
+        tVertex& vertex = bench.mVertex[v];
+
+        vertex.fnc     = "s" + std::to_string(v);
+        vertex.entry   = "e" + std::to_string(v);
+        vertex.exit    = "leave";
+        vertex.parent  = up(v);
+        vertex.initial = (v < first) ? 2 * v + 1 : v;
+        vertex.history = (v <= 2) ? v - 1 : npos;
+        vertex.depth   = level(v);
+    }
+    bench.mHistorySlots = 2;
+    bench.mEvent        = {"Step", "Flip", "Poke"};
+    bench.mTransition.resize(1);
+    for (size_t v = first; v < count; ++v) {
+        tTransition step;
+        tTransition poke;
+
+        step.source = v;
+        step.target = next(v);
+        step.scope  = bench.Scope(v, next(v));
+        step.events = {0};
+        poke.source = v;
+        poke.target = v;
+        poke.scope  = bench.Scope(v, v);
+        poke.guard  = "ready";
+        poke.effect = "touch";
+        poke.events = {2};
+        bench.mTransition.push_back(step);
+        bench.mTransition.push_back(poke);
+    }
+    for (size_t v = 1; v <= 2; ++v) {
+        tTransition flip;
+
+        flip.source = v;
+        flip.target = 3 - v;
+        flip.scope  = 0;
+        flip.resume = true;
+        flip.events = {1};
+        bench.mTransition.push_back(flip);
+    }
+    bench.Flatten();
+
+    output << "class TableMachine : public BenchState {\n"
+              "public:\n"
+              "    bool Dispatch(uint16_t aEvent);\n"
+              "    void leave() { ++exits; }\n"
+              "    void touch() { ++actions; }\n"
+              "    bool ready() { return (++count & 3) != 0; }\n";
+    for (size_t v = 1; v < count; ++v) {
+        output << "    void e" << v << "() { ++entries; sv[" << up(v) << "] = " << v - (2 * up(v) + 1) << "; }\n";
+    }
+    bench.DumpCellPrototypes(output, "TableMachine");
+    output << "    uint16_t mStateIdx = " << first << ";\n"
+              "    uint16_t mHistory[2] = {};\n"
+              "};\n\n";
+
+    bench.DumpCells(output, "TableMachine");
+    bench.DumpArrays(output, "TableMachine", "cBench");
+    output << "bool TableMachine::Dispatch(uint16_t aEvent) {\n"
+              "    return mtt::dispatch(cBenchStatemachine, *this, mStateIdx, aEvent);\n"
+              "}\n\n";
+
+    output << "template <class M>\n"
+              "static double run(M& aMachine, const std::vector<uint16_t>& aEvents, int aRounds) {\n"
+              "    auto start = std::chrono::steady_clock::now();\n\n"
+              "    for (int r = 0; r < aRounds; ++r) {\n"
+              "        for (auto e : aEvents) {\n"
+              "            aMachine.Dispatch(e);\n"
+              "        }\n"
+              "    }\n"
+              "    std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;\n\n"
+              "    return took.count() / (static_cast<double>(aEvents.size()) * aRounds);\n"
+              "}\n\n"
+              "int main(int argc, char** argv) {\n"
+              "    const int             rounds = (argc > 1) ? std::atoi(argv[1]) : 20;\n"
+              "    std::vector<uint16_t> events(1u << 20);\n"
+              "    uint32_t              x = 2463534242u;\n"
+              "    ChainMachine          chain;\n"
+              "    TableMachine          table;\n\n"
+              "    for (auto & e : events) {\n"
+              "        x ^= x << 13;\n"
+              "        x ^= x >> 17;\n"
+              "        x ^= x << 5;\n"
+              "        e  = ((x & 7) == 0) ? eBenchEvent::Flip : (((x & 7) < 4) ? eBenchEvent::Step : eBenchEvent::Poke);\n"
+              "    }\n"
+              "    double c = run(chain, events, rounds);\n"
+              "    double t = run(table, events, rounds);\n\n"
+              "    std::printf(\"if-chain : %6.2f ns/event\\n\", c);\n"
+              "    std::printf(\"table    : %6.2f ns/event\\n\", t);\n"
+              "    if ((chain.Leaf() != table.mStateIdx) || (chain.entries != table.entries) || (chain.exits != table.exits) ||\n"
+              "        (chain.actions != table.actions) || (std::memcmp(chain.sv, table.sv, sizeof(chain.sv)) != 0)) {\n"
+              "        std::printf(\"the modes disagree\\n\");\n"
+              "        return 1;\n"
+              "    }\n"
+              "    return 0;\n"
+              "}\n";
+}
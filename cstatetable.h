@@ -0,0 +1,116 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef CSTATETABLE_H
+#define CSTATETABLE_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class CModel;
+class MElement;
+class MState;
+class MTransition;
+class CSimStatemachine;
+
+//
+//  The state table is the flattened form of a sim object statemachine. Every
+//  state of the hierarchy becomes a vertex and every transition triggered by
+//  an event an entry of a state x event table. The generated code dispatches
+//  an event with one lookup into that table. Every cell is one function that
+//  holds the candidate transitions with their guards, exit and entry chains
+//  already resolved for the state of the row.
+class CStateTable {
+public:
+    static std::string Name(void) { return "mttstatemachine.h"; }
+    static void DumpRuntime(std::shared_ptr<CModel> aModel, const std::string& aId);
+
+    void Build(std::shared_ptr<CSimStatemachine> aSm);
+    bool HasEvent(const std::string& aEvent) const;
+    size_t Leaf(std::shared_ptr<MElement> aState) const;
+
+    void DumpEventEnumerator(std::ostream& output, const std::string& aBasename);
+    void DumpPrototypes(std::ostream& output, const std::string& aClass);
+    void DumpTable(std::ostream& output, const std::string& aClass, const std::string& aBasename);
+    void DumpSetState(std::ostream& output, const std::string& aBasename);
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    struct tVertex {
+        std::shared_ptr<MState> state;
+        std::string             fnc;
+        std::string             entry;              //  Name of the entry function or empty.
+        std::string             exit;               //  Name of the exit function or empty.
+        size_t                  parent  = 0;
+        size_t                  initial = 0;
+        size_t                  history = npos;
+        size_t                  depth   = 0;
+    };
+    struct tTransition {
+        std::shared_ptr<MTransition> trans;
+        std::string                  guard;         //  Name of the guard function or empty.
+        std::string                  effect;        //  Name of the effect function or empty.
+        std::vector<size_t>          events;
+        size_t                       source = 0;
+        size_t                       target = 0;
+        size_t                       scope  = 0;
+        bool                         resume = false;
+    };
+    struct tRoute {
+        std::string                  guard;
+        std::string                  effect;
+        bool                         resume = false;
+        std::vector<size_t>          exits;         //  From the state up to the scope.
+        std::vector<size_t>          entries;       //  From the scope down to the target.
+    };
+    struct tCandidate {
+        size_t                       transition = 0;
+        size_t                       route      = 0;
+    };
+    //
+    //  The candidates of a cell, innermost state first.
+    using tCell = std::vector<tCandidate>;
+
+    size_t AddVertex(std::shared_ptr<MState> aState, size_t aParent, const std::string& aPrefix);
+    size_t Find(std::shared_ptr<MElement> aState) const;
+    size_t Resolve(size_t aVertex) const;
+    size_t Scope(size_t aSource, size_t aTarget) const;
+    std::vector<size_t> Path(size_t aVertex) const;
+    void Flatten(void);
+    void DumpCellPrototypes(std::ostream& output, const std::string& aClass);
+    void DumpEntries(std::ostream& output, const std::vector<size_t>& aEntries, int spacer);
+    void DumpRoute(std::ostream& output, const tRoute& aRoute, int spacer);
+    void DumpCells(std::ostream& output, const std::string& aClass);
+    void DumpArrays(std::ostream& output, const std::string& aClass, const std::string& aPrefix);
+    static void DumpBench(std::ostream& output);
+private:
+    std::shared_ptr<CSimStatemachine> mSm;
+    std::vector<tVertex>              mVertex;
+    std::vector<tTransition>          mTransition;
+    std::vector<std::string>          mEvent;
+    std::vector<tRoute>               mRoute;
+    std::vector<tCell>                mCell;         //  The first cell is the empty one.
+    std::vector<size_t>               mTable;        //  Cell per state and event.
+    std::vector<size_t>               mTopLevel;     //  Vertex for every value of the toplevel state enumerator.
+    size_t                            mHistorySlots = 0;
+};
+
+#endif // CSTATETABLE_H
@@ -50,6 +50,12 @@ void CStruct::Dump(std::shared_ptr<MModel> model) {
     std::list<std::pair<std::string, std::string> >           alist;
     std::list<std::pair<std::string, std::string> >::iterator ilist;
     size_t                                                    alistmax=0;
+    //
+    //  Nothing to do if the element did not change since the last run.
+    if (IsUnchanged(model)) {
+        return;
+    }
+
     DumpBase( std::dynamic_pointer_cast<CModel>(model), name);
     DumpFileHeader(hdr, name, ".h");
     DumpGuardHead(hdr, name);
@@ -179,8 +185,7 @@ void CStruct::Dump(std::shared_ptr<MModel> model) {
         }
     }
     for (ilist=alist.begin(); ilist != alist.end(); ++ilist) {
-        std::string filler;
-        filler.assign(alistmax-ilist->first.size()+1, ' ');
+        const std::string& filler = CodeWriter::spaces(alistmax-ilist->first.size()+1);
         hdr << "    " << ilist->first << filler << ilist->second << ";\n";
     }
     hdr << "};\n";
@@ -64,7 +64,7 @@ void CSubsystemPackage::Prepare(void) {
 }
 
 void CSubsystemPackage::Dump(std::shared_ptr<MModel> model) {
-    std::ofstream document;
+    CodeWriter document;
     CPath path;
     auto cmodel = std::dynamic_pointer_cast<CModel>(model);
 
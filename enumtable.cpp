@@ -0,0 +1,212 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+
+#include "codewriter.h"
+#include "perfecthash.h"
+#include "enumtable.h"
+
+void EnumTable::Add(const std::string& aName, const std::string& aValue) {
+    mLiteral.push_back(tLiteral {aName, aValue, false, 0});
+}
+
+void EnumTable::Add(const std::string& aName, const std::string& aValue, uint64_t aNumber) {
+    mLiteral.push_back(tLiteral {aName, aValue, true, aNumber});
+}
+//
+//  A switch needs the values to be known and distinct.
+bool EnumTable::Known(void) const {
+    std::set<uint64_t> numbers;
+
+    for (auto & l : mLiteral) {
+        if ((!l.known) || (!numbers.insert(l.number).second)) {
+            return false;
+        }
+    }
+    return true;
+}
+//
+//  The table can be indexed by the value if the literals count up by one in
+//  the order they are declared.
+bool EnumTable::Dense(void) const {
+    if (!Known()) {
+        return false;
+    }
+    for (size_t l = 1; l < mLiteral.size(); ++l) {
+        if (mLiteral[l].number != mLiteral[l - 1].number + 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string EnumTable::Definition(void) const {
+    std::string code;
+    std::string table = "c" + mName + "Name";
+    size_t      width = 0;
+
+    if (mLiteral.empty()) {
+        return code;
+    }
+    for (auto & l : mLiteral) {
+        width = std::max(width, l.name.size());
+    }
+    code += "//\n"
+            "//  The names of the " + mName + " literals.\n"
+            "struct t" + mName + "Name {\n"
+            "    std::string_view name;\n"
+            "    " + mType + CodeWriter::spaces((mType.size() < 16) ? 17 - mType.size() : 1) + "value;\n"
+            "};\n"
+            "\n"
+            "constexpr t" + mName + "Name " + table + "[" + std::to_string(mLiteral.size()) + "] = {\n";
+    for (size_t l = 0; l < mLiteral.size(); ++l) {
+        code += "    {\"" + mLiteral[l].name + "\"," + CodeWriter::spaces(width - mLiteral[l].name.size() + 1) + mLiteral[l].value + "}" +
+                ((l + 1 < mLiteral.size()) ? ",\n" : "\n");
+    }
+    code += "};\n";
+    //
+    //  The range check and the name of a value.
+    if (Dense()) {
+        std::string first = "c" + mName + "First";
+        std::string last  = "c" + mName + "Last";
+        std::string type  = mType + CodeWriter::spaces((mType.size() < 6) ? 7 - mType.size() : 1);
+        std::string size  = "size_t" + CodeWriter::spaces((mType.size() > 6) ? mType.size() - 5 : 1);
+
+        code += "//\n"
+                "//  The values are dense from " + mLiteral.front().name + " to " + mLiteral.back().name + ".\n"
+                "constexpr " + type + first + " = " + mLiteral.front().value + ";\n"
+                "constexpr " + type + last + "  = " + mLiteral.back().value + ";\n"
+                "constexpr " + size + "c" + mName + "Count = " + std::to_string(mLiteral.size()) + ";\n"
+                "\n"
+                "constexpr bool " + mName + "IsValid(" + mType + " aValue) noexcept {\n"
+                "    return (aValue >= " + first + ") && (aValue <= " + last + ");\n"
+                "}\n"
+                "\n"
+                "constexpr std::string_view " + mName + "ToString(" + mType + " aValue) noexcept {\n"
+                "    if (" + mName + "IsValid(aValue)) {\n"
+                "        return " + table + "[static_cast<size_t>(aValue) - static_cast<size_t>(" + first + ")].name;\n"
+                "    }\n"
+                "    return std::string_view();\n"
+                "}\n";
+    } else if (Known()) {
+        code += "\n"
+                "constexpr size_t c" + mName + "Count = " + std::to_string(mLiteral.size()) + ";\n"
+                "\n"
+                "constexpr bool " + mName + "IsValid(" + mType + " aValue) noexcept {\n"
+                "    switch (aValue) {\n";
+        for (auto & l : mLiteral) {
+            code += "    case " + l.value + ":\n";
+        }
+        code += "        return true;\n"
+                "    default:\n"
+                "        break;\n"
+                "    }\n"
+                "    return false;\n"
+                "}\n"
+                "\n"
+                "constexpr std::string_view " + mName + "ToString(" + mType + " aValue) noexcept {\n"
+                "    switch (aValue) {\n";
+        for (size_t l = 0; l < mLiteral.size(); ++l) {
+            code += "    case " + mLiteral[l].value + ":\n"
+                    "        return " + table + "[" + std::to_string(l) + "].name;\n";
+        }
+        code += "    default:\n"
+                "        break;\n"
+                "    }\n"
+                "    return std::string_view();\n"
+                "}\n";
+    } else {
+        //
+        //  Values that are expressions or aliases are only known to the
+        //  compiler. The first literal with a value gives its name.
+        code += "\n"
+                "constexpr size_t c" + mName + "Count = " + std::to_string(mLiteral.size()) + ";\n"
+                "\n"
+                "constexpr bool " + mName + "IsValid(" + mType + " aValue) noexcept {\n"
+                "    for (const auto& n : " + table + ") {\n"
+                "        if (n.value == aValue) {\n"
+                "            return true;\n"
+                "        }\n"
+                "    }\n"
+                "    return false;\n"
+                "}\n"
+                "\n"
+                "constexpr std::string_view " + mName + "ToString(" + mType + " aValue) noexcept {\n"
+                "    for (const auto& n : " + table + ") {\n"
+                "        if (n.value == aValue) {\n"
+                "            return n.name;\n"
+                "        }\n"
+                "    }\n"
+                "    return std::string_view();\n"
+                "}\n";
+    }
+    //
+    //  The value of a name.
+    PerfectHash           hash;
+    std::vector<uint64_t> keys;
+
+    for (auto & l : mLiteral) {
+        keys.push_back(PerfectHash::Hash(l.name));
+    }
+    code += "\n";
+    if (hash.Build(keys)) {
+        std::string slot = (mLiteral.size() < 0xff) ? "uint8_t " : (mLiteral.size() < 0xffff) ? "uint16_t" : "uint32_t";
+
+        code += "constexpr uint16_t c" + mName + "Seed[" + std::to_string(hash.Seeds().size()) + "] = {";
+        for (size_t b = 0; b < hash.Seeds().size(); ++b) {
+            code += ((b == 0) ? "" : ", ") + std::to_string(hash.Seeds()[b]);
+        }
+        code += "};\n"
+                "//\n"
+                "//  The index in " + table + " plus one. Zero is an empty slot.\n"
+                "constexpr " + slot + " c" + mName + "Slot[" + std::to_string(hash.Slots().size()) + "] = {";
+        for (size_t s = 0; s < hash.Slots().size(); ++s) {
+            code += ((s == 0) ? "" : ", ") + std::to_string((hash.Slots()[s] == PerfectHash::npos) ? 0 : hash.Slots()[s] + 1);
+        }
+        code += "};\n"
+                "\n"
+                "constexpr bool " + mName + "FromString(std::string_view aName, " + mType + "& aValue) noexcept {\n"
+                "    const size_t entry = c" + mName + "Slot[mtt::phash_slot(mtt::phash_string(aName), c" + mName + "Seed, " +
+                std::to_string(hash.BucketMask()) + ", " + std::to_string(hash.Shift()) + ")];\n"
+                "\n"
+                "    if ((entry != 0) && (" + table + "[entry - 1].name == aName)) {\n"
+                "        aValue = " + table + "[entry - 1].value;\n"
+                "        return true;\n"
+                "    }\n"
+                "    return false;\n"
+                "}\n";
+    } else {
+        //
+        //  Only a collision of two 64 bit hashes ends here.
+        code += "constexpr bool " + mName + "FromString(std::string_view aName, " + mType + "& aValue) noexcept {\n"
+                "    for (const auto& n : " + table + ") {\n"
+                "        if (n.name == aName) {\n"
+                "            aValue = n.value;\n"
+                "            return true;\n"
+                "        }\n"
+                "    }\n"
+                "    return false;\n"
+                "}\n";
+    }
+    return code;
+}
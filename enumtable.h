@@ -0,0 +1,62 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef ENUMTABLE_H
+#define ENUMTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+//  The string conversion of an enumeration. The names of the literals go into
+//  a constexpr table. ToString indexes the table if the values are dense and
+//  switches over the values otherwise. FromString looks the name up through a
+//  perfect hash computed here, so the generated code needs
+//  mttperfecthash.h.
+class EnumTable {
+public:
+    //
+    //  aName prefixes the generated tables and functions. aType is the type of
+    //  the values.
+    EnumTable(const std::string& aName, const std::string& aType) : mName(aName), mType(aType) {}
+    //
+    //  aValue is the expression of the literal. The number is only used if the
+    //  value is known at generation time.
+    void Add(const std::string& aName, const std::string& aValue);
+    void Add(const std::string& aName, const std::string& aValue, uint64_t aNumber);
+    bool Empty(void) const { return mLiteral.empty(); }
+
+    std::string Definition(void) const;
+private:
+    struct tLiteral {
+        std::string name;
+        std::string value;
+        bool        known;
+        uint64_t    number;
+    };
+    bool Known(void) const;
+    bool Dense(void) const;
+private:
+    std::string           mName;
+    std::string           mType;
+    std::vector<tLiteral> mLiteral;
+};
+
+#endif // ENUMTABLE_H
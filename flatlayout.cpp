@@ -0,0 +1,675 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <string>
+#include <memory>
+#include <set>
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+#include "main.h"
+#include "helper.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "mattribute.h"
+#include "cattribute.h"
+#include "massociationend.h"
+#include "cassociationend.h"
+#include "cclassbase.h"
+#include "flatlayout.h"
+
+//
+//  A table holds its fields at fixed offsets. Strings and arrays are a
+//  reference of two uint32_t, the offset from the start of the buffer and the
+//  count. Strings are followed by a NUL. Structs are tables of their own and
+//  referenced by their offset. All values are in host byte order and read
+//  with memcpy, so the buffer needs no alignment. If the buffer starts at an
+//  8 byte boundary, the scalar arrays are aligned for their type.
+static const char* cFlatRuntime = R"RUNTIME(#pragma once
+#ifndef MTTFLAT_INC
+#define MTTFLAT_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+namespace mtt {
+constexpr size_t flat_align(size_t aOffset, size_t aAlign) {
+    return (aOffset + aAlign - 1) & ~(aAlign - 1);
+}
+
+//
+//  Not every byte is a valid bool and not every value of the underlying type
+//  is a valid enum. So these are read through an integer.
+template <typename T>
+inline std::remove_cv_t<T> flat_get(const uint8_t* aData) {
+    using V = std::remove_cv_t<T>;
+
+    if constexpr (std::is_same<V, bool>::value) {
+        return aData[0] != 0;
+    } else if constexpr (std::is_enum<V>::value) {
+        return static_cast<V>(flat_get<std::underlying_type_t<V>>(aData));
+    } else {
+        V value;
+
+        std::memcpy(&value, aData, sizeof(value));
+        return value;
+    }
+}
+//
+//  The element type of vectors, lists and arrays.
+template <typename C, typename = void>
+struct flat_element {
+    using type = C;
+};
+
+template <typename C>
+struct flat_element<C, std::void_t<typename C::value_type>> {
+    using type = typename C::value_type;
+};
+
+template <typename T, size_t N>
+struct flat_element<T[N], void> {
+    using type = T;
+};
+
+template <typename C>
+using flat_element_t = std::remove_cv_t<typename flat_element<C>::type>;
+
+inline std::string_view flat_string(const uint8_t* aBase, size_t aRef) {
+    return std::string_view(reinterpret_cast<const char*>(aBase) + flat_get<uint32_t>(aBase + aRef), flat_get<uint32_t>(aBase + aRef + 4));
+}
+//
+//  The generated views are derived from flat_view.
+class flat_view {
+public:
+    flat_view(const uint8_t* aBase, size_t aTable) : mBase(aBase), mTable(aTable) {}
+protected:
+    const uint8_t* mBase;
+    size_t         mTable;
+};
+//
+//  How the elements of an array are stored.
+template <typename T, typename = void>
+struct flat_traits {
+    static constexpr size_t size = sizeof(T);
+    static T get(const uint8_t* aBase, size_t aAt) { return flat_get<T>(aBase + aAt); }
+};
+
+template <>
+struct flat_traits<std::string_view, void> {
+    static constexpr size_t size = 8;
+    static std::string_view get(const uint8_t* aBase, size_t aAt) { return flat_string(aBase, aAt); }
+};
+
+template <typename T>
+struct flat_traits<T, std::enable_if_t<std::is_base_of<flat_view, T>::value>> {
+    static constexpr size_t size = 4;
+    static T get(const uint8_t* aBase, size_t aAt) { return T(aBase, flat_get<uint32_t>(aBase + aAt)); }
+};
+//
+//  The read only array of a view. The elements are read on access.
+template <typename T>
+class flat_vector {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = T;
+
+        iterator(const flat_vector* aVector, size_t aIndex) : mVector(aVector), mIndex(aIndex) {}
+        T operator*() const { return (*mVector)[mIndex]; }
+        iterator& operator++() {
+            ++mIndex;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+
+            ++mIndex;
+            return old;
+        }
+        bool operator==(const iterator& aOther) const { return mIndex == aOther.mIndex; }
+        bool operator!=(const iterator& aOther) const { return mIndex != aOther.mIndex; }
+    private:
+        const flat_vector* mVector;
+        size_t             mIndex;
+    };
+
+    flat_vector(const uint8_t* aBase, size_t aRef) :
+        mBase(aBase), mData(flat_get<uint32_t>(aBase + aRef)), mCount(flat_get<uint32_t>(aBase + aRef + 4)) {}
+
+    size_t size() const { return mCount; }
+    bool empty() const { return mCount == 0; }
+    T operator[](size_t aIndex) const { return flat_traits<T>::get(mBase, mData + aIndex * flat_traits<T>::size); }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, mCount); }
+    //
+    //  The raw bytes of the elements.
+    const uint8_t* data() const { return mBase + mData; }
+private:
+    const uint8_t* mBase;
+    size_t         mData;
+    size_t         mCount;
+};
+//
+//  The builder writes into a caller buffer. The space is zeroed when it is
+//  taken. If the buffer is too small or an offset does not fit in 32 bit,
+//  nothing is written anymore and finish() returns 0.
+class flat_builder {
+public:
+    flat_builder(uint8_t* aOut, size_t aSize) : mOut(aOut), mSize(aSize) {}
+
+    bool good() const { return mGood; }
+    size_t finish() const { return mGood ? mUsed : 0; }
+
+    size_t alloc(size_t aSize, size_t aAlign) {
+        size_t at = flat_align(mUsed, aAlign);
+
+        if (!mGood || (at > mSize) || (aSize > mSize - at) || (at + aSize > UINT32_MAX)) {
+            mGood = false;
+            return 0;
+        }
+        std::memset(mOut + at, 0, aSize);
+        mUsed = at + aSize;
+
+        return at;
+    }
+    template <typename T>
+    void set(size_t aAt, const T& aValue) {
+        if (mGood) {
+            std::memcpy(mOut + aAt, &aValue, sizeof(T));
+        }
+    }
+    void ref(size_t aAt, size_t aOffset, size_t aCount) {
+        set(aAt, static_cast<uint32_t>(aOffset));
+        set(aAt + 4, static_cast<uint32_t>(aCount));
+    }
+    void string(size_t aAt, std::string_view aValue) {
+        size_t at = alloc(aValue.size() + 1, 1);
+
+        if (mGood) {
+            if (!aValue.empty()) {
+                std::memcpy(mOut + at, aValue.data(), aValue.size());
+            }
+            ref(aAt, at, aValue.size());
+        }
+    }
+    //
+    //  Vectors and arrays are copied in one block.
+    template <typename C>
+    void array(size_t aAt, const C& aValues) {
+        using T = flat_element_t<C>;
+        static_assert(std::is_trivially_copyable<T>::value, "flat arrays need trivially copyable elements");
+        size_t count = std::size(aValues);
+        size_t at    = alloc(fits(count, sizeof(T)) ? count * sizeof(T) : SIZE_MAX, alignof(T));
+
+        if (mGood) {
+            if constexpr (std::is_array<C>::value || (std::is_same<C, std::vector<T>>::value && !std::is_same<T, bool>::value)) {
+                if (count != 0) {
+                    std::memcpy(mOut + at, std::data(aValues), count * sizeof(T));
+                }
+            } else {
+                size_t i = 0;
+
+                for (const auto& v : aValues) {
+                    set<T>(at + sizeof(T) * i++, v);
+                }
+            }
+            ref(aAt, at, count);
+        }
+    }
+    template <typename C>
+    void strings(size_t aAt, const C& aValues) {
+        size_t count = std::size(aValues);
+        size_t at    = alloc(fits(count, 8) ? count * 8 : SIZE_MAX, 4);
+
+        if (mGood) {
+            size_t i = 0;
+
+            ref(aAt, at, count);
+            for (const auto& v : aValues) {
+                string(at + 8 * i++, v);
+            }
+        }
+    }
+    size_t table(size_t aSize) {
+        return alloc(aSize, 8);
+    }
+    size_t table_at(size_t aAt, size_t aSize) {
+        size_t at = alloc(aSize, 8);
+
+        set(aAt, static_cast<uint32_t>(at));
+        return at;
+    }
+    size_t tables(size_t aAt, size_t aCount) {
+        size_t at = alloc(fits(aCount, 4) ? aCount * 4 : SIZE_MAX, 4);
+
+        ref(aAt, at, aCount);
+        return at;
+    }
+private:
+    static bool fits(size_t aCount, size_t aSize) {
+        return aCount <= UINT32_MAX / aSize;
+    }
+private:
+    uint8_t* mOut;
+    size_t   mSize;
+    size_t   mUsed = 0;
+    bool     mGood = true;
+};
+//
+//  The builders of an array of structs. Each element is to be taken once.
+template <typename B>
+class flat_tables {
+public:
+    flat_tables(flat_builder& aOut, size_t aAt) : mOut(aOut), mAt(aAt) {}
+
+    B operator[](size_t aIndex) { return B(mOut, mOut.table_at(mAt + 4 * aIndex, B::cSize)); }
+private:
+    flat_builder& mOut;
+    size_t        mAt;
+};
+//
+//  The checks of verify(). A nested table must start behind the table that
+//  refers to it, so a buffer can not loop.
+inline bool flat_fits(size_t aSize, size_t aAt, size_t aLength) {
+    return (aAt <= aSize) && (aLength <= aSize - aAt);
+}
+
+inline bool flat_verify_array(const uint8_t* aBase, size_t aSize, size_t aRef, size_t aElement) {
+    size_t at    = flat_get<uint32_t>(aBase + aRef);
+    size_t count = flat_get<uint32_t>(aBase + aRef + 4);
+
+    return (at <= aSize) && (count <= (aSize - at) / aElement);
+}
+
+inline bool flat_verify_string(const uint8_t* aBase, size_t aSize, size_t aRef) {
+    size_t at    = flat_get<uint32_t>(aBase + aRef);
+    size_t count = flat_get<uint32_t>(aBase + aRef + 4);
+
+    return flat_fits(aSize, at, count + 1) && (aBase[at + count] == 0);
+}
+
+inline bool flat_verify_strings(const uint8_t* aBase, size_t aSize, size_t aRef) {
+    if (!flat_verify_array(aBase, aSize, aRef, 8)) {
+        return false;
+    }
+    size_t at    = flat_get<uint32_t>(aBase + aRef);
+    size_t count = flat_get<uint32_t>(aBase + aRef + 4);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!flat_verify_string(aBase, aSize, at + 8 * i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename V>
+inline bool flat_verify_table(const uint8_t* aBase, size_t aSize, size_t aTable, size_t aAt) {
+    size_t at = flat_get<uint32_t>(aBase + aAt);
+
+    return (at > aTable) && V::verify(aBase, aSize, at);
+}
+
+template <typename V>
+inline bool flat_verify_tables(const uint8_t* aBase, size_t aSize, size_t aTable, size_t aRef) {
+    if (!flat_verify_array(aBase, aSize, aRef, 4)) {
+        return false;
+    }
+    size_t at    = flat_get<uint32_t>(aBase + aRef);
+    size_t count = flat_get<uint32_t>(aBase + aRef + 4);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!flat_verify_table<V>(aBase, aSize, aTable, at + 4 * i)) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace mtt
+
+#endif  // MTTFLAT_INC
+)RUNTIME";
+
+void FlatLayout::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "fl-inc", header.buffer()});
+        header << cFlatRuntime;
+        header.close();
+    }
+}
+
+void FlatLayout::Member(std::shared_ptr<CAttribute> a) {
+    tField field;
+    //
+    //  A pointer to a sim object is stored as its id.
+    if (a->FQN() == "__simobject__") {
+        if ((a->Aggregation != aShared) && Field(field, nullptr, "objectid_t", a->Multiplicity)) {
+            Add(mRoot.fields, field, mOwner, a->name, nullptr);
+        }
+    } else if (a->QualifierType.empty() && Field(field, a->Classifier, a->ClassifierName, a->Multiplicity)) {
+        Add(mRoot.fields, field, mOwner, a->name, a->Classifier);
+    }
+}
+
+void FlatLayout::Member(std::shared_ptr<CAssociationEnd> a) {
+    tField field;
+
+    if (a->QualifierType.empty() && !a->HasContainerPolicy() &&
+        Field(field, a->Classifier, (a->Classifier) ? a->Classifier->name : std::string(), a->Multiplicity)) {
+        Add(mRoot.fields, field, mOwner, a->name, a->Classifier);
+    }
+}
+
+std::string FlatLayout::Declaration(int aIndent) const {
+    std::string code = "//\n"
+                       "//  The flat layout. View reads the fields in place and Builder writes them\n"
+                       "//  into a caller buffer. pack_flat() returns the used size or 0 if the\n"
+                       "//  buffer is too small.\n"
+                       "class View;\n"
+                       "class Builder;\n";
+
+    for (auto & t : mTables) {
+        code += "class " + t.name + "View;\n"
+                "class " + t.name + "Builder;\n";
+    }
+    code += "size_t pack_flat(uint8_t* aOut, size_t aSize) const;\n";
+
+    return CodeWriter::shift(code, aIndent);
+}
+//
+//  The nested classes are defined after the message class, the struct tables
+//  first as the others refer to them.
+std::string FlatLayout::Definition(void) const {
+    std::string code;
+
+    for (auto & t : mTables) {
+        code += View(t) + "\n";
+    }
+    code += View(mRoot) + "\n";
+    for (auto & t : mTables) {
+        code += Builder(t) + "\n";
+    }
+    code += Builder(mRoot) + "\n"
+            "inline size_t " + mOwner + "::pack_flat(uint8_t* aOut, size_t aSize) const {\n"
+            "    mtt::flat_builder out(aOut, aSize);\n"
+            "\n"
+            "    Builder(out).from(*this);\n"
+            "    return out.finish();\n"
+            "}\n";
+
+    return code;
+}
+//
+//  Optional members, maps and containers with a policy have no flat form and
+//  are left out.
+bool FlatLayout::Field(tField& aField, std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aMultiplicity) {
+    if (aMultiplicity.empty() || (aMultiplicity == "1")) {
+        aField.count = eCount::single;
+    } else if (aMultiplicity == "0..1") {
+        return false;
+    } else if (std::all_of(aMultiplicity.begin(), aMultiplicity.end(), ::isdigit)) {
+        aField.count = eCount::array;
+    } else {
+        aField.count = eCount::vector;
+    }
+    if (aClassifier && ((aClassifier->type == eElementType::Struct) || (aClassifier->type == eElementType::SimStruct) ||
+                        (aClassifier->type == eElementType::CxxClass))) {
+        aField.kind = eKind::table;
+        aField.type = aClassifier->name;
+    } else if ((aType == "string") || (aType == "std::string")) {
+        aField.kind = eKind::string;
+    } else {
+        aField.kind = eKind::scalar;
+    }
+    return true;
+}
+
+void FlatLayout::Add(std::vector<tField>& aFields, tField& aField, const std::string& aOwner, const std::string& aMember, std::shared_ptr<MElement> aClassifier) {
+    aField.member = aMember;
+    aField.owner  = aOwner;
+    if (aField.kind == eKind::table) {
+        Table((aField.count == eCount::single) ? Type(aField) : Element(aField), aClassifier);
+    }
+    aFields.push_back(aField);
+}
+//
+//  A struct gets one table layout, which is made from the first member that
+//  uses it. The name is taken before the fields, so a struct that refers to
+//  itself ends the recursion.
+void FlatLayout::Table(const std::string& aType, std::shared_ptr<MElement> aStruct) {
+    auto   s = std::dynamic_pointer_cast<CClassBase>(aStruct);
+    tTable table;
+
+    if (!mNames.insert(aStruct->name).second) {
+        return;
+    }
+
+    table.name = aStruct->name;
+    table.type = aType;
+    if (s) {
+        for (auto & ai : s->GetAttributes()) {
+            auto   a = std::dynamic_pointer_cast<CAttribute>(ai);
+            tField field;
+
+            if (a->QualifierType.empty() && Field(field, a->Classifier, a->ClassifierName, a->Multiplicity)) {
+                Add(table.fields, field, aType, a->name, a->Classifier);
+            }
+        }
+        for (auto & ae : s->OtherEnd) {
+            auto   a = std::dynamic_pointer_cast<CAssociationEnd>(*ae);
+            tField field;
+
+            if (a->isNavigable() && a->QualifierType.empty() && !a->HasContainerPolicy() &&
+                Field(field, a->Classifier, (a->Classifier) ? a->Classifier->name : std::string(), a->Multiplicity)) {
+                Add(table.fields, field, aType, a->name, a->Classifier);
+            }
+        }
+    }
+    mTables.push_back(table);
+}
+
+std::string FlatLayout::Type(const tField& aField) {
+    return "decltype(" + aField.owner + "::" + aField.member + ")";
+}
+
+std::string FlatLayout::Element(const tField& aField) {
+    return "mtt::flat_element_t<" + Type(aField) + ">";
+}
+//
+//  The C++ type of a field in the view.
+std::string FlatLayout::ViewType(const tField& aField) {
+    std::string type;
+
+    if (aField.kind == eKind::table) {
+        type = aField.type + "View";
+    } else if (aField.kind == eKind::string) {
+        type = "std::string_view";
+    } else if (aField.count == eCount::single) {
+        type = Type(aField);
+    } else {
+        type = Element(aField);
+    }
+    if (aField.count != eCount::single) {
+        type = "mtt::flat_vector<" + type + ">";
+    }
+    return type;
+}
+//
+//  Scalars are stored inline. Strings and arrays take the offset and the count
+//  of the data, single structs the offset of their table.
+std::string FlatLayout::Offsets(const tTable& aTable) {
+    std::string code;
+    std::string next = "0";
+    size_t      width = 0;
+
+    for (auto & f : aTable.fields) {
+        width = std::max(width, f.member.size());
+    }
+    width = std::max(width + 2, std::string("cSize").size());
+    for (auto & f : aTable.fields) {
+        std::string name = "o_" + f.member;
+
+        if ((f.kind == eKind::scalar) && (f.count == eCount::single)) {
+            code += "static constexpr size_t " + name + std::string(width - name.size(), ' ') + " = " +
+                    ((next == "0") ? next : "mtt::flat_align(" + next + ", alignof(" + Type(f) + "))") + ";\n";
+            next = name + " + sizeof(" + Type(f) + ")";
+        } else {
+            code += "static constexpr size_t " + name + std::string(width - name.size(), ' ') + " = " +
+                    ((next == "0") ? next : "mtt::flat_align(" + next + ", 4)") + ";\n";
+            next = name + (((f.kind == eKind::table) && (f.count == eCount::single)) ? " + 4" : " + 8");
+        }
+    }
+    code += "static constexpr size_t cSize" + std::string(width - 5, ' ') + " = " + ((next == "0") ? "8" : "mtt::flat_align(" + next + ", 8)") + ";\n";
+
+    return code;
+}
+
+std::string FlatLayout::View(const tTable& aTable) const {
+    std::string name = aTable.name + "View";
+    std::string code;
+    std::string verify = "return mtt::flat_fits(aSize, aTable, cSize)";
+
+    code = "class " + mOwner + "::" + name + " : public mtt::flat_view {\n"
+           "public:\n" +
+           CodeWriter::shift(Offsets(aTable), 4) +
+           "\n"
+           "    " + name + "(const uint8_t* aBase, size_t aTable = 0) : mtt::flat_view(aBase, aTable) {}\n";
+    for (auto & f : aTable.fields) {
+        std::string slot = "mTable + o_" + f.member;
+        std::string at   = "aTable + o_" + f.member;
+
+        code += "    " + ViewType(f) + " " + f.member + "() const {\n"
+                "        return ";
+        if (f.count != eCount::single) {
+            code += ViewType(f) + "(mBase, " + slot + ");\n";
+            if (f.kind == eKind::table) {
+                verify += " &&\n       mtt::flat_verify_tables<" + f.type + "View>(aBase, aSize, aTable, " + at + ")";
+            } else if (f.kind == eKind::string) {
+                verify += " &&\n       mtt::flat_verify_strings(aBase, aSize, " + at + ")";
+            } else {
+                verify += " &&\n       mtt::flat_verify_array(aBase, aSize, " + at + ", sizeof(" + Element(f) + "))";
+            }
+        } else if (f.kind == eKind::table) {
+            code += ViewType(f) + "(mBase, mtt::flat_get<uint32_t>(mBase + " + slot + "));\n";
+            verify += " &&\n       mtt::flat_verify_table<" + f.type + "View>(aBase, aSize, aTable, " + at + ")";
+        } else if (f.kind == eKind::string) {
+            code += "mtt::flat_string(mBase, " + slot + ");\n";
+            verify += " &&\n       mtt::flat_verify_string(aBase, aSize, " + at + ")";
+        } else {
+            code += "mtt::flat_get<" + Type(f) + ">(mBase + " + slot + ");\n";
+        }
+        code += "    }\n";
+    }
+    //
+    //  A table of scalars only does not look at the bytes.
+    std::string base = (verify.find("aBase") == std::string::npos) ? "" : " aBase";
+
+    code += "    //\n"
+            "    //  Checks that the table and all the data it refers to are inside the\n"
+            "    //  received bytes.\n"
+            "    static bool verify(const uint8_t*" + base + ", size_t aSize, size_t aTable = 0) {\n" +
+            CodeWriter::shift(verify + ";\n", 8) +
+            "    }\n"
+            "};\n";
+
+    return code;
+}
+//
+//  The setters write one field each. Structs return the builder of their
+//  table, which must be filled before the buffer is sent, as an unset table
+//  does not pass verify().
+std::string FlatLayout::Builder(const tTable& aTable) const {
+    std::string name = aTable.name + "Builder";
+    std::string view = aTable.name + "View";
+    std::string code;
+    std::string from;
+
+    code = "class " + mOwner + "::" + name + " {\n"
+           "public:\n"
+           "    static constexpr size_t cSize = " + view + "::cSize;\n"
+           "\n"
+           "    explicit " + name + "(mtt::flat_builder& aOut) : mOut(aOut), mTable(aOut.table(cSize)) {}\n"
+           "    " + name + "(mtt::flat_builder& aOut, size_t aTable) : mOut(aOut), mTable(aTable) {}\n";
+    for (auto & f : aTable.fields) {
+        std::string slot  = "mTable + " + view + "::o_" + f.member;
+        std::string value = "aValue." + f.member;
+
+        if ((f.kind == eKind::table) && (f.count == eCount::single)) {
+            code += "    " + f.type + "Builder " + f.member + "() {\n"
+                    "        return " + f.type + "Builder(mOut, mOut.table_at(" + slot + ", " + f.type + "View::cSize));\n"
+                    "    }\n";
+            from += f.member + "().from(" + value + ");\n";
+        } else if (f.kind == eKind::table) {
+            code += "    mtt::flat_tables<" + f.type + "Builder> " + f.member + "(size_t aCount) {\n"
+                    "        return mtt::flat_tables<" + f.type + "Builder>(mOut, mOut.tables(" + slot + ", aCount));\n"
+                    "    }\n";
+            from += "{\n"
+                    "    auto   tables = " + f.member + "(std::size(" + value + "));\n"
+                    "    size_t index  = 0;\n"
+                    "\n"
+                    "    for (const auto& e : " + value + ") {\n"
+                    "        tables[index++].from(e);\n"
+                    "    }\n"
+                    "}\n";
+        } else {
+            if (f.count != eCount::single) {
+                code += "    template <typename C>\n"
+                        "    " + name + "& " + f.member + "(const C& aValue) {\n"
+                        "        mOut." + ((f.kind == eKind::string) ? "strings" : "array") + "(" + slot + ", aValue);\n";
+            } else if (f.kind == eKind::string) {
+                code += "    " + name + "& " + f.member + "(std::string_view aValue) {\n"
+                        "        mOut.string(" + slot + ", aValue);\n";
+            } else {
+                code += "    " + name + "& " + f.member + "(const " + Type(f) + "& aValue) {\n"
+                        "        mOut.set(" + slot + ", aValue);\n";
+            }
+            code += "        return *this;\n"
+                    "    }\n";
+            from += f.member + "(" + value + ");\n";
+        }
+    }
+    code += "    " + name + "& from(const " + aTable.type + "& aValue) {\n" +
+            CodeWriter::shift(from + "return *this;\n", 8) +
+            "    }\n"
+            "private:\n"
+            "    mtt::flat_builder& mOut;\n"
+            "    size_t             mTable;\n"
+            "};\n";
+
+    return code;
+}
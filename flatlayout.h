@@ -0,0 +1,93 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef FLATLAYOUT_H
+#define FLATLAYOUT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <set>
+
+class CModel;
+class MElement;
+class CAttribute;
+class CAssociationEnd;
+
+//
+//  Flat layout of the messages and signals tagged with Layout=flat. A table
+//  holds the scalars inline at aligned offsets. Strings and arrays are stored
+//  behind the tables and referenced by offset and count. Structs are tables
+//  of their own. The generated View reads the fields in place from the
+//  received bytes and the Builder writes them into a caller buffer. The
+//  runtime is mttflat.h, which is generated once per output directory.
+class FlatLayout {
+public:
+    explicit FlatLayout(const std::string& aOwner) : mOwner(aOwner) {
+        mRoot.type = aOwner;
+    }
+    static std::string Name(void) { return "mttflat.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+
+    void Member(std::shared_ptr<CAttribute> a);
+    void Member(std::shared_ptr<CAssociationEnd> a);
+    //
+    //  The declaration goes into the class, the definition after it.
+    std::string Declaration(int aIndent) const;
+    std::string Definition(void) const;
+private:
+    enum class eKind {
+        scalar,
+        string,
+        table       //  Structs
+    };
+    enum class eCount {
+        single,
+        vector,
+        array
+    };
+    struct tField {
+        std::string         owner;     //  The C++ type the field is a member of.
+        std::string         member;
+        std::string         type;      //  The struct name of tables.
+        eKind               kind  = eKind::scalar;
+        eCount              count = eCount::single;
+    };
+    struct tTable {
+        std::string         name;      //  Empty for the message itself.
+        std::string         type;      //  The C++ type the fields are taken from.
+        std::vector<tField> fields;
+    };
+    static bool Field(tField& aField, std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aMultiplicity);
+    void Add(std::vector<tField>& aFields, tField& aField, const std::string& aOwner, const std::string& aMember, std::shared_ptr<MElement> aClassifier);
+    void Table(const std::string& aType, std::shared_ptr<MElement> aStruct);
+    static std::string Type(const tField& aField);
+    static std::string Element(const tField& aField);
+    static std::string ViewType(const tField& aField);
+    static std::string Offsets(const tTable& aTable);
+    std::string View(const tTable& aTable) const;
+    std::string Builder(const tTable& aTable) const;
+private:
+    std::string           mOwner;
+    tTable                mRoot;
+    std::vector<tTable>   mTables;    //  The struct tables, each after the tables it uses.
+    std::set<std::string> mNames;
+};
+
+#endif // FLATLAYOUT_H
@@ -0,0 +1,169 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <algorithm>
+#include <cctype>
+
+#include "main.h"
+#include "codewriter.h"
+#include "mattribute.h"
+#include "cattribute.h"
+#include "massociationend.h"
+#include "cassociationend.h"
+#include "cclassbase.h"
+#include "cenumeration.h"
+#include "jsondecoder.h"
+
+void JsonDecoder::Key(const std::string& aKey, const std::string& aCode) {
+    Add(mKeys, aKey, aCode);
+}
+
+void JsonDecoder::Member(std::shared_ptr<CAttribute> a, const std::string& aPrefix) {
+    Member(mKeys, a, aPrefix, 0);
+}
+
+void JsonDecoder::Member(std::shared_ptr<CAssociationEnd> a, const std::string& aPrefix) {
+    Member(mKeys, a, aPrefix, 0);
+}
+
+std::string JsonDecoder::Object(int aIndent) const {
+    return CodeWriter::shift(Object(mKeys, 0), aIndent);
+}
+
+void JsonDecoder::Add(tKeys& aKeys, const std::string& aKey, const std::string& aCode) {
+    aKeys[aKey.size()].emplace_back(aKey, aCode);
+}
+
+void JsonDecoder::Member(tKeys& aKeys, std::shared_ptr<CAttribute> a, const std::string& aPrefix, size_t aDepth) {
+    std::string expr = aPrefix + a->name;
+
+    if (a->FQN() == "__simobject__") {
+        //
+        //  A pointer to a sim object can not be restored from its id here.
+        if (a->Aggregation != aShared) {
+            Add(aKeys, a->name, "aReader.value(" + expr + ");\n");
+        }
+    } else if (a->Multiplicity.empty() || (a->Multiplicity == "1")) {
+        Add(aKeys, a->name, Value(a->Classifier, expr, aDepth));
+    } else if ((a->Multiplicity != "0..1") && a->QualifierType.empty()) {
+        Add(aKeys, a->name, Sequence(a->Classifier, expr, a->Multiplicity, aDepth));
+    }
+}
+
+void JsonDecoder::Member(tKeys& aKeys, std::shared_ptr<CAssociationEnd> a, const std::string& aPrefix, size_t aDepth) {
+    std::string expr = aPrefix + a->name;
+
+    if (a->Multiplicity.empty() || (a->Multiplicity == "1")) {
+        Add(aKeys, a->name, Value(a->Classifier, expr, aDepth));
+    } else if ((a->Multiplicity != "0..1") && a->QualifierType.empty() && !a->HasContainerPolicy()) {
+        Add(aKeys, a->name, Sequence(a->Classifier, expr, a->Multiplicity, aDepth));
+    }
+}
+
+std::string JsonDecoder::Value(std::shared_ptr<MElement> aClassifier, const std::string& aExpr, size_t aDepth) {
+    if (aClassifier && ((aClassifier->type == eElementType::Struct) || (aClassifier->type == eElementType::SimStruct) ||
+                        (aClassifier->type == eElementType::CxxClass))) {
+        auto  s = std::dynamic_pointer_cast<CClassBase>(aClassifier);
+        tKeys keys;
+
+        if (s) {
+            for (auto & ai : s->GetAttributes()) {
+                Member(keys, std::dynamic_pointer_cast<CAttribute>(ai), aExpr + ".", aDepth + 1);
+            }
+            for (auto & ae : s->OtherEnd) {
+                auto a = std::dynamic_pointer_cast<CAssociationEnd>(*ae);
+
+                if (a->isNavigable()) {
+                    Member(keys, a, aExpr + ".", aDepth + 1);
+                }
+            }
+        }
+        return Object(keys, aDepth + 1);
+    } else if (aClassifier && (aClassifier->type == eElementType::Enumeration) &&
+               (std::dynamic_pointer_cast<CEnumeration>(aClassifier)->HasStringTable())) {
+        return "aReader.value(" + aExpr + ", " + std::dynamic_pointer_cast<CEnumeration>(aClassifier)->StringFunction("FromString") + ");\n";
+    }
+    return "aReader.value(" + aExpr + ");\n";
+}
+
+std::string JsonDecoder::Sequence(std::shared_ptr<MElement> aClassifier, const std::string& aExpr, const std::string& aMultiplicity, size_t aDepth) {
+    std::string element = "e" + std::to_string(aDepth);
+    std::string index   = "n" + std::to_string(aDepth);
+    std::string code;
+    //
+    //  A number as multiplicity is a plain array. Elements that do not fit
+    //  are skipped.
+    if (std::all_of(aMultiplicity.begin(), aMultiplicity.end(), ::isdigit)) {
+        code = "if (aReader.open('[')) {\n"
+               "    size_t " + index + " = 0;\n"
+               "\n"
+               "    while (aReader.more(']')) {\n"
+               "        if (" + index + " < std::size(" + aExpr + ")) {\n"
+               "            auto& " + element + " = " + aExpr + "[" + index + "++];\n"
+               "\n" +
+               CodeWriter::shift(Value(aClassifier, element, aDepth + 1), 12) +
+               "        } else {\n"
+               "            aReader.skip();\n"
+               "        }\n"
+               "    }\n"
+               "}\n";
+    } else {
+        code = aExpr + ".clear();\n"
+               "if (aReader.open('[')) {\n"
+               "    while (aReader.more(']')) {\n"
+               "        auto& " + element + " = " + aExpr + ".emplace_back();\n"
+               "\n" +
+               CodeWriter::shift(Value(aClassifier, element, aDepth + 1), 8) +
+               "    }\n"
+               "}\n";
+    }
+    return code;
+}
+
+std::string JsonDecoder::Object(const tKeys& aKeys, size_t aDepth) {
+    std::string key = (aDepth == 0) ? std::string("key") : "key" + std::to_string(aDepth);
+    std::string code;
+
+    if (aKeys.empty()) {
+        return "aReader.skip();\n";
+    }
+    code = "if (aReader.open('{')) {\n"
+           "    std::string_view " + key + ";\n"
+           "\n"
+           "    while (aReader.key(" + key + ")) {\n"
+           "        switch (" + key + ".size()) {\n";
+    for (auto & length : aKeys) {
+        code += "        case " + std::to_string(length.first) + ":\n";
+        for (auto & k : length.second) {
+            code += "            if (" + key + " == \"" + k.first + "\") {\n" +
+                    CodeWriter::shift(k.second, 16) +
+                    "                continue;\n"
+                    "            }\n";
+        }
+        code += "            break;\n";
+    }
+    code += "        default:\n"
+            "            break;\n"
+            "        }\n"
+            "        aReader.skip();\n"
+            "    }\n"
+            "}\n";
+
+    return code;
+}
@@ -0,0 +1,62 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef JSONDECODER_H
+#define JSONDECODER_H
+
+#include <string>
+#include <memory>
+#include <map>
+#include <vector>
+
+class MElement;
+class CAttribute;
+class CAssociationEnd;
+
+//
+//  Generates the single pass JSON decoders of message and signal classes.
+//  The keys of an object are dispatched by a switch over their length and
+//  then compared in full. The values are read by the mtt::json_reader
+//  straight into the members. Keys without a member are skipped.
+class JsonDecoder {
+public:
+    //
+    //  A key that is read by the given code instead of a member.
+    void Key(const std::string& aKey, const std::string& aCode);
+    void Member(std::shared_ptr<CAttribute> a, const std::string& aPrefix);
+    void Member(std::shared_ptr<CAssociationEnd> a, const std::string& aPrefix);
+    //
+    //  The code that reads the object. It is indented by aIndent.
+    std::string Object(int aIndent) const;
+private:
+    //
+    //  The keys of an object sorted by their length.
+    using tKeys = std::map<size_t, std::vector<std::pair<std::string, std::string>>>;
+
+    static std::string Value(std::shared_ptr<MElement> aClassifier, const std::string& aExpr, size_t aDepth);
+    static std::string Sequence(std::shared_ptr<MElement> aClassifier, const std::string& aExpr, const std::string& aMultiplicity, size_t aDepth);
+    static std::string Object(const tKeys& aKeys, size_t aDepth);
+    static void Add(tKeys& aKeys, const std::string& aKey, const std::string& aCode);
+    static void Member(tKeys& aKeys, std::shared_ptr<CAttribute> a, const std::string& aPrefix, size_t aDepth);
+    static void Member(tKeys& aKeys, std::shared_ptr<CAssociationEnd> a, const std::string& aPrefix, size_t aDepth);
+private:
+    tKeys mKeys;
+};
+
+#endif // JSONDECODER_H
@@ -0,0 +1,262 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <algorithm>
+#include <cctype>
+
+#include "main.h"
+#include "codewriter.h"
+#include "mattribute.h"
+#include "cattribute.h"
+#include "massociationend.h"
+#include "cassociationend.h"
+#include "cclassbase.h"
+#include "cenumeration.h"
+#include "jsonencoder.h"
+
+//
+//  The longest text of a bool value.
+static constexpr size_t cBoolBound = 5;
+//
+//  The value of mtt::json_number_bound.
+static constexpr size_t cNumberBound = 32;
+
+void JsonEncoder::Literal(const std::string& aJson) {
+    mLiteral += aJson;
+}
+
+void JsonEncoder::Write(const std::string& aCall, const std::string& aBound) {
+    Flush();
+    mPack << Indent(mBlocks.size()) << "aOut = " << aCall << ";\n";
+    if (std::all_of(aBound.begin(), aBound.end(), ::isdigit)) {
+        mLevels.back().fixed += std::stoul(aBound);
+    } else if (aBound == "mtt::json_number_bound") {
+        mLevels.back().numbers++;
+    } else {
+        mSize += Indent(mLevels.size() - 1) + "size += " + aBound + ";\n";
+        mLevels.back().dynamic = true;
+    }
+}
+
+void JsonEncoder::Code(const std::string& aLine) {
+    Flush();
+    mPack << Indent(mBlocks.size()) << aLine << "\n";
+}
+
+void JsonEncoder::Begin(const std::string& aHead, bool aSize, const std::string& aCount) {
+    Flush();
+    mPack << Indent(mBlocks.size()) << aHead << "\n";
+    if (aSize) {
+        tLevel level;
+
+        level.mark  = mSize.size();
+        level.count = aCount;
+        mSize += Indent(mLevels.size() - 1) + aHead + "\n";
+        mLevels.push_back(level);
+    }
+    mBlocks.push_back(aSize);
+}
+
+void JsonEncoder::Else(void) {
+    Flush();
+    mPack << Indent(mBlocks.size() - 1) << "} else {\n";
+}
+
+void JsonEncoder::End(void) {
+    Flush();
+    mPack << Indent(mBlocks.size() - 1) << "}\n";
+    if (mBlocks.back()) {
+        tLevel level = mLevels.back();
+
+        mLevels.pop_back();
+        if (level.dynamic || level.count.empty()) {
+            if ((level.fixed > 0) || (level.numbers > 0)) {
+                mSize += Indent(mLevels.size()) + "size += " + Bound(level.fixed, level.numbers) + ";\n";
+            }
+            mSize += Indent(mLevels.size() - 1) + "}\n";
+        } else {
+            mSize.resize(level.mark);
+            mSize += Indent(mLevels.size() - 1) + "size += std::size(" + level.count + ") * (" + Bound(level.fixed, level.numbers) + ");\n";
+        }
+        mLevels.back().dynamic = true;
+    }
+    mBlocks.pop_back();
+}
+
+void JsonEncoder::Flush(void) {
+    if (!mLiteral.empty()) {
+        std::string text;
+
+        for (auto c : mLiteral) {
+            if ((c == '"') || (c == '\\')) {
+                text.push_back('\\');
+            }
+            text.push_back(c);
+        }
+        mPack << Indent(mBlocks.size()) << "aOut = mtt::json_put(aOut, \"" << text << "\");\n";
+        mLevels.back().fixed += mLiteral.size();
+        mLiteral.clear();
+    }
+}
+
+std::string JsonEncoder::Indent(size_t aDepth) const {
+    return CodeWriter::spaces(mIndent + 4 * aDepth);
+}
+
+std::string JsonEncoder::Bound(size_t aFixed, size_t aNumbers) const {
+    std::string bound;
+
+    if ((aFixed > 0) || (aNumbers == 0)) {
+        bound = std::to_string(aFixed);
+    }
+    if (aNumbers > 0) {
+        if (!bound.empty()) {
+            bound += " + ";
+        }
+        if (aNumbers > 1) {
+            bound += std::to_string(aNumbers) + " * ";
+        }
+        bound += "mtt::json_number_bound";
+    }
+    return bound;
+}
+
+void JsonEncoder::Key(const std::string& aName, bool aFirst) {
+    if (!aFirst) {
+        Literal(",");
+    }
+    Literal("\"" + aName + "\":");
+}
+
+void JsonEncoder::Member(std::shared_ptr<CAttribute> a, const std::string& aPrefix, bool aFirst) {
+    std::string type = a->ClassifierName;
+    std::string expr = aPrefix + a->name;
+
+    Key(a->name, aFirst);
+    if (a->FQN() == "__simobject__") {
+        if (a->Aggregation == aShared) {
+            Write("mtt::json_value(aOut, (int64_t)((" + expr + " != nullptr) ? " + expr + "->objid : 0))", "mtt::json_number_bound");
+        } else {
+            Write("mtt::json_value(aOut, (int64_t)(" + expr + "))", "mtt::json_number_bound");
+        }
+    } else if (a->Multiplicity.empty() || (a->Multiplicity == "1")) {
+        Value(a->Classifier, type, expr);
+    } else if (a->Multiplicity == "0..1") {
+        Optional(a->Classifier, type, expr);
+    } else if (!a->QualifierType.empty()) {
+        Sequence(a->Classifier, type, expr, "", ".second");
+    } else {
+        Sequence(a->Classifier, type, expr, "", "");
+    }
+}
+
+void JsonEncoder::Member(std::shared_ptr<CAssociationEnd> a, const std::string& aPrefix, bool aFirst) {
+    std::string type = (a->Classifier) ? a->Classifier->name : std::string();
+    std::string expr = aPrefix + a->name;
+
+    Key(a->name, aFirst);
+    if (a->Multiplicity.empty() || (a->Multiplicity == "1")) {
+        Value(a->Classifier, type, expr);
+    } else if (a->Multiplicity == "0..1") {
+        Optional(a->Classifier, type, expr);
+    } else if (a->HasContainerPolicy()) {
+        //
+        //  With a container policy the element type is hidden behind mtt::value.
+        Sequence(a->Classifier, type, expr, "mtt::value(", ")");
+    } else if (!a->QualifierType.empty()) {
+        Sequence(a->Classifier, type, expr, "", ".second");
+    } else {
+        Sequence(a->Classifier, type, expr, "", "");
+    }
+}
+
+void JsonEncoder::Struct(std::shared_ptr<MElement> aStruct, const std::string& aPrefix) {
+    auto s     = std::dynamic_pointer_cast<CClassBase>(aStruct);
+    bool first = true;
+
+    Literal("{");
+    if (s) {
+        for (auto & ai : s->GetAttributes()) {
+            Member(std::dynamic_pointer_cast<CAttribute>(ai), aPrefix, first);
+            first = false;
+        }
+        for (auto & ae : s->OtherEnd) {
+            auto a = std::dynamic_pointer_cast<CAssociationEnd>(*ae);
+
+            if (a->isNavigable()) {
+                Member(a, aPrefix, first);
+                first = false;
+            }
+        }
+    }
+    Literal("}");
+}
+
+void JsonEncoder::Value(std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aExpr) {
+    if (aClassifier && ((aClassifier->type == eElementType::Struct) || (aClassifier->type == eElementType::SimStruct) ||
+                        (aClassifier->type == eElementType::CxxClass))) {
+        Struct(aClassifier, aExpr + ".");
+    } else if (aClassifier && (aClassifier->type == eElementType::Enumeration) &&
+               (std::dynamic_pointer_cast<CEnumeration>(aClassifier)->HasStringTable())) {
+        auto e = std::dynamic_pointer_cast<CEnumeration>(aClassifier);
+
+        Write("mtt::json_name(aOut, " + e->StringFunction("ToString") + "(" + aExpr + "), " + aExpr + ")",
+              (e->NameBound() > cNumberBound) ? std::to_string(e->NameBound()) : std::string("mtt::json_number_bound"));
+    } else if ((aType == "string") || (aType == "std::string")) {
+        Write("mtt::json_value(aOut, " + aExpr + ")", "mtt::json_bound(" + aExpr + ")");
+    } else if (aType == "bool") {
+        Write("mtt::json_value(aOut, " + aExpr + ")", std::to_string(cBoolBound));
+    } else if ((aType == "uint64_t") || (aType == "objectid_t")) {
+        //
+        //  The decoders read ids as signed values.
+        Write("mtt::json_value(aOut, (int64_t)(" + aExpr + "))", "mtt::json_number_bound");
+    } else {
+        Write("mtt::json_value(aOut, " + aExpr + ")", "mtt::json_number_bound");
+    }
+}
+
+void JsonEncoder::Optional(std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aExpr) {
+    Begin("if (" + aExpr + " != nullptr) {", false);
+    Value(aClassifier, aType, "(*" + aExpr + ")");
+    Else();
+    Literal("null");
+    End();
+}
+
+void JsonEncoder::Sequence(std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aExpr, const std::string& aOpen, const std::string& aClose) {
+    std::string runner(1, (char)('a' + mBlocks.size()));
+
+    Literal("[");
+    Begin("for (const auto& " + runner + " : " + aExpr + ") {", true, aExpr);
+    Value(aClassifier, aType, aOpen + runner + aClose);
+    Literal(",");
+    End();
+    Write("mtt::json_close(aOut, ']')", "1");
+}
+
+std::string JsonEncoder::Pack(void) {
+    Flush();
+    return mPack.str();
+}
+
+std::string JsonEncoder::Size(void) {
+    Flush();
+    return Indent(0) + "size_t size = " + Bound(mLevels.front().fixed, mLevels.front().numbers) + ";\n" +
+           mSize + "\n" + Indent(0) + "return size;\n";
+}
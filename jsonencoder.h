@@ -0,0 +1,94 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef JSONENCODER_H
+#define JSONENCODER_H
+
+#include <string>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+class MElement;
+class CAttribute;
+class CAssociationEnd;
+
+//
+//  Generates the code of the JSON buffer encoders of message and signal
+//  classes. Two bodies are written side by side. The pack body writes the JSON
+//  text into a caller provided buffer through the pointer aOut. The size body
+//  sums up the upper bound of that text, so the caller can size the buffer
+//  in advance. Literal text that follows each other is merged into a single
+//  copy at generation time.
+class JsonEncoder {
+public:
+    explicit JsonEncoder(int aIndent) : mIndent(aIndent) {}
+    //
+    //  Raw JSON text. It is escaped for the C++ string literal when written.
+    void Literal(const std::string& aJson);
+    //
+    //  A call that writes a value and returns the new end of the buffer. The
+    //  bound is either a number or an expression of the size body.
+    void Write(const std::string& aCall, const std::string& aBound);
+    void Code(const std::string& aLine);
+    //
+    //  Blocks of the pack body. With aSize the block is repeated in the size
+    //  body. This is needed for loops, but not for conditions, as the bound
+    //  may count both branches.
+    //  A loop over a container passes it as aCount. If the bound of its
+    //  elements does not depend on their values, the loop is replaced in the
+    //  size body by a multiplication.
+    void Begin(const std::string& aHead, bool aSize, const std::string& aCount = std::string());
+    void Else(void);
+    void End(void);
+
+    void Member(std::shared_ptr<CAttribute> a, const std::string& aPrefix, bool aFirst);
+    void Member(std::shared_ptr<CAssociationEnd> a, const std::string& aPrefix, bool aFirst);
+    void Struct(std::shared_ptr<MElement> aStruct, const std::string& aPrefix);
+
+    std::string Pack(void);
+    std::string Size(void);
+private:
+    void Flush(void);
+    void Key(const std::string& aName, bool aFirst);
+    void Value(std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aExpr);
+    void Optional(std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aExpr);
+    void Sequence(std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aExpr, const std::string& aOpen, const std::string& aClose);
+    std::string Indent(size_t aDepth) const;
+    std::string Bound(size_t aFixed, size_t aNumbers) const;
+private:
+    //
+    //  The bound of a block of the size body. Fixed sizes and numbers are
+    //  summed up and written at the end of the block.
+    struct tLevel {
+        size_t      fixed   = 0;
+        size_t      numbers = 0;
+        bool        dynamic = false;
+        size_t      mark    = 0;
+        std::string count;
+    };
+    int                 mIndent;
+    std::string         mLiteral;
+    std::ostringstream  mPack;
+    std::string         mSize;
+    std::vector<tLevel> mLevels = std::vector<tLevel>(1);
+    std::vector<bool>   mBlocks;
+};
+
+#endif // JSONENCODER_H
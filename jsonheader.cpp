@@ -0,0 +1,512 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <set>
+
+#include "main.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "jsonheader.h"
+
+//
+//  The encoders write into a buffer that the caller sized with json_size(), so
+//  none of these functions checks for the end of the buffer. The bounds below
+//  are the longest text a single value can produce. The reader of the decoders
+//  on the other side checks every step against the end of the text.
+static const char* cJsonRuntime = R"RUNTIME(#pragma once
+#ifndef MTTJSON_INC
+#define MTTJSON_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <iterator>
+#include <type_traits>
+
+namespace mtt {
+//
+//  Longest text of a number. A double in shortest form needs 24 characters,
+//  a 64 bit integer 20.
+constexpr size_t json_number_bound = 32;
+//
+//  Every character of a string may become a \u00XX sequence. The quotes are
+//  added.
+inline size_t json_bound(const std::string& aValue) {
+    return 2 + 6 * aValue.size();
+}
+
+template <size_t N>
+inline char* json_put(char* aOut, const char (&aText)[N]) {
+    std::memcpy(aOut, aText, N - 1);
+    return aOut + N - 1;
+}
+
+inline char* json_value(char* aOut, bool aValue) {
+    return (aValue) ? json_put(aOut, "true") : json_put(aOut, "false");
+}
+
+template <typename T>
+inline char* json_value(char* aOut, T aValue) {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "json_value needs a number");
+
+    if constexpr (std::is_enum<T>::value) {
+        return json_value(aOut, static_cast<int64_t>(aValue));
+    } else if constexpr (std::is_integral<T>::value) {
+        return std::to_chars(aOut, aOut + json_number_bound, aValue).ptr;
+    } else {
+#if defined(__cpp_lib_to_chars)
+        return std::to_chars(aOut, aOut + json_number_bound, aValue).ptr;
+#else
+        return aOut + std::snprintf(aOut, json_number_bound, "%.17g", static_cast<double>(aValue));
+#endif
+    }
+}
+//
+//  Most strings need no escaping at all. They are found with a single scan and
+//  copied in one piece. Otherwise the clean head is copied and the rest is
+//  escaped character by character.
+inline bool json_plain(char aChar) {
+    return (static_cast<unsigned char>(aChar) >= 0x20) && (aChar != '"') && (aChar != '\\');
+}
+
+inline char* json_value(char* aOut, const std::string& aValue) {
+    static const char cHex[] = "0123456789abcdef";
+    const char*       text   = aValue.data();
+    const char*       end    = text + aValue.size();
+    const char*       clean  = text;
+
+    *aOut++ = '"';
+    while ((clean != end) && (json_plain(*clean))) {
+        ++clean;
+    }
+    std::memcpy(aOut, text, clean - text);
+    aOut += clean - text;
+    for (const char* c = clean; c != end; ++c) {
+        if (json_plain(*c)) {
+            *aOut++ = *c;
+        } else {
+            *aOut++ = '\\';
+            switch (*c) {
+            case '"':
+            case '\\':
+                *aOut++ = *c;
+                break;
+            case '\n':
+                *aOut++ = 'n';
+                break;
+            case '\r':
+                *aOut++ = 'r';
+                break;
+            case '\t':
+                *aOut++ = 't';
+                break;
+            case '\b':
+                *aOut++ = 'b';
+                break;
+            case '\f':
+                *aOut++ = 'f';
+                break;
+            default:
+                aOut = json_put(aOut, "u00");
+                *aOut++ = cHex[(static_cast<unsigned char>(*c) >> 4) & 0xf];
+                *aOut++ = cHex[static_cast<unsigned char>(*c) & 0xf];
+                break;
+            }
+        }
+    }
+    *aOut++ = '"';
+
+    return aOut;
+}
+//
+//  Enumerations are written by the name of the literal. The names need no
+//  escaping. A value without a name is written as number.
+template <typename T>
+inline char* json_name(char* aOut, std::string_view aName, T aValue) {
+    if (aName.empty()) {
+        return json_value(aOut, aValue);
+    }
+    *aOut++ = '"';
+    std::memcpy(aOut, aName.data(), aName.size());
+    aOut += aName.size();
+    *aOut++ = '"';
+
+    return aOut;
+}
+//
+//  The array and object elements are written with a trailing comma. The
+//  closing bracket replaces the last one.
+inline char* json_close(char* aOut, char aBracket) {
+    if (aOut[-1] == ',') {
+        aOut[-1] = aBracket;
+        return aOut;
+    }
+    *aOut++ = aBracket;
+
+    return aOut;
+}
+//
+//  The decoders read the JSON text in a single pass. The reader does not build
+//  a tree. It hands out the keys of an object one by one and the generated
+//  code either reads the value into the member or skips it. Any syntax error
+//  stops the reading and is reported by good().
+class json_reader {
+public:
+    json_reader(const char* aText, size_t aSize) : mPos(aText), mEnd(aText + aSize) {}
+    explicit json_reader(std::string_view aText) : json_reader(aText.data(), aText.size()) {}
+
+    bool good() const { return mGood; }
+    //
+    //  Consumes the opening bracket of an object or array.
+    bool open(char aBracket) {
+        space();
+        if ((mPos != mEnd) && (*mPos == aBracket)) {
+            ++mPos;
+            return true;
+        }
+        return fail();
+    }
+    //
+    //  Reads the next key of the current object including the colon. At the
+    //  end of the object the closing bracket is consumed and false returned.
+    bool key(std::string_view& aKey) {
+        if (!more('}')) {
+            return false;
+        }
+        if ((mPos == mEnd) || (*mPos != '"')) {
+            return fail();
+        }
+        const char* start = ++mPos;
+
+        while ((mPos < mEnd) && (*mPos != '"')) {
+            mPos += (*mPos == '\\') ? 2 : 1;
+        }
+        if (mPos >= mEnd) {
+            return fail();
+        }
+        aKey = std::string_view(start, mPos - start);
+        ++mPos;
+        space();
+        if ((mPos == mEnd) || (*mPos != ':')) {
+            return fail();
+        }
+        ++mPos;
+
+        return true;
+    }
+    //
+    //  Steps to the next element of the current object or array. At the end
+    //  the closing bracket is consumed and false returned.
+    bool more(char aBracket) {
+        space();
+        if (mPos == mEnd) {
+            return fail();
+        }
+        if (*mPos == aBracket) {
+            ++mPos;
+            return false;
+        }
+        if (*mPos == ',') {
+            ++mPos;
+            space();
+        }
+        return mGood;
+    }
+
+    void value(bool& aValue) {
+        space();
+        if (match("true")) {
+            aValue = true;
+        } else if (match("false")) {
+            aValue = false;
+        } else {
+            fail();
+        }
+    }
+    //
+    //  Numbers may be quoted. Ids are written as signed values, so an
+    //  unsigned member takes the bits of a negative number.
+    template <typename T>
+    void value(T& aValue) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "json_reader::value needs a number");
+
+        space();
+        bool quoted = ((mPos != mEnd) && (*mPos == '"'));
+
+        if (quoted) {
+            ++mPos;
+        }
+        if constexpr (std::is_enum<T>::value) {
+            int64_t value = 0;
+
+            number(value);
+            aValue = static_cast<T>(value);
+        } else if constexpr (std::is_integral<T>::value && std::is_unsigned<T>::value) {
+            if ((mPos != mEnd) && (*mPos == '-')) {
+                int64_t value = 0;
+
+                number(value);
+                aValue = static_cast<T>(value);
+            } else {
+                number(aValue);
+            }
+        } else {
+            number(aValue);
+        }
+        if (quoted && ((mPos == mEnd) || (*mPos++ != '"'))) {
+            fail();
+        }
+    }
+    //
+    //  An enumeration is read from the name of its literal. Numbers, quoted or
+    //  not, are still taken.
+    template <typename T, typename F>
+    void value(T& aValue, F aFromString) {
+        space();
+        if ((mPos == mEnd) || (*mPos != '"')) {
+            value(aValue);
+            return;
+        }
+        const char* start = mPos + 1;
+        const char* end   = static_cast<const char*>(std::memchr(start, '"', mEnd - start));
+
+        if ((end != nullptr) && aFromString(std::string_view(start, end - start), aValue)) {
+            mPos = end + 1;
+        } else {
+            value(aValue);
+        }
+    }
+    //
+    //  Strings without escapes are assigned in one piece.
+    void value(std::string& aValue) {
+        space();
+        if ((mPos == mEnd) || (*mPos != '"')) {
+            fail();
+            return;
+        }
+        const char* start = ++mPos;
+
+        while ((mPos != mEnd) && (*mPos != '"') && (*mPos != '\\')) {
+            ++mPos;
+        }
+        aValue.assign(start, mPos - start);
+        while ((mPos != mEnd) && (*mPos == '\\')) {
+            if (++mPos == mEnd) {
+                break;
+            }
+            switch (*mPos++) {
+            case 'n':
+                aValue.push_back('\n');
+                break;
+            case 'r':
+                aValue.push_back('\r');
+                break;
+            case 't':
+                aValue.push_back('\t');
+                break;
+            case 'b':
+                aValue.push_back('\b');
+                break;
+            case 'f':
+                aValue.push_back('\f');
+                break;
+            case 'u':
+                unicode(aValue);
+                break;
+            default:
+                aValue.push_back(mPos[-1]);
+                break;
+            }
+            start = mPos;
+            while ((mPos != mEnd) && (*mPos != '"') && (*mPos != '\\')) {
+                ++mPos;
+            }
+            aValue.append(start, mPos - start);
+        }
+        if (mPos == mEnd) {
+            fail();
+            return;
+        }
+        ++mPos;
+    }
+    //
+    //  Skips a value of any type including nested objects and arrays.
+    void skip() {
+        size_t depth = 0;
+
+        space();
+        do {
+            if (mPos == mEnd) {
+                fail();
+                return;
+            }
+            switch (*mPos) {
+            case '{':
+            case '[':
+                ++depth;
+                ++mPos;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    fail();
+                    return;
+                }
+                --depth;
+                ++mPos;
+                break;
+            case '"':
+                for (++mPos; (mPos < mEnd) && (*mPos != '"'); ++mPos) {
+                    mPos += (*mPos == '\\');
+                }
+                if (mPos >= mEnd) {
+                    fail();
+                    return;
+                }
+                ++mPos;
+                break;
+            default:
+                //
+                //  Numbers and literals end at the next delimiter. Commas
+                //  and colons inside objects and arrays are stepped over.
+                ++mPos;
+                while ((mPos != mEnd) && (*mPos != ',') && (*mPos != ':') && (*mPos != '}') && (*mPos != ']') &&
+                       (*mPos != '"') && (*mPos != '{') && (*mPos != '[')) {
+                    ++mPos;
+                }
+                break;
+            }
+        } while ((depth > 0) && mGood);
+    }
+private:
+    void space() {
+        while ((mPos != mEnd) && ((*mPos == ' ') || (*mPos == '\t') || (*mPos == '\n') || (*mPos == '\r'))) {
+            ++mPos;
+        }
+    }
+    bool fail() {
+        mGood = false;
+        mPos  = mEnd;
+        return false;
+    }
+    template <size_t N>
+    bool match(const char (&aText)[N]) {
+        if ((size_t)(mEnd - mPos) >= N - 1) {
+            if (std::memcmp(mPos, aText, N - 1) == 0) {
+                mPos += N - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+    template <typename T>
+    void number(T& aValue) {
+        if constexpr (std::is_integral<T>::value) {
+            auto result = std::from_chars(mPos, mEnd, aValue);
+
+            if (result.ec != std::errc()) {
+                fail();
+                return;
+            }
+            mPos = result.ptr;
+        } else {
+#if defined(__cpp_lib_to_chars)
+            auto result = std::from_chars(mPos, mEnd, aValue);
+
+            if (result.ec != std::errc()) {
+                fail();
+                return;
+            }
+            mPos = result.ptr;
+#else
+            char  text[json_number_bound] = {};
+            char* end = nullptr;
+
+            std::memcpy(text, mPos, std::min<size_t>(mEnd - mPos, json_number_bound - 1));
+            aValue = static_cast<T>(std::strtod(text, &end));
+            if (end == text) {
+                fail();
+                return;
+            }
+            mPos += end - text;
+#endif
+        }
+    }
+    //
+    //  Writes the code point of a \uXXXX sequence as UTF-8. Surrogate pairs
+    //  are not combined.
+    void unicode(std::string& aValue) {
+        unsigned code = 0;
+
+        for (int i = 0; i < 4; ++i) {
+            char c = (mPos != mEnd) ? *mPos++ : 0;
+
+            code <<= 4;
+            if ((c >= '0') && (c <= '9')) {
+                code |= c - '0';
+            } else if ((c >= 'a') && (c <= 'f')) {
+                code |= c - 'a' + 10;
+            } else if ((c >= 'A') && (c <= 'F')) {
+                code |= c - 'A' + 10;
+            } else {
+                fail();
+                return;
+            }
+        }
+        if (code < 0x80) {
+            aValue.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            aValue.push_back(static_cast<char>(0xc0 | (code >> 6)));
+            aValue.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        } else {
+            aValue.push_back(static_cast<char>(0xe0 | (code >> 12)));
+            aValue.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            aValue.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+    }
+private:
+    const char* mPos;
+    const char* mEnd;
+    bool        mGood = true;
+};
+} // namespace mtt
+
+#endif  // MTTJSON_INC
+)RUNTIME";
+
+void JsonHeader::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "j-inc", header.buffer()});
+        header << cJsonRuntime;
+        header.close();
+    }
+}
@@ -0,0 +1,40 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef JSONHEADER_H
+#define JSONHEADER_H
+
+#include <string>
+#include <memory>
+
+class CModel;
+
+//
+//  The JSON header holds the runtime of the buffer encoders that are generated
+//  for message and signal classes tagged with JSON=buffer. It is generated once
+//  per output directory as mttjson.h.
+class JsonHeader {
+public:
+    static std::string Name(void) { return "mttjson.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+private:
+    JsonHeader() = default;
+};
+
+#endif // JSONHEADER_H
@@ -18,6 +18,8 @@
 // CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <iostream>
+#include <fstream>
+#include <iterator>
 #include <stdio.h>
 #include <limits.h>
 #include <set>
@@ -69,6 +71,7 @@ bool        gNameSpaceInCPP = true;
 bool        gUseSelfContainedHeaderInCPP = false;
 bool        gGenerateSelfContainedHeader = false;
 bool        gUseSelfContainedInModelHeader = false;
+bool        gPreferForwards = false;
 
 bool        gUsePragmaOnce = true;
 bool        gUseNameSpaceInGuards = true;
@@ -94,6 +97,14 @@ std::string gModelPath;
 std::string gDumpId;
 bool        gDumpStarted = true;
 std::set<std::string> gDumpList;
+std::set<std::string> gDumpElements;
+bool        gIncremental = true;
+std::string gGenerationSeed;
+std::string gIncludeReport;
+bool        gUseCMake = false;
+long        gUnityBatchSize = 0;
+long        gPchHeaders = 0;
+std::string gBuildProfile = "debug";
 std::string directory;
 std::string gPackageHeaderDir = "./";
 
@@ -127,6 +138,7 @@ static bool loadConfig(const std::string& aConfigFile) {
         if (docRoot) {
             loadModelConfiguration(docRoot);
             loadCxxGeneratorConfiguration(docRoot);
+            loadBuildConfiguration(docRoot);
             std::shared_ptr<MttXmlNode> modelConfig = docRoot->findChild("model");
             if (modelConfig) {
                 gModelPath = modelConfig->stringProperty("path");
@@ -146,6 +158,8 @@ int main(int argc, char** argv) {
     std::string application;
     std::string libpath;
     std::string configurationfile;
+    bool        forceall = false;
+    int         retval   = 0;
     //
     //  This is the only way on a linux system to get the real path to the application even if
     //  it gets started through various links.
@@ -207,6 +221,21 @@ int main(int argc, char** argv) {
                     }
                 }
                 break;
+            case 'e':       //  element to dump with all dependent elements
+                s++;
+                if (*s != 0) {
+                    gDumpElements.insert(s);
+                } else {
+                    i++;
+                    if (argv[i] != 0) {
+                        gDumpElements.insert(argv[i]);
+                    } else {
+                    }
+                }
+                break;
+            case 'f':       //  force the generation of all elements
+                forceall = true;
+                break;
             case 'v':
                 std::cerr << "mtt-cpp-" << MTT_CPP_VERSION << std::endl;
                 std::cerr << "Copyright by The Simulated-Universe. Hans-J�rgen Lange <hjl@simulated-universe.de>" << std::endl;
@@ -216,6 +245,8 @@ int main(int argc, char** argv) {
                 std::cerr << "usage:\n"
                              "\t-d : Set the directory where to start the output in.\n"
                              "\t-c : The name of an configuration file.\n"
+                             "\t-e : Id or FQN of an element to generate together with all elements depending on it. May be repeated.\n"
+                             "\t-f : Generate all elements, even if they did not change since the last run.\n"
                              "\t-v : Show the version information on startup.\n"
                              "\t-?\n"
                              "\t-h : Show this help\n";
@@ -234,6 +265,17 @@ int main(int argc, char** argv) {
             exit(-1);
         }
     }
+    if (forceall) {
+        gIncremental = false;
+    }
+    //
+    //  Everything besides the model that influences the output goes into the content hashes.
+    gGenerationSeed = std::string(MTT_CPP_VERSION) + ";" + std::to_string(simversion) + ";";
+    if (!configurationfile.empty()) {
+        std::ifstream config(configurationfile);
+
+        gGenerationSeed.append(std::istreambuf_iterator<char>(config), std::istreambuf_iterator<char>());
+    }
 #ifdef NDEBUG
     std::string wd = helper::getcwd();
     std::string lockpath = "./" + directory + ".lock";
@@ -281,6 +323,9 @@ int main(int argc, char** argv) {
 #endif
         loadedmodel->Prepare();
         loadedmodel->Dump();
+        if (loadedmodel->failed) {
+            retval = -1;
+        }
         loadedmodel = std::shared_ptr<CModel>();
         MAction::Instances.clear();
         MActionNode::Instances.clear();
@@ -324,5 +369,5 @@ int main(int argc, char** argv) {
     //std::cerr << "WD: " << helper::getcwd() << std::endl;
     helper::rmdir(lockpath);
 #endif
-    return (0);
+    return (retval);
 }
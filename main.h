@@ -28,6 +28,15 @@ extern std::string gModelPath;
 extern std::string gDumpId;
 extern bool        gDumpStarted;
 extern std::set<std::string> gDumpList;
+extern std::set<std::string> gDumpElements;    //  Ids or FQNs of the elements to dump together with their dependents.
+extern bool        gIncremental;       //  Skip the elements that did not change since the last run.
+extern std::string gGenerationSeed;    //  Generator version and configuration. Part of every content hash.
+extern std::string gIncludeReport;     //  Name of the include graph report in the output directory. Empty for no report.
+
+extern bool        gUseCMake;          //  Generate CMakeLists.txt instead of Makefiles for the build packages.
+extern long        gUnityBatchSize;    //  Number of sources per unity build batch. 0 for no unity build.
+extern long        gPchHeaders;        //  Number of most included headers to precompile. 0 for no precompiled header.
+extern std::string gBuildProfile;      //  Default build profile of the generated build files. debug, release, lto or pgo.
 
 extern std::string gPackageHeaderDir;
 
@@ -36,6 +45,7 @@ extern bool        gNameSpaceInCPP;
 extern bool        gUseSelfContainedHeaderInCPP;
 extern bool        gGenerateSelfContainedHeader;
 extern bool        gUseSelfContainedInModelHeader;
+extern bool        gPreferForwards;    //  Forward declare instead of include in self-contained headers where the usage allows it.
 
 extern bool        gUsePragmaOnce;
 extern bool        gUseNameSpaceInGuards;
@@ -30,6 +30,7 @@ std::map<std::string, std::shared_ptr<MClass>> MClass::Instances;
 std::map<std::string, std::shared_ptr<MClass>> MClass::mByFQN;
 std::map<std::string, std::shared_ptr<MClass>> MClass::mByReverseFQN;
 std::map<std::string, std::shared_ptr<MClass>> MClass::mByModelPath;
+size_t                                         MClass::mClassCount = 0;
 
 MClass::MClass(const std::string&aId, std::shared_ptr<MElement> aParent) : MElement(aId, aParent) {
     type=eElementType::Class;
@@ -59,7 +59,9 @@ public:
     static std::map<std::string, std::shared_ptr<MClass>> mByFQN;
     static std::map<std::string, std::shared_ptr<MClass>> mByReverseFQN;
     static std::map<std::string, std::shared_ptr<MClass>> mByModelPath;
+    static size_t                                         mClassCount;
 public:
+    size_t                   mOrdinal = mClassCount++;  //  Dense number of the class. Index into bitsets over classes.
     std::vector<MElementRef> mSubClass;
     std::vector<MElementRef> mSuperClass;
     bool                     mIsInterface = false;
@@ -0,0 +1,166 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <set>
+#include <algorithm>
+
+#include "main.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "perfecthash.h"
+
+//
+//  The lookup part of the perfect hash. It must compute the same slot as
+//  PerfectHash::Slot.
+static const char* cPerfectHashRuntime = R"RUNTIME(#pragma once
+#ifndef MTTPERFECTHASH_H
+#define MTTPERFECTHASH_H
+//
+//  Generated by mtt-cpp. Lookup of the perfect hashes the generator computed
+//  over the ids of a class.
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace mtt {
+//
+//  The key of a name. It is FNV-1a with the murmur3 finalizer, as the bucket is
+//  taken from the high bits.
+inline constexpr uint64_t phash_string(std::string_view aName) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (char c : aName) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+    }
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdull;
+    hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    return hash ^ (hash >> 33);
+}
+//
+//  The bucket is taken from the high bits of the id. The id mixed with the seed
+//  of its bucket gives the slot. A table of 2^n slots uses aShift = 64 - n.
+inline constexpr size_t phash_slot(uint64_t aKey, const uint16_t* aSeed, uint64_t aBucketMask, unsigned aShift) {
+    return static_cast<size_t>(((aKey ^ aSeed[(aKey >> 40) & aBucketMask]) * 0x9e3779b97f4a7c15ull) >> aShift);
+}
+} // namespace mtt
+
+#endif // MTTPERFECTHASH_H
+)RUNTIME";
+
+void PerfectHash::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "ph-inc", header.buffer()});
+        header << cPerfectHashRuntime;
+        header.close();
+    }
+}
+
+//
+//  Must compute the same key as mtt::phash_string.
+uint64_t PerfectHash::Hash(const std::string& aName) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (char c : aName) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+    }
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdull;
+    hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    return hash ^ (hash >> 33);
+}
+
+size_t PerfectHash::Slot(uint64_t aKey, uint16_t aSeed, unsigned aShift) {
+    return static_cast<size_t>(((aKey ^ aSeed) * 0x9e3779b97f4a7c15ull) >> aShift);
+}
+
+//
+//  Start with the smallest power of two that holds all keys. If a bucket finds
+//  no seed the table is doubled.
+bool PerfectHash::Build(const std::vector<uint64_t>& aKeys) {
+    unsigned bits = 1;
+
+    if (std::set<uint64_t>(aKeys.begin(), aKeys.end()).size() != aKeys.size()) {
+        return false;
+    }
+    while ((size_t(1) << bits) < aKeys.size()) {
+        ++bits;
+    }
+    for (; bits < 24; ++bits) {
+        if (Place(aKeys, bits)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+//  The buckets are placed largest first. Two keys per bucket on average keep
+//  the search for a seed short.
+bool PerfectHash::Place(const std::vector<uint64_t>& aKeys, unsigned aBits) {
+    size_t                           buckets = (aBits > 1) ? (size_t(1) << (aBits - 1)) : 1;
+    std::vector<std::vector<size_t>> bucket(buckets);
+    std::vector<size_t>              order;
+
+    mShift = 64 - aBits;
+    mSlot.assign(size_t(1) << aBits, npos);
+    mSeed.assign(buckets, 0);
+    for (size_t k = 0; k < aKeys.size(); ++k) {
+        bucket[(aKeys[k] >> 40) & (buckets - 1)].push_back(k);
+    }
+    for (size_t b = 0; b < buckets; ++b) {
+        if (!bucket[b].empty()) {
+            order.push_back(b);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&bucket](size_t a, size_t b) { return bucket[a].size() > bucket[b].size(); });
+    for (auto b : order) {
+        bool                placed = false;
+        std::vector<size_t> slots;
+
+        for (uint32_t seed = 0; (seed <= 0xffff) && (!placed); ++seed) {
+            slots.clear();
+            placed = true;
+            for (auto k : bucket[b]) {
+                size_t s = Slot(aKeys[k], static_cast<uint16_t>(seed), mShift);
+
+                if ((mSlot[s] != npos) || (std::find(slots.begin(), slots.end(), s) != slots.end())) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(s);
+            }
+            if (placed) {
+                mSeed[b] = static_cast<uint16_t>(seed);
+                for (size_t i = 0; i < slots.size(); ++i) {
+                    mSlot[slots[i]] = bucket[b][i];
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
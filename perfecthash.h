@@ -0,0 +1,61 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef PERFECTHASH_H
+#define PERFECTHASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+
+class CModel;
+
+//
+//  Minimal perfect hash over a set of 64 bit ids. The ids are crc64 values or
+//  the Hash of a name, so the bits are spread well. The keys are put into buckets by their high bits.
+//  Each bucket gets a seed that moves its keys into free slots. The lookup in
+//  the generated code is mtt::phash_slot from mttperfecthash.h, which is
+//  generated once per output directory.
+class PerfectHash {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+public:
+    static std::string Name(void) { return "mttperfecthash.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+    static size_t Slot(uint64_t aKey, uint16_t aSeed, unsigned aShift);
+    static uint64_t Hash(const std::string& aName);
+
+    bool Build(const std::vector<uint64_t>& aKeys);
+    //
+    //  The index of the key that is stored in the slot, npos if the slot is empty.
+    const std::vector<size_t>& Slots() const { return mSlot; }
+    const std::vector<uint16_t>& Seeds() const { return mSeed; }
+    uint64_t BucketMask() const { return mSeed.size() - 1; }
+    unsigned Shift() const { return mShift; }
+private:
+    bool Place(const std::vector<uint64_t>& aKeys, unsigned aBits);
+private:
+    std::vector<size_t>   mSlot;
+    std::vector<uint16_t> mSeed;
+    unsigned              mShift = 0;
+};
+
+#endif // PERFECTHASH_H
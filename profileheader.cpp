@@ -0,0 +1,207 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <set>
+
+#include "main.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "profileheader.h"
+
+//
+//  Each thread counts into its own table, so the handlers never share a cache
+//  line or take a lock. The counters are atomics with a single writer. They are
+//  bumped with relaxed load and store, which is a plain add, and can be read
+//  from the thread that dumps the statistics.
+static const char* cProfileRuntime = R"RUNTIME(#pragma once
+#ifndef MTTPROFILE_INC
+#define MTTPROFILE_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+
+namespace mtt {
+//
+//  The histogram buckets are powers of two of nanoseconds. The last one
+//  collects everything from 2^31 ns up.
+constexpr size_t profile_buckets = 32;
+
+struct profile_counter {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> nanos{0};
+    std::atomic<uint64_t> histogram[profile_buckets] = {};
+
+    static void bump(std::atomic<uint64_t>& aValue, uint64_t aAdd) {
+        aValue.store(aValue.load(std::memory_order_relaxed) + aAdd, std::memory_order_relaxed);
+    }
+    void add(uint64_t aNanos) {
+        size_t bucket = 0;
+
+        for (uint64_t n = aNanos; (n > 1) && (bucket < profile_buckets - 1); n >>= 1) {
+            ++bucket;
+        }
+        bump(count, 1);
+        bump(nanos, aNanos);
+        bump(histogram[bucket], 1);
+    }
+    void merge(const profile_counter& aOther) {
+        bump(count, aOther.count.load(std::memory_order_relaxed));
+        bump(nanos, aOther.nanos.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < profile_buckets; ++b) {
+            bump(histogram[b], aOther.histogram[b].load(std::memory_order_relaxed));
+        }
+    }
+};
+
+//
+//  The counters of the class T for its N message ids. Every thread gets its
+//  own table on first use. The table registers itself, so the statistics of
+//  all threads can be summed. A thread that ends leaves its counts behind.
+template <class T, size_t N>
+class profile_table {
+public:
+    profile_counter counter[N];
+
+    static profile_table& local() {
+        thread_local profile_table table;
+
+        return table;
+    }
+    static void collect(profile_counter (&aSum)[N]) {
+        std::lock_guard<std::mutex> lock(registry().lock);
+
+        for (size_t i = 0; i < N; ++i) {
+            aSum[i].merge(registry().retired[i]);
+            for (auto t : registry().live) {
+                aSum[i].merge(t->counter[i]);
+            }
+        }
+    }
+private:
+    struct tRegistry {
+        std::mutex                  lock;
+        std::vector<profile_table*> live;
+        profile_counter             retired[N];
+    };
+    static tRegistry& registry() {
+        static tRegistry r;
+
+        return r;
+    }
+    profile_table() {
+        std::lock_guard<std::mutex> lock(registry().lock);
+
+        registry().live.push_back(this);
+    }
+    ~profile_table() {
+        std::lock_guard<std::mutex> lock(registry().lock);
+
+        for (size_t i = 0; i < N; ++i) {
+            registry().retired[i].merge(counter[i]);
+        }
+        registry().live.erase(std::find(registry().live.begin(), registry().live.end(), this));
+    }
+};
+
+//
+//  Measures from construction to destruction. The handler sets index to the
+//  id it dispatched to. Without an index nothing is counted.
+template <class T, size_t N>
+class profile_scope {
+public:
+    profile_scope() : mStart(std::chrono::steady_clock::now()) {}
+    ~profile_scope() {
+        if (index < N) {
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count();
+
+            profile_table<T, N>::local().counter[index].add(static_cast<uint64_t>(nanos));
+        }
+    }
+    size_t index = N;
+private:
+    std::chrono::steady_clock::time_point mStart;
+};
+
+//
+//  One line per id with the count, the mean and the bucket that holds the
+//  median and the 99th percentile, followed by the non-empty buckets.
+template <class T, size_t N>
+void profile_dump(std::ostream& aOut, const char* aClass, const char* const (&aNames)[N]) {
+    profile_counter sum[N];
+
+    profile_table<T, N>::collect(sum);
+    aOut << aClass << "\n";
+    for (size_t i = 0; i < N; ++i) {
+        uint64_t count = sum[i].count.load();
+        uint64_t seen  = 0;
+        uint64_t p50   = 0;
+        uint64_t p99   = 0;
+
+        if (count == 0) {
+            continue;
+        }
+        for (size_t b = 0; b < profile_buckets; ++b) {
+            seen += sum[i].histogram[b].load();
+            if ((p50 == 0) && (seen * 2 >= count)) {
+                p50 = uint64_t(1) << b;
+            }
+            if ((p99 == 0) && (seen * 100 >= count * 99)) {
+                p99 = uint64_t(1) << b;
+            }
+        }
+        aOut << "  " << std::left << std::setw(32) << aNames[i] << std::right
+             << " count " << std::setw(10) << count
+             << "  mean " << std::setw(10) << sum[i].nanos.load() / count << " ns"
+             << "  p50 <" << std::setw(10) << p50 * 2 << " ns"
+             << "  p99 <" << std::setw(10) << p99 * 2 << " ns\n";
+        for (size_t b = 0; b < profile_buckets; ++b) {
+            uint64_t n = sum[i].histogram[b].load();
+
+            if (n != 0) {
+                aOut << "      < " << std::setw(10) << (uint64_t(1) << (b + 1)) << " ns " << std::setw(10) << n << "\n";
+            }
+        }
+    }
+}
+} // namespace mtt
+
+#endif // MTTPROFILE_INC
+)RUNTIME";
+
+void ProfileHeader::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "p-inc", header.buffer()});
+        header << cProfileRuntime;
+        header.close();
+    }
+}
@@ -0,0 +1,860 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <string>
+#include <memory>
+#include <set>
+#include <map>
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+#include "main.h"
+#include "helper.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "mattribute.h"
+#include "cattribute.h"
+#include "massociationend.h"
+#include "cassociationend.h"
+#include "cclassbase.h"
+#include "protocodec.h"
+
+//
+//  The wire types of proto3 are varint (0), fixed64 (1), length delimited (2)
+//  and fixed32 (5). Repeated numbers are written packed, but the reader also
+//  takes them unpacked as required by the format. Fields with unknown numbers
+//  or an unexpected wire type are skipped. The reader checks every step
+//  against the end of its range. A failure in a nested range is reported by
+//  the reader at the top.
+static const char* cProtoRuntime = R"RUNTIME(#pragma once
+#ifndef MTTPROTO_INC
+#define MTTPROTO_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+namespace mtt {
+enum class pb_type {
+    varint,
+    zigzag,
+    fixed32,
+    fixed64,
+    bytes
+};
+
+constexpr uint32_t pb_wire(pb_type aType) {
+    return (aType == pb_type::fixed64) ? 1 : (aType == pb_type::bytes) ? 2 : (aType == pb_type::fixed32) ? 5 : 0;
+}
+
+inline size_t pb_varint_size(uint64_t aValue) {
+    size_t size = 1;
+
+    while (aValue >= 0x80) {
+        aValue >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+inline uint8_t* pb_put_varint(uint8_t* aOut, uint64_t aValue) {
+    while (aValue >= 0x80) {
+        *aOut++ = static_cast<uint8_t>(aValue | 0x80);
+        aValue >>= 7;
+    }
+    *aOut++ = static_cast<uint8_t>(aValue);
+
+    return aOut;
+}
+//
+//  Negative numbers of plain varints are sign extended to ten bytes as
+//  protobuf does. Zigzag folds the sign into the lowest bit.
+template <pb_type E, typename T>
+inline uint64_t pb_encode(T aValue) {
+    if constexpr (E == pb_type::zigzag) {
+        int64_t value = static_cast<int64_t>(aValue);
+
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    } else if constexpr (std::is_enum<T>::value || std::is_signed<T>::value) {
+        return static_cast<uint64_t>(static_cast<int64_t>(aValue));
+    } else {
+        return static_cast<uint64_t>(aValue);
+    }
+}
+
+template <typename B, typename T>
+inline B pb_bits(const T& aValue) {
+    if constexpr (std::is_floating_point<T>::value) {
+        B bits;
+
+        static_assert(sizeof(B) == sizeof(T), "a fixed float needs the matching size");
+        std::memcpy(&bits, &aValue, sizeof(bits));
+        return bits;
+    } else {
+        return static_cast<B>(aValue);
+    }
+}
+
+template <pb_type E, typename T>
+inline size_t pb_value_size(const T& aValue) {
+    if constexpr (E == pb_type::fixed32) {
+        return 4;
+    } else if constexpr (E == pb_type::fixed64) {
+        return 8;
+    } else {
+        return pb_varint_size(pb_encode<E>(aValue));
+    }
+}
+
+template <pb_type E, typename T>
+inline uint8_t* pb_put_value(uint8_t* aOut, const T& aValue) {
+    if constexpr ((E == pb_type::fixed32) || (E == pb_type::fixed64)) {
+        using bits_t = typename std::conditional<E == pb_type::fixed32, uint32_t, uint64_t>::type;
+        bits_t bits = pb_bits<bits_t>(aValue);
+
+        for (size_t i = 0; i < sizeof(bits); ++i) {
+            *aOut++ = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        return aOut;
+    } else {
+        return pb_put_varint(aOut, pb_encode<E>(aValue));
+    }
+}
+//
+//  Proto3 does not write scalars with the default value. A negative zero is
+//  not the default.
+template <typename T>
+inline bool pb_is_default(const T& aValue) {
+    if constexpr (std::is_floating_point<T>::value) {
+        T zero = 0;
+
+        return std::memcmp(&aValue, &zero, sizeof(T)) == 0;
+    } else {
+        return aValue == T {};
+    }
+}
+
+inline size_t pb_bytes_size(size_t aSize) {
+    return pb_varint_size(aSize) + aSize;
+}
+
+inline uint8_t* pb_put_bytes(uint8_t* aOut, const std::string& aValue) {
+    aOut = pb_put_varint(aOut, aValue.size());
+    std::memcpy(aOut, aValue.data(), aValue.size());
+
+    return aOut + aValue.size();
+}
+
+class pb_reader {
+public:
+    pb_reader(const uint8_t* aData, size_t aSize) : mPos(aData), mEnd(aData + aSize), mGood(&mOwnGood) {}
+
+    bool good() const { return *mGood; }
+    bool more() const { return *mGood && (mPos < mEnd); }
+    //
+    //  The key is the field number and the wire type.
+    uint32_t key() {
+        uint64_t key = varint();
+
+        if (((key >> 3) == 0) || (key > 0xffffffffu)) {
+            fail();
+            return 0;
+        }
+        return static_cast<uint32_t>(key);
+    }
+    void skip(uint32_t aKey) {
+        switch (aKey & 7) {
+        case 0:
+            varint();
+            break;
+        case 1:
+            advance(8);
+            break;
+        case 2:
+            bytes();
+            break;
+        case 5:
+            advance(4);
+            break;
+        default:
+            fail();
+            break;
+        }
+    }
+    //
+    //  Returns the reader of an embedded message. A field of another wire
+    //  type is skipped and the returned reader is empty.
+    pb_reader message(uint32_t aKey) {
+        if ((aKey & 7) != 2) {
+            skip(aKey);
+            return pb_reader(*this, mEnd, 0);
+        }
+        return bytes();
+    }
+
+    template <pb_type E, typename T>
+    void value(uint32_t aKey, T& aValue) {
+        if ((aKey & 7) != pb_wire(E)) {
+            skip(aKey);
+        } else {
+            read<E>(aValue);
+        }
+    }
+    void value(uint32_t aKey, std::string& aValue) {
+        if ((aKey & 7) != 2) {
+            skip(aKey);
+        } else {
+            read<pb_type::bytes>(aValue);
+        }
+    }
+    //
+    //  Adds the elements of a repeated field, packed or not.
+    template <pb_type E, typename T>
+    void append(uint32_t aKey, std::vector<T>& aValues) {
+        if ((E != pb_type::bytes) && ((aKey & 7) == 2)) {
+            pb_reader packed = bytes();
+
+            while (packed.more()) {
+                T value {};
+
+                packed.read<E>(value);
+                aValues.push_back(value);
+            }
+        } else if ((aKey & 7) == pb_wire(E)) {
+            T value {};
+
+            read<E>(value);
+            aValues.push_back(value);
+        } else {
+            skip(aKey);
+        }
+    }
+    //
+    //  Elements that do not fit into the array are dropped.
+    template <pb_type E, typename T, size_t N>
+    void append(uint32_t aKey, T (&aValues)[N], size_t& aUsed) {
+        T dropped {};
+
+        if ((E != pb_type::bytes) && ((aKey & 7) == 2)) {
+            pb_reader packed = bytes();
+
+            while (packed.more()) {
+                packed.read<E>((aUsed < N) ? aValues[aUsed++] : dropped);
+            }
+        } else if ((aKey & 7) == pb_wire(E)) {
+            read<E>((aUsed < N) ? aValues[aUsed++] : dropped);
+        } else {
+            skip(aKey);
+        }
+    }
+private:
+    pb_reader(const pb_reader& aParent, const uint8_t* aData, size_t aSize) : mPos(aData), mEnd(aData + aSize), mGood(aParent.mGood) {}
+
+    template <pb_type E, typename T>
+    void read(T& aValue) {
+        if constexpr (E == pb_type::bytes) {
+            pb_reader payload = bytes();
+
+            aValue.assign(reinterpret_cast<const char*>(payload.mPos), payload.mEnd - payload.mPos);
+        } else if constexpr ((E == pb_type::fixed32) || (E == pb_type::fixed64)) {
+            using bits_t = typename std::conditional<E == pb_type::fixed32, uint32_t, uint64_t>::type;
+            bits_t bits = 0;
+
+            if (static_cast<size_t>(mEnd - mPos) < sizeof(bits)) {
+                fail();
+                return;
+            }
+            for (size_t i = 0; i < sizeof(bits); ++i) {
+                bits |= static_cast<bits_t>(*mPos++) << (8 * i);
+            }
+            if constexpr (std::is_floating_point<T>::value) {
+                static_assert(sizeof(bits) == sizeof(T), "a fixed float needs the matching size");
+                std::memcpy(&aValue, &bits, sizeof(bits));
+            } else {
+                aValue = static_cast<T>(bits);
+            }
+        } else if constexpr (std::is_same<T, bool>::value) {
+            aValue = (varint() != 0);
+        } else if constexpr (E == pb_type::zigzag) {
+            uint64_t value = varint();
+
+            aValue = static_cast<T>(static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1));
+        } else {
+            aValue = static_cast<T>(varint());
+        }
+    }
+    pb_reader bytes() {
+        uint64_t size = varint();
+
+        if (size > static_cast<uint64_t>(mEnd - mPos)) {
+            fail();
+            return pb_reader(*this, mEnd, 0);
+        }
+        pb_reader payload(*this, mPos, static_cast<size_t>(size));
+
+        mPos += size;
+        return payload;
+    }
+    void advance(size_t aSize) {
+        if (static_cast<size_t>(mEnd - mPos) < aSize) {
+            fail();
+        } else {
+            mPos += aSize;
+        }
+    }
+    uint64_t varint() {
+        uint64_t value = 0;
+
+        for (unsigned shift = 0; (mPos < mEnd) && (shift < 64); shift += 7) {
+            uint8_t byte = *mPos++;
+
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        fail();
+        return 0;
+    }
+    void fail() {
+        *mGood = false;
+        mPos   = mEnd;
+    }
+private:
+    const uint8_t* mPos;
+    const uint8_t* mEnd;
+    bool*          mGood;
+    bool           mOwnGood = true;
+};
+} // namespace mtt
+
+#endif  // MTTPROTO_INC
+)RUNTIME";
+
+//
+//  The proto type and the encoding of the C++ types.
+static const std::map<std::string, std::pair<std::string, std::string>> cProtoTypes = {
+    {"bool",               {"bool",   "varint"}},
+    {"char",               {"sint32", "zigzag"}},
+    {"signed char",        {"sint32", "zigzag"}},
+    {"short",              {"sint32", "zigzag"}},
+    {"int",                {"sint32", "zigzag"}},
+    {"int8_t",             {"sint32", "zigzag"}},
+    {"int16_t",            {"sint32", "zigzag"}},
+    {"int32_t",            {"sint32", "zigzag"}},
+    {"long",               {"sint64", "zigzag"}},
+    {"long int",           {"sint64", "zigzag"}},
+    {"long long",          {"sint64", "zigzag"}},
+    {"int64_t",            {"sint64", "zigzag"}},
+    {"unsigned char",      {"uint32", "varint"}},
+    {"unsigned short",     {"uint32", "varint"}},
+    {"unsigned",           {"uint32", "varint"}},
+    {"unsigned int",       {"uint32", "varint"}},
+    {"uint8_t",            {"uint32", "varint"}},
+    {"uint16_t",           {"uint32", "varint"}},
+    {"uint32_t",           {"uint32", "varint"}},
+    {"unsigned long",      {"uint64", "varint"}},
+    {"unsigned long long", {"uint64", "varint"}},
+    {"uint64_t",           {"uint64", "varint"}},
+    {"size_t",             {"uint64", "varint"}},
+    {"objectid_t",         {"uint64", "varint"}},
+    {"float",              {"float",  "fixed32"}},
+    {"double",             {"double", "fixed64"}}
+};
+//
+//  The types that can be selected with the tagged value ProtoType.
+static const std::map<std::string, std::string> cProtoEncodings = {
+    {"bool",     "varint"},
+    {"int32",    "varint"},
+    {"int64",    "varint"},
+    {"uint32",   "varint"},
+    {"uint64",   "varint"},
+    {"sint32",   "zigzag"},
+    {"sint64",   "zigzag"},
+    {"fixed32",  "fixed32"},
+    {"sfixed32", "fixed32"},
+    {"float",    "fixed32"},
+    {"fixed64",  "fixed64"},
+    {"sfixed64", "fixed64"},
+    {"double",   "fixed64"}
+};
+
+static size_t VarintSize(uint64_t aValue) {
+    size_t size = 1;
+
+    while (aValue >= 0x80) {
+        aValue >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void ProtoCodec::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "pb-inc", header.buffer()});
+        header << cProtoRuntime;
+        header.close();
+    }
+}
+
+void ProtoCodec::Member(std::shared_ptr<CAttribute> a, const std::string& aOwner) {
+    tField field;
+    //
+    //  A pointer to a sim object is written as its id.
+    if (a->FQN() == "__simobject__") {
+        if ((a->Aggregation != aShared) && Field(field, a, nullptr, "objectid_t", a->Multiplicity)) {
+            Add(mFields, field, a, nullptr, aOwner, a->name);
+        }
+    } else if (a->QualifierType.empty() && Field(field, a, a->Classifier, a->ClassifierName, a->Multiplicity)) {
+        Add(mFields, field, a, a->Classifier, aOwner, a->name);
+    }
+}
+
+void ProtoCodec::Member(std::shared_ptr<CAssociationEnd> a, const std::string& aOwner) {
+    tField field;
+
+    if (a->QualifierType.empty() && !a->HasContainerPolicy() &&
+        Field(field, a, a->Classifier, (a->Classifier) ? a->Classifier->name : std::string(), a->Multiplicity)) {
+        Add(mFields, field, a, a->Classifier, aOwner, a->name);
+    }
+}
+
+std::string ProtoCodec::Size(int aIndent) const {
+    return CodeWriter::shift("size_t size = 0;\n\n" + Size(mFields, "this->", "size", 0) + "\nreturn size;\n", aIndent);
+}
+
+std::string ProtoCodec::Pack(int aIndent) const {
+    return CodeWriter::shift(Pack(mFields, "this->", 0) + "\nreturn aOut;\n", aIndent);
+}
+//
+//  Proto3 has no presence for scalars, so all members start with their
+//  default value before the fields are read.
+std::string ProtoCodec::Unpack(int aIndent) const {
+    return CodeWriter::shift(Reset(mFields, "this->", 0) + Unpack(mFields, "this->", "aReader", 0) + "\nreturn aReader.good();\n", aIndent);
+}
+
+std::string ProtoCodec::Schema(const std::string& aMessage) const {
+    return "syntax = \"proto3\";\n\n" + Schema(aMessage, mFields, 0);
+}
+//
+//  Optional members, maps and containers with a policy have no proto form
+//  and are left out.
+bool ProtoCodec::Field(tField& aField, std::shared_ptr<MElement> aElement, std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aMultiplicity) {
+    if (aMultiplicity.empty() || (aMultiplicity == "1")) {
+        aField.count = eCount::single;
+    } else if (aMultiplicity == "0..1") {
+        return false;
+    } else if (std::all_of(aMultiplicity.begin(), aMultiplicity.end(), ::isdigit)) {
+        aField.count = eCount::array;
+    } else {
+        aField.count = eCount::vector;
+    }
+    if (aClassifier && ((aClassifier->type == eElementType::Struct) || (aClassifier->type == eElementType::SimStruct) ||
+                        (aClassifier->type == eElementType::CxxClass))) {
+        aField.kind = eKind::record;
+        aField.type = aClassifier->name;
+    } else if ((aType == "string") || (aType == "std::string")) {
+        aField.kind = eKind::string;
+        aField.type = "string";
+    } else if (aClassifier && ((aClassifier->type == eElementType::Enumeration) || (aClassifier->type == eElementType::SimEnumeration))) {
+        aField.type     = "int32";
+        aField.encoding = "varint";
+    } else if (cProtoTypes.find(aType) != cProtoTypes.end()) {
+        aField.type     = cProtoTypes.at(aType).first;
+        aField.encoding = cProtoTypes.at(aType).second;
+    } else {
+        std::cerr << "No protobuf type for " << aType << " of " << aElement->name << ". The member is left out.\n";
+        return false;
+    }
+    if ((aField.kind == eKind::scalar) && aElement->HasTaggedValue("ProtoType")) {
+        std::string type = helper::tolower(helper::trim(aElement->GetTaggedValue("ProtoType")));
+
+        if (cProtoEncodings.find(type) != cProtoEncodings.end()) {
+            aField.type     = type;
+            aField.encoding = cProtoEncodings.at(type);
+        } else {
+            std::cerr << "Unknown protobuf type " << type << " at " << aElement->name << "\n";
+        }
+    }
+    return true;
+}
+
+std::set<std::string> ProtoCodec::mUnpinned;
+
+void ProtoCodec::Add(std::vector<tField>& aFields, tField& aField, std::shared_ptr<MElement> aElement, std::shared_ptr<MElement> aClassifier, const std::string& aOwner, const std::string& aMember) {
+    aField.label  = aOwner + "::" + aMember;
+    aField.member = aMember;
+    aField.number = 1;
+    for (auto & f : aFields) {
+        aField.number = std::max(aField.number, f.number + 1);
+    }
+    //
+    //  Valid numbers are 1 to 2^29-1 without the reserved range 19000-19999.
+    //  An invalid one falls back to the next free number. The fallback
+    //  follows the declaration order, so fields without a pinned number
+    //  change their number when members are inserted or reordered.
+    if (aElement->HasTaggedValue("FieldNumber")) {
+        std::string   value  = helper::trim(aElement->GetTaggedValue("FieldNumber"));
+        unsigned long number = 0;
+
+        if ((!value.empty()) && (value.size() < 10) && std::all_of(value.begin(), value.end(), ::isdigit)) {
+            number = std::stoul(value);
+        }
+        if ((number == 0) || (number > 536870911UL) || ((number >= 19000) && (number <= 19999))) {
+            std::cerr << "Field number " << value << " of " << aField.label << " is not valid. It gets number " << aField.number << ".\n";
+        } else {
+            aField.number = static_cast<uint32_t>(number);
+        }
+    } else if (mUnpinned.insert(aField.label).second) {
+        std::cerr << "Field " << aField.label << " has no FieldNumber and gets number " << aField.number << " by declaration order.\n";
+    }
+    for (auto & f : aFields) {
+        if (f.number == aField.number) {
+            std::cerr << "Field number " << aField.number << " of " << aField.label << " collides with " << f.label << ". The member is left out.\n";
+            return;
+        }
+    }
+    if (aField.kind == eKind::record) {
+        Fields(aField.fields, aClassifier);
+    }
+    aFields.push_back(aField);
+}
+
+void ProtoCodec::Fields(std::vector<tField>& aFields, std::shared_ptr<MElement> aStruct) {
+    auto s = std::dynamic_pointer_cast<CClassBase>(aStruct);
+
+    if (s) {
+        for (auto & ai : s->GetAttributes()) {
+            auto  a = std::dynamic_pointer_cast<CAttribute>(ai);
+            tField field;
+
+            if (a->QualifierType.empty() && Field(field, a, a->Classifier, a->ClassifierName, a->Multiplicity)) {
+                Add(aFields, field, a, a->Classifier, s->FQN(), a->name);
+            }
+        }
+        for (auto & ae : s->OtherEnd) {
+            auto   a = std::dynamic_pointer_cast<CAssociationEnd>(*ae);
+            tField field;
+
+            if (a->isNavigable() && a->QualifierType.empty() && !a->HasContainerPolicy() &&
+                Field(field, a, a->Classifier, (a->Classifier) ? a->Classifier->name : std::string(), a->Multiplicity)) {
+                Add(aFields, field, a, a->Classifier, s->FQN(), a->name);
+            }
+        }
+    }
+}
+//
+//  Repeated numbers are packed into one length delimited field.
+uint32_t ProtoCodec::Key(const tField& aField, bool aPacked) {
+    uint32_t wire = 2;
+
+    if ((aField.kind == eKind::scalar) && !aPacked) {
+        wire = (aField.encoding == "fixed64") ? 1 : (aField.encoding == "fixed32") ? 5 : 0;
+    }
+    return (aField.number << 3) | wire;
+}
+
+std::string ProtoCodec::Put(uint32_t aKey, const tField& aField) {
+    return "aOut = mtt::pb_put_varint(aOut, " + std::to_string(aKey) + ");   // " + aField.label + " = " + std::to_string(aField.number) + "\n";
+}
+
+std::string ProtoCodec::Size(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aTarget, size_t aDepth) {
+    std::string code;
+
+    for (auto & f : aFields) {
+        code += Size(f, aPrefix, aTarget, aDepth);
+    }
+    return code;
+}
+
+std::string ProtoCodec::Size(const tField& aField, const std::string& aPrefix, const std::string& aTarget, size_t aDepth) {
+    std::string expr     = aPrefix + aField.member;
+    std::string size     = "s" + std::to_string(aDepth);
+    std::string element  = "e" + std::to_string(aDepth);
+    std::string type     = "mtt::pb_type::" + aField.encoding;
+    std::string fixed    = (aField.encoding == "fixed32") ? "4" : "8";
+    bool        repeated = (aField.count != eCount::single);
+    std::string key      = std::to_string(VarintSize(Key(aField, repeated)));
+
+    switch (aField.kind) {
+    case eKind::scalar:
+        if (!repeated) {
+            return "if (!mtt::pb_is_default(" + expr + ")) {\n"
+                   "    " + aTarget + " += " + key + " + mtt::pb_value_size<" + type + ">(" + expr + ");\n"
+                   "}\n";
+        } else if ((aField.encoding == "fixed32") || (aField.encoding == "fixed64")) {
+            return "if (!std::empty(" + expr + ")) {\n"
+                   "    " + aTarget + " += " + key + " + mtt::pb_bytes_size(std::size(" + expr + ") * " + fixed + ");\n"
+                   "}\n";
+        }
+        return "if (!std::empty(" + expr + ")) {\n"
+               "    size_t " + size + " = 0;\n"
+               "\n"
+               "    for (const auto& " + element + " : " + expr + ") {\n"
+               "        " + size + " += mtt::pb_value_size<" + type + ">(" + element + ");\n"
+               "    }\n"
+               "    " + aTarget + " += " + key + " + mtt::pb_bytes_size(" + size + ");\n"
+               "}\n";
+    case eKind::string:
+        if (!repeated) {
+            return "if (!" + expr + ".empty()) {\n"
+                   "    " + aTarget + " += " + key + " + mtt::pb_bytes_size(" + expr + ".size());\n"
+                   "}\n";
+        }
+        return "for (const auto& " + element + " : " + expr + ") {\n"
+               "    " + aTarget + " += " + key + " + mtt::pb_bytes_size(" + element + ".size());\n"
+               "}\n";
+    case eKind::record:
+        break;
+    }
+    if (!repeated) {
+        return "{\n"
+               "    size_t " + size + " = 0;\n"
+               "\n" +
+               CodeWriter::shift(Size(aField.fields, expr + ".", size, aDepth + 1), 4) +
+               "    " + aTarget + " += " + key + " + mtt::pb_bytes_size(" + size + ");\n"
+               "}\n";
+    }
+    size = "s" + std::to_string(aDepth + 1);
+    return "for (const auto& " + element + " : " + expr + ") {\n"
+           "    size_t " + size + " = 0;\n"
+           "\n" +
+           CodeWriter::shift(Size(aField.fields, element + ".", size, aDepth + 2), 4) +
+           "    " + aTarget + " += " + key + " + mtt::pb_bytes_size(" + size + ");\n"
+           "}\n";
+}
+
+std::string ProtoCodec::Pack(const std::vector<tField>& aFields, const std::string& aPrefix, size_t aDepth) {
+    std::string code;
+
+    for (auto & f : aFields) {
+        code += Pack(f, aPrefix, aDepth);
+    }
+    return code;
+}
+
+std::string ProtoCodec::Pack(const tField& aField, const std::string& aPrefix, size_t aDepth) {
+    std::string expr     = aPrefix + aField.member;
+    std::string size     = "s" + std::to_string(aDepth);
+    std::string element  = "e" + std::to_string(aDepth);
+    std::string type     = "mtt::pb_type::" + aField.encoding;
+    std::string fixed    = (aField.encoding == "fixed32") ? "4" : "8";
+    bool        repeated = (aField.count != eCount::single);
+    std::string put      = Put(Key(aField, repeated), aField);
+
+    switch (aField.kind) {
+    case eKind::scalar:
+        if (!repeated) {
+            return "if (!mtt::pb_is_default(" + expr + ")) {\n" +
+                   CodeWriter::shift(put, 4) +
+                   "    aOut = mtt::pb_put_value<" + type + ">(aOut, " + expr + ");\n"
+                   "}\n";
+        }
+        if ((aField.encoding == "fixed32") || (aField.encoding == "fixed64")) {
+            size = "std::size(" + expr + ") * " + fixed;
+        }
+        return "if (!std::empty(" + expr + ")) {\n" +
+               (((aField.encoding == "fixed32") || (aField.encoding == "fixed64")) ? std::string() :
+                "    size_t " + size + " = 0;\n"
+                "\n"
+                "    for (const auto& " + element + " : " + expr + ") {\n"
+                "        " + size + " += mtt::pb_value_size<" + type + ">(" + element + ");\n"
+                "    }\n") +
+               CodeWriter::shift(put, 4) +
+               "    aOut = mtt::pb_put_varint(aOut, " + size + ");\n"
+               "    for (const auto& " + element + " : " + expr + ") {\n"
+               "        aOut = mtt::pb_put_value<" + type + ">(aOut, " + element + ");\n"
+               "    }\n"
+               "}\n";
+    case eKind::string:
+        if (!repeated) {
+            return "if (!" + expr + ".empty()) {\n" +
+                   CodeWriter::shift(put, 4) +
+                   "    aOut = mtt::pb_put_bytes(aOut, " + expr + ");\n"
+                   "}\n";
+        }
+        return "for (const auto& " + element + " : " + expr + ") {\n" +
+               CodeWriter::shift(put, 4) +
+               "    aOut = mtt::pb_put_bytes(aOut, " + element + ");\n"
+               "}\n";
+    case eKind::record:
+        break;
+    }
+    if (!repeated) {
+        return "{\n"
+               "    size_t " + size + " = 0;\n"
+               "\n" +
+               CodeWriter::shift(Size(aField.fields, expr + ".", size, aDepth + 1), 4) +
+               CodeWriter::shift(put, 4) +
+               "    aOut = mtt::pb_put_varint(aOut, " + size + ");\n" +
+               CodeWriter::shift(Pack(aField.fields, expr + ".", aDepth + 1), 4) +
+               "}\n";
+    }
+    size = "s" + std::to_string(aDepth + 1);
+    return "for (const auto& " + element + " : " + expr + ") {\n"
+           "    size_t " + size + " = 0;\n"
+           "\n" +
+           CodeWriter::shift(Size(aField.fields, element + ".", size, aDepth + 2), 4) +
+           CodeWriter::shift(put, 4) +
+           "    aOut = mtt::pb_put_varint(aOut, " + size + ");\n" +
+           CodeWriter::shift(Pack(aField.fields, element + ".", aDepth + 2), 4) +
+           "}\n";
+}
+
+std::string ProtoCodec::Reset(const std::vector<tField>& aFields, const std::string& aPrefix, size_t aDepth) {
+    std::string element = "e" + std::to_string(aDepth);
+    std::string code;
+
+    for (auto & f : aFields) {
+        std::string expr = aPrefix + f.member;
+
+        if (f.count == eCount::vector) {
+            code += expr + ".clear();\n";
+        } else if (f.count == eCount::array) {
+            code += "for (auto& " + element + " : " + expr + ") {\n";
+            if (f.kind == eKind::record) {
+                code += CodeWriter::shift(Reset(f.fields, element + ".", aDepth + 1), 4);
+            } else if (f.kind == eKind::string) {
+                code += "    " + element + ".clear();\n";
+            } else {
+                code += "    " + element + " = {};\n";
+            }
+            code += "}\n";
+        } else if (f.kind == eKind::record) {
+            code += Reset(f.fields, expr + ".", aDepth);
+        } else if (f.kind == eKind::string) {
+            code += expr + ".clear();\n";
+        } else {
+            code += expr + " = {};\n";
+        }
+    }
+    return code;
+}
+
+std::string ProtoCodec::Unpack(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aReader, size_t aDepth) {
+    std::string key = "k" + std::to_string(aDepth);
+    std::string code;
+    //
+    //  The arrays count their elements over all occurrences of the field.
+    for (auto & f : aFields) {
+        if (f.count == eCount::array) {
+            code += "size_t n" + std::to_string(aDepth) + "_" + f.member + " = 0;\n";
+        }
+    }
+    code += "while (" + aReader + ".more()) {\n"
+            "    uint32_t " + key + " = " + aReader + ".key();\n"
+            "\n"
+            "    switch (" + key + " >> 3) {\n";
+    for (auto & f : aFields) {
+        code += "    case " + std::to_string(f.number) + ":   // " + f.label + "\n" +
+                CodeWriter::shift(Unpack(f, aPrefix, aReader, key, aDepth), 8) +
+                "        break;\n";
+    }
+    code += "    default:\n"
+            "        " + aReader + ".skip(" + key + ");\n"
+            "        break;\n"
+            "    }\n"
+            "}\n";
+
+    return code;
+}
+
+std::string ProtoCodec::Unpack(const tField& aField, const std::string& aPrefix, const std::string& aReader, const std::string& aKey, size_t aDepth) {
+    std::string expr    = aPrefix + aField.member;
+    std::string element = "e" + std::to_string(aDepth);
+    std::string message = "m" + std::to_string(aDepth);
+    std::string index   = "n" + std::to_string(aDepth) + "_" + aField.member;
+    std::string type    = (aField.kind == eKind::string) ? std::string("mtt::pb_type::bytes") : "mtt::pb_type::" + aField.encoding;
+
+    if (aField.kind != eKind::record) {
+        switch (aField.count) {
+        case eCount::single:
+            if (aField.kind == eKind::string) {
+                return aReader + ".value(" + aKey + ", " + expr + ");\n";
+            }
+            return aReader + ".value<" + type + ">(" + aKey + ", " + expr + ");\n";
+        case eCount::vector:
+            return aReader + ".append<" + type + ">(" + aKey + ", " + expr + ");\n";
+        case eCount::array:
+            return aReader + ".append<" + type + ">(" + aKey + ", " + expr + ", " + index + ");\n";
+        }
+    }
+    switch (aField.count) {
+    case eCount::single:
+        return "{\n"
+               "    mtt::pb_reader " + message + " = " + aReader + ".message(" + aKey + ");\n"
+               "\n" +
+               CodeWriter::shift(Unpack(aField.fields, expr + ".", message, aDepth + 1), 4) +
+               "}\n";
+    case eCount::vector:
+        return "if ((" + aKey + " & 7) == 2) {\n"
+               "    auto&          " + element + " = " + expr + ".emplace_back();\n"
+               "    mtt::pb_reader " + message + " = " + aReader + ".message(" + aKey + ");\n"
+               "\n" +
+               CodeWriter::shift(Unpack(aField.fields, element + ".", message, aDepth + 1), 4) +
+               "} else {\n"
+               "    " + aReader + ".skip(" + aKey + ");\n"
+               "}\n";
+    case eCount::array:
+        break;
+    }
+    //
+    //  Elements that do not fit into the array are dropped.
+    return "if (((" + aKey + " & 7) == 2) && (" + index + " < std::size(" + expr + "))) {\n"
+           "    auto&          " + element + " = " + expr + "[" + index + "++];\n"
+           "    mtt::pb_reader " + message + " = " + aReader + ".message(" + aKey + ");\n"
+           "\n" +
+           CodeWriter::shift(Unpack(aField.fields, element + ".", message, aDepth + 1), 4) +
+           "} else {\n"
+           "    " + aReader + ".skip(" + aKey + ");\n"
+           "}\n";
+}
+//
+//  Enums are written as int32, which has the same encoding as a proto enum.
+//  The structs become nested messages of the message that uses them.
+std::string ProtoCodec::Schema(const std::string& aMessage, const std::vector<tField>& aFields, int aIndent) {
+    std::set<std::string> nested;
+    std::string           code;
+    std::string           filler = CodeWriter::spaces(aIndent);
+
+    code = filler + "message " + aMessage + " {\n";
+    for (auto & f : aFields) {
+        if ((f.kind == eKind::record) && nested.insert(f.type).second) {
+            code += Schema(f.type, f.fields, aIndent + 4);
+        }
+    }
+    for (auto & f : aFields) {
+        code += filler + "    " + ((f.count != eCount::single) ? "repeated " : "") + f.type + " " + f.member + " = " + std::to_string(f.number) + ";\n";
+    }
+    code += filler + "}\n";
+
+    return code;
+}
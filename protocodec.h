@@ -0,0 +1,101 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef PROTOCODEC_H
+#define PROTOCODEC_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+
+class CModel;
+class MElement;
+class CAttribute;
+class CAssociationEnd;
+
+//
+//  Protobuf codec of the signal classes with the Protobuf stereotype. The
+//  generated code writes and reads the proto3 wire format directly, so no
+//  protoc and no libprotobuf are needed. The .proto schema is generated from
+//  the same fields. Field numbers follow the declaration order of the members
+//  and can be pinned with the tagged value FieldNumber. Fields without one
+//  are reported, since their numbers shift when members are reordered. The
+//  runtime is mttproto.h, which is generated once per output directory.
+class ProtoCodec {
+public:
+    static std::string Name(void) { return "mttproto.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+
+    void Member(std::shared_ptr<CAttribute> a, const std::string& aOwner);
+    void Member(std::shared_ptr<CAssociationEnd> a, const std::string& aOwner);
+    //
+    //  The code of the size, pack and unpack bodies. The unpack body reads
+    //  from the mtt::pb_reader aReader.
+    std::string Size(int aIndent) const;
+    std::string Pack(int aIndent) const;
+    std::string Unpack(int aIndent) const;
+    std::string Schema(const std::string& aMessage) const;
+private:
+    enum class eKind {
+        scalar,
+        string,
+        record      //  Structs as nested messages.
+    };
+    enum class eCount {
+        single,
+        vector,
+        array
+    };
+    struct tField {
+        uint32_t            number = 0;
+        std::string         label;
+        std::string         member;
+        std::string         type;       //  The proto type of scalars or the message name of records.
+        std::string         encoding;   //  The mtt::pb_type of scalars.
+        eKind               kind  = eKind::scalar;
+        eCount              count = eCount::single;
+        std::vector<tField> fields;
+    };
+    //
+    //  The code generators take the depth of nesting. Each declares its
+    //  variables with the depth as suffix and passes the next depth on.
+    static bool Field(tField& aField, std::shared_ptr<MElement> aElement, std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aMultiplicity);
+    static void Add(std::vector<tField>& aFields, tField& aField, std::shared_ptr<MElement> aElement, std::shared_ptr<MElement> aClassifier, const std::string& aOwner, const std::string& aMember);
+    static void Fields(std::vector<tField>& aFields, std::shared_ptr<MElement> aStruct);
+    static uint32_t Key(const tField& aField, bool aPacked);
+    static std::string Put(uint32_t aKey, const tField& aField);
+    static std::string Reset(const std::vector<tField>& aFields, const std::string& aPrefix, size_t aDepth);
+    static std::string Size(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aTarget, size_t aDepth);
+    static std::string Size(const tField& aField, const std::string& aPrefix, const std::string& aTarget, size_t aDepth);
+    static std::string Pack(const std::vector<tField>& aFields, const std::string& aPrefix, size_t aDepth);
+    static std::string Pack(const tField& aField, const std::string& aPrefix, size_t aDepth);
+    static std::string Unpack(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aReader, size_t aDepth);
+    static std::string Unpack(const tField& aField, const std::string& aPrefix, const std::string& aReader, const std::string& aKey, size_t aDepth);
+    static std::string Schema(const std::string& aMessage, const std::vector<tField>& aFields, int aIndent);
+private:
+    std::vector<tField> mFields;
+    //
+    //  The fields already reported without a FieldNumber.
+    static std::set<std::string> mUnpinned;
+};
+
+#endif // PROTOCODEC_H
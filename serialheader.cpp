@@ -0,0 +1,152 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <string>
+#include <memory>
+#include <set>
+
+#include "main.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "serialheader.h"
+
+//
+//  Values are moved through an unsigned integer of the same size, so the
+//  conversion works for enums and floats as well. On big endian hosts the
+//  network order is the host order and nothing is swapped.
+static const char* cSerialRuntime = R"RUNTIME(#pragma once
+#ifndef MTTSERIAL_INC
+#define MTTSERIAL_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mtt {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+constexpr bool serial_swap_needed = false;
+#else
+constexpr bool serial_swap_needed = true;
+#endif
+
+inline uint16_t serial_bswap(uint16_t aValue) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(aValue);
+#else
+    return static_cast<uint16_t>((aValue >> 8) | (aValue << 8));
+#endif
+}
+
+inline uint32_t serial_bswap(uint32_t aValue) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(aValue);
+#else
+    return ((aValue >> 24) & 0x000000ffu) | ((aValue >> 8) & 0x0000ff00u) |
+           ((aValue << 8) & 0x00ff0000u) | ((aValue << 24) & 0xff000000u);
+#endif
+}
+
+inline uint64_t serial_bswap(uint64_t aValue) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(aValue);
+#else
+    return (static_cast<uint64_t>(serial_bswap(static_cast<uint32_t>(aValue))) << 32) |
+           serial_bswap(static_cast<uint32_t>(aValue >> 32));
+#endif
+}
+
+template <size_t N> struct serial_uint;
+template <> struct serial_uint<1> { using type = uint8_t; };
+template <> struct serial_uint<2> { using type = uint16_t; };
+template <> struct serial_uint<4> { using type = uint32_t; };
+template <> struct serial_uint<8> { using type = uint64_t; };
+
+template <typename T>
+inline uint8_t* serial_put(uint8_t* aOut, const T& aValue) {
+    static_assert(std::is_trivially_copyable<T>::value, "serial_put needs a scalar value");
+    typename serial_uint<sizeof(T)>::type bits;
+
+    std::memcpy(&bits, &aValue, sizeof(T));
+    if constexpr (serial_swap_needed && (sizeof(T) > 1)) {
+        bits = serial_bswap(bits);
+    }
+    std::memcpy(aOut, &bits, sizeof(T));
+
+    return aOut + sizeof(T);
+}
+
+template <typename T>
+inline uint8_t* serial_get(uint8_t* aIn, T& aValue) {
+    static_assert(std::is_trivially_copyable<T>::value, "serial_get needs a scalar value");
+    typename serial_uint<sizeof(T)>::type bits;
+
+    std::memcpy(&bits, aIn, sizeof(T));
+    if constexpr (serial_swap_needed && (sizeof(T) > 1)) {
+        bits = serial_bswap(bits);
+    }
+    std::memcpy(&aValue, &bits, sizeof(T));
+
+    return aIn + sizeof(T);
+}
+
+template <typename T>
+inline uint8_t* serial_put_n(uint8_t* aOut, const T* aValue, size_t aCount) {
+    if constexpr (serial_swap_needed && (sizeof(T) > 1)) {
+        for (size_t i = 0; i < aCount; ++i) {
+            aOut = serial_put(aOut, aValue[i]);
+        }
+    } else if (aCount != 0) {
+        std::memcpy(aOut, aValue, aCount * sizeof(T));
+        aOut += aCount * sizeof(T);
+    }
+    return aOut;
+}
+
+template <typename T>
+inline uint8_t* serial_get_n(uint8_t* aIn, T* aValue, size_t aCount) {
+    if constexpr (serial_swap_needed && (sizeof(T) > 1)) {
+        for (size_t i = 0; i < aCount; ++i) {
+            aIn = serial_get(aIn, aValue[i]);
+        }
+    } else if (aCount != 0) {
+        std::memcpy(aValue, aIn, aCount * sizeof(T));
+        aIn += aCount * sizeof(T);
+    }
+    return aIn;
+}
+} // namespace mtt
+
+#endif // MTTSERIAL_INC
+)RUNTIME";
+
+void SerialHeader::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "sr-inc", header.buffer()});
+        header << cSerialRuntime;
+        header.close();
+    }
+}
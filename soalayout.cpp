@@ -0,0 +1,343 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <string>
+#include <memory>
+#include <set>
+
+#include "main.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "soalayout.h"
+
+//
+//  The index maps the handles to the position of the elements in the columns.
+//  Erasing an element moves the last one into its place, so the columns stay
+//  dense. The slot of an erased element is reused by a later insert with a
+//  new generation, so the old handle does not reach the new element. The
+//  columns do not use std::vector as a column of bool has to be contiguous as
+//  well.
+static const char* cSoARuntime = R"RUNTIME(#pragma once
+#ifndef MTTSOA_INC
+#define MTTSOA_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
+
+namespace mtt {
+using soa_handle = uint64_t;
+
+template <typename T>
+class soa_column {
+public:
+    T*       data(void) { return mData.get(); }
+    const T* data(void) const { return mData.get(); }
+    size_t   size(void) const { return mSize; }
+    T&       operator[](size_t aIndex) { return mData[aIndex]; }
+    const T& operator[](size_t aIndex) const { return mData[aIndex]; }
+
+    void reserve(size_t aCapacity) {
+        if (aCapacity > mCapacity) {
+            std::unique_ptr<T[]> data(new T[aCapacity]);
+
+            for (size_t i = 0; i < mSize; ++i) {
+                data[i] = std::move(mData[i]);
+            }
+            mData     = std::move(data);
+            mCapacity = aCapacity;
+        }
+    }
+    void push_back(T aValue) {
+        if (mSize == mCapacity) {
+            reserve((mCapacity == 0) ? 16 : 2 * mCapacity);
+        }
+        mData[mSize++] = std::move(aValue);
+    }
+    //
+    //  The last value is moved into the removed one.
+    void swap_remove(size_t aIndex) {
+        --mSize;
+        if (aIndex != mSize) {
+            mData[aIndex] = std::move(mData[mSize]);
+        }
+        mData[mSize] = T();
+    }
+    void clear(void) {
+        mData.reset();
+        mSize     = 0;
+        mCapacity = 0;
+    }
+private:
+    std::unique_ptr<T[]> mData;
+    size_t               mSize     = 0;
+    size_t               mCapacity = 0;
+};
+
+//
+//  A handle carries the slot in the lower and the generation of the slot in
+//  the upper 32 bits. Erasing an element bumps the generation, so a handle
+//  kept past the erase is no longer valid once its slot is reused.
+class soa_index {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+    //
+    //  The new element is the last one in the columns.
+    soa_handle insert(void) {
+        uint32_t slot;
+
+        if (mFree.empty()) {
+            slot = static_cast<uint32_t>(mSlot.size());
+            mSlot.push_back(tSlot());
+        } else {
+            slot = mFree.back();
+            mFree.pop_back();
+        }
+        mSlot[slot].index = static_cast<uint32_t>(mBack.size());
+        mBack.push_back(slot);
+        return make(slot);
+    }
+    //
+    //  Returns the index of the erased element. The columns have to move their
+    //  last value there.
+    size_t erase(soa_handle aHandle) {
+        uint32_t slot  = static_cast<uint32_t>(aHandle);
+        size_t   index = mSlot[slot].index;
+        uint32_t last  = mBack.back();
+
+        mBack[index]      = last;
+        mSlot[last].index = static_cast<uint32_t>(index);
+        mBack.pop_back();
+        mSlot[slot].index = npos;
+        mSlot[slot].generation++;
+        mFree.push_back(slot);
+        return index;
+    }
+    bool valid(soa_handle aHandle) const {
+        uint32_t slot = static_cast<uint32_t>(aHandle);
+
+        return (slot < mSlot.size()) && (mSlot[slot].index != npos) &&
+               (mSlot[slot].generation == static_cast<uint32_t>(aHandle >> 32));
+    }
+    size_t     index(soa_handle aHandle) const { return mSlot[static_cast<uint32_t>(aHandle)].index; }
+    soa_handle handle(size_t aIndex) const { return make(mBack[aIndex]); }
+    size_t     size(void) const { return mBack.size(); }
+    void reserve(size_t aCapacity) {
+        mSlot.reserve(aCapacity);
+        mBack.reserve(aCapacity);
+    }
+    //
+    //  The generations are kept, so handles from before stay invalid.
+    void clear(void) {
+        mFree.clear();
+        for (uint32_t slot = 0; slot < mSlot.size(); ++slot) {
+            if (mSlot[slot].index != npos) {
+                mSlot[slot].index = npos;
+                mSlot[slot].generation++;
+            }
+            mFree.push_back(slot);
+        }
+        mBack.clear();
+    }
+private:
+    struct tSlot {
+        uint32_t index      = npos;
+        uint32_t generation = 0;
+    };
+    soa_handle make(uint32_t aSlot) const {
+        return (static_cast<soa_handle>(mSlot[aSlot].generation) << 32) | aSlot;
+    }
+private:
+    std::vector<tSlot>    mSlot;   //  The index by slot.
+    std::vector<uint32_t> mBack;   //  The slot by index.
+    std::vector<uint32_t> mFree;
+};
+} // namespace mtt
+
+#endif  // MTTSOA_INC
+)RUNTIME";
+
+void SoALayout::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/." + Name();
+    //
+    //  One header per directory is enough.
+    if (done.insert(path).second) {
+        CodeWriter header;
+
+        header.open(path);
+        aModel->generatedfiles.push_back(tGenFile {path, aId, "//", "soa-inc", header.buffer()});
+        header << cSoARuntime;
+        header.close();
+    }
+}
+
+void SoALayout::Member(const std::string& aType, const std::string& aName, const std::string& aExtent, const std::string& aValue, bool aReadOnly) {
+    tColumn column;
+
+    column.type     = aType;
+    column.name     = aName;
+    column.extent   = aExtent;
+    column.value    = aValue;
+    column.readonly = aReadOnly;
+    mColumns.push_back(column);
+}
+
+std::string SoALayout::Definition(void) const {
+    std::string soa = mOwner + "SoA";
+    std::string code = "//\n"
+                       "//  Struct of arrays for " + mOwner + ". The handles stay valid until the element\n"
+                       "//  is erased. The index of an element changes if another one is erased.\n"
+                       "class " + soa + " {\n"
+                       "public:\n"
+                       "    using handle = mtt::soa_handle;\n";
+
+    for (auto & c : mColumns) {
+        code += "    using " + c.name + "_type = " + Type(c) + ";\n";
+    }
+    code += "\n" + Proxy("reference", false) + "\n" + Proxy("const_reference", true) + "\n"
+            "    handle insert(void) {\n";
+    for (auto & c : mColumns) {
+        code += "        m_" + c.name + ".push_back(" + Value(c) + ");\n";
+    }
+    code += "        return mIndex.insert();\n"
+            "    }\n"
+            "    handle insert(const " + mOwner + "& aValue) {\n";
+    for (auto & c : mColumns) {
+        if (c.extent.empty()) {
+            code += "        m_" + c.name + ".push_back(aValue." + c.name + ");\n";
+        } else {
+            code += "        {\n"
+                    "            " + c.name + "_type value;\n"
+                    "\n"
+                    "            std::copy(std::begin(aValue." + c.name + "), std::end(aValue." + c.name + "), value.begin());\n"
+                    "            m_" + c.name + ".push_back(value);\n"
+                    "        }\n";
+        }
+    }
+    code += "        return mIndex.insert();\n"
+            "    }\n"
+            "    void erase(handle aHandle) {\n"
+            "        if (mIndex.valid(aHandle)) {\n"
+            "            size_t index = mIndex.erase(aHandle);\n"
+            "\n";
+    for (auto & c : mColumns) {
+        code += "            m_" + c.name + ".swap_remove(index);\n";
+    }
+    code += "        }\n"
+            "    }\n"
+            "    bool   valid(handle aHandle) const { return mIndex.valid(aHandle); }\n"
+            "    size_t index(handle aHandle) const { return mIndex.index(aHandle); }\n"
+            "    handle at(size_t aIndex) const { return mIndex.handle(aIndex); }\n"
+            "    size_t size(void) const { return mIndex.size(); }\n"
+            "    void reserve(size_t aCapacity) {\n"
+            "        mIndex.reserve(aCapacity);\n";
+    for (auto & c : mColumns) {
+        code += "        m_" + c.name + ".reserve(aCapacity);\n";
+    }
+    code += "    }\n"
+            "    void clear(void) {\n"
+            "        mIndex.clear();\n";
+    for (auto & c : mColumns) {
+        code += "        m_" + c.name + ".clear();\n";
+    }
+    code += "    }\n"
+            "    reference       operator[](handle aHandle) { return reference(*this, mIndex.index(aHandle)); }\n"
+            "    const_reference operator[](handle aHandle) const { return const_reference(*this, mIndex.index(aHandle)); }\n"
+            "    //\n"
+            "    //  The columns and the kernels that run over them in index order. Read only\n"
+            "    //  members are passed as const.\n";
+    for (auto & c : mColumns) {
+        std::string cq = (c.readonly) ? "const " : "";
+
+        if (!c.readonly) {
+            code += "    " + c.name + "_type*       " + c.name + "_data(void) { return m_" + c.name + ".data(); }\n";
+        }
+        code += "    const " + c.name + "_type* " + c.name + "_data(void) const { return m_" + c.name + ".data(); }\n"
+                "    template <typename F>\n"
+                "    void for_each_" + c.name + "(F aKernel)" + ((c.readonly) ? " const" : "") + " {\n"
+                "        " + cq + c.name + "_type* column = m_" + c.name + ".data();\n"
+                "\n"
+                "        for (size_t i = 0, n = size(); i < n; ++i) {\n"
+                "            aKernel(column[i]);\n"
+                "        }\n"
+                "    }\n";
+    }
+    code += "private:\n"
+            "    mtt::soa_index mIndex;\n";
+    for (auto & c : mColumns) {
+        code += "    mtt::soa_column<" + c.name + "_type> m_" + c.name + ";\n";
+    }
+    code += "};\n";
+
+    return code;
+}
+//
+//  The proxy of one element. Read only members have no setter.
+std::string SoALayout::Proxy(const std::string& aName, bool aConst) const {
+    std::string soa   = (aConst) ? "const " + mOwner + "SoA" : mOwner + "SoA";
+    std::string code  = "    class " + aName + " {\n"
+                        "    public:\n"
+                        "        " + aName + "(" + soa + "& aSoA, size_t aIndex) : mSoA(aSoA), mIndex(aIndex) {}\n";
+
+    for (auto & c : mColumns) {
+        if (aConst || c.readonly) {
+            code += "        const " + c.name + "_type& " + c.name + "(void) const { return mSoA.m_" + c.name + "[mIndex]; }\n";
+        } else {
+            code += "        " + c.name + "_type& " + c.name + "(void) const { return mSoA.m_" + c.name + "[mIndex]; }\n"
+                    "        void " + c.name + "(const " + c.name + "_type& aValue) const { mSoA.m_" + c.name + "[mIndex] = aValue; }\n";
+        }
+    }
+    code += "    private:\n"
+            "        " + soa + "& mSoA;\n"
+            "        size_t mIndex;\n"
+            "    };\n";
+
+    return code;
+}
+
+std::string SoALayout::Type(const tColumn& aColumn) {
+    std::string type = aColumn.type;
+
+    if (!aColumn.extent.empty()) {
+        type = "std::array<" + type + ", " + aColumn.extent + ">";
+    }
+    return type;
+}
+//
+//  Arrays and braced default values are list initialized, others are converted.
+std::string SoALayout::Value(const tColumn& aColumn) {
+    std::string value = aColumn.name + "_type()";
+
+    if (!aColumn.value.empty()) {
+        if (aColumn.value[0] == '{') {
+            value = aColumn.name + "_type " + aColumn.value;
+        } else if (!aColumn.extent.empty()) {
+            value = aColumn.name + "_type {" + aColumn.value + "}";
+        } else {
+            value = aColumn.name + "_type(" + aColumn.value + ")";
+        }
+    }
+    return value;
+}
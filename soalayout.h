@@ -0,0 +1,59 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef SOALAYOUT_H
+#define SOALAYOUT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+class CModel;
+
+//
+//  Struct of arrays container for the classes tagged with Layout=SoA. Every
+//  member of the class gets a contiguous column. Elements are addressed by a
+//  handle that stays valid until the element is erased. The proxies give
+//  access to the members of one element and the for_each kernels run over a
+//  single column. The runtime is mttsoa.h, which is generated once per output
+//  directory.
+class SoALayout {
+public:
+    explicit SoALayout(const std::string& aOwner) : mOwner(aOwner) {}
+    static std::string Name(void) { return "mttsoa.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+
+    void Member(const std::string& aType, const std::string& aName, const std::string& aExtent, const std::string& aValue, bool aReadOnly);
+    std::string Definition(void) const;
+private:
+    struct tColumn {
+        std::string type;
+        std::string name;
+        std::string extent;    //  Plain arrays are stored as std::array.
+        std::string value;     //  The default value of new elements.
+        bool        readonly = false;
+    };
+    std::string Proxy(const std::string& aName, bool aConst) const;
+    static std::string Type(const tColumn& aColumn);
+    static std::string Value(const tColumn& aColumn);
+    std::string          mOwner;
+    std::vector<tColumn> mColumns;
+};
+
+#endif // SOALAYOUT_H
@@ -0,0 +1,946 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <set>
+#include <map>
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+#include "main.h"
+#include "crc64.h"
+#include "cmodel.h"
+#include "codewriter.h"
+#include "mattribute.h"
+#include "cattribute.h"
+#include "massociationend.h"
+#include "cassociationend.h"
+#include "cclassbase.h"
+#include "jsonheader.h"
+#include "tlvcodec.h"
+
+//
+//  Integers are written as varint. Signed values and enums are zigzag coded
+//  before, so small negative numbers stay short. Floats are written with
+//  their bits in little endian order. The reader checks every step against
+//  the end of its range. A failure in a nested range is reported by the
+//  reader at the top.
+static const char* cTlvRuntime = R"RUNTIME(#pragma once
+#ifndef MTTTLV_INC
+#define MTTTLV_INC
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+namespace mtt {
+inline size_t tlv_varint_size(uint64_t aValue) {
+    size_t size = 1;
+
+    while (aValue >= 0x80) {
+        aValue >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+inline uint8_t* tlv_put_varint(uint8_t* aOut, uint64_t aValue) {
+    while (aValue >= 0x80) {
+        *aOut++ = static_cast<uint8_t>(aValue | 0x80);
+        aValue >>= 7;
+    }
+    *aOut++ = static_cast<uint8_t>(aValue);
+
+    return aOut;
+}
+
+template <typename T>
+inline uint64_t tlv_encode(T aValue) {
+    if constexpr (std::is_enum<T>::value) {
+        return tlv_encode(static_cast<int64_t>(aValue));
+    } else if constexpr (std::is_signed<T>::value) {
+        return (static_cast<uint64_t>(aValue) << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(aValue) >> 63);
+    } else {
+        return static_cast<uint64_t>(aValue);
+    }
+}
+
+template <typename T>
+inline size_t tlv_value_size(const T& aValue) {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "tlv_value_size needs a number");
+
+    if constexpr (std::is_floating_point<T>::value) {
+        return sizeof(T);
+    } else {
+        return tlv_varint_size(tlv_encode(aValue));
+    }
+}
+
+template <typename T>
+inline uint8_t* tlv_put_value(uint8_t* aOut, const T& aValue) {
+    if constexpr (std::is_floating_point<T>::value) {
+        using bits_t = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+        bits_t bits;
+
+        std::memcpy(&bits, &aValue, sizeof(bits));
+        for (size_t i = 0; i < sizeof(bits); ++i) {
+            *aOut++ = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        return aOut;
+    } else {
+        return tlv_put_varint(aOut, tlv_encode(aValue));
+    }
+}
+
+inline uint8_t* tlv_put_bytes(uint8_t* aOut, const std::string& aValue) {
+    std::memcpy(aOut, aValue.data(), aValue.size());
+    return aOut + aValue.size();
+}
+//
+//  A record is the tag, the length and the payload. A chunk is an element of
+//  an array of strings or records. It has the length only.
+inline size_t tlv_record_size(size_t aPayload) {
+    return 4 + tlv_varint_size(aPayload) + aPayload;
+}
+
+inline size_t tlv_chunk_size(size_t aPayload) {
+    return tlv_varint_size(aPayload) + aPayload;
+}
+
+inline uint8_t* tlv_put_head(uint8_t* aOut, uint32_t aTag, size_t aPayload) {
+    for (size_t i = 0; i < 4; ++i) {
+        *aOut++ = static_cast<uint8_t>(aTag >> (8 * i));
+    }
+    return tlv_put_varint(aOut, aPayload);
+}
+
+class tlv_reader {
+public:
+    tlv_reader(const uint8_t* aData, size_t aSize) : mPos(aData), mEnd(aData + aSize), mGood(&mOwnGood) {}
+
+    bool good() const { return *mGood; }
+    bool more() const { return *mGood && (mPos < mEnd); }
+    //
+    //  Reads the head of the next record and returns the reader of its
+    //  payload. The payload is stepped over, so an unknown tag needs nothing
+    //  to be skipped.
+    tlv_reader record(uint32_t& aTag) {
+        aTag = 0;
+        if ((mEnd - mPos) < 4) {
+            fail();
+            return tlv_reader(*this, mEnd, 0);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            aTag |= static_cast<uint32_t>(*mPos++) << (8 * i);
+        }
+        return chunk();
+    }
+    tlv_reader chunk() {
+        uint64_t size = varint();
+
+        if (size > static_cast<uint64_t>(mEnd - mPos)) {
+            fail();
+            return tlv_reader(*this, mEnd, 0);
+        }
+        tlv_reader payload(*this, mPos, static_cast<size_t>(size));
+
+        mPos += size;
+        return payload;
+    }
+
+    void value(bool& aValue) {
+        aValue = (varint() != 0);
+    }
+    template <typename T>
+    void value(T& aValue) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "tlv_reader::value needs a number");
+
+        if constexpr (std::is_floating_point<T>::value) {
+            using bits_t = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+            bits_t bits = 0;
+
+            if (static_cast<size_t>(mEnd - mPos) < sizeof(bits)) {
+                fail();
+                return;
+            }
+            for (size_t i = 0; i < sizeof(bits); ++i) {
+                bits |= static_cast<bits_t>(*mPos++) << (8 * i);
+            }
+            std::memcpy(&aValue, &bits, sizeof(bits));
+        } else if constexpr (std::is_enum<T>::value) {
+            int64_t value = 0;
+
+            this->value(value);
+            aValue = static_cast<T>(value);
+        } else if constexpr (std::is_signed<T>::value) {
+            uint64_t value = varint();
+
+            aValue = static_cast<T>(static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1));
+        } else {
+            aValue = static_cast<T>(varint());
+        }
+    }
+    //
+    //  A string takes the rest of the range.
+    void value(std::string& aValue) {
+        aValue.assign(reinterpret_cast<const char*>(mPos), mEnd - mPos);
+        mPos = mEnd;
+    }
+private:
+    tlv_reader(const tlv_reader& aParent, const uint8_t* aData, size_t aSize) : mPos(aData), mEnd(aData + aSize), mGood(aParent.mGood) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+
+        for (unsigned shift = 0; (mPos < mEnd) && (shift < 64); shift += 7) {
+            uint8_t byte = *mPos++;
+
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        fail();
+        return 0;
+    }
+    void fail() {
+        *mGood = false;
+        mPos   = mEnd;
+    }
+private:
+    const uint8_t* mPos;
+    const uint8_t* mEnd;
+    bool*          mGood;
+    bool           mOwnGood = true;
+};
+} // namespace mtt
+
+#endif  // MTTTLV_INC
+)RUNTIME";
+
+void TlvCodec::Dump(std::shared_ptr<CModel> aModel, const std::string& aId) {
+    static std::set<std::string> done;
+    std::string                  path = aModel->pathstack.back() + "/.";
+    //
+    //  One header and one benchmark per directory is enough. The benchmark
+    //  compares with the JSON buffer codec.
+    if (done.insert(path).second) {
+        CodeWriter header;
+        CodeWriter bench;
+
+        header.open(path + Name());
+        aModel->generatedfiles.push_back(tGenFile {path + Name(), aId, "//", "t-inc", header.buffer()});
+        header << cTlvRuntime;
+        header.close();
+
+        JsonHeader::Dump(aModel, aId);
+        bench.open(path + "mtttlv_bench.cpp");
+        aModel->generatedfiles.push_back(tGenFile {path + "mtttlv_bench.cpp", aId, "//", "t-bench", bench.buffer()});
+        DumpBench(bench);
+        bench.close();
+    }
+}
+
+uint32_t TlvCodec::Tag(const std::string& aName) {
+    Crc64    crc;
+    uint64_t value = crc.calc(aName);
+
+    return static_cast<uint32_t>(value ^ (value >> 32));
+}
+
+void TlvCodec::Member(std::shared_ptr<CAttribute> a, const std::string& aOwner) {
+    tField field;
+    //
+    //  A pointer to a sim object can not be restored from its id here.
+    if (a->FQN() == "__simobject__") {
+        if ((a->Aggregation != aShared) && Field(field, nullptr, "objectid_t", a->Multiplicity)) {
+            Add(mFields, field, nullptr, aOwner, a->name);
+        }
+    } else if (a->QualifierType.empty() && Field(field, a->Classifier, a->ClassifierName, a->Multiplicity)) {
+        Add(mFields, field, a->Classifier, aOwner, a->name);
+    }
+}
+
+void TlvCodec::Member(std::shared_ptr<CAssociationEnd> a, const std::string& aOwner) {
+    tField field;
+
+    if (a->QualifierType.empty() && !a->HasContainerPolicy() &&
+        Field(field, a->Classifier, (a->Classifier) ? a->Classifier->name : std::string(), a->Multiplicity)) {
+        Add(mFields, field, a->Classifier, aOwner, a->name);
+    }
+}
+
+std::string TlvCodec::Size(int aIndent) const {
+    return CodeWriter::shift("size_t size = 0;\n\n" + Size(mFields, "this->", "size", 0) + "\nreturn size;\n", aIndent);
+}
+
+std::string TlvCodec::Pack(int aIndent) const {
+    return CodeWriter::shift(Pack(mFields, "this->", 0) + "\nreturn aOut;\n", aIndent);
+}
+
+std::string TlvCodec::Unpack(int aIndent) const {
+    return CodeWriter::shift(Unpack(mFields, "this->", "aReader", 0) + "\nreturn aReader.good();\n", aIndent);
+}
+//
+//  Optional members, maps and containers with a policy have no TLV form and
+//  are left out.
+bool TlvCodec::Field(tField& aField, std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aMultiplicity) {
+    if (aMultiplicity.empty() || (aMultiplicity == "1")) {
+        aField.count = eCount::single;
+    } else if (aMultiplicity == "0..1") {
+        return false;
+    } else if (std::all_of(aMultiplicity.begin(), aMultiplicity.end(), ::isdigit)) {
+        aField.count = eCount::array;
+    } else {
+        aField.count = eCount::vector;
+    }
+    if (aClassifier && ((aClassifier->type == eElementType::Struct) || (aClassifier->type == eElementType::SimStruct) ||
+                        (aClassifier->type == eElementType::CxxClass))) {
+        aField.kind = eKind::record;
+    } else if ((aType == "string") || (aType == "std::string")) {
+        aField.kind = eKind::string;
+    } else {
+        aField.kind = eKind::scalar;
+    }
+    return true;
+}
+
+void TlvCodec::Add(std::vector<tField>& aFields, tField& aField, std::shared_ptr<MElement> aClassifier, const std::string& aOwner, const std::string& aMember) {
+    aField.label  = aOwner + "::" + aMember;
+    aField.member = aMember;
+    aField.tag    = Tag(aField.label);
+    for (auto & f : aFields) {
+        if (f.tag == aField.tag) {
+            std::cerr << "TLV tag of " << aField.label << " collides with " << f.label << ". The member is left out.\n";
+            return;
+        }
+    }
+    if (aField.kind == eKind::record) {
+        Fields(aField.fields, aClassifier);
+    }
+    aFields.push_back(aField);
+}
+
+void TlvCodec::Fields(std::vector<tField>& aFields, std::shared_ptr<MElement> aStruct) {
+    auto s = std::dynamic_pointer_cast<CClassBase>(aStruct);
+
+    if (s) {
+        for (auto & ai : s->GetAttributes()) {
+            auto  a = std::dynamic_pointer_cast<CAttribute>(ai);
+            tField field;
+
+            if (a->QualifierType.empty() && Field(field, a->Classifier, a->ClassifierName, a->Multiplicity)) {
+                Add(aFields, field, a->Classifier, s->FQN(), a->name);
+            }
+        }
+        for (auto & ae : s->OtherEnd) {
+            auto   a = std::dynamic_pointer_cast<CAssociationEnd>(*ae);
+            tField field;
+
+            if (a->isNavigable() && a->QualifierType.empty() && !a->HasContainerPolicy() &&
+                Field(field, a->Classifier, (a->Classifier) ? a->Classifier->name : std::string(), a->Multiplicity)) {
+                Add(aFields, field, a->Classifier, s->FQN(), a->name);
+            }
+        }
+    }
+}
+
+std::string TlvCodec::Size(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aTarget, size_t aDepth) {
+    std::string code;
+
+    for (auto & f : aFields) {
+        code += Size(f, aPrefix, aTarget, aDepth);
+    }
+    return code;
+}
+
+std::string TlvCodec::Size(const tField& aField, const std::string& aPrefix, const std::string& aTarget, size_t aDepth) {
+    std::string expr    = aPrefix + aField.member;
+    std::string size    = "s" + std::to_string(aDepth);
+    std::string element = "e" + std::to_string(aDepth);
+
+    if (aField.count != eCount::single) {
+        return "{\n"
+               "    size_t " + size + " = 0;\n"
+               "\n"
+               "    for (const auto& " + element + " : " + expr + ") {\n" +
+               CodeWriter::shift(ElementSize(aField, element, size, aDepth + 1), 8) +
+               "    }\n"
+               "    " + aTarget + " += mtt::tlv_record_size(" + size + ");\n"
+               "}\n";
+    }
+    switch (aField.kind) {
+    case eKind::scalar:
+        return aTarget + " += mtt::tlv_record_size(mtt::tlv_value_size(" + expr + "));\n";
+    case eKind::string:
+        return aTarget + " += mtt::tlv_record_size(" + expr + ".size());\n";
+    case eKind::record:
+        break;
+    }
+    return "{\n"
+           "    size_t " + size + " = 0;\n"
+           "\n" +
+           CodeWriter::shift(Size(aField.fields, expr + ".", size, aDepth + 1), 4) +
+           "    " + aTarget + " += mtt::tlv_record_size(" + size + ");\n"
+           "}\n";
+}
+
+std::string TlvCodec::ElementSize(const tField& aField, const std::string& aElement, const std::string& aTarget, size_t aDepth) {
+    std::string size = "s" + std::to_string(aDepth);
+
+    switch (aField.kind) {
+    case eKind::scalar:
+        return aTarget + " += mtt::tlv_value_size(" + aElement + ");\n";
+    case eKind::string:
+        return aTarget + " += mtt::tlv_chunk_size(" + aElement + ".size());\n";
+    case eKind::record:
+        break;
+    }
+    return "size_t " + size + " = 0;\n"
+           "\n" +
+           Size(aField.fields, aElement + ".", size, aDepth + 1) +
+           aTarget + " += mtt::tlv_chunk_size(" + size + ");\n";
+}
+
+std::string TlvCodec::Pack(const std::vector<tField>& aFields, const std::string& aPrefix, size_t aDepth) {
+    std::string code;
+
+    for (auto & f : aFields) {
+        code += Pack(f, aPrefix, aDepth);
+    }
+    return code;
+}
+
+std::string TlvCodec::Pack(const tField& aField, const std::string& aPrefix, size_t aDepth) {
+    std::string expr    = aPrefix + aField.member;
+    std::string size    = "s" + std::to_string(aDepth);
+    std::string element = "e" + std::to_string(aDepth);
+    std::string tag     = Hex(aField.tag);
+
+    if (aField.count != eCount::single) {
+        return "{\n"
+               "    size_t " + size + " = 0;\n"
+               "\n"
+               "    for (const auto& " + element + " : " + expr + ") {\n" +
+               CodeWriter::shift(ElementSize(aField, element, size, aDepth + 1), 8) +
+               "    }\n"
+               "    aOut = mtt::tlv_put_head(aOut, " + tag + ", " + size + ");   // " + aField.label + "\n"
+               "    for (const auto& " + element + " : " + expr + ") {\n" +
+               CodeWriter::shift(ElementPack(aField, element, aDepth + 1), 8) +
+               "    }\n"
+               "}\n";
+    }
+    switch (aField.kind) {
+    case eKind::scalar:
+        return "aOut = mtt::tlv_put_head(aOut, " + tag + ", mtt::tlv_value_size(" + expr + "));   // " + aField.label + "\n"
+               "aOut = mtt::tlv_put_value(aOut, " + expr + ");\n";
+    case eKind::string:
+        return "aOut = mtt::tlv_put_head(aOut, " + tag + ", " + expr + ".size());   // " + aField.label + "\n"
+               "aOut = mtt::tlv_put_bytes(aOut, " + expr + ");\n";
+    case eKind::record:
+        break;
+    }
+    return "{\n"
+           "    size_t " + size + " = 0;\n"
+           "\n" +
+           CodeWriter::shift(Size(aField.fields, expr + ".", size, aDepth + 1), 4) +
+           "    aOut = mtt::tlv_put_head(aOut, " + tag + ", " + size + ");   // " + aField.label + "\n" +
+           CodeWriter::shift(Pack(aField.fields, expr + ".", aDepth + 1), 4) +
+           "}\n";
+}
+
+std::string TlvCodec::ElementPack(const tField& aField, const std::string& aElement, size_t aDepth) {
+    std::string size = "s" + std::to_string(aDepth);
+
+    switch (aField.kind) {
+    case eKind::scalar:
+        return "aOut = mtt::tlv_put_value(aOut, " + aElement + ");\n";
+    case eKind::string:
+        return "aOut = mtt::tlv_put_varint(aOut, " + aElement + ".size());\n"
+               "aOut = mtt::tlv_put_bytes(aOut, " + aElement + ");\n";
+    case eKind::record:
+        break;
+    }
+    return "size_t " + size + " = 0;\n"
+           "\n" +
+           Size(aField.fields, aElement + ".", size, aDepth + 1) +
+           "aOut = mtt::tlv_put_varint(aOut, " + size + ");\n" +
+           Pack(aField.fields, aElement + ".", aDepth + 1);
+}
+
+std::string TlvCodec::Unpack(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aReader, size_t aDepth) {
+    std::string tag     = "t" + std::to_string(aDepth);
+    std::string payload = "r" + std::to_string(aDepth);
+    std::string code;
+    //
+    //  The payload of a record with an unknown tag is dropped.
+    code = "while (" + aReader + ".more()) {\n"
+           "    uint32_t        " + tag + ";\n"
+           "    mtt::tlv_reader " + payload + " = " + aReader + ".record(" + tag + ");\n"
+           "\n"
+           "    switch (" + tag + ") {\n";
+    for (auto & f : aFields) {
+        code += "    case " + Hex(f.tag) + ":   // " + f.label + "\n" +
+                CodeWriter::shift(Unpack(f, aPrefix, payload, aDepth + 1), 8) +
+                "        break;\n";
+    }
+    code += "    default:\n"
+            "        break;\n"
+            "    }\n"
+            "}\n";
+
+    return code;
+}
+
+std::string TlvCodec::Unpack(const tField& aField, const std::string& aPrefix, const std::string& aReader, size_t aDepth) {
+    std::string expr    = aPrefix + aField.member;
+    std::string element = "e" + std::to_string(aDepth);
+    std::string index   = "n" + std::to_string(aDepth);
+
+    switch (aField.count) {
+    case eCount::vector:
+        return expr + ".clear();\n"
+               "while (" + aReader + ".more()) {\n"
+               "    auto& " + element + " = " + expr + ".emplace_back();\n"
+               "\n" +
+               CodeWriter::shift(ElementUnpack(aField, element, aReader, aDepth + 1), 4) +
+               "}\n";
+    case eCount::array:
+        //
+        //  Elements that do not fit into the array are dropped.
+        return "{\n"
+               "    size_t " + index + " = 0;\n"
+               "\n"
+               "    while (" + aReader + ".more() && (" + index + " < std::size(" + expr + "))) {\n"
+               "        auto& " + element + " = " + expr + "[" + index + "++];\n"
+               "\n" +
+               CodeWriter::shift(ElementUnpack(aField, element, aReader, aDepth + 1), 8) +
+               "    }\n"
+               "}\n";
+    case eCount::single:
+        break;
+    }
+    if (aField.kind == eKind::record) {
+        return Unpack(aField.fields, expr + ".", aReader, aDepth + 1);
+    }
+    return aReader + ".value(" + expr + ");\n";
+}
+
+std::string TlvCodec::ElementUnpack(const tField& aField, const std::string& aElement, const std::string& aReader, size_t aDepth) {
+    std::string chunk = "c" + std::to_string(aDepth);
+
+    switch (aField.kind) {
+    case eKind::scalar:
+        return aReader + ".value(" + aElement + ");\n";
+    case eKind::string:
+        return "mtt::tlv_reader " + chunk + " = " + aReader + ".chunk();\n"
+               "\n" +
+               chunk + ".value(" + aElement + ");\n";
+    case eKind::record:
+        break;
+    }
+    return "mtt::tlv_reader " + chunk + " = " + aReader + ".chunk();\n"
+           "\n" +
+           Unpack(aField.fields, aElement + ".", chunk, aDepth + 1);
+}
+
+std::string TlvCodec::Hex(uint32_t aTag) {
+    static const char cHex[] = "0123456789abcdef";
+    std::string       hex    = "0x";
+
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        hex.push_back(cHex[(aTag >> shift) & 0xf]);
+    }
+    return hex;
+}
+
+//
+//  The bench record has a member of every kind the codec knows. Its TLV code
+//  is made by the codec itself, the JSON code is written the way the buffer
+//  encoder and the decoder of the signal classes write it. The bench checks
+//  the round trip of both before it measures them.
+void TlvCodec::DumpBench(std::ostream &output) {
+    TlvCodec codec;
+    uint32_t unknown = 0;
+    auto     field   = [](const std::string& aOwner, const std::string& aMember, eKind aKind, eCount aCount) {
+        tField f;
+
+        f.label  = aOwner + "::" + aMember;
+        f.member = aMember;
+        f.tag    = Tag(f.label);
+        f.kind   = aKind;
+        f.count  = aCount;
+        return f;
+    };
+    std::vector<tField> pose = {field("BenchPose", "x", eKind::scalar, eCount::single),
+                                field("BenchPose", "y", eKind::scalar, eCount::single),
+                                field("BenchPose", "heading", eKind::scalar, eCount::single)};
+
+    codec.mFields = {field("BenchRecord", "code", eKind::scalar, eCount::single),
+                     field("BenchRecord", "delta", eKind::scalar, eCount::single),
+                     field("BenchRecord", "ok", eKind::scalar, eCount::single),
+                     field("BenchRecord", "mode", eKind::scalar, eCount::single),
+                     field("BenchRecord", "load", eKind::scalar, eCount::single),
+                     field("BenchRecord", "text", eKind::string, eCount::single),
+                     field("BenchRecord", "samples", eKind::scalar, eCount::vector),
+                     field("BenchRecord", "names", eKind::string, eCount::vector),
+                     field("BenchRecord", "win", eKind::scalar, eCount::array),
+                     field("BenchRecord", "pose", eKind::record, eCount::single),
+                     field("BenchRecord", "poses", eKind::record, eCount::vector)};
+    codec.mFields[9].fields  = pose;
+    codec.mFields[10].fields = pose;
+    //
+    //  The tag of the record the reader has to step over.
+    while (std::any_of(codec.mFields.begin(), codec.mFields.end(), [&](const tField& f) { return f.tag == unknown; })) {
+        ++unknown;
+    }
+
+    output << "//\n"
+              "//  Round trip test and micro benchmark of the TLV codec against the JSON\n"
+              "//  buffer codec on a record with a member of every kind.\n"
+              "//\n"
+              "//  g++ -O2 -std=c++17 -I. mtttlv_bench.cpp -o mtttlv_bench\n"
+              "//\n"
+              "#include <algorithm>\n"
+              "#include <chrono>\n"
+              "#include <cstdint>\n"
+              "#include <cstdio>\n"
+              "#include <cstdlib>\n"
+              "#include <iterator>\n"
+              "#include <string>\n"
+              "#include <string_view>\n"
+              "#include <vector>\n\n"
+              "#include \"" << Name() << "\"\n"
+              "#include \"" << JsonHeader::Name() << "\"\n\n"
+              "enum class eBenchMode : int16_t {\n"
+              "    Off   = 0,\n"
+              "    Eco   = 1,\n"
+              "    Sport = -300\n"
+              "};\n\n"
+              "struct BenchPose {\n"
+              "    double  x       = 0.0;\n"
+              "    double  y       = 0.0;\n"
+              "    int32_t heading = 0;\n"
+              "};\n\n"
+              "struct BenchRecord {\n"
+              "    uint32_t                 code   = 0;\n"
+              "    int64_t                  delta  = 0;\n"
+              "    bool                     ok     = false;\n"
+              "    eBenchMode               mode   = eBenchMode::Off;\n"
+              "    float                    load   = 0.0f;\n"
+              "    std::string              text;\n"
+              "    std::vector<int32_t>     samples;\n"
+              "    std::vector<std::string> names;\n"
+              "    int16_t                  win[4] = {};\n"
+              "    BenchPose                pose;\n"
+              "    std::vector<BenchPose>   poses;\n\n"
+              "    size_t tlv_size() const {\n"
+           << codec.Size(8)
+           << "    }\n"
+              "    uint8_t* pack_tlv(uint8_t* aOut) const {\n"
+           << codec.Pack(8)
+           << "    }\n"
+              "    bool unpack_tlv(mtt::tlv_reader& aReader) {\n"
+           << codec.Unpack(8)
+           << "    }\n"
+              "    size_t json_size() const;\n"
+              "    char* json(char* aOut) const;\n"
+              "    bool unpack_json(mtt::json_reader& aReader);\n"
+              "};\n\n";
+    //
+    //  The JSON codec.
+    output << "static char* json(char* aOut, const BenchPose& aPose) {\n"
+              "    aOut = mtt::json_put(aOut, \"{\\\"x\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, aPose.x);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"y\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, aPose.y);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"heading\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, aPose.heading);\n\n"
+              "    return mtt::json_put(aOut, \"}\");\n"
+              "}\n\n"
+              "static void unpack_json(mtt::json_reader& aReader, BenchPose& aPose) {\n"
+              "    std::string_view key;\n\n"
+              "    aReader.open('{');\n"
+              "    while (aReader.key(key)) {\n"
+              "        if (key == \"x\") {\n"
+              "            aReader.value(aPose.x);\n"
+              "        } else if (key == \"y\") {\n"
+              "            aReader.value(aPose.y);\n"
+              "        } else if (key == \"heading\") {\n"
+              "            aReader.value(aPose.heading);\n"
+              "        } else {\n"
+              "            aReader.skip();\n"
+              "        }\n"
+              "    }\n"
+              "}\n\n"
+              "size_t BenchRecord::json_size() const {\n"
+              "    size_t size = 256 + 13 * mtt::json_number_bound;\n\n"
+              "    size += mtt::json_bound(text);\n"
+              "    size += samples.size() * (1 + mtt::json_number_bound);\n"
+              "    for (const auto& a : names) {\n"
+              "        size += mtt::json_bound(a) + 1;\n"
+              "    }\n"
+              "    size += poses.size() * (32 + 3 * mtt::json_number_bound);\n\n"
+              "    return size;\n"
+              "}\n\n"
+              "char* BenchRecord::json(char* aOut) const {\n"
+              "    aOut = mtt::json_put(aOut, \"{\\\"code\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, code);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"delta\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, delta);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"ok\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, ok);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"mode\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, mode);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"load\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, load);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"text\\\":\");\n"
+              "    aOut = mtt::json_value(aOut, text);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"samples\\\":[\");\n"
+              "    for (const auto& a : samples) {\n"
+              "        aOut = mtt::json_value(aOut, a);\n"
+              "        aOut = mtt::json_put(aOut, \",\");\n"
+              "    }\n"
+              "    aOut = mtt::json_close(aOut, ']');\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"names\\\":[\");\n"
+              "    for (const auto& a : names) {\n"
+              "        aOut = mtt::json_value(aOut, a);\n"
+              "        aOut = mtt::json_put(aOut, \",\");\n"
+              "    }\n"
+              "    aOut = mtt::json_close(aOut, ']');\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"win\\\":[\");\n"
+              "    for (const auto& a : win) {\n"
+              "        aOut = mtt::json_value(aOut, a);\n"
+              "        aOut = mtt::json_put(aOut, \",\");\n"
+              "    }\n"
+              "    aOut = mtt::json_close(aOut, ']');\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"pose\\\":\");\n"
+              "    aOut = ::json(aOut, pose);\n"
+              "    aOut = mtt::json_put(aOut, \",\\\"poses\\\":[\");\n"
+              "    for (const auto& a : poses) {\n"
+              "        aOut = ::json(aOut, a);\n"
+              "        aOut = mtt::json_put(aOut, \",\");\n"
+              "    }\n"
+              "    aOut = mtt::json_close(aOut, ']');\n\n"
+              "    return mtt::json_put(aOut, \"}\");\n"
+              "}\n\n"
+              "bool BenchRecord::unpack_json(mtt::json_reader& aReader) {\n"
+              "    std::string_view key;\n\n"
+              "    aReader.open('{');\n"
+              "    while (aReader.key(key)) {\n"
+              "        if (key == \"code\") {\n"
+              "            aReader.value(code);\n"
+              "        } else if (key == \"delta\") {\n"
+              "            aReader.value(delta);\n"
+              "        } else if (key == \"ok\") {\n"
+              "            aReader.value(ok);\n"
+              "        } else if (key == \"mode\") {\n"
+              "            aReader.value(mode);\n"
+              "        } else if (key == \"load\") {\n"
+              "            aReader.value(load);\n"
+              "        } else if (key == \"text\") {\n"
+              "            aReader.value(text);\n"
+              "        } else if (key == \"samples\") {\n"
+              "            samples.clear();\n"
+              "            aReader.open('[');\n"
+              "            while (aReader.more(']')) {\n"
+              "                aReader.value(samples.emplace_back());\n"
+              "            }\n"
+              "        } else if (key == \"names\") {\n"
+              "            names.clear();\n"
+              "            aReader.open('[');\n"
+              "            while (aReader.more(']')) {\n"
+              "                aReader.value(names.emplace_back());\n"
+              "            }\n"
+              "        } else if (key == \"win\") {\n"
+              "            size_t n = 0;\n\n"
+              "            aReader.open('[');\n"
+              "            while (aReader.more(']')) {\n"
+              "                if (n < std::size(win)) {\n"
+              "                    aReader.value(win[n++]);\n"
+              "                } else {\n"
+              "                    aReader.skip();\n"
+              "                }\n"
+              "            }\n"
+              "        } else if (key == \"pose\") {\n"
+              "            ::unpack_json(aReader, pose);\n"
+              "        } else if (key == \"poses\") {\n"
+              "            poses.clear();\n"
+              "            aReader.open('[');\n"
+              "            while (aReader.more(']')) {\n"
+              "                ::unpack_json(aReader, poses.emplace_back());\n"
+              "            }\n"
+              "        } else {\n"
+              "            aReader.skip();\n"
+              "        }\n"
+              "    }\n"
+              "    return aReader.good();\n"
+              "}\n\n";
+    //
+    //  The records, the round trip and the timing.
+    output << "static bool same(const BenchPose& a, const BenchPose& b) {\n"
+              "    return (a.x == b.x) && (a.y == b.y) && (a.heading == b.heading);\n"
+              "}\n\n"
+              "static bool same(const BenchRecord& a, const BenchRecord& b) {\n"
+              "    return (a.code == b.code) && (a.delta == b.delta) && (a.ok == b.ok) && (a.mode == b.mode) && (a.load == b.load) &&\n"
+              "           (a.text == b.text) && (a.samples == b.samples) && (a.names == b.names) &&\n"
+              "           std::equal(std::begin(a.win), std::end(a.win), std::begin(b.win)) && same(a.pose, b.pose) &&\n"
+              "           std::equal(a.poses.begin(), a.poses.end(), b.poses.begin(), b.poses.end(),\n"
+              "                      [](const BenchPose& l, const BenchPose& r) { return same(l, r); });\n"
+              "}\n\n"
+              "static uint32_t next(uint32_t& x) {\n"
+              "    x ^= x << 13;\n"
+              "    x ^= x >> 17;\n"
+              "    x ^= x << 5;\n"
+              "    return x;\n"
+              "}\n\n"
+              "static BenchPose make_pose(uint32_t& x) {\n"
+              "    BenchPose pose;\n\n"
+              "    pose.x       = static_cast<double>(next(x)) / 1024.0 - 2.0e6;\n"
+              "    pose.y       = static_cast<double>(next(x)) / 3.0;\n"
+              "    pose.heading = static_cast<int32_t>(next(x) % 360) - 180;\n"
+              "    return pose;\n"
+              "}\n\n"
+              "static BenchRecord make(uint32_t& x) {\n"
+              "    static const char*       cWords[5] = {\"\", \"gear\", \"a \\\"quoted\\\" name\", \"tab\\tand\\nnewline\", \"brake\"};\n"
+              "    static const eBenchMode  cModes[3] = {eBenchMode::Off, eBenchMode::Eco, eBenchMode::Sport};\n"
+              "    BenchRecord              record;\n\n"
+              "    record.code  = next(x);\n"
+              "    record.delta = (static_cast<int64_t>(next(x)) << 20) - (static_cast<int64_t>(1) << 50);\n"
+              "    record.ok    = (next(x) & 1) != 0;\n"
+              "    record.mode  = cModes[next(x) % 3];\n"
+              "    record.load  = static_cast<float>(next(x) % 100000) / 7.0f;\n"
+              "    record.text  = cWords[next(x) % 5];\n"
+              "    for (uint32_t i = next(x) % 16; i > 0; --i) {\n"
+              "        record.samples.push_back(static_cast<int32_t>(next(x)) >> (next(x) % 31));\n"
+              "    }\n"
+              "    for (uint32_t i = next(x) % 4; i > 0; --i) {\n"
+              "        record.names.push_back(cWords[next(x) % 5]);\n"
+              "    }\n"
+              "    for (auto & w : record.win) {\n"
+              "        w = static_cast<int16_t>(next(x));\n"
+              "    }\n"
+              "    record.pose = make_pose(x);\n"
+              "    for (uint32_t i = next(x) % 4; i > 0; --i) {\n"
+              "        record.poses.push_back(make_pose(x));\n"
+              "    }\n"
+              "    return record;\n"
+              "}\n\n"
+              "//\n"
+              "//  Both codecs have to give the record back unchanged. The TLV reader\n"
+              "//  has to step over a record with an unknown tag and has to fail on data\n"
+              "//  that is cut short.\n"
+              "static bool check(const BenchRecord& aRecord) {\n"
+              "    std::vector<uint8_t> tlv(aRecord.tlv_size() + 8);\n"
+              "    std::vector<char>    text(aRecord.json_size());\n"
+              "    uint8_t*             start = mtt::tlv_put_head(tlv.data(), " << Hex(unknown) << ", 3);\n"
+              "    uint8_t*             end   = aRecord.pack_tlv(start + 3);\n"
+              "    BenchRecord          back;\n\n"
+              "    if (static_cast<size_t>(end - start - 3) != aRecord.tlv_size()) {\n"
+              "        return false;\n"
+              "    }\n"
+              "    mtt::tlv_reader whole(tlv.data(), end - tlv.data());\n\n"
+              "    if (!back.unpack_tlv(whole) || !same(aRecord, back)) {\n"
+              "        return false;\n"
+              "    }\n"
+              "    mtt::tlv_reader cut(tlv.data(), end - tlv.data() - 1);\n\n"
+              "    if (BenchRecord().unpack_tlv(cut)) {\n"
+              "        return false;\n"
+              "    }\n"
+              "    char*            last = aRecord.json(text.data());\n"
+              "    mtt::json_reader reader(text.data(), last - text.data());\n\n"
+              "    back = BenchRecord();\n"
+              "    return back.unpack_json(reader) && same(aRecord, back);\n"
+              "}\n\n"
+              "template <class F>\n"
+              "static double run(F aPass, size_t aRecords, int aRounds) {\n"
+              "    auto start = std::chrono::steady_clock::now();\n\n"
+              "    for (int r = 0; r < aRounds; ++r) {\n"
+              "        aPass();\n"
+              "    }\n"
+              "    std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;\n\n"
+              "    return took.count() / (static_cast<double>(aRecords) * aRounds);\n"
+              "}\n\n"
+              "int main(int argc, char** argv) {\n"
+              "    const int                   rounds = (argc > 1) ? std::atoi(argv[1]) : 20;\n"
+              "    std::vector<BenchRecord>    records(1u << 12);\n"
+              "    std::vector<const uint8_t*> tlvat(records.size() + 1);\n"
+              "    std::vector<const char*>    jsonat(records.size() + 1);\n"
+              "    std::vector<uint8_t>        tlv;\n"
+              "    std::vector<char>           text;\n"
+              "    size_t                      tlvsize  = 0;\n"
+              "    size_t                      jsonsize = 0;\n"
+              "    uint32_t                    x = 2463534242u;\n"
+              "    BenchRecord                 sink;\n"
+              "    bool                        good = true;\n\n"
+              "    for (auto & r : records) {\n"
+              "        r = make(x);\n"
+              "        if (!check(r)) {\n"
+              "            std::printf(\"the round trip failed\\n\");\n"
+              "            return 1;\n"
+              "        }\n"
+              "        tlvsize  += r.tlv_size();\n"
+              "        jsonsize += r.json_size();\n"
+              "    }\n"
+              "    tlv.resize(tlvsize);\n"
+              "    text.resize(jsonsize);\n"
+              "    tlvat[0]  = tlv.data();\n"
+              "    jsonat[0] = text.data();\n"
+              "    for (size_t i = 0; i < records.size(); ++i) {\n"
+              "        tlvat[i + 1]  = records[i].pack_tlv(const_cast<uint8_t*>(tlvat[i]));\n"
+              "        jsonat[i + 1] = records[i].json(const_cast<char*>(jsonat[i]));\n"
+              "    }\n"
+              "    double tp = run([&] {\n"
+              "        uint8_t* out = tlv.data();\n\n"
+              "        for (const auto& r : records) {\n"
+              "            out = r.pack_tlv(out);\n"
+              "        }\n"
+              "    }, records.size(), rounds);\n"
+              "    double tu = run([&] {\n"
+              "        for (size_t i = 0; i < records.size(); ++i) {\n"
+              "            mtt::tlv_reader reader(tlvat[i], tlvat[i + 1] - tlvat[i]);\n\n"
+              "            good = sink.unpack_tlv(reader) && good;\n"
+              "        }\n"
+              "    }, records.size(), rounds);\n"
+              "    double jp = run([&] {\n"
+              "        char* out = text.data();\n\n"
+              "        for (const auto& r : records) {\n"
+              "            out = r.json(out);\n"
+              "        }\n"
+              "    }, records.size(), rounds);\n"
+              "    double ju = run([&] {\n"
+              "        for (size_t i = 0; i < records.size(); ++i) {\n"
+              "            mtt::json_reader reader(jsonat[i], jsonat[i + 1] - jsonat[i]);\n\n"
+              "            good = sink.unpack_json(reader) && good;\n"
+              "        }\n"
+              "    }, records.size(), rounds);\n"
+              "    double n  = static_cast<double>(records.size());\n\n"
+              "    std::printf(\"tlv  : pack %7.1f ns  unpack %7.1f ns  %7.1f bytes/record\\n\", tp, tu, (tlvat.back() - tlvat.front()) / n);\n"
+              "    std::printf(\"json : pack %7.1f ns  unpack %7.1f ns  %7.1f bytes/record\\n\", jp, ju, (jsonat.back() - jsonat.front()) / n);\n"
+              "    if (!good) {\n"
+              "        std::printf(\"a record did not decode\\n\");\n"
+              "        return 1;\n"
+              "    }\n"
+              "    return 0;\n"
+              "}\n";
+}
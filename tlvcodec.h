@@ -0,0 +1,97 @@
+//
+// Copyright 2024 Hans-Juergen Lange <hjl@simulated-universe.de>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef TLVCODEC_H
+#define TLVCODEC_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+class CModel;
+class MElement;
+class CAttribute;
+class CAssociationEnd;
+
+//
+//  Binary TLV codec of the signal classes with the TLV stereotype. Each member
+//  is written as a record of a 32 bit tag, a varint length and the payload.
+//  The tag is folded from the crc64 of the member name qualified by its owner,
+//  so it does not change if members are added or reordered. Decoders skip the
+//  records with unknown tags. The runtime is mtttlv.h, which is generated once
+//  per output directory together with the round trip test and benchmark
+//  mtttlv_bench.cpp.
+class TlvCodec {
+public:
+    static std::string Name(void) { return "mtttlv.h"; }
+    static void Dump(std::shared_ptr<CModel> aModel, const std::string& aId);
+    static uint32_t Tag(const std::string& aName);
+
+    void Member(std::shared_ptr<CAttribute> a, const std::string& aOwner);
+    void Member(std::shared_ptr<CAssociationEnd> a, const std::string& aOwner);
+    //
+    //  The code of the size, pack and unpack bodies. The unpack body reads
+    //  from the mtt::tlv_reader aReader.
+    std::string Size(int aIndent) const;
+    std::string Pack(int aIndent) const;
+    std::string Unpack(int aIndent) const;
+private:
+    enum class eKind {
+        scalar,     //  Integers, enums and bools as varint. Floats fixed size.
+        string,
+        record      //  Structs as nested records.
+    };
+    enum class eCount {
+        single,
+        vector,
+        array
+    };
+    struct tField {
+        uint32_t            tag = 0;
+        std::string         label;
+        std::string         member;
+        eKind               kind  = eKind::scalar;
+        eCount              count = eCount::single;
+        std::vector<tField> fields;
+    };
+    //
+    //  The code generators take the depth of nesting. Each declares its
+    //  variables with the depth as suffix and passes the next depth on.
+    static bool Field(tField& aField, std::shared_ptr<MElement> aClassifier, const std::string& aType, const std::string& aMultiplicity);
+    static void Add(std::vector<tField>& aFields, tField& aField, std::shared_ptr<MElement> aClassifier, const std::string& aOwner, const std::string& aMember);
+    static void Fields(std::vector<tField>& aFields, std::shared_ptr<MElement> aStruct);
+    static std::string Size(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aTarget, size_t aDepth);
+    static std::string Size(const tField& aField, const std::string& aPrefix, const std::string& aTarget, size_t aDepth);
+    static std::string ElementSize(const tField& aField, const std::string& aElement, const std::string& aTarget, size_t aDepth);
+    static std::string Pack(const std::vector<tField>& aFields, const std::string& aPrefix, size_t aDepth);
+    static std::string Pack(const tField& aField, const std::string& aPrefix, size_t aDepth);
+    static std::string ElementPack(const tField& aField, const std::string& aElement, size_t aDepth);
+    static std::string Unpack(const std::vector<tField>& aFields, const std::string& aPrefix, const std::string& aReader, size_t aDepth);
+    static std::string Unpack(const tField& aField, const std::string& aPrefix, const std::string& aReader, size_t aDepth);
+    static std::string ElementUnpack(const tField& aField, const std::string& aElement, const std::string& aReader, size_t aDepth);
+    static std::string Hex(uint32_t aTag);
+    static void DumpBench(std::ostream& output);
+private:
+    std::vector<tField> mFields;
+};
+
+#endif // TLVCODEC_H